@@ -18,7 +18,10 @@ bool BpmEditMode::OnMouseLeftButtonClicked(const bool InIsShiftDown)
     {
         _MovableStop = _HoveredStop;
         _MovableStopInitialValue = *_MovableStop;
-        static_Chart->RegisterTimeSliceHistory(_MovableStop->TimePoint);
+
+        //the drag stays one transaction until the button is released
+        static_Chart->BeginTransaction();
+        static_Chart->JournalTimingChange(_MovableStop->TimePoint);
         return false;
     }
 
@@ -26,7 +29,9 @@ bool BpmEditMode::OnMouseLeftButtonClicked(const bool InIsShiftDown)
     {
         _MovableSV = _HoveredSV;
         _MovableSVInitialValue = *_MovableSV;
-        static_Chart->RegisterTimeSliceHistory(_MovableSV->TimePoint);
+
+        static_Chart->BeginTransaction();
+        static_Chart->JournalTimingChange(_MovableSV->TimePoint);
         return false;
     }
 
@@ -35,11 +40,19 @@ bool BpmEditMode::OnMouseLeftButtonClicked(const bool InIsShiftDown)
         _MovableBpmPoint = _HoveredBpmPoint;
         _MovableBpmPointInitialValue = *_MovableBpmPoint;
 
-        static_Chart->RegisterTimeSliceHistory(_MovableBpmPoint->TimePoint);
-
         _PreviousBpmPoint = static_Chart->GetPreviousBpmPointFromTimePoint(_MovableBpmPoint->TimePoint);
         _NextBpmPoint = static_Chart->GetNextBpmPointFromTimePoint(_MovableBpmPoint->TimePoint);
 
+        if(static_Flags.UseTempoRebase)
+            _FormerTempoMap = static_Chart->GetTempoMap();
+
+        //auto timing rewrites the previous bpm point while dragging, so its timeslice is journaled as well
+        static_Chart->BeginTransaction();
+        static_Chart->JournalTimingChange(_MovableBpmPoint->TimePoint);
+
+        if(_PreviousBpmPoint)
+            static_Chart->JournalTimingChange(_PreviousBpmPoint->TimePoint);
+
         return false;
     }
 
@@ -47,15 +60,17 @@ bool BpmEditMode::OnMouseLeftButtonClicked(const bool InIsShiftDown)
 
     if (_CurrentTool == EditTool::Stop)
     {
+        static_Chart->BeginTransaction();
         static_Chart->InjectStop(t, 1.0);
-        static_Chart->RegisterTimeSliceHistory(t);
+        static_Chart->Commit();
         _VisibleStops = nullptr;
         return true;
     }
     else if (_CurrentTool == EditTool::Sv)
     {
+        static_Chart->BeginTransaction();
         static_Chart->InjectSV(t, 1.0); // Default 1.0x
-        static_Chart->RegisterTimeSliceHistory(t);
+        static_Chart->Commit();
         _VisibleSVs = nullptr;
         return true;
     }
@@ -74,18 +89,36 @@ bool BpmEditMode::OnMouseLeftButtonReleased()
     if(_MovableStop != nullptr)
     {
         static_Chart->RevaluateStop(_MovableStopInitialValue, *_MovableStop);
+        static_Chart->Commit();
         _MovableStop = nullptr;
         return false;
     }
     if(_MovableSV != nullptr)
     {
         static_Chart->RevaluateSV(_MovableSVInitialValue, *_MovableSV);
+        static_Chart->Commit();
         _MovableSV = nullptr;
         return false;
     }
     if(_MovableBpmPoint != nullptr)
     {
+        //the bpm point may end up in another timeslice, so the timepoints are taken before it is revaluated
+        const Time movedTimePoint = _MovableBpmPoint->TimePoint;
+        const bool isPreviousRetimed = static_Flags.UseAutoTiming && _PreviousBpmPoint;
+        const Time previousTimePoint = isPreviousRetimed ? _PreviousBpmPoint->TimePoint : 0;
+
         static_Chart->RevaluateBpmPoint(_MovableBpmPointInitialValue, *_MovableBpmPoint);
+
+        if(static_Flags.UseTempoRebase)
+        {
+            //auto timing changed the tempo of the previous bpm point too, so the notes following it are kept on their beats as well
+            if(isPreviousRetimed)
+                RebaseNotes(previousTimePoint, { previousTimePoint, movedTimePoint });
+            else
+                RebaseNotes(_MovableBpmPointInitialValue.TimePoint, { movedTimePoint });
+        }
+
+        static_Chart->Commit();
         _MovableBpmPoint = nullptr;
         return false;
     }
@@ -111,6 +144,8 @@ bool BpmEditMode::OnMouseRightButtonClicked(const bool InIsShiftDown)
     }
     if(_HoveredBpmPoint && !_MovableBpmPoint)
     {
+        static_Chart->BeginTransaction();
+
         if(static_Flags.UseAutoTiming)
         {
             if(BpmPoint* previousBpmPoint = static_Chart->GetPreviousBpmPointFromTimePoint(_HoveredBpmPoint->TimePoint))
@@ -120,13 +155,16 @@ bool BpmEditMode::OnMouseRightButtonClicked(const bool InIsShiftDown)
                     Time deltaTime = abs((previousBpmPoint->TimePoint) - nextBpmPoint->TimePoint);
                     double beatLength = double(deltaTime);
                     double newBpm = 60000.0 / beatLength;
+                    static_Chart->JournalTimingChange(previousBpmPoint->TimePoint);
                     previousBpmPoint->BeatLength = beatLength;
                     previousBpmPoint->Bpm = newBpm;
+                    static_Chart->InvalidateTempoMap(previousBpmPoint->TimePoint);
                 }
             }
         }
 
         static_Chart->RemoveBpmPoint(*_HoveredBpmPoint);
+        static_Chart->Commit();
         _HoveredBpmPoint = nullptr;
         _VisibleBpmPoints->clear();
         return true;
@@ -137,17 +175,20 @@ bool BpmEditMode::OnMouseRightButtonClicked(const bool InIsShiftDown)
 
 void BpmEditMode::OnEstimateBPM()
 {
-    Time length = MOD(AudioModule).GetSongLengthMilliSeconds();
-    float bpm = MOD(AudioModule).EstimateBPM(0, length);
+    // The whole song, in chart time
+    Time begin = -MOD(AudioModule).GetChartOffset();
+    Time end = begin + MOD(AudioModule).GetSongLengthMilliSeconds();
+    float bpm = MOD(AudioModule).EstimateBPM(begin, end);
 
     if (bpm > 0.0f)
     {
-        Time offset = MOD(AudioModule).EstimateOffset(bpm, 0, length);
+        Time offset = MOD(AudioModule).EstimateOffset(bpm, begin, end);
 
         PUSH_NOTIFICATION("Estimated BPM: %.2f, Offset: %d", bpm, offset);
 
         if (_MovableBpmPoint)
         {
+             static_Chart->InvalidateTempoMap(std::min(_MovableBpmPoint->TimePoint, offset));
              _MovableBpmPoint->Bpm = bpm;
              _MovableBpmPoint->BeatLength = 60000.0 / bpm;
              _MovableBpmPoint->TimePoint = offset;
@@ -312,10 +353,26 @@ void BpmEditMode::Tick()
 {
     DisplayToolSelector();
 
-    if(_MovableStop) { _MovableStop->TimePoint = GetCursorTime(); return; }
+    if(_IsRebasePending)
+    {
+        _IsRebasePending = false;
+
+        RebaseNotes(_RebaseTimeFrom, _RebaseEditedTimePoints);
+        static_Chart->Commit();
+        return;
+    }
+
+    if(_MovableStop)
+    {
+        static_Chart->InvalidateTempoMap(std::min(_MovableStop->TimePoint, GetCursorTime()));
+        _MovableStop->TimePoint = GetCursorTime();
+        return;
+    }
     if(_MovableSV) { _MovableSV->TimePoint = GetCursorTime(); return; }
     if(_MovableBpmPoint)
     {
+        //the tempo map is rebuilt from wherever the dragged timing could have had an effect last tick
+        static_Chart->InvalidateTempoMap(std::min(_MovableBpmPoint->TimePoint, GetCursorTime()));
         _MovableBpmPoint->TimePoint = GetCursorTime();
 
         if(!static_Flags.UseAutoTiming)
@@ -328,6 +385,7 @@ void BpmEditMode::Tick()
             double newBpm = 60000.0 / beatLength;
             _PreviousBpmPoint->BeatLength = beatLength;
             _PreviousBpmPoint->Bpm = newBpm;
+            static_Chart->InvalidateTempoMap(_PreviousBpmPoint->TimePoint);
         }
 
         if(_NextBpmPoint)
@@ -369,13 +427,19 @@ void BpmEditMode::Tick()
 void BpmEditMode::PlaceAutoTimePoint()
 {
     Time cursorTime = GetCursorTime() ;
+
+    static_Chart->BeginTransaction();
+
     if(BpmPoint* previousBpmPoint = static_Chart->GetPreviousBpmPointFromTimePoint(GetCursorTime()))
     {
+        static_Chart->JournalTimingChange(previousBpmPoint->TimePoint);
+
         Time deltaTime = abs(previousBpmPoint->TimePoint - cursorTime);
         double beatLength = double(deltaTime);
         double newBpm = 60000.0 / beatLength;
         previousBpmPoint->BeatLength = beatLength;
         previousBpmPoint->Bpm = newBpm;
+        static_Chart->InvalidateTempoMap(previousBpmPoint->TimePoint);
     }
 
     if(BpmPoint* nextBpmPoint =  static_Chart->GetNextBpmPointFromTimePoint(cursorTime))
@@ -387,6 +451,34 @@ void BpmEditMode::PlaceAutoTimePoint()
     }
     else
         static_Chart->PlaceBpmPoint(cursorTime, 120.0, 60000.0 / 120.0);
+
+    static_Chart->Commit();
+}
+
+void BpmEditMode::RebaseNotes(const Time InTimeFrom, const std::vector<Time>& InEditedTimePoints)
+{
+    const Time pinnedTimePoint = _PinnedBpmPoint ? _PinnedBpmPoint->TimePoint : 0;
+
+    if(!static_Chart->RebaseTiming(_FormerTempoMap, InTimeFrom, InEditedTimePoints))
+        PUSH_NOTIFICATION("Notes Would Collide, Left Them In Place");
+
+    //timing points were moved between timeslices, so every pointer to one is gathered again
+    _VisibleBpmPoints = nullptr;
+    _VisibleStops = nullptr;
+    _VisibleSVs = nullptr;
+
+    _HoveredBpmPoint = nullptr;
+    _HoveredStop = nullptr;
+    _HoveredSV = nullptr;
+
+    if(!_PinnedBpmPoint)
+        return;
+
+    _PinnedBpmPoint = nullptr;
+
+    for (auto& bpmPointPtr : static_Chart->GetBpmPointsRelatedToTimeRange(pinnedTimePoint, pinnedTimePoint))
+        if(bpmPointPtr->TimePoint == pinnedTimePoint)
+            _PinnedBpmPoint = bpmPointPtr;
 }
 
 void BpmEditMode::PlaceTimePoint()
@@ -422,15 +514,67 @@ void BpmEditMode::DisplayBpmNode(BpmPoint& InBpmPoint, const int InScreenX, cons
 	ImGui::PushItemWidth(96);
 
     float bpmFloat = float(InBpmPoint.Bpm);
-	ImGui::DragFloat(" ", &bpmFloat, 0.1f, 0.01f, 2000.0f);
-	InBpmPoint.Bpm = double(bpmFloat);
-    InBpmPoint.BeatLength = 60000.0 / InBpmPoint.Bpm;
+	if(ImGui::DragFloat(" ", &bpmFloat, 0.1f, 0.01f, 2000.0f))
+    {
+        InBpmPoint.Bpm = double(bpmFloat);
+        InBpmPoint.BeatLength = 60000.0 / InBpmPoint.Bpm;
+        static_Chart->InvalidateTempoMap(InBpmPoint.TimePoint);
+    }
+
+    if(static_Flags.UseTempoRebase && ImGui::IsItemActivated())
+    {
+        _FormerTempoMap = static_Chart->GetTempoMap();
+        _FormerBpmValue = InBpmPoint;
+    }
+
+    if(static_Flags.UseTempoRebase && ImGui::IsItemDeactivatedAfterEdit() && !_IsRebasePending)
+    {
+        //the value is dragged without journaling, so the bpm point is journaled as it was when the drag began
+        const BpmPoint editedBpmPoint = InBpmPoint;
+        InBpmPoint = _FormerBpmValue;
+
+        static_Chart->BeginTransaction();
+        static_Chart->JournalTimingChange(InBpmPoint.TimePoint);
+
+        InBpmPoint = editedBpmPoint;
+
+        _IsRebasePending = true;
+        _RebaseTimeFrom = InBpmPoint.TimePoint;
+        _RebaseEditedTimePoints = { InBpmPoint.TimePoint };
+    }
 
     if(InIsPinned)
     {
-        if(ImGui::Button("+1 MS")) InBpmPoint.TimePoint++;
+        Time nudge = 0;
+
+        if(ImGui::Button("+1 MS")) nudge = 1;
         ImGui::SameLine();
-        if(ImGui::Button("-1 MS")) InBpmPoint.TimePoint--;
+        if(ImGui::Button("-1 MS")) nudge = -1;
+
+        if(nudge && !_IsRebasePending)
+        {
+            const bool isRebasing = static_Flags.UseTempoRebase;
+
+            if(isRebasing)
+                _FormerTempoMap = static_Chart->GetTempoMap();
+
+            static_Chart->BeginTransaction();
+            static_Chart->JournalTimingChange(InBpmPoint.TimePoint);
+            static_Chart->InvalidateTempoMap(std::min(InBpmPoint.TimePoint, InBpmPoint.TimePoint + nudge));
+
+            //the transaction stays open until the notes followed on the next tick
+            if(isRebasing)
+            {
+                _IsRebasePending = true;
+                _RebaseTimeFrom = InBpmPoint.TimePoint;
+                _RebaseEditedTimePoints = { InBpmPoint.TimePoint + nudge };
+            }
+
+            InBpmPoint.TimePoint += nudge;
+
+            if(!isRebasing)
+                static_Chart->Commit();
+        }
     }
 	ImGui::End();
 }
@@ -445,8 +589,11 @@ void BpmEditMode::DisplayStopNode(StopPoint& InStop, const int InScreenX, const
     ImGui::SameLine();
     ImGui::PushItemWidth(96);
     float len = float(InStop.Length);
-    ImGui::DragFloat("s", &len, 0.01f, 0.0f, 100.0f);
-    InStop.Length = double(len);
+    if(ImGui::DragFloat("s", &len, 0.01f, 0.0f, 100.0f))
+    {
+        InStop.Length = double(len);
+        static_Chart->InvalidateTempoMap(InStop.TimePoint);
+    }
     ImGui::End();
 }
 
@@ -460,8 +607,11 @@ void BpmEditMode::DisplaySVNode(ScrollVelocityMultiplier& InSV, const int InScre
     ImGui::SameLine();
     ImGui::PushItemWidth(96);
     float mul = float(InSV.Multiplier);
-    ImGui::DragFloat("x", &mul, 0.01f, 0.0f, 100.0f);
-    InSV.Multiplier = double(mul);
+    if(ImGui::DragFloat("x", &mul, 0.01f, 0.0f, 100.0f))
+    {
+        InSV.Multiplier = double(mul);
+        static_Chart->InvalidateScrollMap();
+    }
     ImGui::End();
 }
 
@@ -22,6 +22,9 @@ private:
 	void PlaceAutoTimePoint();
 	void PlaceTimePoint();
 
+	//moves the notes and timing following an edit back onto the beats they had before it, within the transaction of the edit
+	void RebaseNotes(const Time InTimeFrom, const std::vector<Time>& InEditedTimePoints);
+
 	void DisplayBpmNode(BpmPoint& InBpmPoint, const int InScreenX, const int InScreenY, const bool InIsPinned = false);
     void DisplayStopNode(StopPoint& InStop, const int InScreenX, const int InScreenY, const bool InIsPinned = false);
     void DisplaySVNode(ScrollVelocityMultiplier& InSV, const int InScreenX, const int InScreenY, const bool InIsPinned = false);
@@ -55,6 +58,15 @@ private:
     enum class EditTool { Bpm, Stop, Sv };
     EditTool _CurrentTool = EditTool::Bpm;
 
+    //the tempo map as it was before the edit in progress, the beats the notes are kept on are looked up in it
+    TempoMap _FormerTempoMap;
+    BpmPoint _FormerBpmValue;
+
+    //edits made from a bpm node happen while the timefield is drawn, their notes are rebased on the next tick
+    bool _IsRebasePending = false;
+    Time _RebaseTimeFrom = 0;
+    std::vector<Time> _RebaseEditedTimePoints;
+
     std::vector<long long> _TapTimes;
     float _TappedBPM = 0.0f;
 };
@@ -3,5 +3,6 @@
 struct EditFlags
 {
     bool UseAutoTiming = false;
+    bool UseTempoRebase = false;
     bool ShowColumnHeatmap = false;
 };
\ No newline at end of file
@@ -13,42 +13,40 @@ bool SelectEditMode::OnCopy()
 {
     std::string clipboard =  "LeraineStudio:";
 
-    for(const auto [column, noteCollection] : _SelectedNotes.Notes)
+    //copied in time order
+    static_Chart->IterateSelectedNotes(_SelectedNotes, [&clipboard](Note& selectedNote, const Column column)
     {
-        for(auto selectedNote : noteCollection)
+        std::string noteSegment = "";
+        switch(selectedNote.Type)
         {
-            std::string noteSegment = "";
-            switch(selectedNote->Type)
+            case Note::EType::Common:
             {
-                case Note::EType::Common:
-                {
-                    noteSegment += "N";
-                    noteSegment += std::to_string(column) + "|";
-                    noteSegment += std::to_string(selectedNote->TimePoint) + ";";
-                }
-                break;
-
-                case Note::EType::Mine:
-                {
-                    noteSegment += "M";
-                    noteSegment += std::to_string(column) + "|";
-                    noteSegment += std::to_string(selectedNote->TimePoint) + ";";
-                }
-                break;
+                noteSegment += "N";
+                noteSegment += std::to_string(column) + "|";
+                noteSegment += std::to_string(selectedNote.TimePoint) + ";";
+            }
+            break;
 
-                case Note::EType::HoldBegin:
-                {
-                    noteSegment += "H";
-                    noteSegment += std::to_string(column) + "|";
-                    noteSegment += std::to_string(selectedNote->TimePointBegin) + ",";
-                    noteSegment += std::to_string(selectedNote->TimePointEnd) + ";";
-                }
-                break;
+            case Note::EType::Mine:
+            {
+                noteSegment += "M";
+                noteSegment += std::to_string(column) + "|";
+                noteSegment += std::to_string(selectedNote.TimePoint) + ";";
             }
+            break;
 
-            clipboard += noteSegment;
+            case Note::EType::HoldBegin:
+            {
+                noteSegment += "H";
+                noteSegment += std::to_string(column) + "|";
+                noteSegment += std::to_string(selectedNote.TimePointBegin) + ",";
+                noteSegment += std::to_string(selectedNote.TimePointEnd) + ";";
+            }
+            break;
         }
-    }
+
+        clipboard += noteSegment;
+    });
 
     PUSH_NOTIFICATION("Copied %d Notes", _SelectedNotes.NoteAmount);
     sf::Clipboard::setString(clipboard);
@@ -181,8 +179,12 @@ bool SelectEditMode::OnMirror()
 
     if(_SelectedNotes.HasNotes)
     {
-        PUSH_NOTIFICATION("Mirrored %d Notes", _SelectedNotes.NoteAmount);
-        static_Chart->MirrorNotes(_SelectedNotes);
+        const int noteAmount = _SelectedNotes.NoteAmount;
+
+        if(static_Chart->MirrorNotes(_SelectedNotes))
+            PUSH_NOTIFICATION("Mirrored %d Notes", noteAmount);
+        else
+            PUSH_NOTIFICATION("Mirroring Would Overlap Other Notes");
     }
 
     return true;
@@ -192,8 +194,15 @@ bool SelectEditMode::OnExpand()
 {
     if(_SelectedNotes.HasNotes)
     {
-        PUSH_NOTIFICATION("Expanded %d Notes", _SelectedNotes.NoteAmount);
-        static_Chart->ScaleNotes(_SelectedNotes, 2.0f);
+        const int noteAmount = _SelectedNotes.NoteAmount;
+
+        if(!static_Chart->ScaleNotes(_SelectedNotes, 2.0f))
+        {
+            PUSH_NOTIFICATION("Expanding Would Overlap Other Notes");
+            return false;
+        }
+
+        PUSH_NOTIFICATION("Expanded %d Notes", noteAmount);
         return true;
     }
     return false;
@@ -203,8 +212,15 @@ bool SelectEditMode::OnConvertToHolds(Time Length)
 {
     if(_SelectedNotes.HasNotes)
     {
-        PUSH_NOTIFICATION("Converted %d Notes to Holds", _SelectedNotes.NoteAmount);
-        static_Chart->ConvertToHolds(_SelectedNotes, Length);
+        const int noteAmount = _SelectedNotes.NoteAmount;
+
+        if(!static_Chart->ConvertToHolds(_SelectedNotes, Length))
+        {
+            PUSH_NOTIFICATION("Converting Would Overlap Other Notes");
+            return false;
+        }
+
+        PUSH_NOTIFICATION("Converted %d Notes to Holds", noteAmount);
         return true;
     }
     return false;
@@ -214,8 +230,15 @@ bool SelectEditMode::OnConvertToTaps()
 {
     if(_SelectedNotes.HasNotes)
     {
-        PUSH_NOTIFICATION("Converted %d Notes to Taps", _SelectedNotes.NoteAmount);
-        static_Chart->ConvertToTaps(_SelectedNotes);
+        const int noteAmount = _SelectedNotes.NoteAmount;
+
+        if(!static_Chart->ConvertToTaps(_SelectedNotes))
+        {
+            PUSH_NOTIFICATION("Converting Would Overlap Other Notes");
+            return false;
+        }
+
+        PUSH_NOTIFICATION("Converted %d Notes to Taps", noteAmount);
         return true;
     }
     return false;
@@ -225,8 +248,15 @@ bool SelectEditMode::OnQuantize(int InDivisor)
 {
     if(_SelectedNotes.HasNotes)
     {
-        PUSH_NOTIFICATION("Quantized %d Notes to 1/%d", _SelectedNotes.NoteAmount, InDivisor);
-        static_Chart->QuantizeNotes(_SelectedNotes, InDivisor);
+        const int noteAmount = _SelectedNotes.NoteAmount;
+
+        if(!static_Chart->QuantizeNotes(_SelectedNotes, InDivisor))
+        {
+            PUSH_NOTIFICATION("Quantizing Would Overlap Other Notes");
+            return false;
+        }
+
+        PUSH_NOTIFICATION("Quantized %d Notes to 1/%d", noteAmount, InDivisor);
         MOD(BeatModule).RecalculateSnaps(static_Chart, _SelectedNotes.MinTimePoint - TIMESLICE_LENGTH, _SelectedNotes.MaxTimePoint + TIMESLICE_LENGTH);
         return true;
     }
@@ -237,8 +267,15 @@ bool SelectEditMode::OnReverse()
 {
     if(_SelectedNotes.HasNotes)
     {
-        PUSH_NOTIFICATION("Reversed %d Notes", _SelectedNotes.NoteAmount);
-        static_Chart->ReverseNotes(_SelectedNotes);
+        const int noteAmount = _SelectedNotes.NoteAmount;
+
+        if(!static_Chart->ReverseNotes(_SelectedNotes))
+        {
+            PUSH_NOTIFICATION("Reversing Would Overlap Other Notes");
+            return false;
+        }
+
+        PUSH_NOTIFICATION("Reversed %d Notes", noteAmount);
         return true;
     }
     return false;
@@ -248,8 +285,15 @@ bool SelectEditMode::OnShuffle()
 {
     if(_SelectedNotes.HasNotes)
     {
-        PUSH_NOTIFICATION("Shuffled %d Notes", _SelectedNotes.NoteAmount);
-        static_Chart->ShuffleNotes(_SelectedNotes);
+        const int noteAmount = _SelectedNotes.NoteAmount;
+
+        if(!static_Chart->ShuffleNotes(_SelectedNotes))
+        {
+            PUSH_NOTIFICATION("Shuffling Would Overlap Other Notes");
+            return false;
+        }
+
+        PUSH_NOTIFICATION("Shuffled %d Notes", noteAmount);
         return true;
     }
     return false;
@@ -259,8 +303,15 @@ bool SelectEditMode::OnCompress()
 {
     if(_SelectedNotes.HasNotes)
     {
-        PUSH_NOTIFICATION("Compressed %d Notes", _SelectedNotes.NoteAmount);
-        static_Chart->ScaleNotes(_SelectedNotes, 0.5f);
+        const int noteAmount = _SelectedNotes.NoteAmount;
+
+        if(!static_Chart->ScaleNotes(_SelectedNotes, 0.5f))
+        {
+            PUSH_NOTIFICATION("Compressing Would Overlap Other Notes");
+            return false;
+        }
+
+        PUSH_NOTIFICATION("Compressed %d Notes", noteAmount);
         return true;
     }
     return false;
@@ -287,22 +338,7 @@ bool SelectEditMode::OnSelectAll()
 
 void SelectEditMode::OnInvertSelection()
 {
-    // Collect currently selected pointers
-    std::unordered_set<Note*> selectedSet;
-    for(auto& [col, notes] : _SelectedNotes.Notes)
-    {
-        for(auto* n : notes) selectedSet.insert(n);
-    }
-
-    _SelectedNotes.Clear();
-
-    // Iterate all notes, add if not in set
-    static_Chart->IterateAllNotes([&](Note& n, Column c) {
-        if(selectedSet.find(&n) == selectedSet.end())
-        {
-            _SelectedNotes.PushNote(c, &n);
-        }
-    });
+    static_Chart->InvertSelection(_SelectedNotes);
 
     PUSH_NOTIFICATION("Inverted Selection: %d Notes", _SelectedNotes.NoteAmount);
 }
@@ -337,39 +373,40 @@ void SelectEditMode::Tick()
     if(!static_Cursor.HoveredNotes.empty() && static_Cursor.TimefieldSide == Cursor::FieldPosition::Middle && !_IsAreaSelecting)
     {
         _HoveredNoteColumn = static_Cursor.CursorColumn;
-        _HoveredNote = static_Chart->FindNote(static_Cursor.HoveredNotes.back()->TimePoint, _HoveredNoteColumn);
+        _HoveredNote = static_Cursor.HoveredNotes.back();
     }
     else
-        _HoveredNote = nullptr;
+        _HoveredNote = NoteHandle();
 }
 
 bool SelectEditMode::OnMouseLeftButtonClicked(const bool InIsShiftDown)
 {
     _AnchoredCursor = static_Cursor;
 
-    if(_HoveredNote != nullptr)
+    if(static_Chart->ResolveNote(_HoveredNote) != nullptr)
     {
         if(_SelectedNotes.NoteAmount > 1)
         {
             Time smallestDis = INT32_MAX;
-            for(auto& [column, notes] : _SelectedNotes.Notes)
-                for(auto& note : notes)
-                {
-                    Note noteCopy = *note;
-                    noteCopy.BeatSnap = -1;
+            static_Chart->IterateSelectedNotes(_SelectedNotes, [this, &smallestDis](Note& note, const Column column)
+            {
+                //the preview is not the note itself, so it must not be hovered as one
+                Note noteCopy = note;
+                noteCopy.BeatSnap = -1;
+                noteCopy.Handle = NoteHandle();
 
-                    _MostRightColumn = std::max(_MostRightColumn, column);
-                    _MostLeftColumn = std::min(_MostLeftColumn, column);
+                _MostRightColumn = std::max(_MostRightColumn, column);
+                _MostLeftColumn = std::min(_MostLeftColumn, column);
 
-                    _PastePreviewNotes.push_back({column, noteCopy});
-                    _DraggingNotes.PushNote(column, note);
+                _PastePreviewNotes.push_back({column, noteCopy});
+                _DraggingNotes.PushNote(column, note);
 
-                    if(abs(static_Cursor.UnsnappedTimePoint - note->TimePoint) < smallestDis)
-                    {
-                        smallestDis = abs(static_Cursor.UnsnappedTimePoint - note->TimePoint);
-                        _LowestPasteTimePoint = note->TimePoint;
-                    }
+                if(abs(static_Cursor.UnsnappedTimePoint - note.TimePoint) < smallestDis)
+                {
+                    smallestDis = abs(static_Cursor.UnsnappedTimePoint - note.TimePoint);
+                    _LowestPasteTimePoint = note.TimePoint;
                 }
+            });
         }
 
         _SelectedNotes.Clear();
@@ -417,12 +454,10 @@ bool SelectEditMode::OnMouseLeftButtonReleased()
         {
             SetNewPreviewPasteLocation();
 
-            Time minTimePoint = (_HighestPasteTimepoint < _DraggingNotes.MaxTimePoint) ? _HighestPasteTimepoint - (_DraggingNotes.MaxTimePoint - _DraggingNotes.MinTimePoint) : _DraggingNotes.MinTimePoint;
-            Time maxTimePoint = (_HighestPasteTimepoint < _DraggingNotes.MaxTimePoint) ? _DraggingNotes.MaxTimePoint : _HighestPasteTimepoint;
-
-            static_Chart->RegisterTimeSliceHistoryRanged(minTimePoint - TIMESLICE_LENGTH, maxTimePoint + TIMESLICE_LENGTH);
-            static_Chart->BulkRemoveNotes(_DraggingNotes, true);
-            static_Chart->BulkPlaceNotes(_PastePreviewNotes, true);
+            static_Chart->BeginTransaction();
+            static_Chart->BulkRemoveNotes(_DraggingNotes);
+            static_Chart->BulkPlaceNotes(_PastePreviewNotes);
+            static_Chart->Commit();
 
             if (!_PastePreviewNotes.empty())
             {
@@ -449,27 +484,36 @@ bool SelectEditMode::OnMouseLeftButtonReleased()
             return _IsMovingNote = false;
         }
 
-        if (_DraggingNote->Type == Note::EType::HoldEnd && _DraggingNote->TimePointBegin >= static_Cursor.TimePoint)
+        const Note* draggingNote = static_Chart->ResolveNote(_DraggingNote);
+
+        if (!draggingNote)
+            return _IsMovingNote = false;
+
+        if (draggingNote->Type == Note::EType::HoldEnd && draggingNote->TimePointBegin >= static_Cursor.TimePoint)
         {
-            // TODO : Make the one-undo implementation
-            Time TimePointBegin = _DraggingNote->TimePointBegin;
-            static_Chart->RemoveNote(_DraggingNote->TimePointBegin, static_Cursor.CursorColumn);
+            Time TimePointBegin = draggingNote->TimePointBegin;
+            static_Chart->BeginTransaction();
+            static_Chart->RemoveNote(TimePointBegin, static_Cursor.CursorColumn);
             static_Chart->PlaceNote(TimePointBegin, static_Cursor.CursorColumn, static_Cursor.BeatSnap);
+            static_Chart->Commit();
 
             return _IsMovingNote = false;
         }
 
-        if (_DraggingNote->Type == Note::EType::HoldBegin && _DraggingNote->TimePointEnd <= static_Cursor.TimePoint)
+        if (draggingNote->Type == Note::EType::HoldBegin && draggingNote->TimePointEnd <= static_Cursor.TimePoint)
         {
-            // TODO : Make the one-undo implementation
-            Time TimePointEnd = _DraggingNote->TimePointEnd;
-            static_Chart->RemoveNote(_DraggingNote->TimePointEnd, static_Cursor.CursorColumn);
+            Time TimePointEnd = draggingNote->TimePointEnd;
+            static_Chart->BeginTransaction();
+            static_Chart->RemoveNote(TimePointEnd, static_Cursor.CursorColumn);
             static_Chart->PlaceNote(TimePointEnd, static_Cursor.CursorColumn, static_Cursor.BeatSnap);
+            static_Chart->Commit();
 
             return _IsMovingNote = false;
         }
 
-        _HoveredNote = static_Chart->MoveNote(_HoveredNote->TimePoint, static_Cursor.TimePoint, _HoveredNoteColumn, static_Cursor.CursorColumn, static_Cursor.BeatSnap);
+        Note* movedNote = static_Chart->MoveNote(draggingNote->TimePoint, static_Cursor.TimePoint, _HoveredNoteColumn, static_Cursor.CursorColumn, static_Cursor.BeatSnap);
+
+        _HoveredNote = movedNote ? movedNote->Handle : NoteHandle();
         _HoveredNoteColumn = static_Cursor.CursorColumn;
 
         return _IsMovingNote = false;
@@ -493,7 +537,7 @@ bool SelectEditMode::OnMouseLeftButtonReleased()
     {
         if((InOutNote.Type == Note::EType::Common || InOutNote.Type == Note::EType::Mine || InOutNote.Type == Note::EType::HoldBegin ||
             InOutNote.Type == Note::EType::RollBegin || InOutNote.Type == Note::EType::Lift || InOutNote.Type == Note::EType::Fake) && (InColumn >= columnMin && InColumn <= columnMax))
-            _SelectedNotes.PushNote(InColumn, &InOutNote);
+            _SelectedNotes.PushNote(InColumn, InOutNote);
     });
 
     if(_SelectedNotes.NoteAmount != 0)
@@ -534,14 +578,15 @@ void SelectEditMode::SubmitToRenderGraph(TimefieldRenderGraph& InOutTimefieldRen
         return;
     }
 
-    for(const auto& [column, noteCollection] : _SelectedNotes.Notes)
+    //only the notes on screen are looked up in the selection
+    if(_SelectedNotes.HasNotes)
     {
-        for(auto& selectedNote : noteCollection)
+        static_Chart->IterateNotesInTimeRange(InTimeBegin - TIMESLICE_LENGTH, InTimeEnd + TIMESLICE_LENGTH, [this, &InOutTimefieldRenderGraph](Note& InNote, const Column InColumn)
         {
-            if(selectedNote->TimePoint < InTimeBegin - TIMESLICE_LENGTH || selectedNote->TimePoint > InTimeEnd + TIMESLICE_LENGTH)
-                continue;
+            if(!_SelectedNotes.Contains(InNote.Handle))
+                return;
 
-            InOutTimefieldRenderGraph.SubmitTimefieldRenderCommand(column, selectedNote->TimePoint,
+            InOutTimefieldRenderGraph.SubmitTimefieldRenderCommand(InColumn, InNote.TimePoint,
             [](sf::RenderTarget* const InRenderTarget, const TimefieldMetrics& InTimefieldMetrics, const int InScreenX, const int InScreenY)
             {
                 sf::RectangleShape rectangle;
@@ -555,13 +600,18 @@ void SelectEditMode::SubmitToRenderGraph(TimefieldRenderGraph& InOutTimefieldRen
 
                 InRenderTarget->draw(rectangle);
             });
-        }
+        });
     }
 
     if(_SelectedNotes.HasNotes && static_Flags.ShowColumnHeatmap)
     {
-         for(const auto& [column, count] : _SelectedNotes.ColumnNoteCount)
+         for(Column column = 0; column < _SelectedNotes.ColumnNoteCount.size(); ++column)
          {
+             const int count = _SelectedNotes.ColumnNoteCount[column];
+
+             if(count == 0)
+                 continue;
+
              sf::Uint8 alpha = sf::Uint8(std::pow(float(count) / float(_SelectedNotes.HighestColumnAmount), 1.f) * 255.f);
 
             //TODO: rendercommand for multiple timepoints and columns since this is extremely hacky
@@ -589,38 +639,41 @@ void SelectEditMode::SubmitToRenderGraph(TimefieldRenderGraph& InOutTimefieldRen
          }
     }
 
-    if(_HoveredNote || _IsMovingNote)
+    const Note* hoveredNote = static_Chart->ResolveNote(_HoveredNote);
+    const Note* draggingNote = static_Chart->ResolveNote(_DraggingNote);
+
+    if(hoveredNote && (!_IsMovingNote || draggingNote))
     {
         Column column = _HoveredNoteColumn;
-        Time timePoint = _HoveredNote->TimePoint;
+        Time timePoint = hoveredNote->TimePoint;
 
         if(_IsMovingNote)
         {
             column = static_Cursor.CursorColumn;
             timePoint = static_Cursor.TimePoint;
 
-            switch (_DraggingNote->Type)
+            switch (draggingNote->Type)
             {
             case Note::EType::HoldBegin:
-                InOutTimefieldRenderGraph.SubmitHoldNoteRenderCommand(column, timePoint, _DraggingNote->TimePointEnd, -1, -1, 128);
+                InOutTimefieldRenderGraph.SubmitHoldNoteRenderCommand(column, timePoint, draggingNote->TimePointEnd, -1, -1, 128);
                 break;
 
             case Note::EType::HoldEnd:
-                InOutTimefieldRenderGraph.SubmitHoldNoteRenderCommand(column, _DraggingNote->TimePointBegin, timePoint, -1, -1, 128);
+                InOutTimefieldRenderGraph.SubmitHoldNoteRenderCommand(column, draggingNote->TimePointBegin, timePoint, -1, -1, 128);
                 break;
 
             case Note::EType::RollBegin:
-                InOutTimefieldRenderGraph.SubmitRollNoteRenderCommand(column, timePoint, _DraggingNote->TimePointEnd, -1, -1, 128);
+                InOutTimefieldRenderGraph.SubmitRollNoteRenderCommand(column, timePoint, draggingNote->TimePointEnd, -1, -1, 128);
                 break;
 
             case Note::EType::RollEnd:
-                InOutTimefieldRenderGraph.SubmitRollNoteRenderCommand(column, _DraggingNote->TimePointBegin, timePoint, -1, -1, 128);
+                InOutTimefieldRenderGraph.SubmitRollNoteRenderCommand(column, draggingNote->TimePointBegin, timePoint, -1, -1, 128);
                 break;
 
             default:
                 {
                     Note n;
-                    n.Type = _DraggingNote->Type;
+                    n.Type = draggingNote->Type;
                     n.TimePoint = timePoint;
                     n.BeatSnap = -1;
                     InOutTimefieldRenderGraph.SubmitNoteRenderCommand(n, column, 128);
@@ -71,7 +71,7 @@ void AudioModule::SetPause(bool InPause)
 void AudioModule::PlayRange(Time Start, Time End)
 {
     SetTimeMilliSeconds(Start);
-    _PlayEndTime = double(End) / 1000.0;
+    _PlayEndTime = double(End + _ChartOffset) / 1000.0;
     SetPause(false);
 }
 
@@ -95,11 +95,21 @@ void AudioModule::ResetSpeed()
 
 void AudioModule::SetTimeMilliSeconds(const Time InTime)
 {
-	_CurrentTime = double(InTime) / 1000.0;
+	_CurrentTime = double(InTime + _ChartOffset) / 1000.0;
 
 	BASS_ChannelSetPosition(_StreamHandle, BASS_ChannelSeconds2Bytes(_StreamHandle, _CurrentTime), BASS_POS_BYTE);
 }
 
+void AudioModule::SetChartOffset(const Time InOffset)
+{
+	_ChartOffset = InOffset;
+}
+
+Time AudioModule::GetChartOffset() const
+{
+	return _ChartOffset;
+}
+
 void AudioModule::MoveDelta(const int InDeltaMilliSeconds)
 {
 	_CurrentTime += double(InDeltaMilliSeconds) / 1000.0;
@@ -138,7 +148,7 @@ double AudioModule::GetTimeSeconds()
 
 Time AudioModule::GetTimeMilliSeconds()
 {
-	return _CurrentTime * 1000;
+	return Time(_CurrentTime * 1000) - _ChartOffset;
 }
 
 Time AudioModule::GetSongLengthMilliSeconds()
@@ -160,8 +170,8 @@ float AudioModule::EstimateBPM(Time Start, Time End)
     if (!decodeStream)
         return 0.0f;
 
-    double startSec = double(Start) / 1000.0;
-    double endSec = double(End) / 1000.0;
+    double startSec = double(Start + _ChartOffset) / 1000.0;
+    double endSec = double(End + _ChartOffset) / 1000.0;
 
     // Use default min/max hints (e.g. 45 to 230)
     // MAKELONG(low, high)
@@ -197,17 +207,18 @@ Time AudioModule::EstimateOffset(double BPM, Time Start, Time End)
     int bestPhi = 0;
 
     Time songLen = GetSongLengthMilliSeconds();
-    Time searchEnd = std::min(End, songLen);
+    Time searchEnd = std::min(End + _ChartOffset, songLen);
 
     for (int phi = 0; phi < maxPhi; phi += step)
     {
         float energy = 0.0f;
         int count = 0;
 
-        for (double t = Start + phi; t < searchEnd; t += beatInterval)
+        // The waveform is laid out in song time
+        for (double t = Start + _ChartOffset + phi; t < searchEnd; t += beatInterval)
         {
             Time timeIdx = Time(t);
-            if (timeIdx < songLen)
+            if (timeIdx >= 0 && timeIdx < songLen)
             {
                 // Simple energy: amplitude
                 const WaveFormData& data = _ReadableWaveFormData[timeIdx];
@@ -237,11 +248,12 @@ Time AudioModule::FindNearestPeak(Time Center, int WindowMs)
         return Center;
 
     Time songLen = GetSongLengthMilliSeconds();
-    Time start = std::max(0, Center - WindowMs);
-    Time end = std::min(songLen, Center + WindowMs);
+    Time songCenter = Center + _ChartOffset;
+    Time start = std::max(0, songCenter - WindowMs);
+    Time end = std::min(songLen - 1, songCenter + WindowMs);
 
     float maxAmp = -1.0f;
-    Time peakTime = Center;
+    Time peakTime = songCenter;
 
     for (Time t = start; t <= end; ++t)
     {
@@ -257,7 +269,7 @@ Time AudioModule::FindNearestPeak(Time Center, int WindowMs)
         }
     }
 
-    return peakTime;
+    return peakTime - _ChartOffset;
 }
 
 void AudioModule::InitMetronome()
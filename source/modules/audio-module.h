@@ -22,6 +22,10 @@ public:
 	void ResetSpeed();
 	void SetTimeMilliSeconds(const Time InTime);
 
+	//positions are in chart time, the song is played that much later. the length is the song's own
+	void SetChartOffset(const Time InOffset);
+	Time GetChartOffset() const;
+
 	void MoveDelta(const int InDeltaMilliSeconds);
 	void ChangeSpeed(const float InDeltaSpeed);
 
@@ -53,6 +57,7 @@ private:
     std::filesystem::path _CurrentAudioPath;
 
 	double _CurrentTime = 0;
+	Time _ChartOffset = 0;
     double _PlayEndTime = -1.0;
 	float _Speed = 1.f;
 	bool _Paused = true;
@@ -1,7 +1,15 @@
 #include "beat-module.h"
 #include "../structures/chart.h"
+#include "../structures/chart-snapshot.h"
 
 #include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <thread>
+
+//whole chart assignment hands out the notes of a column in blocks of this size to the worker threads
+#define SNAP_ASSIGNMENT_BLOCK_SIZE 4096
 
 bool BeatModule::StartUp()
 {
@@ -24,23 +32,88 @@ bool BeatModule::StartUp()
 	return true;
 }
 
+//positions read from a file may be finer than the grid the tempo map finds, so they are kept as long as the note still sits on them
+static void AssignNoteToGrid(const TempoMap& InTempoMap, Note& InOutNote)
+{
+	InOutNote.BeatSnap = BeatModule::GetBeatSnapFromTime(InTempoMap, InOutNote.TimePoint);
+
+	if (!InTempoMap.IsAtBeatPosition(InOutNote.TimePoint, InOutNote.Position))
+		InOutNote.Position = InTempoMap.GetBeatPosition(InOutNote.TimePoint);
+
+	if (InOutNote.Type != Note::EType::HoldBegin && InOutNote.Type != Note::EType::RollBegin)
+		return;
+
+	if (!InTempoMap.IsAtBeatPosition(InOutNote.TimePointEnd, InOutNote.PositionEnd))
+		InOutNote.PositionEnd = InTempoMap.GetBeatPosition(InOutNote.TimePointEnd);
+}
+
 void BeatModule::AssignNotesToSnapsInChart(Chart* const InChart)
 {
 	if(!InChart)
 		return;
 
-	if(InChart->TimeSlices.empty())
+	if(InChart->Notes.IsEmpty())
 		return;
 
-	Time timeBegin = 0;
-	Time timeEnd = InChart->TimeSlices.rbegin()->second.TimePoint + TIMESLICE_LENGTH;
+	//brought up to date here, the worker threads only read it
+	const TempoMap& tempoMap = InChart->GetTempoMap();
+
+	//everything is assigned again, so neither pending timing changes nor the results of one still being worked on matter anymore
+	Time timingChange;
+	InChart->TakeTimingChange(timingChange);
+
+	_PropagationChart = InChart;
+	_PendingPropagationTimePoint = std::numeric_limits<Time>::max();
 
-	for (Time time = timeBegin; time <= timeEnd; time += TIMESLICE_LENGTH)
+	if (_PropagationUpdates.valid())
+		_PropagationTimeBegin = std::numeric_limits<Time>::max();
+
+	struct NoteBlock
 	{
-		auto& slice = InChart->FindOrAddTimeSlice(time);
+		std::vector<Note>* Notes;
+		size_t Begin;
+		size_t End;
+	};
+
+	std::vector<NoteBlock> blocks;
 
-		AssignNotesToSnapsInTimeSlice(InChart, slice);
+	for (Column column = 0; column < Column(InChart->Notes.GetColumnAmount()); ++column)
+	{
+		std::vector<Note>& notes = InChart->Notes.GetColumn(column);
+
+		for (size_t begin = 0; begin < notes.size(); begin += SNAP_ASSIGNMENT_BLOCK_SIZE)
+			blocks.push_back({ &notes, begin, std::min<size_t>(begin + SNAP_ASSIGNMENT_BLOCK_SIZE, notes.size()) });
 	}
+
+	//every note only ever has its own snap written, so the blocks need no locking
+	std::atomic<size_t> nextBlock = 0;
+
+	auto assignBlocks = [&blocks, &nextBlock, &tempoMap]()
+	{
+		for (size_t blockIndex = nextBlock++; blockIndex < blocks.size(); blockIndex = nextBlock++)
+		{
+			NoteBlock& block = blocks[blockIndex];
+
+			for (size_t index = block.Begin; index < block.End; ++index)
+				AssignNoteToGrid(tempoMap, (*block.Notes)[index]);
+		}
+	};
+
+	const size_t threadAmount = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), blocks.size());
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadAmount);
+
+	for (size_t threadIndex = 1; threadIndex < threadAmount; ++threadIndex)
+		threads.emplace_back(assignBlocks);
+
+	assignBlocks();
+
+	for (auto& thread : threads)
+		thread.join();
+
+	//the snaps are written into the notes in place
+	InChart->MarkSnapshotDirty(0, InChart->Notes.GetLastTimePoint() + TIMESLICE_LENGTH);
 }
 
 void BeatModule::RecalculateSnaps(Chart* const InChart, Time Start, Time End)
@@ -48,40 +121,244 @@ void BeatModule::RecalculateSnaps(Chart* const InChart, Time Start, Time End)
     InChart->IterateTimeSlicesInTimeRange(Start, End, [&](TimeSlice& slice){
         AssignNotesToSnapsInTimeSlice(InChart, slice);
     });
+    InChart->MarkSnapshotDirty(Start, End);
 }
 
 void BeatModule::AssignNotesToSnapsInTimeSlice(Chart* const InChart, TimeSlice& InOutTimeSlice)
 {
-	GenerateTimeRangeBeatLines(InOutTimeSlice.TimePoint, InOutTimeSlice.TimePoint + TIMESLICE_LENGTH, InChart, 48);
-	GenerateTimeRangeBeatLines(InOutTimeSlice.TimePoint, InOutTimeSlice.TimePoint + TIMESLICE_LENGTH, InChart, 5, true);
-	GenerateTimeRangeBeatLines(InOutTimeSlice.TimePoint, InOutTimeSlice.TimePoint + TIMESLICE_LENGTH, InChart, 7, true);
-	GenerateTimeRangeBeatLines(InOutTimeSlice.TimePoint, InOutTimeSlice.TimePoint + TIMESLICE_LENGTH, InChart, 9, true);
+	const TempoMap& tempoMap = InChart->GetTempoMap();
+
+	InChart->IterateNotesInTimeRange(InOutTimeSlice.TimePoint, InOutTimeSlice.TimePoint + TIMESLICE_LENGTH - 1, [&tempoMap](Note& InOutNote, const Column)
+	{
+		AssignNoteToGrid(tempoMap, InOutNote);
+	});
+}
+
+bool BeatModule::PropagateTimingChanges(Chart* const InChart, Time& OutTimeBegin, Time& OutTimeEnd)
+{
+	if (InChart != _PropagationChart)
+	{
+		_PropagationChart = InChart;
+		_PendingPropagationTimePoint = std::numeric_limits<Time>::max();
 
-	std::sort(_OnFieldBeatLines.begin(), _OnFieldBeatLines.end(), [](const auto& lhs, const auto& rhs) { return lhs.TimePoint < rhs.TimePoint; });
+		//whatever the worker is busy with belongs to another chart
+		if (_PropagationUpdates.valid())
+			_PropagationTimeBegin = std::numeric_limits<Time>::max();
+	}
 
-	for (auto& column : InOutTimeSlice.Notes)
+	Time timingChange;
+
+	if (InChart->TakeTimingChange(timingChange))
 	{
-		for (auto& note : column.second)
+		//a change at or before the first bpm point moves beat 0, and with it the position of every note
+		const auto& bpmPoints = InChart->GetBpmPointIndex().GetAll();
+
+		if (bpmPoints.empty() || timingChange <= bpmPoints.front()->TimePoint)
+			timingChange = std::numeric_limits<Time>::min();
+
+		_PendingPropagationTimePoint = std::min(_PendingPropagationTimePoint, timingChange);
+	}
+
+	bool isApplied = false;
+
+	if (_PropagationUpdates.valid())
+	{
+		if (_PropagationUpdates.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			return false;
+
+		std::vector<SnapUpdate> updates = _PropagationUpdates.get();
+
+		//notes after a change made in the meantime are worked out again, the ones before it are not affected by it.
+		//notes moved in the meantime had their snap assigned along with the move
+		const Time timeEnd = std::min(_PropagationTimeEnd, _PendingPropagationTimePoint);
+
+		if (_PropagationTimeBegin < timeEnd)
 		{
-			auto attachedBeatLine = GetClosestBeatLineToTimePoint(note.TimePoint);
-			note.BeatSnap = GetBeatSnap(attachedBeatLine, attachedBeatLine.BeatDivision);
+			for (const auto& update : updates)
+			{
+				if (update.TimePoint >= timeEnd)
+					continue;
+
+				Note* note = InChart->ResolveNote(update.Handle);
+
+				if (!note || note->TimePoint != update.TimePoint)
+					continue;
+
+				note->BeatSnap = update.BeatSnap;
+				note->Position = update.Position;
+				note->PositionEnd = update.PositionEnd;
+			}
+
+			InChart->MarkSnapshotDirty(_PropagationTimeBegin, timeEnd);
+
+			OutTimeBegin = _PropagationTimeBegin;
+			OutTimeEnd = timeEnd;
+			isApplied = true;
 		}
 	}
 
-	_OnFieldBeatLines.clear();
+	if (_PendingPropagationTimePoint == std::numeric_limits<Time>::max() || InChart->Notes.IsEmpty())
+		return isApplied;
+
+	_PropagationTimeBegin = std::max(_PendingPropagationTimePoint, InChart->Notes.GetFirstTimePoint());
+	_PropagationTimeEnd = InChart->Notes.GetLastTimePoint() + 1;
+	_PendingPropagationTimePoint = std::numeric_limits<Time>::max();
+
+	//the snapshot carries the tempo map it was taken with, the chart can go on being edited meanwhile
+	_PropagationUpdates = std::async(std::launch::async, &BeatModule::GatherSnapUpdates, InChart->TakeSnapshot(), _PropagationTimeBegin);
+
+	return isApplied;
 }
 
-void BeatModule::GenerateTimeRangeBeatLines(const Time InTimeBegin, const Time InTimeEnd, Chart* const InChart, const int InBeatDivision, const bool InSkipClearCollection)
+bool BeatModule::IsPropagatingTimingChanges() const
 {
-	//edge cases edge cases edge cases edge cases edge cases edge cases edge cases edge cases edge cases edge cases edge cases edge cases edge cases edge cases edge cases edge cases
-	if(!InSkipClearCollection)
+	return _PropagationUpdates.valid() || _PendingPropagationTimePoint != std::numeric_limits<Time>::max();
+}
+
+std::vector<BeatModule::SnapUpdate> BeatModule::GatherSnapUpdates(std::shared_ptr<const ChartSnapshot> InSnapshot, const Time InTimeBegin)
+{
+	const TempoMap& tempoMap = InSnapshot->GetTempoMap();
+	const auto& chunks = InSnapshot->GetNoteChunks();
+
+	std::vector<SnapUpdate> updates;
+
+	for (auto chunkIt = chunks.lower_bound(GetSnapshotChunkIndex(InTimeBegin)); chunkIt != chunks.end(); ++chunkIt)
+	{
+		for (const auto& notes : chunkIt->second->Columns)
+		{
+			for (const auto& note : notes)
+			{
+				if (note.TimePoint < InTimeBegin)
+					continue;
+
+				Note assignedNote = note;
+				AssignNoteToGrid(tempoMap, assignedNote);
+
+				if (assignedNote.BeatSnap != note.BeatSnap || assignedNote.Position != note.Position || assignedNote.PositionEnd != note.PositionEnd)
+					updates.push_back({ note.Handle, note.TimePoint, assignedNote.BeatSnap, assignedNote.Position, assignedNote.PositionEnd });
+			}
+		}
+	}
+
+	return updates;
+}
+
+int BeatModule::GetBeatSnapFromTime(const TempoMap& InTempoMap, const Time InTime)
+{
+	if (InTempoMap.IsEmpty())
+		return -1;
+
+	const double beatLength = InTempoMap.GetBeatLength(InTime);
+	const double beat = InTempoMap.GetBeatFromTime(InTime) - InTempoMap.GetSectionBeat(InTime);
+
+	if (beat * beatLength < -BEAT_TOLERANCE)
+		return -1;
+
+	const double fraction = beat - floor(beat);
+	int denominator = TempoMap::GetBeatDenominator(fraction, beatLength);
+
+	//notes further off than the tolerance fall onto the nearest 48th
+	if (denominator == 0)
+	{
+		const int numerator = int(std::round(fraction * 48.0)) % 48;
+		denominator = numerator == 0 ? 1 : 48 / std::gcd(numerator, 48);
+	}
+
+	//5ths, 7ths, 9ths, 24ths and 48ths have no colour of their own
+	switch (denominator)
+	{
+	case 1: case 2: case 3: case 4: case 6: case 8: case 12: case 16:
+		return denominator;
+
+	default:
+		return -1;
+	}
+}
+
+void BeatModule::GenerateTimeRangeBeatLines(const Time InTimeBegin, const Time InTimeEnd, Chart* const InChart, const int InBeatDivision)
+{
+	const size_t timingRevision = InChart->GetTimingRevision();
+
+	//anything but scrolling or zooming generates the whole window again
+	if (timingRevision != _BeatLineTimingRevision || InBeatDivision != _BeatLineDivision || _OnFieldBeatLines.empty() || InTimeEnd <= _BeatLineTimeBegin || InTimeBegin >= _BeatLineTimeEnd)
+	{
+		if (timingRevision != _BeatLineTimingRevision)
+			GatherTimeSignatureBeats(InChart);
+
 		_OnFieldBeatLines.clear();
+		AppendTimeRangeBeatLines(InTimeBegin, InTimeEnd, InChart, InBeatDivision, _OnFieldBeatLines);
+
+		_BeatLineTimingRevision = timingRevision;
+		_BeatLineDivision = InBeatDivision;
+		_BeatLineTimeBegin = InTimeBegin;
+		_BeatLineTimeEnd = InTimeEnd;
+
+		return;
+	}
+
+	auto isEarlier = [](const BeatLine& InBeatLine, const Time InTime) { return InBeatLine.TimePoint < InTime; };
+	auto isLater = [](const Time InTime, const BeatLine& InBeatLine) { return InTime < InBeatLine.TimePoint; };
+
+	//the lines generated for the uncovered part overlap the cached ones by a line at the border, those are skipped
+	if (InTimeBegin < _BeatLineTimeBegin)
+	{
+		_BeatLineBuffer.clear();
+		AppendTimeRangeBeatLines(InTimeBegin, _BeatLineTimeBegin, InChart, InBeatDivision, _BeatLineBuffer);
+
+		auto bufferEnd = std::lower_bound(_BeatLineBuffer.begin(), _BeatLineBuffer.end(), _OnFieldBeatLines.front().TimePoint, isEarlier);
+		_OnFieldBeatLines.insert(_OnFieldBeatLines.begin(), _BeatLineBuffer.begin(), bufferEnd);
+	}
+
+	if (InTimeEnd > _BeatLineTimeEnd)
+	{
+		_BeatLineBuffer.clear();
+		AppendTimeRangeBeatLines(_BeatLineTimeEnd, InTimeEnd, InChart, InBeatDivision, _BeatLineBuffer);
+
+		auto bufferBegin = std::upper_bound(_BeatLineBuffer.begin(), _BeatLineBuffer.end(), _OnFieldBeatLines.back().TimePoint, isLater);
+		_OnFieldBeatLines.insert(_OnFieldBeatLines.end(), bufferBegin, _BeatLineBuffer.end());
+	}
+
+	//a line on either side of the window is kept, like a fresh generation has them
+	auto linesBegin = std::lower_bound(_OnFieldBeatLines.begin(), _OnFieldBeatLines.end(), InTimeBegin, isEarlier);
+
+	if (linesBegin != _OnFieldBeatLines.begin())
+		--linesBegin;
+
+	_OnFieldBeatLines.erase(_OnFieldBeatLines.begin(), linesBegin);
+
+	auto linesEnd = std::upper_bound(_OnFieldBeatLines.begin(), _OnFieldBeatLines.end(), InTimeEnd, isLater);
+
+	if (linesEnd != _OnFieldBeatLines.end())
+		++linesEnd;
+
+	_OnFieldBeatLines.erase(linesEnd, _OnFieldBeatLines.end());
+
+	_BeatLineTimeBegin = InTimeBegin;
+	_BeatLineTimeEnd = InTimeEnd;
+}
+
+void BeatModule::GatherTimeSignatureBeats(Chart* const InChart)
+{
+	const auto& timeSignatures = InChart->GetTimeSignatureIndex().GetAll();
+	const TempoMap& tempoMap = InChart->GetTempoMap();
+
+	_TimeSignatureBeats.clear();
+	_TimeSignatureBeats.reserve(timeSignatures.size());
 
+	for (const auto* ts : timeSignatures)
+		_TimeSignatureBeats.push_back({ tempoMap.GetBeatFromTime(ts->TimePoint), *ts });
+}
+
+void BeatModule::AppendTimeRangeBeatLines(const Time InTimeBegin, const Time InTimeEnd, Chart* const InChart, const int InBeatDivision, std::vector<BeatLine>& OutBeatLines)
+{
+	//edge cases edge cases edge cases edge cases edge cases edge cases edge cases edge cases edge cases edge cases edge cases edge cases edge cases edge cases edge cases edge cases
 	const auto& bpmPoints = InChart->GetBpmPointsRelatedToTimeRange(InTimeBegin, InTimeEnd);
+	const TempoMap& tempoMap = InChart->GetTempoMap();
+
+	//measures are only marked on the finest division, the time signatures are resolved to beats once per timing revision
+	const auto& timeSignatureBeats = _TimeSignatureBeats;
 
-    std::vector<TimeSignature> allTS;
-    InChart->IterateAllTimeSignatures([&](TimeSignature& ts){ allTS.push_back(ts); });
-    std::sort(allTS.begin(), allTS.end(), [](const auto& a, const auto& b){ return a.TimePoint < b.TimePoint; });
+	size_t timeSignatureIndex = 0;
 
 	size_t index = 0;
 	for (const auto& bpmPointPtr : bpmPoints)
@@ -97,80 +374,54 @@ void BeatModule::GenerateTimeRangeBeatLines(const Time InTimeBegin, const Time I
 		if (index + 1 <= bpmPoints.size() - 1)
 			timeEnd = bpmPoints[index + 1]->TimePoint;
 
-		const double timeBetweenSnaps = bpmPoint.BeatLength / double(InBeatDivision);
-		double firstPosition = double(bpmPoint.TimePoint) + ceil(double(timeBegin - bpmPoint.TimePoint) / timeBetweenSnaps) * timeBetweenSnaps;
+		//the beat grid of every bpm point counts from the beat it is placed on, stops within it are followed through the tempo map
+		const double sectionBeat = tempoMap.GetBeatFromTime(bpmPoint.TimePoint);
+		const double beatsBetweenSnaps = 1.0 / double(InBeatDivision);
+
+		int beatCount = (int)ceil((tempoMap.GetBeatFromTime(timeBegin) - sectionBeat) / beatsBetweenSnaps - 0.001);
 
 		if (timeBegin == InTimeBegin)
-			firstPosition -= timeBetweenSnaps;
+			beatCount--;
 
 		if (timeEnd == InTimeEnd)
-			timeEnd += Time(timeBetweenSnaps);
-
-		int beatCount = (int)std::max(0.0, double(firstPosition - double(bpmPoint.TimePoint)) / timeBetweenSnaps + 0.5);
+			timeEnd += Time(bpmPoint.BeatLength * beatsBetweenSnaps);
 
-		for (double timePosition = firstPosition; timePosition + 0.5 < double(timeEnd); timePosition += timeBetweenSnaps)
+		for (Time timePoint = InChart->GetTimeFromBeat(sectionBeat + beatCount * beatsBetweenSnaps); timePoint < timeEnd; timePoint = InChart->GetTimeFromBeat(sectionBeat + ++beatCount * beatsBetweenSnaps))
 		{
-			Time actualTime = Time(timePosition);
-			Time analyticalTime = bpmPoint.TimePoint + Time(bpmPoint.BeatLength * double(beatCount)) / InBeatDivision; //this is apparently more accurate than the one above, so it's used for the actual beatlines
-
-			if (actualTime < bpmPoint.TimePoint)
-				_OnFieldBeatLines.push_back({ actualTime, -1, InBeatDivision, -1});
-			else
+			if (beatCount < 0)
 			{
-                bool isMeasure = false;
-                if (InBeatDivision == 48)
-                {
-                    TimeSignature currentTs;
-                    currentTs.TimePoint = -999999;
-                    currentTs.Numerator = 4;
-                    currentTs.Denominator = 4;
-
-                    for (const auto& ts : allTS)
-                    {
-                        if (ts.TimePoint <= analyticalTime)
-                            currentTs = ts;
-                        else
-                            break;
-                    }
-
-                    double absBeat = InChart->GetBeatFromTime(analyticalTime);
-                    double beatAtTs = (currentTs.TimePoint == -999999) ? 0.0 : InChart->GetBeatFromTime(currentTs.TimePoint);
-
-                    double beatInTs = absBeat - beatAtTs;
-                    double measureLen = (double)currentTs.Numerator * (4.0 / (double)currentTs.Denominator);
-
-                    double m = beatInTs / measureLen;
-                    if (std::abs(m - std::round(m)) < 0.001)
-                        isMeasure = true;
-                }
-
-				_OnFieldBeatLines.push_back({ analyticalTime, beatCount, InBeatDivision, GetBeatSnap(beatCount, InBeatDivision), isMeasure });
-				beatCount++;
+				OutBeatLines.push_back({ timePoint, -1, InBeatDivision, -1});
+				continue;
 			}
-		}
-		index++;
-	}
-}
 
-void BeatModule::GenerateBeatLinesFromTimePointIfInvalid(Chart* const InChart, const Time InTime)
-{
-	const Time timeBegin = _OnFieldBeatLines.front().TimePoint;
-	const Time timeEnd = _OnFieldBeatLines.back().TimePoint;
+			bool isMeasure = false;
+			if (InBeatDivision == 48)
+			{
+				const double absBeat = sectionBeat + beatCount * beatsBetweenSnaps;
 
-	if(InTime < timeBegin)
-	{
-		Time deltaTime = abs(timeBegin - InTime) + TIMESLICE_LENGTH;
+				while (timeSignatureIndex + 1 < timeSignatureBeats.size() && timeSignatureBeats[timeSignatureIndex + 1].second.TimePoint <= timePoint)
+					timeSignatureIndex++;
 
-		GenerateTimeRangeBeatLines(timeBegin - deltaTime, timeBegin, InChart, 48, true);
-		GenerateTimeRangeBeatLines(timeBegin - deltaTime, timeBegin, InChart, 5, true);
-	}
+				TimeSignature currentTs;
+				double beatAtTs = 0.0;
 
-	if(InTime > timeEnd)
-	{
-		Time deltaTime = abs(timeEnd - InTime) + TIMESLICE_LENGTH;
+				if (!timeSignatureBeats.empty() && timeSignatureBeats[timeSignatureIndex].second.TimePoint <= timePoint)
+				{
+					beatAtTs = timeSignatureBeats[timeSignatureIndex].first;
+					currentTs = timeSignatureBeats[timeSignatureIndex].second;
+				}
+
+				double beatInTs = absBeat - beatAtTs;
+				double measureLen = (double)currentTs.Numerator * (4.0 / (double)currentTs.Denominator);
 
-		GenerateTimeRangeBeatLines(timeEnd, timeEnd + deltaTime, InChart, 48, true);
-		GenerateTimeRangeBeatLines(timeEnd, timeEnd + deltaTime, InChart, 5, true);
+				double m = beatInTs / measureLen;
+				if (std::abs(m - std::round(m)) < 0.001)
+					isMeasure = true;
+			}
+
+			OutBeatLines.push_back({ timePoint, beatCount, InBeatDivision, GetBeatSnap(beatCount, InBeatDivision), isMeasure });
+		}
+		index++;
 	}
 }
 
@@ -231,29 +482,22 @@ BeatLine BeatModule::GetPreviousBeatLine(const Time InTime)
 
 BeatLine BeatModule::GetCurrentBeatLine(const Time InTime, const Time InBias, const bool InScanDown)
 {
-	Time time = InTime + InBias;
-	BeatLine selectedBeatline;
+	if (_OnFieldBeatLines.empty())
+		return BeatLine();
+
+	const Time time = InTime + InBias;
 
+	//the last line before the time, or the first line after it, falling back to the outermost line of the window
 	if (InScanDown)
 	{
-		for (auto beatLine = _OnFieldBeatLines.rbegin(); beatLine != _OnFieldBeatLines.rend(); ++beatLine)
-		{
-			selectedBeatline = *beatLine;
-			if (time > beatLine->TimePoint)
-				break;
-		}
-	}
-	else
-	{
-		for (const auto& beatLine : _OnFieldBeatLines)
-		{
-			selectedBeatline = beatLine;
-			if (time < beatLine.TimePoint)
-				break;
-		}
+		auto beatLine = std::lower_bound(_OnFieldBeatLines.begin(), _OnFieldBeatLines.end(), time, [](const BeatLine& InBeatLine, const Time InTime) { return InBeatLine.TimePoint < InTime; });
+
+		return beatLine == _OnFieldBeatLines.begin() ? *beatLine : *(beatLine - 1);
 	}
 
-	return selectedBeatline;
+	auto beatLine = std::upper_bound(_OnFieldBeatLines.begin(), _OnFieldBeatLines.end(), time, [](const Time InTime, const BeatLine& InBeatLine) { return InTime < InBeatLine.TimePoint; });
+
+	return beatLine == _OnFieldBeatLines.end() ? _OnFieldBeatLines.back() : *beatLine;
 }
 
 const int BeatModule::GetNextSnap(const int InCurrentSnap)
@@ -288,15 +532,11 @@ bool BeatModule::IsBeatThisDivision(const int InBeatCount, const int InBeatDivis
 
 BeatLine BeatModule::GetClosestBeatLineToTimePoint(const Time InTimePoint)
 {
-	BeatLine attachedBeatLine = _OnFieldBeatLines.back();
-
-	for (auto beatLine = _OnFieldBeatLines.rbegin(); beatLine != _OnFieldBeatLines.rend(); ++beatLine)
-	{
-		if (beatLine->TimePoint + 2 < InTimePoint)
-				break;
+	if (_OnFieldBeatLines.empty())
+		return BeatLine();
 
-		attachedBeatLine = *beatLine;
-	}
+	//the first line no more than 2ms before the timepoint
+	auto beatLine = std::lower_bound(_OnFieldBeatLines.begin(), _OnFieldBeatLines.end(), InTimePoint - 2, [](const BeatLine& InBeatLine, const Time InTime) { return InBeatLine.TimePoint < InTime; });
 
-	return attachedBeatLine;
+	return beatLine == _OnFieldBeatLines.end() ? _OnFieldBeatLines.back() : *beatLine;
 }
@@ -1,10 +1,16 @@
 #pragma once
 
 #include <functional>
+#include <future>
+#include <limits>
+#include <memory>
 #include <set>
 
 #include "base/module.h"
 
+class TempoMap;
+class ChartSnapshot;
+
 /*
 * this module is responsible for a number of sleepless nights, please proceed with caution
 */
@@ -30,12 +36,21 @@ public:
 	void AssignNotesToSnapsInChart(Chart* const InChart);
     void RecalculateSnaps(Chart* const InChart, Time Start, Time End);
 	void AssignNotesToSnapsInTimeSlice(Chart* const InChart, TimeSlice& InOutTimeSlice);
-	void GenerateTimeRangeBeatLines(const Time InTimeBegin, const Time InTimeEnd, Chart* const InChart, const int InBeatDivision, const bool InSkipClearCollection = false);
+
+	//picks up the timing changes of the chart and works out the snaps of every note after them on a worker thread, a later call writes them into the chart.
+	//returns true once it did, along with the range of notes it went over
+	bool PropagateTimingChanges(Chart* const InChart, Time& OutTimeBegin, Time& OutTimeEnd);
+	bool IsPropagatingTimingChanges() const;
+	//the lines of the last window are kept for as long as the timing and division stay the same, scrolling only generates the part newly in view
+	void GenerateTimeRangeBeatLines(const Time InTimeBegin, const Time InTimeEnd, Chart* const InChart, const int InBeatDivision);
 	void IterateThroughBeatlines(std::function<void(const BeatLine&)> InWork);
 
 	int GetBeatSnap(const BeatLine& InBeatLine, const int InBeatDivision);
 	int GetBeatSnap(const int InBeatCount, const int InBeatDivision);
 
+	//the snap of a timepoint straight from its beat, -1 when it is off the 1/16 grid or before the first bpm point
+	static int GetBeatSnapFromTime(const TempoMap& InTempoMap, const Time InTime);
+
 	BeatLine GetNextBeatLine(const Time InTime);
 	BeatLine GetPreviousBeatLine(const Time InTime);
 	BeatLine GetCurrentBeatLine(const Time InTime, const Time InBias = 0, const bool InScanDown = true);
@@ -48,9 +63,39 @@ public:
 private:
 
 	bool IsBeatThisDivision(const int InBeatCount, const int InBeatDivision, const int InDenominator);
-	void GenerateBeatLinesFromTimePointIfInvalid(Chart* const InChart, const Time InTime);
+	struct SnapUpdate
+	{
+		NoteHandle Handle;
+		Time TimePoint = 0;
+
+		int BeatSnap = -1;
+		BeatPosition Position;
+		BeatPosition PositionEnd;
+	};
+
+	//only the notes whose snap or position changed are handed back
+	static std::vector<SnapUpdate> GatherSnapUpdates(std::shared_ptr<const ChartSnapshot> InSnapshot, const Time InTimeBegin);
 
+	void AppendTimeRangeBeatLines(const Time InTimeBegin, const Time InTimeEnd, Chart* const InChart, const int InBeatDivision, std::vector<BeatLine>& OutBeatLines);
+	void GatherTimeSignatureBeats(Chart* const InChart);
+
+	//sorted by timepoint, covering the window plus a line on either side of it
 	std::vector<BeatLine> _OnFieldBeatLines;
+	std::vector<BeatLine> _BeatLineBuffer;
+
+	size_t _BeatLineTimingRevision = 0;
+	int _BeatLineDivision = 0;
+	Time _BeatLineTimeBegin = 0;
+	Time _BeatLineTimeEnd = 0;
+
+	std::vector<std::pair<double, TimeSignature>> _TimeSignatureBeats;
 
 	std::set<int> _LegalSnaps;
+
+	//the chart the timing changes are followed on, the ones not yet handed to the worker and the ones it is busy with
+	Chart* _PropagationChart = nullptr;
+	Time _PendingPropagationTimePoint = std::numeric_limits<Time>::max();
+	Time _PropagationTimeBegin = 0;
+	Time _PropagationTimeEnd = 0;
+	std::future<std::vector<SnapUpdate>> _PropagationUpdates;
 };
@@ -3,12 +3,22 @@
 #include <sstream>
 #include <algorithm>
 #include <limits>
+#include <numeric>
 
 #include <math.h>
 
+#include "../structures/chart-builder.h"
+
 #define PARSE_COMMA_VALUE(stringstream, target) stringstream >> target; if (stringstream.peek() == ',') stringstream.ignore()
 #define REMOVE_POTENTIAL_NEWLINE(str) if(str.find('\r') != std::string::npos) str.resize(str.size() - 1)
 
+// Stepmania resolves a measure into 192 steps, measures needing more rows than that are rounded onto them
+#define SM_ROWS_PER_MEASURE 192
+
+// osu! keeps the sv of its inherited timing points within these bounds
+#define OSU_MIN_SV 0.01
+#define OSU_MAX_SV 10.0
+
 void ChartParserModule::SetCurrentChartPath(const std::filesystem::path& InPath)
 {
 	_CurrentChartPath = InPath;
@@ -97,6 +107,20 @@ Chart* ChartParserModule::ParseAndGenerateChartSet(const std::filesystem::path&
 
 Chart* ChartParserModule::LoadChart(const std::filesystem::path& InPath, const std::string& InDifficultyName)
 {
+	if(InPath.extension() == ".sm")
+	{
+		//scanning the file for its difficulties already parsed all of them
+		if(!(_ChartSet && _ChartSetPath == InPath) && !ParseChartSet(InPath))
+			return nullptr;
+
+		_CurrentChartPath = InPath;
+		_ChartSetDifficultyIndex = _ChartSet->FindDifficulty(InDifficultyName);
+
+		PUSH_NOTIFICATION("Opened %s", InPath.c_str());
+
+		return _ChartSet->CreateChart(_ChartSetDifficultyIndex);
+	}
+
 	std::ifstream chartFile(InPath);
 	if (!chartFile.is_open()) return nullptr;
 	
@@ -106,12 +130,22 @@ Chart* ChartParserModule::LoadChart(const std::filesystem::path& InPath, const s
 
 	if(InPath.extension() == ".osu")
 		return ParseChartOsuImpl(chartFile, InPath);
-	else if(InPath.extension() == ".sm")
-		return ParseChartStepmaniaImpl(chartFile, InPath, InDifficultyName);
 
 	return nullptr;
 }
 
+ChartSet* ChartParserModule::ParseChartSet(const std::filesystem::path& InPath)
+{
+	std::ifstream chartFile(InPath);
+	if (!chartFile.is_open()) return nullptr;
+
+	_ChartSet.reset(ParseChartSetStepmaniaImpl(chartFile, InPath));
+	_ChartSetPath = InPath;
+	_ChartSetDifficultyIndex = -1;
+
+	return _ChartSet.get();
+}
+
 std::vector<ChartDefinition> ChartParserModule::ScanForCharts(const std::filesystem::path& InPath)
 {
     std::vector<ChartDefinition> definitions;
@@ -123,47 +157,11 @@ std::vector<ChartDefinition> ChartParserModule::ScanForCharts(const std::filesys
 
     if(InPath.extension() == ".sm")
     {
-        std::ifstream InIfstream(InPath);
-        std::string line;
-
-        while (std::getline(InIfstream, line))
-        {
-            size_t commentPos = line.find("//");
-		    if (commentPos != std::string::npos) line = line.substr(0, commentPos);
-
-            line.erase(0, line.find_first_not_of(" \t\r\n"));
-            line.erase(line.find_last_not_of(" \t\r\n") + 1);
-            if (line.empty()) continue;
-
-            if (line.find("#NOTES") != std::string::npos)
-            {
-                std::string buffer = line;
-                if (buffer.find(':') != std::string::npos)
-                    buffer = buffer.substr(buffer.find(':') + 1);
-
-                while (std::count(buffer.begin(), buffer.end(), ':') < 3 && InIfstream.peek() != EOF)
-                {
-                    std::string nextLine;
-                    std::getline(InIfstream, nextLine);
-                    buffer += nextLine;
-                }
+        ChartSet* chartSet = ParseChartSet(InPath);
+        if (!chartSet) return definitions;
 
-                std::vector<std::string> sections;
-                std::stringstream ss(buffer);
-                std::string segment;
-                while (std::getline(ss, segment, ':'))
-                {
-                    segment.erase(0, segment.find_first_not_of(" \t\r\n"));
-                    segment.erase(segment.find_last_not_of(" \t\r\n") + 1);
-                    sections.push_back(segment);
-                }
-
-                if (sections.size() >= 3)
-                {
-                    definitions.push_back({sections[2], sections[1], sections[0]});
-                }
-            }
-        }
+        for (const auto& difficulty : chartSet->Difficulties)
+            definitions.push_back({difficulty.DifficultyName, difficulty.Charter, difficulty.ChartType});
     }
     return definitions;
 }
@@ -171,6 +169,10 @@ std::vector<ChartDefinition> ChartParserModule::ScanForCharts(const std::filesys
 Chart* ChartParserModule::ParseChartOsuImpl(std::ifstream& InIfstream, std::filesystem::path InPath)
 {
 	Chart* chart = new Chart();
+	ChartBuilder builder;
+
+	std::vector<std::pair<Time, double>> osuSvs;
+	std::vector<Time> osuBpmTimePoints;
 
 	std::string line;
 
@@ -354,7 +356,6 @@ Chart* ChartParserModule::ParseChartOsuImpl(std::ifstream& InIfstream, std::file
 
 		if (line == "[TimingPoints]")
 		{
-			std::string timePointLine;
 			while (InIfstream >> line)
 			{
 				if (line == "[HitObjects]" || line == "[Colours]")
@@ -378,9 +379,10 @@ Chart* ChartParserModule::ParseChartOsuImpl(std::ifstream& InIfstream, std::file
 				//BPMData* bpmData = new BPMData();
 				//bpmData->BPMSaved = bpm;
 
+				// Inherited timing points carry the sv as a negative percentage in place of the beat length
 				if (beatLength < 0)
 				{
-					chart->InheritedTimingPoints.push_back(timePointLine);
+					osuSvs.push_back({Time(timePoint), std::clamp(-100.0 / beatLength, OSU_MIN_SV, OSU_MAX_SV)});
 					continue;
 				}
 
@@ -391,7 +393,8 @@ Chart* ChartParserModule::ParseChartOsuImpl(std::ifstream& InIfstream, std::file
 				//bpmData->meter = meter;
 				//bpmData->uninherited = uninherited;
 
-				chart->InjectBpmPoint(Time(timePoint), bpm, beatLength);
+				builder.AddBpmPoint(Time(timePoint), bpm, beatLength);
+				osuBpmTimePoints.push_back(Time(timePoint));
 			}
 		}
 
@@ -419,16 +422,38 @@ Chart* ChartParserModule::ParseChartOsuImpl(std::ifstream& InIfstream, std::file
 
 				if (noteType == 128)
 				{
-					chart->InjectHold(timePoint, timePointEnd, parsedColumn);
+					builder.AddHold(timePoint, timePointEnd, parsedColumn);
 				}
 				else if (noteType == 1 || noteType == 5)
 				{
-					chart->InjectNote(timePoint, parsedColumn, Note::EType::Common);
+					builder.AddNote(timePoint, parsedColumn, Note::EType::Common);
 				}
 			}
 		}
 	}
 
+	// A red line resets the sv in osu!, here the sv carries on across bpm points unless it is reset as well
+	std::stable_sort(osuSvs.begin(), osuSvs.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+	std::sort(osuBpmTimePoints.begin(), osuBpmTimePoints.end());
+
+	double svMultiplier = 1.0;
+	size_t svIndex = 0;
+
+	for (const Time bpmTimePoint : osuBpmTimePoints)
+	{
+		for (; svIndex < osuSvs.size() && osuSvs[svIndex].first < bpmTimePoint; ++svIndex)
+			svMultiplier = osuSvs[svIndex].second;
+
+		if (svMultiplier != 1.0 && (svIndex == osuSvs.size() || osuSvs[svIndex].first != bpmTimePoint))
+			builder.AddSV(bpmTimePoint, 1.0);
+
+		svMultiplier = 1.0;
+	}
+
+	for (const auto& [timePoint, multiplier] : osuSvs)
+		builder.AddSV(timePoint, multiplier);
+
+	builder.Build(*chart);
 
 	return chart;
 }
@@ -436,9 +461,23 @@ Chart* ChartParserModule::ParseChartOsuImpl(std::ifstream& InIfstream, std::file
 // Helper to keep track of holds
 struct SmHoldTracker
 {
-	Time TimePointBegin;
+	double BeatBegin;
 	Column Col;
     Note::EType Type;
+	BeatPosition PositionBegin;
+};
+
+// Helper for notes read before all of the timing is known
+struct SmParsedNote
+{
+	double Beat;
+	double BeatEnd;
+	Column Col;
+	Note::EType Type;
+
+	// The row a note sits on is exact, unlike its beat
+	BeatPosition Position;
+	BeatPosition PositionEnd;
 };
 
 // Helper struct for beat-based bpm points needed during parsing
@@ -448,10 +487,9 @@ struct SmBpmPoint
 	double Bpm;
 };
 
-Chart* ChartParserModule::ParseChartStepmaniaImpl(std::ifstream& InIfstream, std::filesystem::path InPath, const std::string& InDifficultyName)
+ChartSet* ChartParserModule::ParseChartSetStepmaniaImpl(std::ifstream& InIfstream, std::filesystem::path InPath)
 {
-	Chart* chart = new Chart();
-	chart->KeyAmount = 4; // Default to 4 keys for dance-single
+	ChartSet* chartSet = new ChartSet();
 
 	std::string line;
 	std::string buffer; // To accumulate multiline values
@@ -479,12 +517,20 @@ Chart* ChartParserModule::ParseChartStepmaniaImpl(std::ifstream& InIfstream, std
     std::vector<SmTimeSignature> smTimeSignatures;
 	bool inNotes = false;
 
-	// Helper to calculate time from beat using smBpmPoints and offset
+	// Notes are kept in beats until the whole file is read, timing tags may still follow them
+	std::vector<std::vector<SmParsedNote>> smNotesPerDifficulty;
+
+	// Helper to calculate time from beat using smBpmPoints, smStops and offset
 	auto GetTimeFromBeat = [&](double InBeat) -> Time
 	{
 		double time = offset * 1000.0;
 		double currentBeat = 0.0;
 
+		// Every stop before the beat delays it, a note on the stop itself is hit as it begins
+		for (const auto& stop : smStops)
+			if (stop.Beat < InBeat)
+				time += stop.Length * 1000.0;
+
 		if (smBpmPoints.empty()) return Time(time);
 
 		double currentBpm = smBpmPoints[0].Bpm;
@@ -550,18 +596,18 @@ Chart* ChartParserModule::ParseChartStepmaniaImpl(std::ifstream& InIfstream, std
 
 				if (!value.empty() && value.back() == ';') value.pop_back();
 
-				if (key == "TITLE") chart->SongTitle = value;
-				else if (key == "ARTIST") chart->Artist = value;
-				else if (key == "CREDIT") chart->Charter = value;
+				if (key == "TITLE") chartSet->Metadata.SongTitle = value;
+				else if (key == "ARTIST") chartSet->Metadata.Artist = value;
+				else if (key == "CREDIT") chartSet->Metadata.Charter = value;
 				else if (key == "MUSIC")
 				{
 					std::filesystem::path songPath = std::filesystem::path(parentPath) / value;
-					chart->AudioPath = songPath;
+					chartSet->Metadata.AudioPath = songPath;
 				}
 				else if (key == "BANNER" || key == "BACKGROUND")
 				{
 					std::filesystem::path bgPath = std::filesystem::path(parentPath) / value;
-					chart->BackgroundPath = bgPath;
+					chartSet->Metadata.BackgroundPath = bgPath;
 				}
 				else if (key == "OFFSET")
 				{
@@ -584,13 +630,6 @@ Chart* ChartParserModule::ParseChartStepmaniaImpl(std::ifstream& InIfstream, std
 					}
 					// Ensure sorted
 					std::sort(smBpmPoints.begin(), smBpmPoints.end(), [](const SmBpmPoint& a, const SmBpmPoint& b){ return a.Beat < b.Beat; });
-
-					// Inject into Chart
-					for (const auto& pt : smBpmPoints)
-					{
-						Time t = GetTimeFromBeat(pt.Beat);
-						chart->InjectBpmPoint(t, pt.Bpm, 60000.0 / pt.Bpm);
-					}
 				}
                 else if (key == "STOPS")
                 {
@@ -643,8 +682,8 @@ Chart* ChartParserModule::ParseChartStepmaniaImpl(std::ifstream& InIfstream, std
                         }
                     }
                 }
-                else if (key == "BGCHANGES") chart->SmBgChanges = value;
-                else if (key == "FGCHANGES") chart->SmFgChanges = value;
+                else if (key == "BGCHANGES") chartSet->Metadata.SmBgChanges = value;
+                else if (key == "FGCHANGES") chartSet->Metadata.SmFgChanges = value;
 				else if (key == "NOTES")
 				{
 					inNotes = true;
@@ -682,161 +721,168 @@ Chart* ChartParserModule::ParseChartStepmaniaImpl(std::ifstream& InIfstream, std
 
 			if (sections.size() >= 6)
 			{
-                for (const auto& stop : smStops)
-                {
-                    Time t = GetTimeFromBeat(stop.Beat);
-                    chart->InjectStop(t, stop.Length);
-                }
-                for (const auto& sv : smSVs)
-                {
-                    Time t = GetTimeFromBeat(sv.Beat);
-                    chart->InjectSV(t, sv.Multiplier);
-                }
-                for (const auto& ts : smTimeSignatures)
-                {
-                    Time t = GetTimeFromBeat(ts.Beat);
-                    chart->InjectTimeSignature(t, ts.Numerator, ts.Denominator);
-                }
+				ChartSetDifficulty difficulty;
+				difficulty.ChartType = sections[0];
+				difficulty.Charter = sections[1];
+				difficulty.DifficultyName = sections[2];
+				difficulty.Meter = sections[3];
+				difficulty.RadarValues = sections[4];
 
-				std::string chartType = sections[0];
-                std::string difficulty = sections[2];
+				chartSet->Difficulties.push_back(std::move(difficulty));
+				std::vector<SmParsedNote>& smNotes = smNotesPerDifficulty.emplace_back();
 
-                bool match = false;
-                if (InDifficultyName.empty())
-                {
-				    if (chartType.find("dance-single") != std::string::npos) match = true;
-                }
-                else
-                {
-                    if (difficulty == InDifficultyName) match = true;
-                }
+				std::string noteData = sections[5];
 
-				if (match)
-				{
-					chart->DifficultyName = difficulty;
+				// Process Measures
+				std::vector<SmHoldTracker> holds;
+				double currentMeasureIndex = 0;
 
-					std::string noteData = sections[5];
+				std::stringstream measureStream(noteData);
+				std::string measureStr;
 
-					// Process Measures
-					std::vector<SmHoldTracker> holds;
-					double currentMeasureIndex = 0;
-
-					std::stringstream measureStream(noteData);
-					std::string measureStr;
-
-					while (std::getline(measureStream, measureStr, ','))
+				while (std::getline(measureStream, measureStr, ','))
+				{
+					// Process one measure
+					// Split into rows
+					std::vector<std::string> rows;
+					std::stringstream rowStream(measureStr);
+					std::string rowStr;
+					while (std::getline(rowStream, rowStr))
 					{
-						// Process one measure
-						// Split into rows
-						std::vector<std::string> rows;
-						std::stringstream rowStream(measureStr);
-						std::string rowStr;
-						while (std::getline(rowStream, rowStr))
+						// Clean row
+						rowStr.erase(0, rowStr.find_first_not_of(" \t\r"));
+						rowStr.erase(rowStr.find_last_not_of(" \t\r") + 1);
+						// Remove comments in note data?
+						if (rowStr.substr(0, 2) == "//") continue;
+
+						// Check for semicolon terminator
+						size_t semiPos = rowStr.find(';');
+						if (semiPos != std::string::npos)
 						{
-							// Clean row
-							rowStr.erase(0, rowStr.find_first_not_of(" \t\r"));
-							rowStr.erase(rowStr.find_last_not_of(" \t\r") + 1);
-							// Remove comments in note data?
-							if (rowStr.substr(0, 2) == "//") continue;
-
-							// Check for semicolon terminator
-							size_t semiPos = rowStr.find(';');
-							if (semiPos != std::string::npos)
+							rowStr = rowStr.substr(0, semiPos);
+							if (rowStr.empty())
 							{
-								rowStr = rowStr.substr(0, semiPos);
-								if (rowStr.empty())
-								{
-									// Semicolon found on empty line (or start of line).
-									break;
-								}
+								// Semicolon found on empty line (or start of line).
+								break;
 							}
-
-							if (rowStr.empty()) continue;
-							rows.push_back(rowStr);
 						}
 
-						int numRows = rows.size();
-						if (numRows == 0)
-						{
-							currentMeasureIndex++;
-							continue;
-						}
+						if (rowStr.empty()) continue;
+						rows.push_back(rowStr);
+					}
 
-						for (int r = 0; r < numRows; ++r)
-						{
-							double beatIndex = (currentMeasureIndex * 4.0) + ((double)r / (double)numRows) * 4.0;
-							Time t = GetTimeFromBeat(beatIndex);
+					int numRows = rows.size();
+					if (numRows == 0)
+					{
+						currentMeasureIndex++;
+						continue;
+					}
 
-							std::string& row = rows[r];
-							for (int c = 0; c < 4 && c < (int)row.size(); ++c) // 4 columns
+					for (int r = 0; r < numRows; ++r)
+					{
+						double beatIndex = (currentMeasureIndex * 4.0) + ((double)r / (double)numRows) * 4.0;
+						BeatPosition position = MakeBeatPosition(((long long)currentMeasureIndex * numRows + r) * 4, numRows);
+
+						std::string& row = rows[r];
+						for (int c = 0; c < 4 && c < (int)row.size(); ++c) // 4 columns
+						{
+							char type = row[c];
+							if (type == '1') // Tap
 							{
-								char type = row[c];
-								if (type == '1') // Tap
-								{
-									chart->InjectNote(t, c, Note::EType::Common);
-								}
-								else if (type == '2') // Hold Head
-								{
-									holds.push_back({t, (Column)c, Note::EType::HoldBegin});
-								}
-                                else if (type == '4') // Roll Head
-                                {
-                                    holds.push_back({t, (Column)c, Note::EType::RollBegin});
-                                }
-								else if (type == '3') // Hold Tail
+								smNotes.push_back({beatIndex, beatIndex, (Column)c, Note::EType::Common, position, BeatPosition()});
+							}
+							else if (type == '2') // Hold Head
+							{
+								holds.push_back({beatIndex, (Column)c, Note::EType::HoldBegin, position});
+							}
+                            else if (type == '4') // Roll Head
+                            {
+                                holds.push_back({beatIndex, (Column)c, Note::EType::RollBegin, position});
+                            }
+							else if (type == '3') // Hold Tail
+							{
+								// Find matching head
+								for (auto it = holds.begin(); it != holds.end(); ++it)
 								{
-									// Find matching head
-									for (auto it = holds.begin(); it != holds.end(); ++it)
+									if (it->Col == (Column)c)
 									{
-										if (it->Col == (Column)c)
-										{
-                                            if (it->Type == Note::EType::HoldBegin)
-											    chart->InjectHold(it->TimePointBegin, t, c);
-                                            else if (it->Type == Note::EType::RollBegin)
-                                                chart->InjectRoll(it->TimePointBegin, t, c);
-
-											holds.erase(it);
-											break;
-										}
+										smNotes.push_back({it->BeatBegin, beatIndex, (Column)c, it->Type, it->PositionBegin, position});
+
+										holds.erase(it);
+										break;
 									}
 								}
-								else if (type == 'M') // Mine
-								{
-									chart->InjectNote(t, c, Note::EType::Mine);
-								}
-                                else if (type == 'L') // Lift
-                                {
-                                    chart->InjectNote(t, c, Note::EType::Lift);
-                                }
-                                else if (type == 'F') // Fake
-                                {
-                                    chart->InjectNote(t, c, Note::EType::Fake);
-                                }
 							}
+							else if (type == 'M') // Mine
+							{
+								smNotes.push_back({beatIndex, beatIndex, (Column)c, Note::EType::Mine, position, BeatPosition()});
+							}
+                            else if (type == 'L') // Lift
+                            {
+                                smNotes.push_back({beatIndex, beatIndex, (Column)c, Note::EType::Lift, position, BeatPosition()});
+                            }
+                            else if (type == 'F') // Fake
+                            {
+                                smNotes.push_back({beatIndex, beatIndex, (Column)c, Note::EType::Fake, position, BeatPosition()});
+                            }
 						}
-						currentMeasureIndex++;
 					}
-
-					// Found and parsed one chart, we return it.
-					// If file has multiple difficulties, this picks the first dance-single one.
-					return chart;
+					currentMeasureIndex++;
 				}
 			}
 
-			// If not dance-single or failed parse, reset inNotes to look for next #NOTES
+			// Reset inNotes to look for the next #NOTES
 			inNotes = false;
 			buffer.clear();
 		}
 	}
 
-	return chart;
+	// All timing is known now, it is converted once and shared by every difficulty
+	for (const auto& pt : smBpmPoints)
+		chartSet->Timing.BpmPoints.push_back({GetTimeFromBeat(pt.Beat), 60000.0 / pt.Bpm, pt.Bpm});
+	for (const auto& stop : smStops)
+		chartSet->Timing.Stops.push_back({GetTimeFromBeat(stop.Beat), stop.Length});
+	for (const auto& sv : smSVs)
+		chartSet->Timing.SvMultipliers.push_back({GetTimeFromBeat(sv.Beat), sv.Multiplier});
+	for (const auto& ts : smTimeSignatures)
+		chartSet->Timing.TimeSignatures.push_back({GetTimeFromBeat(ts.Beat), ts.Numerator, ts.Denominator});
+
+	for (size_t difficultyIndex = 0; difficultyIndex < smNotesPerDifficulty.size(); ++difficultyIndex)
+	{
+		auto& notes = chartSet->Difficulties[difficultyIndex].Notes;
+		notes.reserve(smNotesPerDifficulty[difficultyIndex].size());
+
+		for (const auto& smNote : smNotesPerDifficulty[difficultyIndex])
+		{
+			Note note;
+			note.Type = smNote.Type;
+			note.TimePoint = GetTimeFromBeat(smNote.Beat);
+			note.TimePointBegin = note.TimePoint;
+			note.TimePointEnd = GetTimeFromBeat(smNote.BeatEnd);
+			note.Position = smNote.Position;
+			note.PositionEnd = smNote.PositionEnd;
+
+			notes.push_back({smNote.Col, note});
+		}
+	}
+
+	return chartSet;
 }
 
 void ChartParserModule::ExportChartSet(Chart* InChart)
 {
 	std::ofstream chartFile(_CurrentChartPath);
 
-	ExportChartOsuImpl(InChart, chartFile);
+	//the other difficulties of the file are written along with the one edited
+	if (_CurrentChartPath.extension() == ".sm" && _ChartSet && _ChartSetPath == _CurrentChartPath && _ChartSetDifficultyIndex >= 0)
+	{
+		_ChartSet->StoreChart(_ChartSetDifficultyIndex, *InChart);
+		ExportChartSetStepmaniaImpl(*_ChartSet, chartFile);
+	}
+	else if (_CurrentChartPath.extension() == ".sm")
+		ExportChartStepmaniaImpl(InChart, chartFile);
+	else
+		ExportChartOsuImpl(InChart, chartFile);
 
 	PUSH_NOTIFICATION("Saved to %s", _CurrentChartPath.c_str());
 }
@@ -904,13 +950,43 @@ void ChartParserModule::ExportChartOsuImpl(Chart* InChart, std::ofstream& InOfSt
 							<< "\n"
 							<< "[TimingPoints]" << "\n";
 
-	for (std::string inheritedPoint : InChart->InheritedTimingPoints)
-		chartStream << inheritedPoint;
-	
-	InChart->IterateAllBpmPoints([&chartStream](BpmPoint& InBpmPoint)
+	//the base offset is baked into every timepoint written
+	const Time baseOffset = InChart->GetBaseOffset();
+
+	std::vector<BpmPoint> bpmPoints;
+	std::vector<ScrollVelocityMultiplier> svs;
+
+	InChart->IterateAllBpmPoints([&bpmPoints](BpmPoint& InBpmPoint) { bpmPoints.push_back(InBpmPoint); });
+	InChart->IterateAllSVs([&svs](ScrollVelocityMultiplier& InSV) { svs.push_back(InSV); });
+
+	std::stable_sort(bpmPoints.begin(), bpmPoints.end(), [](const BpmPoint& lhs, const BpmPoint& rhs) { return lhs.TimePoint < rhs.TimePoint; });
+	std::stable_sort(svs.begin(), svs.end(), [](const ScrollVelocityMultiplier& lhs, const ScrollVelocityMultiplier& rhs) { return lhs.TimePoint < rhs.TimePoint; });
+
+	auto writeSV = [&chartStream, baseOffset](const Time InTimePoint, const double InMultiplier)
 	{
-		chartStream << InBpmPoint.TimePoint << "," << InBpmPoint.BeatLength << "," << "4" << ",0,0,10,1,0\n";
-	});
+		chartStream << InTimePoint + baseOffset << "," << -100.0 / std::clamp(InMultiplier, OSU_MIN_SV, OSU_MAX_SV) << "," << "4" << ",0,0,10,0,0\n";
+	};
+
+	//osu! resets the sv on every red line, so the sv in effect across one is written again right after it
+	double svMultiplier = 1.0;
+	size_t svIndex = 0;
+
+	for (const auto& bpmPoint : bpmPoints)
+	{
+		for (; svIndex < svs.size() && svs[svIndex].TimePoint < bpmPoint.TimePoint; ++svIndex)
+		{
+			writeSV(svs[svIndex].TimePoint, svs[svIndex].Multiplier);
+			svMultiplier = svs[svIndex].Multiplier;
+		}
+
+		chartStream << bpmPoint.TimePoint + baseOffset << "," << bpmPoint.BeatLength << "," << "4" << ",0,0,10,1,0\n";
+
+		if (svMultiplier != 1.0 && (svIndex == svs.size() || svs[svIndex].TimePoint != bpmPoint.TimePoint))
+			writeSV(bpmPoint.TimePoint, svMultiplier);
+	}
+
+	for (; svIndex < svs.size(); ++svIndex)
+		writeSV(svs[svIndex].TimePoint, svs[svIndex].Multiplier);
 
 	// leaving the "4" there since we will want to set custom snap divisor
 	
@@ -919,18 +995,18 @@ void ChartParserModule::ExportChartOsuImpl(Chart* InChart, std::ofstream& InOfSt
 							<< "[HitObjects]" << "\n";
 
 	int keyAmount = InChart->KeyAmount;
-	InChart->IterateAllNotes([keyAmount, &chartStream](const Note InOutNote, const Column InColumn)
+	InChart->IterateAllNotes([keyAmount, baseOffset, &chartStream](const Note InOutNote, const Column InColumn)
 	{
 		int column = float(float((InColumn + 1)) * 512.f) / float(keyAmount) - (512.f / float(keyAmount) / 2.f);
 
 		switch (InOutNote.Type)
 		{
 		case Note::EType::Common:
-			chartStream << column << ",192," << InOutNote.TimePoint << ",1,0,0:0:0:0:\n";
+			chartStream << column << ",192," << InOutNote.TimePoint + baseOffset << ",1,0,0:0:0:0:\n";
 			break;
 		
 		case Note::EType::HoldBegin:
-			chartStream << column << ",192," << InOutNote.TimePoint << ",128,0," << InOutNote.TimePointEnd << ":0:0:0:0:\n";
+			chartStream << column << ",192," << InOutNote.TimePoint + baseOffset << ",128,0," << InOutNote.TimePointEnd + baseOffset << ":0:0:0:0:\n";
 			break;
 
 		default:
@@ -944,6 +1020,15 @@ void ChartParserModule::ExportChartOsuImpl(Chart* InChart, std::ofstream& InOfSt
 }
 
 void ChartParserModule::ExportChartStepmaniaImpl(Chart* InChart, std::ofstream& InOfStream)
+{
+	ChartSet chartSet;
+	chartSet.Difficulties.emplace_back();
+	chartSet.StoreChart(0, *InChart);
+
+	ExportChartSetStepmaniaImpl(chartSet, InOfStream);
+}
+
+void ChartParserModule::ExportChartSetStepmaniaImpl(const ChartSet& InChartSet, std::ofstream& InOfStream)
 {
 	// 1. Calculate Beats for all BPM Points to generate #BPMS and for note conversion
 	struct ProcessedBpmPoint
@@ -954,9 +1039,8 @@ void ChartParserModule::ExportChartStepmaniaImpl(Chart* InChart, std::ofstream&
 	};
 	std::vector<ProcessedBpmPoint> processedBpmPoints;
 
-	// Sort BPM points from Chart
-	std::vector<BpmPoint> sortedBpmPoints;
-	InChart->IterateAllBpmPoints([&sortedBpmPoints](BpmPoint& pt){ sortedBpmPoints.push_back(pt); });
+	// Sort BPM points from the shared timing
+	std::vector<BpmPoint> sortedBpmPoints = InChartSet.Timing.BpmPoints;
 	std::sort(sortedBpmPoints.begin(), sortedBpmPoints.end(), [](const BpmPoint& a, const BpmPoint& b){ return a.TimePoint < b.TimePoint; });
 
 	// Offset logic:
@@ -971,69 +1055,31 @@ void ChartParserModule::ExportChartStepmaniaImpl(Chart* InChart, std::ofstream&
 	if (!sortedBpmPoints.empty())
 		offset = sortedBpmPoints[0].TimePoint / 1000.0;
 
-	double currentBeat = 0.0;
-	double lastTime = offset * 1000.0; // This is Time of Beat 0
-	double currentBpm = 120.0;
-
-	if (!sortedBpmPoints.empty())
-	{
-		// Initial BPM is the one at Beat 0 (or the first one)
-		currentBpm = sortedBpmPoints[0].Bpm;
-		processedBpmPoints.push_back({0.0, currentBpm, (Time)lastTime});
-	}
-
-	for (size_t i = 1; i < sortedBpmPoints.size(); ++i)
-	{
-		double timeDelta = sortedBpmPoints[i].TimePoint - lastTime;
-		double beatDelta = timeDelta / (60000.0 / currentBpm);
-		currentBeat += beatDelta;
-
-		processedBpmPoints.push_back({currentBeat, sortedBpmPoints[i].Bpm, sortedBpmPoints[i].TimePoint});
-
-		lastTime = sortedBpmPoints[i].TimePoint;
-		currentBpm = sortedBpmPoints[i].Bpm;
-	}
-
-	auto TimeToBeat = [&](Time t) -> double {
-		// Find relevant BPM segment
-		// processedBpmPoints has (Beat, Bpm, TimePoint).
-		// We want to map Time t -> Beat.
-
-		if (processedBpmPoints.empty()) return 0.0;
-
-		// Find the segment that starts <= t
-		int idx = -1;
-		for (int i = processedBpmPoints.size() - 1; i >= 0; --i)
-		{
-			if (processedBpmPoints[i].TimePoint <= t + 1) // +1 epsilon
-			{
-				idx = i;
-				break;
-			}
-		}
+	// The base offset only moves where beat 0 lies in the song, the beats themselves stay as they are
+	offset += InChartSet.Timing.BaseOffset / 1000.0;
 
-		if (idx == -1) // Time is before first BPM point (before offset?)
-		{
-			// Extrapolate backwards using first BPM
-			double delta = t - processedBpmPoints[0].TimePoint;
-			return processedBpmPoints[0].Beat + delta / (60000.0 / processedBpmPoints[0].Bpm);
-		}
+	// Beats follow the tempo map of the timing, so stops are accounted for the same way the importer adds them
+	TempoMap tempoMap;
+	tempoMap.Append(InChartSet.Timing.BpmPoints, InChartSet.Timing.Stops);
 
-		double delta = t - processedBpmPoints[idx].TimePoint;
-		return processedBpmPoints[idx].Beat + delta / (60000.0 / processedBpmPoints[idx].Bpm);
+	auto TimeToBeat = [&tempoMap](Time t) -> double {
+		return tempoMap.GetBeatFromTime(t);
 	};
 
+	for (const auto& bpmPoint : sortedBpmPoints)
+		processedBpmPoints.push_back({TimeToBeat(bpmPoint.TimePoint), bpmPoint.Bpm, bpmPoint.TimePoint});
+
 	// 2. Write Header
 	std::stringstream ss;
-	ss << "#TITLE:" << InChart->SongTitle << ";\n";
+	ss << "#TITLE:" << InChartSet.Metadata.SongTitle << ";\n";
 	ss << "#SUBTITLE:;\n";
-	ss << "#ARTIST:" << InChart->Artist << ";\n";
-	ss << "#TITLETRANSLIT:" << InChart->SongtitleUnicode << ";\n";
-	ss << "#ARTISTTRANSLIT:" << InChart->ArtistUnicode << ";\n";
+	ss << "#ARTIST:" << InChartSet.Metadata.Artist << ";\n";
+	ss << "#TITLETRANSLIT:" << InChartSet.Metadata.SongtitleUnicode << ";\n";
+	ss << "#ARTISTTRANSLIT:" << InChartSet.Metadata.ArtistUnicode << ";\n";
 	ss << "#GENRE:;\n";
-	ss << "#CREDIT:" << InChart->Charter << ";\n";
-	ss << "#MUSIC:" << InChart->AudioPath.filename().string() << ";\n";
-	ss << "#BANNER:" << InChart->BackgroundPath.filename().string() << ";\n";
+	ss << "#CREDIT:" << InChartSet.Metadata.Charter << ";\n";
+	ss << "#MUSIC:" << InChartSet.Metadata.AudioPath.filename().string() << ";\n";
+	ss << "#BANNER:" << InChartSet.Metadata.BackgroundPath.filename().string() << ";\n";
 	ss << "#BACKGROUND:;\n";
 	ss << "#LYRICSPATH:;\n";
 	ss << "#CDTITLE:;\n";
@@ -1051,8 +1097,7 @@ void ChartParserModule::ExportChartStepmaniaImpl(Chart* InChart, std::ofstream&
 	}
 
 	ss << "#STOPS:";
-    std::vector<StopPoint> stops;
-    InChart->IterateAllStops([&](StopPoint& s){ stops.push_back(s); });
+    std::vector<StopPoint> stops = InChartSet.Timing.Stops;
     std::sort(stops.begin(), stops.end(), [](const StopPoint& a, const StopPoint& b){ return a.TimePoint < b.TimePoint; });
 
     for (size_t i = 0; i < stops.size(); ++i)
@@ -1064,8 +1109,7 @@ void ChartParserModule::ExportChartStepmaniaImpl(Chart* InChart, std::ofstream&
 	ss << ";\n";
 
     ss << "#SCROLLS:";
-    std::vector<ScrollVelocityMultiplier> svs;
-    InChart->IterateAllSVs([&](ScrollVelocityMultiplier& s){ svs.push_back(s); });
+    std::vector<ScrollVelocityMultiplier> svs = InChartSet.Timing.SvMultipliers;
     std::sort(svs.begin(), svs.end(), [](const auto& a, const auto& b){ return a.TimePoint < b.TimePoint; });
 
     for (size_t i = 0; i < svs.size(); ++i)
@@ -1077,8 +1121,7 @@ void ChartParserModule::ExportChartStepmaniaImpl(Chart* InChart, std::ofstream&
     ss << ";\n";
 
     ss << "#TIMESIGNATURES:";
-    std::vector<TimeSignature> tss;
-    InChart->IterateAllTimeSignatures([&](TimeSignature& ts){ tss.push_back(ts); });
+    std::vector<TimeSignature> tss = InChartSet.Timing.TimeSignatures;
     std::sort(tss.begin(), tss.end(), [](const auto& a, const auto& b){ return a.TimePoint < b.TimePoint; });
 
     for (size_t i = 0; i < tss.size(); ++i)
@@ -1089,138 +1132,149 @@ void ChartParserModule::ExportChartStepmaniaImpl(Chart* InChart, std::ofstream&
     }
     ss << ";\n";
 
-	ss << "#BGCHANGES:" << InChart->SmBgChanges << ";\n";
-	ss << "#FGCHANGES:" << InChart->SmFgChanges << ";\n";
+	ss << "#BGCHANGES:" << InChartSet.Metadata.SmBgChanges << ";\n";
+	ss << "#FGCHANGES:" << InChartSet.Metadata.SmFgChanges << ";\n";
 
 	// 3. Convert Notes to Beat Positions
 	struct SmNote
 	{
-		double Beat;
+		// The measure of the file and the reduced fraction of it the note sits on
+		int Measure;
+		int Numerator;
+		int Denominator;
+
 		int Column;
 		char Type; // 1=Tap, 2=Head, 3=Tail
 	};
-	std::vector<SmNote> smNotes;
 
-	InChart->IterateAllNotes([&](Note& n, const Column& col) {
-		// Only support 4 keys for now
-		if (col >= 4) return;
-
-		double b = TimeToBeat(n.TimePoint);
-		if (n.Type == Note::EType::Common)
+	// A measure of the file always spans 4 beats, whatever the time signatures say. The whole part of the position returned counts measures
+	// Notes on the grid already know their beat, the others are put on the coarsest row of the measure within tolerance
+	auto GetPosition = [&TimeToBeat](const Time InTime, const BeatPosition& InPosition) -> BeatPosition
+	{
+		if (InPosition.IsValid())
 		{
-			smNotes.push_back({b, (int)col, '1'});
+			BeatPosition measurePosition = MakeBeatPosition((long long)InPosition.Beat * InPosition.Denominator + InPosition.Numerator, 4LL * InPosition.Denominator);
+
+			if (measurePosition.IsValid())
+				return measurePosition;
 		}
-		else if (n.Type == Note::EType::HoldBegin)
+
+		double measures = TimeToBeat(InTime) / 4.0;
+		double measure = floor(measures);
+
+		for (int div : {4, 8, 12, 16, 24, 32, 48, 64})
 		{
-			smNotes.push_back({b, (int)col, '2'});
-			double bEnd = TimeToBeat(n.TimePointEnd);
-			smNotes.push_back({bEnd, (int)col, '3'});
+			double pos = (measures - measure) * div;
+			if (std::abs(pos - std::round(pos)) <= 0.01)
+				return MakeBeatPosition((long long)measure * div + (long long)std::round(pos), div);
 		}
-        else if (n.Type == Note::EType::RollBegin)
-        {
-            smNotes.push_back({b, (int)col, '4'});
-            double bEnd = TimeToBeat(n.TimePointEnd);
-            smNotes.push_back({bEnd, (int)col, '3'});
-        }
-        else if (n.Type == Note::EType::Mine)
-        {
-            smNotes.push_back({b, (int)col, 'M'});
-        }
-        else if (n.Type == Note::EType::Lift)
-        {
-            smNotes.push_back({b, (int)col, 'L'});
-        }
-        else if (n.Type == Note::EType::Fake)
-        {
-            smNotes.push_back({b, (int)col, 'F'});
-        }
-	});
 
-	std::sort(smNotes.begin(), smNotes.end(), [](const SmNote& a, const SmNote& b){
-		if (std::abs(a.Beat - b.Beat) > 0.001) return a.Beat < b.Beat;
-		return a.Column < b.Column;
-	});
+		return MakeBeatPosition((long long)std::round(measures * SM_ROWS_PER_MEASURE), SM_ROWS_PER_MEASURE);
+	};
 
-	// 4. Write #NOTES
-	ss << "//---------------" << InChart->DifficultyName << " - " << InChart->Charter << "---------------\n";
-	ss << "#NOTES:\n";
-	ss << "     dance-single:\n";
-	ss << "     " << InChart->Charter << ":\n";
-	ss << "     " << InChart->DifficultyName << ":\n"; // Difficulty Class needs mapping? Or just use name
-	ss << "     8:\n"; // Meter hardcoded for now
-	ss << "     0.000,0.000,0.000,0.000,0.000:\n";
-
-	// 5. Write Measures
-	int currentMeasure = 0;
-	size_t noteIdx = 0;
-
-	// Determine last measure
-	double lastBeat = smNotes.empty() ? 0.0 : smNotes.back().Beat;
-	int totalMeasures = (int)ceil(lastBeat / 4.0);
-	if (totalMeasures == 0 && !smNotes.empty()) totalMeasures = 1;
-
-	for (int m = 0; m < totalMeasures; ++m)
+	// The header and timing are written once, every difficulty follows with its own #NOTES
+	for (const auto& difficulty : InChartSet.Difficulties)
 	{
-		// Find notes in this measure [m*4, (m+1)*4)
-		std::vector<SmNote*> measureNotes;
-		while (noteIdx < smNotes.size() && smNotes[noteIdx].Beat < (m + 1) * 4)
+		std::vector<SmNote> smNotes;
+		smNotes.reserve(difficulty.Notes.size());
+
+		auto pushNote = [&smNotes](const BeatPosition& InPosition, const int InColumn, const char InType)
 		{
-			if (smNotes[noteIdx].Beat >= m * 4 - 0.001) // Tolerance
-				measureNotes.push_back(&smNotes[noteIdx]);
-			noteIdx++;
-		}
+			smNotes.push_back({ InPosition.Beat, InPosition.Numerator, InPosition.Denominator, InColumn, InType });
+		};
 
-		// Determine quantization
-		int divs[] = {4, 8, 12, 16, 24, 32, 48, 64, 192};
-		int bestDiv = 4;
+		for (const auto& [col, n] : difficulty.Notes) {
+			// Only support 4 keys for now
+			if (col >= 4) continue;
 
-		for (int div : divs)
-		{
-			bool fit = true;
-			for (auto* n : measureNotes)
+			BeatPosition p = GetPosition(n.TimePoint, n.Position);
+			if (n.Type == Note::EType::Common)
 			{
-				double relativeBeat = n->Beat - (m * 4);
-				double pos = relativeBeat * div;
-				// Check if pos is close to integer
-				if (std::abs(pos - std::round(pos)) > 0.01)
-				{
-					fit = false;
-					break;
-				}
+				pushNote(p, (int)col, '1');
 			}
-			if (fit)
+			else if (n.Type == Note::EType::HoldBegin)
 			{
-				bestDiv = div;
-				break;
+				pushNote(p, (int)col, '2');
+				pushNote(GetPosition(n.TimePointEnd, n.PositionEnd), (int)col, '3');
 			}
-			bestDiv = 192; // Fallback
+	        else if (n.Type == Note::EType::RollBegin)
+	        {
+	            pushNote(p, (int)col, '4');
+	            pushNote(GetPosition(n.TimePointEnd, n.PositionEnd), (int)col, '3');
+	        }
+	        else if (n.Type == Note::EType::Mine)
+	        {
+	            pushNote(p, (int)col, 'M');
+	        }
+	        else if (n.Type == Note::EType::Lift)
+	        {
+	            pushNote(p, (int)col, 'L');
+	        }
+	        else if (n.Type == Note::EType::Fake)
+	        {
+	            pushNote(p, (int)col, 'F');
+	        }
 		}
 
-		// Write rows
-		for (int r = 0; r < bestDiv; ++r)
+		// Nothing before the first measure can be written
+		smNotes.erase(std::remove_if(smNotes.begin(), smNotes.end(), [](const SmNote& n){ return n.Measure < 0; }), smNotes.end());
+
+		std::sort(smNotes.begin(), smNotes.end(), [](const SmNote& a, const SmNote& b){
+			if (a.Measure != b.Measure) return a.Measure < b.Measure;
+			long long lhs = (long long)a.Numerator * b.Denominator;
+			long long rhs = (long long)b.Numerator * a.Denominator;
+			if (lhs != rhs) return lhs < rhs;
+			return a.Column < b.Column;
+		});
+
+		// 4. Write #NOTES
+		ss << "//---------------" << difficulty.DifficultyName << " - " << difficulty.Charter << "---------------\n";
+		ss << "#NOTES:\n";
+		ss << "     " << difficulty.ChartType << ":\n";
+		ss << "     " << difficulty.Charter << ":\n";
+		ss << "     " << difficulty.DifficultyName << ":\n"; // Difficulty Class needs mapping? Or just use name
+		ss << "     " << difficulty.Meter << ":\n";
+		ss << "     " << difficulty.RadarValues << ":\n";
+
+		// 5. Write Measures
+		size_t noteIdx = 0;
+
+		// A note on the first beat of a measure opens that measure, and an empty chart still needs one to be terminated
+		int totalMeasures = smNotes.empty() ? 1 : smNotes.back().Measure + 1;
+
+		std::vector<std::string> rows;
+
+		for (int m = 0; m < totalMeasures; ++m)
 		{
-			char rowStr[5] = "0000";
+			size_t measureEnd = noteIdx;
+			while (measureEnd < smNotes.size() && smNotes[measureEnd].Measure == m)
+				measureEnd++;
+
+			// The fewest rows holding every note of the measure exactly
+			int rowAmount = 4;
+			for (size_t i = noteIdx; i < measureEnd && rowAmount <= SM_ROWS_PER_MEASURE; ++i)
+				rowAmount = std::lcm(rowAmount, smNotes[i].Denominator);
 
-			// Check for notes at this row
-			double rowBeatStart = (m * 4) + (double)r / bestDiv * 4.0;
-			// We check for notes approximately at this beat
+			if (rowAmount > SM_ROWS_PER_MEASURE)
+				rowAmount = SM_ROWS_PER_MEASURE;
 
-			for (auto* n : measureNotes)
+			rows.assign(rowAmount, "0000");
+
+			for (; noteIdx < measureEnd; ++noteIdx)
 			{
-				if (std::abs(n->Beat - rowBeatStart) < 0.01) // Tolerance
-				{
-					if (n->Column < 4)
-						rowStr[n->Column] = n->Type;
-				}
+				const SmNote& n = smNotes[noteIdx];
+				int row = (int)std::round((double)n.Numerator * rowAmount / n.Denominator);
+				rows[std::min(row, rowAmount - 1)][n.Column] = n.Type;
 			}
 
-			ss << rowStr << "\n";
-		}
+			for (const auto& row : rows)
+				ss << row << "\n";
 
-		if (m < totalMeasures - 1)
-			ss << ",\n";
-		else
-			ss << ";\n";
+			if (m < totalMeasures - 1)
+				ss << ",\n";
+			else
+				ss << ";\n";
+		}
 	}
 
 	InOfStream.clear();
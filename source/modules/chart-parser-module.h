@@ -5,8 +5,10 @@
 #include <fstream>
 #include <filesystem>
 #include <vector>
+#include <memory>
 
 #include "../structures/chart-metadata.h"
+#include "../structures/chart-set.h"
 
 
 /*
@@ -30,6 +32,9 @@ public:
 	Chart* ParseAndGenerateChartSet(const std::filesystem::path& InPath);
 	void ExportChartSet(Chart* InChart);
 
+	//reads every difficulty of a stepmania file in one pass, the set is kept so opening one of them does not read the file again
+	ChartSet* ParseChartSet(const std::filesystem::path& InPath);
+
 	void SetCurrentChartPath(const std::filesystem::path& InPath);
 
 	ChartMetadata GetChartMetadata(Chart* InChart);
@@ -41,9 +46,15 @@ private:
 
 	std::filesystem::path _CurrentChartPath;
 
+	//the set of the stepmania file last parsed, and which of its difficulties is open
+	std::unique_ptr<ChartSet> _ChartSet;
+	std::filesystem::path _ChartSetPath;
+	int _ChartSetDifficultyIndex = -1;
+
 	Chart* ParseChartOsuImpl(std::ifstream& InIfstream, std::filesystem::path InPath);
-	Chart* ParseChartStepmaniaImpl(std::ifstream& InIfstream, std::filesystem::path InPath, const std::string& InDifficultyName = "");
+	ChartSet* ParseChartSetStepmaniaImpl(std::ifstream& InIfstream, std::filesystem::path InPath);
 
 	void ExportChartOsuImpl(Chart* InChart, std::ofstream& InOfStream);
 	void ExportChartStepmaniaImpl(Chart* InChart, std::ofstream& InOfStream);
+	void ExportChartSetStepmaniaImpl(const ChartSet& InChartSet, std::ofstream& InOfStream);
 };
@@ -34,3 +34,24 @@ void DebugModule::RenderTimeSliceBoundaries(TimefieldRenderGraph& OutRenderGraph
 	});
 	
 }
+
+void DebugModule::RenderHistoryMemory(Chart* const InSelectedChart)
+{
+    if(!ShowHistoryMemory)
+        return;
+
+    ImGui::Begin("History Memory", &ShowHistoryMemory, ImGuiWindowFlags_AlwaysAutoResize);
+
+    auto displayUsage = [](const char* InName, const HistoryMemoryUsage& InUsage)
+    {
+        ImGui::Text("%s", InName);
+        ImGui::Text("  live:       %zu entries, %.1f KB", InUsage.LiveEntries, InUsage.LiveBytes / 1024.0);
+        ImGui::Text("  compressed: %zu entries, %.1f KB", InUsage.CompressedEntries, InUsage.CompressedBytes / 1024.0);
+        ImGui::Text("  on disk:    %zu entries, %.1f KB", InUsage.SpilledEntries, InUsage.SpilledBytes / 1024.0);
+    };
+
+    displayUsage("Undo", InSelectedChart->UndoJournal.GetMemoryUsage());
+    displayUsage("Redo", InSelectedChart->RedoJournal.GetMemoryUsage());
+
+    ImGui::End();
+}
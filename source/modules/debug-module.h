@@ -7,8 +7,10 @@ class DebugModule : public Module
 public:
 
     void RenderTimeSliceBoundaries(TimefieldRenderGraph& OutRenderGraph, Chart* const InSelectedChart, Time InTimeBegin, Time InTimeEnd);
+    void RenderHistoryMemory(Chart* const InSelectedChart);
 
 public:
 
     bool ShowTimeSliceBoundaries = false;
+    bool ShowHistoryMemory = false;
 };
\ No newline at end of file
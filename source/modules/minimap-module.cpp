@@ -2,9 +2,13 @@
 
 #include <imgui.h>
 
+#include "../structures/chart-snapshot.h"
+
 void MiniMapModule::Generate(Chart* const InChart, Skin& InSkin, const Time InSongLength)
 {
     _Width = _BorderPadding * 2 + _NoteWidth + (InChart->KeyAmount * _NoteWidth + (InChart->KeyAmount - 1)) + _NoteWidth;
+    _PatternLanePosition = _Width;
+    _Width += _PatternLaneWidth + _BorderPadding;
     _ScaledSongLength = InSongLength / _HeightScale;
     
     if(_SongLength != InSongLength)
@@ -14,10 +18,12 @@ void MiniMapModule::Generate(Chart* const InChart, Skin& InSkin, const Time InSo
     }
     
     _MiniMapRenderTexture.clear({0, 0, 0, 255});
+    _PatternSnapshot.reset();
+    _DirtyTimeSliceBegin = _DirtyTimeSliceEnd = 0;
 
     InChart->IterateNotesInTimeRange(0, InSongLength, [this, &InSkin, &InSongLength](Note& InOutNote, const Column InColumn)
     {
-        if(InOutNote.Type == Note::EType::HoldEnd || InOutNote.Type == Note::EType::HoldIntermediate)
+        if(InOutNote.Type == Note::EType::HoldEnd)
             return;
 
         if(InOutNote.Type == Note::EType::HoldBegin)
@@ -47,7 +53,7 @@ void MiniMapModule::Generate(Chart* const InChart, Skin& InSkin, const Time InSo
     _MiniMapSprite.setTexture(_MiniMapRenderTexture.getTexture());
 }
 
-void MiniMapModule::GeneratePortion(const TimeSlice& InTimeSlice, Skin& InSkin) 
+void MiniMapModule::GeneratePortion(Chart* const InChart, const TimeSlice& InTimeSlice, Skin& InSkin) 
 {
     sf::RectangleShape backgroundRectangle;
     backgroundRectangle.setSize(sf::Vector2f(_Width, int(float(TIMESLICE_LENGTH / _HeightScale) + 0.5f) + _NoteHeight));
@@ -57,36 +63,72 @@ void MiniMapModule::GeneratePortion(const TimeSlice& InTimeSlice, Skin& InSkin)
 
     _MiniMapRenderTexture.draw(backgroundRectangle);
 
-    for(const auto& [column, notes] : InTimeSlice.Notes)
+    //the background covers the pattern lane as well
+    _PatternSnapshot.reset();
+
+    InChart->IterateLongNotesInTimeRange(InTimeSlice.TimePoint, InTimeSlice.TimePoint + TIMESLICE_LENGTH - 1, [this](Note& note, const Column column)
     {
-        for(const auto& note : notes)
-        {
-            if(note.Type == Note::EType::HoldEnd || note.Type == Note::EType::HoldBegin || note.Type == Note::EType::HoldIntermediate)
-            {
-                sf::RectangleShape rectangleHold;
+        if(note.Type != Note::EType::HoldBegin)
+            return;
+
+        sf::RectangleShape rectangleHold;
 
-                rectangleHold.setSize(sf::Vector2f(_NoteWidth, (note.TimePointEnd - note.TimePointBegin + _NoteHeight) / _HeightScale));
-                rectangleHold.setFillColor({32, 255, 32, 255});
+        rectangleHold.setSize(sf::Vector2f(_NoteWidth, (note.TimePointEnd - note.TimePointBegin + _NoteHeight) / _HeightScale));
+        rectangleHold.setFillColor({32, 255, 32, 255});
 
-                rectangleHold.setPosition(sf::Vector2f(_BorderPadding + _NoteWidth + (column * _NoteWidth + column), (note.TimePointBegin - _NoteHeight) / _HeightScale));
+        rectangleHold.setPosition(sf::Vector2f(_BorderPadding + _NoteWidth + (column * _NoteWidth + column), (note.TimePointBegin - _NoteHeight) / _HeightScale));
 
-                _MiniMapRenderTexture.draw(rectangleHold);
-            }
+        _MiniMapRenderTexture.draw(rectangleHold);
+    });
 
-            Time noteTime = note.Type == Note::EType::HoldBegin 
-                         || note.Type == Note::EType::HoldEnd 
-                         || note.Type == Note::EType::HoldIntermediate ? note.TimePointBegin : note.TimePoint;
+    InChart->IterateNotesInTimeRange(InTimeSlice.TimePoint, InTimeSlice.TimePoint + TIMESLICE_LENGTH - 1, [this, &InSkin](Note& note, const Column column)
+    {
+        if(note.Type == Note::EType::HoldEnd)
+            return;
 
-            sf::RectangleShape rectangle;
+        sf::RectangleShape rectangle;
 
-            rectangle.setSize(sf::Vector2f(_NoteWidth, _NoteHeight));
-            rectangle.setFillColor(InSkin.SnapColorTable[note.BeatSnap]);
+        rectangle.setSize(sf::Vector2f(_NoteWidth, _NoteHeight));
+        rectangle.setFillColor(InSkin.SnapColorTable[note.BeatSnap]);
 
-            rectangle.setPosition(sf::Vector2f(_BorderPadding + _NoteWidth + (column * _NoteWidth + column), (noteTime - _NoteHeight) / _HeightScale));
+        rectangle.setPosition(sf::Vector2f(_BorderPadding + _NoteWidth + (column * _NoteWidth + column), (note.TimePoint - _NoteHeight) / _HeightScale));
 
-            _MiniMapRenderTexture.draw(rectangle);
-        }
+        _MiniMapRenderTexture.draw(rectangle);
+    });
+}
+
+void MiniMapModule::MarkPortionsDirty(const Time InTimeBegin, const Time InTimeEnd)
+{
+    const int timeSliceBegin = GetTimeSliceIndex(std::max<Time>(InTimeBegin, 0));
+    const int timeSliceEnd = GetTimeSliceIndex(std::min(InTimeEnd, _SongLength)) + 1;
+
+    if(timeSliceBegin >= timeSliceEnd)
+        return;
+
+    if(_DirtyTimeSliceBegin >= _DirtyTimeSliceEnd)
+    {
+        _DirtyTimeSliceBegin = timeSliceBegin;
+        _DirtyTimeSliceEnd = timeSliceEnd;
+        return;
     }
+
+    _DirtyTimeSliceBegin = std::min(_DirtyTimeSliceBegin, timeSliceBegin);
+    _DirtyTimeSliceEnd = std::max(_DirtyTimeSliceEnd, timeSliceEnd);
+}
+
+void MiniMapModule::GenerateDirtyPortions(Chart* const InChart, Skin& InSkin)
+{
+    if(_DirtyTimeSliceBegin >= _DirtyTimeSliceEnd)
+        return;
+
+    const int timeSliceEnd = std::min(_DirtyTimeSliceBegin + _DirtyPortionsPerTick, _DirtyTimeSliceEnd);
+
+    InChart->IterateTimeSlicesInTimeRange(_DirtyTimeSliceBegin * TIMESLICE_LENGTH, timeSliceEnd * TIMESLICE_LENGTH - 1, [this, InChart, &InSkin](TimeSlice& InTimeSlice)
+    {
+        GeneratePortion(InChart, InTimeSlice, InSkin);
+    });
+
+    _DirtyTimeSliceBegin = timeSliceEnd;
 }
 
 TimefieldRenderGraph& MiniMapModule::GetPreviewRenderGraph(Chart* const InChart) 
@@ -96,9 +138,57 @@ TimefieldRenderGraph& MiniMapModule::GetPreviewRenderGraph(Chart* const InChart)
 		_PreviewRenderGraph.SubmitNoteRenderCommand(InNote, InColumn);
 	});
 
+	InChart->IterateLongNotesInTimeRange(_HoveredTime - _PreviewTimeLength, _HoveredTime + _PreviewTimeLength, [this](Note& InNote, const Column InColumn)
+	{
+		if(InNote.TimePoint < _HoveredTime - _PreviewTimeLength)
+			_PreviewRenderGraph.SubmitNoteRenderCommand(InNote, InColumn);
+	});
+
     return _PreviewRenderGraph;
 }
 
+void MiniMapModule::UpdatePatternOverlay(Chart* const InChart)
+{
+    auto snapshot = InChart->TakeSnapshot();
+
+    if(snapshot == _PatternSnapshot)
+        return;
+
+    _PatternSnapshot = snapshot;
+    _PatternClassifier.Analyze(*snapshot);
+
+    static const sf::Color patternColors[] =
+    {
+        {0, 0, 0, 255},
+        {64, 160, 255, 255},
+        {64, 255, 160, 255},
+        {255, 224, 64, 255},
+        {255, 64, 64, 255},
+        {192, 96, 255, 255},
+        {255, 128, 32, 255}
+    };
+
+    sf::RectangleShape laneRectangle;
+
+    laneRectangle.setSize(sf::Vector2f(_PatternLaneWidth, float(_MiniMapRenderTexture.getSize().y)));
+    laneRectangle.setPosition(sf::Vector2f(_PatternLanePosition, 0));
+    laneRectangle.setFillColor({0, 0, 0, 255});
+
+    _MiniMapRenderTexture.draw(laneRectangle);
+
+    for (const auto& section : _PatternClassifier.GetSections())
+    {
+        sf::RectangleShape sectionRectangle;
+
+        sectionRectangle.setSize(sf::Vector2f(_PatternLaneWidth, float(section.TimeEnd - section.TimeBegin) / _HeightScale));
+        sectionRectangle.setFillColor(patternColors[int(section.Type)]);
+
+        sectionRectangle.setPosition(sf::Vector2f(_PatternLanePosition, float(section.TimeBegin) / _HeightScale));
+
+        _MiniMapRenderTexture.draw(sectionRectangle);
+    }
+}
+
 bool MiniMapModule::IsHoveringTimeline(const int InScreenX, const int InScreenY, const int InHeight, const int InDistanceFromBorders, const Time InTime, const Time InTimeScreenBegin, const Time InTimeScreenEnd, const Cursor& InCursor) 
 {
     if(_IsDragging)
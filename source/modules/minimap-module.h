@@ -4,6 +4,8 @@
 
 #include <SFML/Graphics.hpp>
 
+#include "../structures/pattern-classifier.h"
+
 //TODO: refactor, remove all hardcoded values
 class MiniMapModule : public Module
 {
@@ -14,9 +16,16 @@ public:
 public:
 
     void Generate(Chart* const InChart, Skin& InSkin, const Time InSongLength);
-    void GeneratePortion(const TimeSlice& InTimeSlice, Skin& InSkin);
+    void GeneratePortion(Chart* const InChart, const TimeSlice& InTimeSlice, Skin& InSkin);
+
+    //the portions in the range are drawn again a few timeslices per call, so a change spanning the whole chart never holds up a frame
+    void MarkPortionsDirty(const Time InTimeBegin, const Time InTimeEnd);
+    void GenerateDirtyPortions(Chart* const InChart, Skin& InSkin);
     TimefieldRenderGraph& GetPreviewRenderGraph(Chart* const InChart);
 
+    //classifies the chart again whenever it changed and draws the patterns in a lane next to the notes
+    void UpdatePatternOverlay(Chart* const InChart);
+
     bool IsHoveringTimeline(const int InScreenX, const int InScreenY, const int InHeight, const int InDistanceFromBorders, const Time InTime,  const Time InTimeScreenBegin, const Time InTimeScreenEnd, const Cursor& InCursor);
     bool IsPossibleToDrag();
     bool IsDragging();
@@ -33,6 +42,7 @@ public:
 private:
 
     int _Width = 0;
+    int _PatternLanePosition = 0;
     int _ScaledSongLength = 0;
 
     int _MiniScreenBottomPosition = 0;
@@ -51,12 +61,17 @@ private:
     bool _IsPossibleToDrag = false;
     bool _IsDragging = false;
 
+    int _DirtyTimeSliceBegin = 0;
+    int _DirtyTimeSliceEnd = 0;
+
     const int _HeightScale = 150;
     const int _NoteWidth = 2;
     const int _NoteHeight = 1;
     const int _BorderPadding = 4;
     const int _DragButtonBounds = 20;
     const Time _PreviewTimeLength = 1500;
+    const int _PatternLaneWidth = 4;
+    const int _DirtyPortionsPerTick = 32;
 
     sf::RectangleShape _MiniMapRectangle;
 
@@ -65,6 +80,9 @@ private:
 
     TimefieldRenderGraph _PreviewRenderGraph;
 
+    PatternClassifier _PatternClassifier;
+    std::shared_ptr<const ChartSnapshot> _PatternSnapshot;
+
     sf::RenderTexture _PreviewRenderTexture;
     sf::Sprite _PreviewSprite;
 };
\ No newline at end of file
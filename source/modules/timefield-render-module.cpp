@@ -1,5 +1,8 @@
 #include "timefield-render-module.h"
 
+#include <algorithm>
+#include <cmath>
+
 bool TimefieldRenderModule::StartUp()
 {
 	_HoldRenderLayer.create(3840, 2160);
@@ -7,9 +10,6 @@ bool TimefieldRenderModule::StartUp()
 
 	_SegmentedRenderTexture.create(3840, 2160);
 
-
-	_OnScreenNotes.reserve(1000);
-
 	return true;
 }
 
@@ -35,38 +35,41 @@ bool TimefieldRenderModule::RenderFront(sf::RenderTarget* const InOutRenderTarge
 void TimefieldRenderModule::RenderTimefieldGraph(sf::RenderTarget* const InOutRenderTarget, TimefieldRenderGraph& InOutTimefieldRenderGraph, const Time InTime, const float InZoomLevel, const bool InRegisterToOnscreenNotes)
 {
 	if(InRegisterToOnscreenNotes)
-		_OnScreenNotes.clear();
+	{
+		for(auto& columnNotes : _OnScreenNotes)
+			columnNotes.clear();
+	}
 
 	_HoldRenderLayer.clear({ 0,0,0,0 });
 	_NoteRenderLayer.clear({ 0,0,0,0 });
 
-	InOutTimefieldRenderGraph.Render([this, &InTime, &InZoomLevel, &InRegisterToOnscreenNotes](const NoteRenderCommand& InNoteRenderCommand)
+	//notes come in mostly chronologically, so the cursor steps along the scroll map rather than searching it for every note
+	const double position = _ScrollMap->GetPosition(InTime);
+	ScrollCursor noteScrollCursor(*_ScrollMap);
+
+	InOutTimefieldRenderGraph.Render([this, &InZoomLevel, &InRegisterToOnscreenNotes, &position, &noteScrollCursor](const NoteRenderCommand& InNoteRenderCommand)
 	{
 		const Note& note = InNoteRenderCommand.RenderNote;
 		const Column column = InNoteRenderCommand.NoteColumn;
 
-		const int y = GetScreenPointFromTime(note.TimePoint, InTime, InZoomLevel) + _TimefieldMetrics.NoteScreenPivot;
+		const int y = GetScreenPointFromPosition(noteScrollCursor.GetPosition(note.TimePoint) - position, InZoomLevel) + _TimefieldMetrics.NoteScreenPivot;
 
-		//hold pass
+		//hold pass, the body is drawn once per hold from its begin
 		switch (note.Type)
 		{
 		case Note::EType::HoldBegin:
-		case Note::EType::HoldIntermediate:
-		case Note::EType::HoldEnd:
 			{
-				int endY = GetScreenPointFromTime(note.TimePointEnd, InTime, InZoomLevel) - _TimefieldMetrics.ColumnSize / 2;
-				int height = GetScreenPointFromTime(note.TimePointBegin, InTime, InZoomLevel) - endY;
+				int endY = GetScreenPointFromPosition(_ScrollMap->GetPosition(note.TimePointEnd) - position, InZoomLevel) - _TimefieldMetrics.ColumnSize / 2;
+				int height = GetScreenPointFromPosition(noteScrollCursor.GetPosition(note.TimePointBegin) - position, InZoomLevel) - endY;
 
 				_Skin.RenderHoldBody(column, endY + _TimefieldMetrics.NoteScreenPivot, height, &_HoldRenderLayer, InNoteRenderCommand.Alpha);
 			}
 			break;
 
 		case Note::EType::RollBegin:
-		case Note::EType::RollIntermediate:
-		case Note::EType::RollEnd:
 			{
-				int endY = GetScreenPointFromTime(note.TimePointEnd, InTime, InZoomLevel) - _TimefieldMetrics.ColumnSize / 2;
-				int height = GetScreenPointFromTime(note.TimePointBegin, InTime, InZoomLevel) - endY;
+				int endY = GetScreenPointFromPosition(_ScrollMap->GetPosition(note.TimePointEnd) - position, InZoomLevel) - _TimefieldMetrics.ColumnSize / 2;
+				int height = GetScreenPointFromPosition(noteScrollCursor.GetPosition(note.TimePointBegin) - position, InZoomLevel) - endY;
 
 				_Skin.RenderRollBody(column, endY + _TimefieldMetrics.NoteScreenPivot, height, &_HoldRenderLayer, InNoteRenderCommand.Alpha);
 			}
@@ -106,10 +109,30 @@ void TimefieldRenderModule::RenderTimefieldGraph(sf::RenderTarget* const InOutRe
 			break;
 		}
 
-		if(InRegisterToOnscreenNotes)
-			_OnScreenNotes.push_back({&note, column, y});
+		//previews are not part of the chart and carry no valid handle
+		if(InRegisterToOnscreenNotes && note.Handle.IsValid() && column < _OnScreenNotes.size())
+			_OnScreenNotes[column].push_back({note.Handle, note.TimePoint, column, y});
 	});
 
+	//notes are mostly handed over chronologically, which is descending on screen
+	if(InRegisterToOnscreenNotes)
+	{
+		for(auto& columnNotes : _OnScreenNotes)
+		{
+			auto isAbove = [](const _OnScreenNote& lhs, const _OnScreenNote& rhs) { return lhs.OnScreenY < rhs.OnScreenY || (lhs.OnScreenY == rhs.OnScreenY && lhs.m_TimePoint > rhs.m_TimePoint); };
+
+			if(std::is_sorted(columnNotes.begin(), columnNotes.end(), isAbove))
+				continue;
+
+			auto isBelow = [&isAbove](const _OnScreenNote& lhs, const _OnScreenNote& rhs) { return isAbove(rhs, lhs); };
+
+			if(std::is_sorted(columnNotes.begin(), columnNotes.end(), isBelow))
+				std::reverse(columnNotes.begin(), columnNotes.end());
+			else
+				std::sort(columnNotes.begin(), columnNotes.end(), isAbove);
+		}
+	}
+
 	_HoldRenderLayer.display();
 	_NoteRenderLayer.display();
 
@@ -122,9 +145,13 @@ void TimefieldRenderModule::RenderTimefieldGraph(sf::RenderTarget* const InOutRe
 	InOutRenderTarget->draw(_HoldRenderLayerSprite);
 	InOutRenderTarget->draw(_NoteRenderLayerSprite);
 
-	InOutTimefieldRenderGraph.Render([this, &InOutRenderTarget, &InTime, &InZoomLevel](const TimefieldRenderCommand& InRenderCommand)
+	ScrollCursor commandScrollCursor(*_ScrollMap);
+
+	InOutTimefieldRenderGraph.Render([this, &InOutRenderTarget, &InZoomLevel, &position, &commandScrollCursor](const TimefieldRenderCommand& InRenderCommand)
 	{
-		InRenderCommand.RenderWork(InOutRenderTarget, _TimefieldMetrics, _TimefieldMetrics.FirstColumnPosition + InRenderCommand.ColumnPoint * _TimefieldMetrics.ColumnSize, GetScreenPointFromTime(InRenderCommand.TimePoint, InTime, InZoomLevel));
+		const int y = GetScreenPointFromPosition(commandScrollCursor.GetPosition(InRenderCommand.TimePoint) - position, InZoomLevel);
+
+		InRenderCommand.RenderWork(InOutRenderTarget, _TimefieldMetrics, _TimefieldMetrics.FirstColumnPosition + InRenderCommand.ColumnPoint * _TimefieldMetrics.ColumnSize, y);
 	});
 }
 
@@ -182,14 +209,17 @@ void TimefieldRenderModule::RenderReceptors(sf::RenderTarget* const InOutRenderT
 
 int TimefieldRenderModule::GetScreenPointFromTime(const Time InTimePoint, const Time InTime, const float InZoomLevel)
 {
-	int timePoint = InTimePoint - InTime;
+	return GetScreenPointFromPosition(_ScrollMap->GetPosition(InTimePoint) - _ScrollMap->GetPosition(InTime), InZoomLevel);
+}
 
-	timePoint = float(timePoint) * InZoomLevel + 0.5f;
-	timePoint += _TimefieldMetrics.HitLine;
+int TimefieldRenderModule::GetScreenPointFromPosition(const double InPositionDistance, const float InZoomLevel)
+{
+	int screenPoint = float(InPositionDistance) * InZoomLevel + 0.5f;
+	screenPoint += _TimefieldMetrics.HitLine;
 
-	timePoint = _WindowMetrics.Height - timePoint;
+	screenPoint = _WindowMetrics.Height - screenPoint;
 
-	return timePoint;
+	return screenPoint;
 }
 
 Time TimefieldRenderModule::GetTimeFromScreenPoint(const int InScreenPointY, const Time InTime, const float InZoomLevel, const bool InNoteTimePivot)
@@ -199,9 +229,7 @@ Time TimefieldRenderModule::GetTimeFromScreenPoint(const int InScreenPointY, con
 	screenPoint -= _TimefieldMetrics.HitLine;
 	screenPoint = float(screenPoint) / InZoomLevel - 0.5f;
 
-	const int timePoint = screenPoint + InTime;
-
-	return timePoint;
+	return Time(std::lround(_ScrollMap->GetTimeFromPosition(_ScrollMap->GetPosition(InTime) + screenPoint)));
 }
 
 Time TimefieldRenderModule::GetWindowTimePointBegin(const Time InTime, const float InZoomLevel)
@@ -214,6 +242,11 @@ Time TimefieldRenderModule::GetWindowTimePointEnd(const Time InTime, const float
 	return GetTimeFromScreenPoint(0, InTime, InZoomLevel);
 }
 
+void TimefieldRenderModule::SetScrollMap(const ScrollMap* InScrollMap)
+{
+	_ScrollMap = InScrollMap ? InScrollMap : &_LinearScrollMap;
+}
+
 Column TimefieldRenderModule::GetColumnFromScreenPoint(const int InScreenPointX)
 {
 	int inputX = InScreenPointX - _TimefieldMetrics.ColumnSize;
@@ -238,18 +271,20 @@ Column TimefieldRenderModule::GetColumnFromScreenPoint(const int InScreenPointX)
 	return  _TimefieldMetrics.KeyAmount - 1;
 }
 
-void TimefieldRenderModule::GetOverlappedOnScreenNotes(const Column InColumn, const int InScreenPointY, std::vector<const Note*>& OutNoteCollection)
+void TimefieldRenderModule::GetOverlappedOnScreenNotes(const Column InColumn, const int InScreenPointY, std::vector<NoteHandle>& OutNoteCollection)
 {
-	for(auto& onScreenNote : _OnScreenNotes)
-	{
-		if(InColumn != onScreenNote.m_Column)
-			continue;
+	if(InColumn >= _OnScreenNotes.size())
+		return;
 
-		if(!(InScreenPointY >= onScreenNote.OnScreenY - _TimefieldMetrics.ColumnSize && InScreenPointY <= onScreenNote.OnScreenY))
-			continue;
+	const auto& columnNotes = _OnScreenNotes[InColumn];
 
-		OutNoteCollection.push_back(onScreenNote.m_Note);
-	}
+	//a note covers the column sized square above its screen point
+	auto beginIt = std::lower_bound(columnNotes.begin(), columnNotes.end(), InScreenPointY, [](const _OnScreenNote& InNote, const int InY) { return InNote.OnScreenY < InY; });
+	auto endIt = std::upper_bound(beginIt, columnNotes.end(), InScreenPointY + _TimefieldMetrics.ColumnSize, [](const int InY, const _OnScreenNote& InNote) { return InY < InNote.OnScreenY; });
+
+	//walking upwards from the bottom is walking forward in time
+	for(auto noteIt = endIt; noteIt != beginIt;)
+		OutNoteCollection.push_back((--noteIt)->m_Note);
 }
 
 Skin& TimefieldRenderModule::GetSkin()
@@ -266,6 +301,11 @@ void TimefieldRenderModule::InitializeResources(const int InKeyAmount, const std
 {
 	_KeyAmount = InKeyAmount;
 
+	_OnScreenNotes.resize(_KeyAmount);
+
+	for(auto& columnNotes : _OnScreenNotes)
+		columnNotes.reserve(1000);
+
 	_TimefieldMetrics.KeyAmount = _KeyAmount;
 	_TimefieldMetrics.NoteScreenPivot = _TimefieldMetrics.NoteScreenPivotsLookup[_KeyAmount];
 
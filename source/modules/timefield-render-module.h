@@ -4,6 +4,8 @@
 
 #include "base/module.h"
 
+#include "../structures/scroll-map.h"
+
 class TimefieldRenderModule : public Module
 {
 public: //module overrides
@@ -32,7 +34,7 @@ public: //data gathering
 	Time GetWindowTimePointBegin(const Time InTime, const float InZoomLevel);
 	Time GetWindowTimePointEnd(const Time InTime, const float InZoomLevel);
 
-	void GetOverlappedOnScreenNotes(const Column InColumn, const int InScreenPointY, std::vector<const Note*>& OutNoteCollection);
+	void GetOverlappedOnScreenNotes(const Column InColumn, const int InScreenPointY, std::vector<NoteHandle>& OutNoteCollection);
 
 	Skin& GetSkin();
 	const TimefieldMetrics& GetTimefieldMetrics();
@@ -42,6 +44,13 @@ public: //data setting
 	void InitializeResources(const int InKeyAmount, const std::filesystem::path& InSkinFolderPath);
 	void UpdateMetrics(const WindowMetrics& InWindowMetrics);
 
+	//places timepoints on the timefield where the scroll map has them, without one the field scrolls linearly
+	void SetScrollMap(const ScrollMap* InScrollMap);
+
+private: //data gathering
+
+	int GetScreenPointFromPosition(const double InPositionDistance, const float InZoomLevel);
+
 private: //data ownership
 
 	sf::RenderTexture _NoteRenderLayer;
@@ -60,14 +69,21 @@ private: //data ownership
 
 	int _KeyAmount;
 
+	//an empty scroll map maps every timepoint onto itself
+	ScrollMap _LinearScrollMap;
+	const ScrollMap* _ScrollMap = &_LinearScrollMap;
+
 	struct _OnScreenNote
 	{
-		const Note* m_Note;
-		const Column m_Column;
-		const int OnScreenY;
+		NoteHandle m_Note;
+		Time m_TimePoint;
+		Column m_Column;
+		int OnScreenY;
 	};
 
-	std::vector<_OnScreenNote> _OnScreenNotes;
+	//bucketed by column and sorted by screen y after every render pass, so hovering is a binary search.
+	//the buckets are only cleared between frames and keep their capacity
+	std::vector<std::vector<_OnScreenNote>> _OnScreenNotes;
 
 	Skin _Skin;
 };
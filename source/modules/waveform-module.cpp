@@ -17,6 +17,11 @@ void WaveFormModule::SetWaveFormData(WaveFormData* const InWaveFormData, const T
     _SongLengthMilliSeconds = InSongLengthMilliSeconds;
 }
 
+void WaveFormModule::SetChartOffset(const Time InOffset)
+{
+    _ChartOffset = InOffset;
+}
+
 void WaveFormModule::RenderWaveForm(TimefieldRenderGraph& InOutRenderGraph, const Time InTimeBegin, const Time InTimeEnd, const int InScreenX, const float InZoomLevel, const float InWindowHeight) 
 {
     //TODO: Represent lowpass and highpass filters through cool shaders
@@ -41,7 +46,7 @@ void WaveFormModule::RenderWaveForm(TimefieldRenderGraph& InOutRenderGraph, cons
 
     for(int i = 0; i < lineAmount; ++i)
     {
-        const size_t index = std::min(_SongLengthMilliSeconds, std::max(0, timeStartPoint + timeHeight - i));
+        const size_t index = std::min(_SongLengthMilliSeconds, std::max(0, timeStartPoint + timeHeight - i + _ChartOffset));
         const WaveFormData waveFormData = _WaveFormData[index];
 
         const float y = float(_ScalableWaveFormTexture.getSize().y - i);
@@ -14,6 +14,8 @@ public:
 public:
 
     void SetWaveFormData(WaveFormData* const InWaveFormData, const Time InSongLengthMilliSeconds);
+    //the waveform is drawn at chart time, the song plays this much later
+    void SetChartOffset(const Time InOffset);
     void RenderWaveForm(TimefieldRenderGraph& InOutRenderGraph, const Time InTimeBegin, const Time InTimeEnd, const int InScreenX, const float InZoomLevel, const float InWindowHeight);
 
 private:
@@ -27,4 +29,5 @@ private:
     WaveFormData* _WaveFormData = nullptr;
 
     Time _SongLengthMilliSeconds = 0;
+    Time _ChartOffset = 0;
 };
\ No newline at end of file
@@ -1,11 +1,14 @@
 #include "program.h"
 
+#include <cmath>
+
 #include "imgui.h"
 #include "../utilities/imgui/addons/imgui_user.h"
 #include "../utilities/imgui/std/imgui-stdlib.h"
 
 #include "../structures/chart-metadata.h"
 #include "../structures/configuration.h"
+#include "../structures/chart-snapshot.h"
 
 namespace
 {
@@ -96,9 +99,33 @@ void Program::InnerTick()
 	if (!SelectedChart)
 		return;
 
+	//the base offset moves with undo and redo as well, so it is picked up wherever it changed
+	if (MOD(AudioModule).GetChartOffset() != SelectedChart->GetBaseOffset())
+		SyncChartOffset();
+
+	//the scroll map is only built once it is asked for, and again only after the timing changed
+	MOD(TimefieldRenderModule).SetScrollMap(Config.PreviewScrollVelocities ? &SelectedChart->GetScrollMap() : nullptr);
+
 	UpdateCursor();
 	MOD(EditModule).SetCursorData(EditCursor);
 
+	//snaps after a timing change are worked out in the background, the notes and minimap catch up once they are done
+	Time propagatedTimeBegin = 0;
+	Time propagatedTimeEnd = 0;
+
+	if (MOD(BeatModule).PropagateTimingChanges(SelectedChart, propagatedTimeBegin, propagatedTimeEnd))
+	{
+		MOD(MiniMapModule).MarkPortionsDirty(propagatedTimeBegin, propagatedTimeEnd);
+
+		for (int timeSliceIndex = GetTimeSliceIndex(propagatedTimeBegin); timeSliceIndex <= GetTimeSliceIndex(propagatedTimeEnd); ++timeSliceIndex)
+			_ChartLinter.MarkTimeSliceModified(timeSliceIndex);
+	}
+
+	MOD(MiniMapModule).GenerateDirtyPortions(SelectedChart, MOD(TimefieldRenderModule).GetSkin());
+
+	if (_ChartLinter.IsWaitingForSnapshot())
+		_ChartLinter.Submit(SelectedChart->TakeSnapshot());
+
 	WindowTimeBegin = MOD(TimefieldRenderModule).GetWindowTimePointBegin(MOD(AudioModule).GetTimeMilliSeconds(), ZoomLevel);
 	WindowTimeEnd = MOD(TimefieldRenderModule).GetWindowTimePointEnd(MOD(AudioModule).GetTimeMilliSeconds(), ZoomLevel);
 
@@ -154,6 +181,19 @@ void Program::InnerTick()
 		NoteRenderGraph.SubmitNoteRenderCommand(InNote, InColumn, alpha);
 	});
 
+	//holds reaching into the window from below only have their body drawn through their begin
+	SelectedChart->IterateLongNotesInTimeRange(WindowTimeBegin - TIMESLICE_LENGTH, WindowTimeEnd, [this](Note &InNote, const Column InColumn) {
+		if (InNote.TimePoint >= WindowTimeBegin - TIMESLICE_LENGTH)
+			return;
+
+		sf::Int8 alpha = 255;
+
+		if (MOD(EditModule).IsEditModeActive<BpmEditMode>())
+			alpha = 128;
+
+		NoteRenderGraph.SubmitNoteRenderCommand(InNote, InColumn, alpha);
+	});
+
 	MOD(EditModule).SubmitToRenderGraph(PreviewRenderGraph, WindowTimeBegin, WindowTimeEnd);
 }
 
@@ -165,7 +205,8 @@ void Program::InnerRender(sf::RenderTarget *const InOutRenderTarget)
     MOD(BackgroundModule).RenderBack(InOutRenderTarget);
     MOD(TimefieldRenderModule).RenderBack(InOutRenderTarget);
 
-	if(Config.ShowWaveform)
+	//the waveform is laid out linearly in time and would not line up with the notes while they scroll by their sv
+	if(Config.ShowWaveform && !Config.PreviewScrollVelocities)
 		MOD(WaveFormModule).RenderWaveForm(WaveformRenderGraph, WindowTimeBegin, WindowTimeEnd, MOD(TimefieldRenderModule).GetTimefieldMetrics().LeftSidePosition + MOD(TimefieldRenderModule).GetTimefieldMetrics().FieldWidthHalf, ZoomLevel, InOutRenderTarget->getView().getSize().y);
 		//MOD(WaveFormModule).RenderWaveFormPolygon(InOutRenderTarget, WindowTimeBegin, WindowTimeEnd, MOD(TimefieldRenderModule).GetTimefieldMetrics().LeftSidePosition + MOD(TimefieldRenderModule).GetTimefieldMetrics().FieldWidthHalf, ZoomLevel, InOutRenderTarget->getView().getSize().y);
 
@@ -174,17 +215,16 @@ void Program::InnerRender(sf::RenderTarget *const InOutRenderTarget)
 		MOD(TimefieldRenderModule).RenderBeatLine(InOutRenderTarget, InBeatLine.TimePoint, InBeatLine.BeatSnap, MOD(AudioModule).GetTimeMilliSeconds(), ZoomLevel, InBeatLine.IsMeasure);
 	});
 
-    SelectedChart->IterateAllBpmPoints([this, &InOutRenderTarget](BpmPoint& bpm){
-        if (bpm.TimePoint >= WindowTimeBegin && bpm.TimePoint <= WindowTimeEnd)
-            MOD(TimefieldRenderModule).RenderTimingEvent(InOutRenderTarget, bpm.TimePoint, MOD(AudioModule).GetTimeMilliSeconds(), ZoomLevel, sf::Color(0, 255, 255, 128));
+    SelectedChart->GetBpmPointIndex().IterateInTimeRange(WindowTimeBegin, WindowTimeEnd, [this, &InOutRenderTarget](BpmPoint& bpm){
+        MOD(TimefieldRenderModule).RenderTimingEvent(InOutRenderTarget, bpm.TimePoint, MOD(AudioModule).GetTimeMilliSeconds(), ZoomLevel, sf::Color(0, 255, 255, 128));
     });
 
-    SelectedChart->IterateAllStops([this, &InOutRenderTarget](StopPoint& stop){
-        if (stop.TimePoint >= WindowTimeBegin && stop.TimePoint <= WindowTimeEnd)
-            MOD(TimefieldRenderModule).RenderTimingEvent(InOutRenderTarget, stop.TimePoint, MOD(AudioModule).GetTimeMilliSeconds(), ZoomLevel, sf::Color(255, 255, 0, 128));
+    SelectedChart->GetStopIndex().IterateInTimeRange(WindowTimeBegin, WindowTimeEnd, [this, &InOutRenderTarget](StopPoint& stop){
+        MOD(TimefieldRenderModule).RenderTimingEvent(InOutRenderTarget, stop.TimePoint, MOD(AudioModule).GetTimeMilliSeconds(), ZoomLevel, sf::Color(255, 255, 0, 128));
     });
 
 	MOD(DebugModule).RenderTimeSliceBoundaries(DebugRenderGraph, SelectedChart, WindowTimeBegin, WindowTimeEnd);
+	MOD(DebugModule).RenderHistoryMemory(SelectedChart);
 
 	MOD(TimefieldRenderModule).RenderTimefieldGraph(InOutRenderTarget, WaveformRenderGraph, MOD(AudioModule).GetTimeMilliSeconds(), ZoomLevel);
 	MOD(TimefieldRenderModule).RenderTimefieldGraph(InOutRenderTarget, DebugRenderGraph, MOD(AudioModule).GetTimeMilliSeconds(), ZoomLevel, false);
@@ -194,6 +234,7 @@ void Program::InnerRender(sf::RenderTarget *const InOutRenderTarget)
 	MOD(TimefieldRenderModule).RenderTimefieldGraph(InOutRenderTarget, NoteRenderGraph, MOD(AudioModule).GetTimeMilliSeconds(), ZoomLevel);
 	MOD(TimefieldRenderModule).RenderTimefieldGraph(InOutRenderTarget, PreviewRenderGraph, MOD(AudioModule).GetTimeMilliSeconds(), ZoomLevel, false);
 
+	MOD(MiniMapModule).UpdatePatternOverlay(SelectedChart);
 	MOD(MiniMapModule).Render(InOutRenderTarget);
 
 	if (MOD(MiniMapModule).ShouldPreview()) // :D ???
@@ -252,11 +293,21 @@ void Program::MenuBar()
 
 		if (MOD(ShortcutMenuModule).BeginMenu("Edit"))
 		{
-			if (MOD(ShortcutMenuModule).MenuItem("Undo", sf::Keyboard::Key::LControl, sf::Keyboard::Key::Z) && SelectedChart && MOD(EditModule).OnUndo())
-				PUSH_NOTIFICATION("Undo");
+			if (MOD(ShortcutMenuModule).MenuItem("Undo", sf::Keyboard::Key::LControl, sf::Keyboard::Key::Z) && SelectedChart)
+			{
+				if (MOD(EditModule).OnUndo())
+					PUSH_NOTIFICATION("Undo");
+				else if (!SelectedChart->UndoJournal.IsEmpty())
+					PUSH_NOTIFICATION("Undo failed, the history could not be read back");
+			}
 
-			if (MOD(ShortcutMenuModule).MenuItem("Redo", sf::Keyboard::Key::LControl, sf::Keyboard::Key::Y) && SelectedChart && MOD(EditModule).OnRedo())
-				PUSH_NOTIFICATION("Redo");
+			if (MOD(ShortcutMenuModule).MenuItem("Redo", sf::Keyboard::Key::LControl, sf::Keyboard::Key::Y) && SelectedChart)
+			{
+				if (MOD(EditModule).OnRedo())
+					PUSH_NOTIFICATION("Redo");
+				else if (!SelectedChart->RedoJournal.IsEmpty())
+					PUSH_NOTIFICATION("Redo failed, the history could not be read back");
+			}
 
 			if (MOD(ShortcutMenuModule).MenuItem("Select All", sf::Keyboard::Key::LControl, sf::Keyboard::Key::A))
 				MOD(EditModule).OnSelectAll();
@@ -286,6 +337,9 @@ void Program::MenuBar()
 			if (MOD(ShortcutMenuModule).MenuItem("Difficulty Analyzer", sf::Keyboard::Key::Unknown, sf::Keyboard::Unknown) && SelectedChart)
 				OpenDifficultyAnalyzer();
 
+			if (MOD(ShortcutMenuModule).MenuItem("Lint Chart", sf::Keyboard::Key::Unknown, sf::Keyboard::Unknown) && SelectedChart)
+				OpenLintResults();
+
 			if (MOD(ShortcutMenuModule).MenuItem("Reverse", sf::Keyboard::Key::LControl, sf::Keyboard::Key::R) && SelectedChart)
 				MOD(EditModule).OnReverse();
 
@@ -394,6 +448,7 @@ void Program::MenuBar()
 			}
 
 			if (ImGui::Checkbox("Show Waveform", &Config.ShowWaveform)) Config.Save();
+			if (ImGui::Checkbox("Preview Scroll Velocities", &Config.PreviewScrollVelocities)) Config.Save();
 
 			if (ImGui::Checkbox("Use Auto Timing", &Config.UseAutoTiming))
 			{
@@ -401,6 +456,12 @@ void Program::MenuBar()
 				Config.Save();
 			}
 
+			if (ImGui::Checkbox("Keep Notes On Beats When Timing", &Config.UseTempoRebase))
+			{
+				EditMode::static_Flags.UseTempoRebase = Config.UseTempoRebase;
+				Config.Save();
+			}
+
 			if (ImGui::Checkbox("Show Column Heatmap", &Config.ShowColumnHeatmap))
 			{
 				EditMode::static_Flags.ShowColumnHeatmap = Config.ShowColumnHeatmap;
@@ -424,6 +485,7 @@ void Program::MenuBar()
 		if (ImGui::BeginMenu("Debug"))
 		{
 			ImGui::Checkbox("Show TimeSlice Boundaries", &MOD(DebugModule).ShowTimeSliceBoundaries);
+			ImGui::Checkbox("Show History Memory", &MOD(DebugModule).ShowHistoryMemory);
 
 			ImGui::EndMenu();
 		}
@@ -562,7 +624,6 @@ void Program::OpenMoveAllNotes()
             if (offset != 0)
             {
                 MOD(EditModule).OnMoveAllNotes(offset);
-                MOD(BeatModule).AssignNotesToSnapsInChart(SelectedChart);
                 PUSH_NOTIFICATION("Moved all notes by %d ms", offset);
             }
             OutOpen = false;
@@ -633,6 +694,68 @@ void Program::OpenDifficultyAnalyzer()
 		ImGui::Text("Average NPS: %.2f", avg);
 		ImGui::Text("Peak NPS (1s): %.2f", peak);
 
+		//the worker only gets the snapshot when it changed, until it is through the last rating is shown
+		_StrainRating.Submit(SelectedChart->TakeSnapshot());
+
+		const size_t normalRateIndex = size_t(std::round((1.0 - STRAIN_RATE_MIN) / STRAIN_RATE_STEP));
+		const std::vector<double> sectionPeaks = _StrainRating.GetSectionPeaks(normalRateIndex);
+
+		if (!sectionPeaks.empty())
+		{
+			std::vector<float> strainGraph(sectionPeaks.begin(), sectionPeaks.end());
+			ImGui::PlotLines("Strain", strainGraph.data(), strainGraph.size(), 0, NULL, 0.0f, FLT_MAX, ImVec2(0, 100));
+		}
+
+		ImGui::Text("Star Rating: %.2f", _StrainRating.GetStarRating(normalRateIndex));
+
+		if (ImGui::BeginTable("Rates", 4))
+		{
+			for (size_t rateIndex = 0; rateIndex < STRAIN_RATE_AMOUNT; ++rateIndex)
+			{
+				ImGui::TableNextColumn();
+				ImGui::Text("%.1fx: %.2f", _StrainRating.GetRate(rateIndex), _StrainRating.GetStarRating(rateIndex));
+			}
+
+			ImGui::EndTable();
+		}
+
+		if(ImGui::Button("Close") || MOD(InputModule).WasKeyPressed(sf::Keyboard::Key::Escape))
+			OutOpen = false;
+	});
+}
+
+void Program::OpenLintResults()
+{
+	MOD(PopupModule).OpenPopup("Lint Results", [this](bool& OutOpen)
+	{
+		if (_LintIssuesRevision != _ChartLinter.GetRevision())
+		{
+			_LintIssuesRevision = _ChartLinter.GetRevision();
+			_LintIssues = _ChartLinter.GetIssues();
+		}
+
+		ImGui::Text("%d issues", int(_LintIssues.size()));
+
+		if (ImGui::BeginChild("Issues", ImVec2(480, 300), true))
+		{
+			for (size_t index = 0; index < _LintIssues.size(); ++index)
+			{
+				const LintIssue& issue = _LintIssues[index];
+
+				ImGui::PushID(int(index));
+
+				if (ImGui::Selectable(ChartLinter::GetLintName(issue.Type)))
+					MOD(AudioModule).SetTimeMilliSeconds(issue.TimePoint);
+
+				ImGui::SameLine(300);
+				ImGui::Text("%d ms, column %d", issue.TimePoint, int(issue.NoteColumn) + 1);
+
+				ImGui::PopID();
+			}
+		}
+
+		ImGui::EndChild();
+
 		if(ImGui::Button("Close") || MOD(InputModule).WasKeyPressed(sf::Keyboard::Key::Escape))
 			OutOpen = false;
 	});
@@ -778,6 +901,8 @@ void Program::InputActions()
 void Program::InitializeChart(Chart* InChart)
 {
     SelectedChart = InChart;
+	_StrainRating.Clear();
+	SelectedChart->SetHistoryMemoryBudget(size_t(std::max(Config.HistoryMemoryBudget, 1)) * 1024 * 1024);
 
 	MOD(BeatModule).AssignNotesToSnapsInChart(SelectedChart);
 	MOD(AudioModule).LoadAudio(SelectedChart->AudioPath);
@@ -787,15 +912,31 @@ void Program::InitializeChart(Chart* InChart)
 	MOD(MiniMapModule).Generate(SelectedChart, MOD(TimefieldRenderModule).GetSkin(), MOD(AudioModule).GetSongLengthMilliSeconds());
 	MOD(WaveFormModule).SetWaveFormData(MOD(AudioModule).GenerateAndGetWaveformData(SelectedChart->AudioPath), MOD(AudioModule).GetSongLengthMilliSeconds());
 	ChartMetadataSetup = MOD(ChartParserModule).GetChartMetadata(SelectedChart);
+	SyncChartOffset();
 
 	SelectedChart->RegisterOnModifiedCallback([this](TimeSlice &InTimeSlice)
 	{
 		//TODO: replicate the timeslice method to optimize when "re-generating"
 		MOD(BeatModule).AssignNotesToSnapsInTimeSlice(SelectedChart, InTimeSlice);
-		MOD(MiniMapModule).GeneratePortion(InTimeSlice, MOD(TimefieldRenderModule).GetSkin());
+		MOD(MiniMapModule).GeneratePortion(SelectedChart, InTimeSlice, MOD(TimefieldRenderModule).GetSkin());
+		_ChartLinter.MarkTimeSliceModified(InTimeSlice.Index);
 	});
 }
 
+void Program::SyncChartOffset()
+{
+	//the chart is shifted against the song rather than rewritten, so the audio and waveform are looked up that much later
+	const Time offset = SelectedChart->GetBaseOffset();
+
+	MOD(AudioModule).SetChartOffset(offset);
+	MOD(WaveFormModule).SetChartOffset(offset);
+
+	_ChartLinter.Reset(SelectedChart->ToChartTime(MOD(AudioModule).GetSongLengthMilliSeconds()));
+
+	_LintIssues.clear();
+	_LintIssuesRevision = size_t(-1);
+}
+
 void Program::OpenChart(const std::string& InPath)
 {
     auto charts = MOD(ChartParserModule).ScanForCharts(InPath);
@@ -905,8 +1046,6 @@ void Program::UpdateCursor()
 	EditCursor.HoveredNotes.clear();
 
 	MOD(TimefieldRenderModule).GetOverlappedOnScreenNotes(EditCursor.CursorColumn, EditCursor.Y, EditCursor.HoveredNotes);
-
-	std::sort(EditCursor.HoveredNotes.begin(), EditCursor.HoveredNotes.end(), [](const Note *lhs, const Note *rhs) { return lhs->TimePoint < rhs->TimePoint; });
 }
 
 void Program::SetConfig(const Configuration& InConfig)
@@ -914,5 +1053,6 @@ void Program::SetConfig(const Configuration& InConfig)
 	MOD(AudioModule).UsePitch = Config.UsePitch;
 	MOD(TimefieldRenderModule).GetSkin().ShowColumnLines = Config.ShowColumnLines;
 	EditMode::static_Flags.UseAutoTiming = Config.UseAutoTiming;
+	EditMode::static_Flags.UseTempoRebase = Config.UseTempoRebase;
 	EditMode::static_Flags.ShowColumnHeatmap = Config.ShowColumnHeatmap;
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "../structures/configuration.h"
+#include "../structures/chart-linter.h"
+#include "../structures/strain-rating.h"
 #include "../modules/manager/module-manager.h"
 
 class Program
@@ -21,6 +23,7 @@ public: //abstractions
     void OpenMoveAllNotes();
 	void OpenStreamGenerator();
 	void OpenDifficultyAnalyzer();
+	void OpenLintResults();
     void SnapToPeak();
 	void ScrollShortcutRoutines();
 	void InputActions();
@@ -28,6 +31,7 @@ public: //abstractions
 	void ApplyDeltaToZoom(const float InDelta);
 	void UpdateCursor();
     void InitializeChart(Chart* InChart);
+	void SyncChartOffset();
 	void OpenChart(const std::string& InPath);
 	void SetConfig(const Configuration& InConfig);
 
@@ -57,4 +61,13 @@ private: //meta data ownership
     bool _AssistTickEnabled = false;
     Time _LastTickTime = 0;
     Time _LastAssistTickTime = 0;
+
+    ChartLinter _ChartLinter;
+
+    //the worker replaces issues as it goes, the list is only copied again once it did
+    std::vector<LintIssue> _LintIssues;
+    size_t _LintIssuesRevision = size_t(-1);
+
+    //only what was edited since the last frame is calculated again
+    StrainRating _StrainRating;
 };
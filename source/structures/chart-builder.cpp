@@ -0,0 +1,180 @@
+#include "chart-builder.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "chart.h"
+
+//appends the points timeslice by timeslice, merging them with the points a timeslice already holds
+template<typename T>
+static void MergeIntoTimeSlices(Chart& OutChart, std::vector<T>& InPoints, std::vector<T> TimeSlice::* InMember, std::vector<int>& OutModifiedTimeSlices)
+{
+	auto isEarlier = [](const T& lhs, const T& rhs) { return lhs.TimePoint < rhs.TimePoint; };
+
+	std::stable_sort(InPoints.begin(), InPoints.end(), isEarlier);
+
+	size_t index = 0;
+
+	while(index < InPoints.size())
+	{
+		const int timeSliceIndex = GetTimeSliceIndex(InPoints[index].TimePoint);
+
+		TimeSlice& timeSlice = OutChart.FindOrAddTimeSlice(InPoints[index].TimePoint);
+		OutChart.JournalTimingChange(timeSlice.TimePoint);
+
+		auto& points = timeSlice.*InMember;
+		const size_t formerSize = points.size();
+
+		for (; index < InPoints.size() && GetTimeSliceIndex(InPoints[index].TimePoint) == timeSliceIndex; ++index)
+			points.push_back(InPoints[index]);
+
+		std::inplace_merge(points.begin(), points.begin() + formerSize, points.end(), isEarlier);
+
+		OutModifiedTimeSlices.push_back(timeSliceIndex);
+	}
+}
+
+void ChartBuilder::Reserve(const size_t InNoteAmount)
+{
+	_Notes.reserve(InNoteAmount);
+}
+
+void ChartBuilder::AddNote(const Time InTime, const Column InColumn, const Note::EType InNoteType, const int InBeatSnap, const BeatPosition& InPosition)
+{
+	Note note;
+	note.Type = InNoteType;
+	note.TimePoint = InTime;
+	note.BeatSnap = InBeatSnap;
+	note.Position = InPosition;
+
+	note.TimePointBegin = -1;
+	note.TimePointEnd = -1;
+
+	_Notes.push_back({ InColumn, note });
+}
+
+void ChartBuilder::AddHold(const Time InTimeBegin, const Time InTimeEnd, const Column InColumn, const int InBeatSnapBegin, const int InBeatSnapEnd, const BeatPosition& InPositionBegin, const BeatPosition& InPositionEnd)
+{
+	AddLongNote(InTimeBegin, InTimeEnd, InColumn, Note::EType::HoldBegin, Note::EType::HoldEnd, InBeatSnapBegin, InBeatSnapEnd, InPositionBegin, InPositionEnd);
+}
+
+void ChartBuilder::AddRoll(const Time InTimeBegin, const Time InTimeEnd, const Column InColumn, const int InBeatSnapBegin, const int InBeatSnapEnd, const BeatPosition& InPositionBegin, const BeatPosition& InPositionEnd)
+{
+	AddLongNote(InTimeBegin, InTimeEnd, InColumn, Note::EType::RollBegin, Note::EType::RollEnd, InBeatSnapBegin, InBeatSnapEnd, InPositionBegin, InPositionEnd);
+}
+
+void ChartBuilder::AddBpmPoint(const Time InTime, const double InBpm, const double InBeatLength)
+{
+	BpmPoint bpmPoint;
+	bpmPoint.TimePoint = InTime;
+	bpmPoint.Bpm = InBpm;
+	bpmPoint.BeatLength = InBeatLength;
+
+	_BpmPoints.push_back(bpmPoint);
+}
+
+void ChartBuilder::AddStop(const Time InTime, const double InLength)
+{
+	StopPoint stop;
+	stop.TimePoint = InTime;
+	stop.Length = InLength;
+
+	_Stops.push_back(stop);
+}
+
+void ChartBuilder::AddSV(const Time InTime, const double InMultiplier)
+{
+	ScrollVelocityMultiplier sv;
+	sv.TimePoint = InTime;
+	sv.Multiplier = InMultiplier;
+
+	_SvMultipliers.push_back(sv);
+}
+
+void ChartBuilder::AddTimeSignature(const Time InTime, const int InNumerator, const int InDenominator)
+{
+	TimeSignature timeSignature;
+	timeSignature.TimePoint = InTime;
+	timeSignature.Numerator = InNumerator;
+	timeSignature.Denominator = InDenominator;
+
+	_TimeSignatures.push_back(timeSignature);
+}
+
+size_t ChartBuilder::GetNoteAmount() const
+{
+	return _Notes.size();
+}
+
+bool ChartBuilder::IsEmpty() const
+{
+	return _Notes.empty() && _BpmPoints.empty() && _Stops.empty() && _SvMultipliers.empty() && _TimeSignatures.empty();
+}
+
+void ChartBuilder::Build(Chart& OutChart, const bool InSkipOnModified)
+{
+	std::vector<int> modifiedTimeSlices;
+	modifiedTimeSlices.reserve(_Notes.size());
+
+	for (const auto& [column, note] : _Notes)
+		modifiedTimeSlices.push_back(GetTimeSliceIndex(note.TimePoint));
+
+	//the note store sorts the notes of every column once and merges them in
+	OutChart.Notes.ApplyBatch({}, _Notes);
+
+	//the density is counted in one pass over the notes rather than updated note by note
+	OutChart.JournalNotes(true, _Notes);
+
+	Time earliestTempoChange = std::numeric_limits<Time>::max();
+
+	for (const auto& bpmPoint : _BpmPoints)
+		earliestTempoChange = std::min(earliestTempoChange, bpmPoint.TimePoint);
+
+	for (const auto& stop : _Stops)
+		earliestTempoChange = std::min(earliestTempoChange, stop.TimePoint);
+
+	if(earliestTempoChange != std::numeric_limits<Time>::max())
+		OutChart.InvalidateTempoMap(earliestTempoChange);
+
+	OutChart._BpmPointCounter += int(_BpmPoints.size());
+
+	MergeIntoTimeSlices(OutChart, _BpmPoints, &TimeSlice::BpmPoints, modifiedTimeSlices);
+	MergeIntoTimeSlices(OutChart, _Stops, &TimeSlice::Stops, modifiedTimeSlices);
+	MergeIntoTimeSlices(OutChart, _SvMultipliers, &TimeSlice::SvMultipliers, modifiedTimeSlices);
+	MergeIntoTimeSlices(OutChart, _TimeSignatures, &TimeSlice::TimeSignatures, modifiedTimeSlices);
+
+	OutChart.InvalidateTimingIndices();
+
+	if(!InSkipOnModified)
+	{
+		std::sort(modifiedTimeSlices.begin(), modifiedTimeSlices.end());
+		modifiedTimeSlices.erase(std::unique(modifiedTimeSlices.begin(), modifiedTimeSlices.end()), modifiedTimeSlices.end());
+
+		for (const int index : modifiedTimeSlices)
+			OutChart.NotifyModified(index * TIMESLICE_LENGTH, index * TIMESLICE_LENGTH);
+	}
+
+	*this = ChartBuilder();
+}
+
+void ChartBuilder::AddLongNote(const Time InTimeBegin, const Time InTimeEnd, const Column InColumn, const Note::EType InBeginType, const Note::EType InEndType, const int InBeatSnapBegin, const int InBeatSnapEnd, const BeatPosition& InPositionBegin, const BeatPosition& InPositionEnd)
+{
+	Note note;
+	note.Type = InBeginType;
+	note.TimePoint = InTimeBegin;
+	note.BeatSnap = InBeatSnapBegin;
+	note.Position = InPositionBegin;
+	note.PositionEnd = InPositionEnd;
+
+	note.TimePointBegin = InTimeBegin;
+	note.TimePointEnd = InTimeEnd;
+
+	_Notes.push_back({ InColumn, note });
+
+	note.Type = InEndType;
+	note.TimePoint = InTimeEnd;
+	note.BeatSnap = InBeatSnapEnd;
+	note.Position = InPositionEnd;
+
+	_Notes.push_back({ InColumn, note });
+}
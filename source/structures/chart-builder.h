@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+
+#include "chart-types.h"
+
+struct Chart;
+
+/*
+* collects the notes and timing points of a chart in whatever order they come in, be it from a parser or the clipboard.
+* nothing is sorted while collecting. Build sorts every column and every kind of timing point once and merges the result
+* into the chart column by column and timeslice by timeslice, instead of searching and shifting for every single object.
+* the changes are journaled into the chart's open transaction if there is one, a chart being loaded has none.
+*/
+class ChartBuilder
+{
+public:
+
+	void Reserve(const size_t InNoteAmount);
+
+	void AddNote(const Time InTime, const Column InColumn, const Note::EType InNoteType, const int InBeatSnap = -1, const BeatPosition& InPosition = BeatPosition());
+	void AddHold(const Time InTimeBegin, const Time InTimeEnd, const Column InColumn, const int InBeatSnapBegin = -1, const int InBeatSnapEnd = -1, const BeatPosition& InPositionBegin = BeatPosition(), const BeatPosition& InPositionEnd = BeatPosition());
+	void AddRoll(const Time InTimeBegin, const Time InTimeEnd, const Column InColumn, const int InBeatSnapBegin = -1, const int InBeatSnapEnd = -1, const BeatPosition& InPositionBegin = BeatPosition(), const BeatPosition& InPositionEnd = BeatPosition());
+
+	void AddBpmPoint(const Time InTime, const double InBpm, const double InBeatLength);
+	void AddStop(const Time InTime, const double InLength);
+	void AddSV(const Time InTime, const double InMultiplier);
+	void AddTimeSignature(const Time InTime, const int InNumerator, const int InDenominator);
+
+	size_t GetNoteAmount() const;
+	bool IsEmpty() const;
+
+	//hands everything collected over to the chart and leaves the builder empty
+	void Build(Chart& OutChart, const bool InSkipOnModified = false);
+
+private:
+
+	void AddLongNote(const Time InTimeBegin, const Time InTimeEnd, const Column InColumn, const Note::EType InBeginType, const Note::EType InEndType, const int InBeatSnapBegin, const int InBeatSnapEnd, const BeatPosition& InPositionBegin, const BeatPosition& InPositionEnd);
+
+	std::vector<std::pair<Column, Note>> _Notes;
+
+	std::vector<BpmPoint> _BpmPoints;
+	std::vector<StopPoint> _Stops;
+	std::vector<ScrollVelocityMultiplier> _SvMultipliers;
+	std::vector<TimeSignature> _TimeSignatures;
+};
@@ -0,0 +1,388 @@
+#include "chart-linter.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "chart-snapshot.h"
+
+static bool IsHoldBegin(const Note::EType InType)
+{
+	return InType == Note::EType::HoldBegin || InType == Note::EType::RollBegin;
+}
+
+static bool IsHoldEnd(const Note::EType InType)
+{
+	return InType == Note::EType::HoldEnd || InType == Note::EType::RollEnd;
+}
+
+//mines and fakes are never hit, so they take no part in jacks and stacks
+static bool IsHitNote(const Note::EType InType)
+{
+	return InType == Note::EType::Common || InType == Note::EType::Lift || IsHoldBegin(InType);
+}
+
+static double GetFirstBpmTimePoint(const ChartSnapshot& InSnapshot)
+{
+	const TempoMap& tempoMap = InSnapshot.GetTempoMap();
+
+	return tempoMap.IsEmpty() ? std::numeric_limits<double>::max() : tempoMap.GetTimeFromBeat(0.0);
+}
+
+ChartLinter::ChartLinter()
+{
+	_Worker = std::thread(&ChartLinter::Work, this);
+}
+
+ChartLinter::~ChartLinter()
+{
+	{
+		std::lock_guard<std::mutex> lock(_Mutex);
+		_IsStopping = true;
+	}
+
+	_Condition.notify_one();
+	_Worker.join();
+}
+
+void ChartLinter::Reset(const Time InSongLength)
+{
+	std::lock_guard<std::mutex> lock(_Mutex);
+
+	_Issues.clear();
+	_Revision++;
+	_ResetCount++;
+
+	_SongLength = InSongLength;
+	_PendingSnapshot.reset();
+	_PendingTimeSlices.clear();
+
+	_ModifiedTimeSlices.clear();
+	_IsFullCheckDue = true;
+}
+
+void ChartLinter::SetMinJackInterval(const Time InInterval)
+{
+	std::lock_guard<std::mutex> lock(_Mutex);
+
+	if (_MinJackInterval == InInterval)
+		return;
+
+	_MinJackInterval = InInterval;
+	_IsFullCheckDue = true;
+}
+
+void ChartLinter::MarkTimeSliceModified(const int InTimeSliceIndex)
+{
+	_ModifiedTimeSlices.insert(InTimeSliceIndex);
+}
+
+bool ChartLinter::IsWaitingForSnapshot() const
+{
+	return _IsFullCheckDue || !_ModifiedTimeSlices.empty();
+}
+
+void ChartLinter::Submit(std::shared_ptr<const ChartSnapshot> InSnapshot)
+{
+	{
+		std::lock_guard<std::mutex> lock(_Mutex);
+
+		//a check not picked up yet is simply folded into this one
+		_PendingSnapshot = std::move(InSnapshot);
+		_PendingTimeSlices.insert(_ModifiedTimeSlices.begin(), _ModifiedTimeSlices.end());
+		_IsFullCheckPending |= _IsFullCheckDue;
+	}
+
+	_ModifiedTimeSlices.clear();
+	_IsFullCheckDue = false;
+
+	_Condition.notify_one();
+}
+
+void ChartLinter::Wait()
+{
+	std::unique_lock<std::mutex> lock(_Mutex);
+	_IdleCondition.wait(lock, [this]() { return !_IsWorking && !_PendingSnapshot; });
+}
+
+std::vector<LintIssue> ChartLinter::GetIssues() const
+{
+	std::lock_guard<std::mutex> lock(_Mutex);
+
+	std::vector<LintIssue> issues;
+
+	for (const auto& [index, timeSliceIssues] : _Issues)
+		issues.insert(issues.end(), timeSliceIssues.begin(), timeSliceIssues.end());
+
+	return issues;
+}
+
+size_t ChartLinter::GetRevision() const
+{
+	std::lock_guard<std::mutex> lock(_Mutex);
+
+	return _Revision;
+}
+
+const char* ChartLinter::GetLintName(const ELintType InType)
+{
+	switch (InType)
+	{
+	case ELintType::StackedNote: return "Stacked note";
+	case ELintType::OverlappingHold: return "Hold overlapping a note";
+	case ELintType::ZeroLengthHold: return "Zero length hold";
+	case ELintType::BeforeFirstBpmPoint: return "Note before the first bpm point";
+	case ELintType::UnsnappedNote: return "Unsnapped note";
+	case ELintType::ImpossibleJack: return "Impossible jack";
+	case ELintType::PastSongEnd: return "Note past the end of the song";
+	default: return "";
+	}
+}
+
+void ChartLinter::Work()
+{
+	while (true)
+	{
+		std::shared_ptr<const ChartSnapshot> snapshot;
+		std::set<int> timeSliceIndices;
+		bool isFullCheck = false;
+		size_t resetCount = 0;
+
+		{
+			std::unique_lock<std::mutex> lock(_Mutex);
+			_Condition.wait(lock, [this]() { return _IsStopping || _PendingSnapshot; });
+
+			if (_IsStopping)
+				return;
+
+			snapshot = std::move(_PendingSnapshot);
+			_PendingSnapshot.reset();
+
+			timeSliceIndices.swap(_PendingTimeSlices);
+			isFullCheck = _IsFullCheckPending;
+			_IsFullCheckPending = false;
+
+			resetCount = _ResetCount;
+			_CheckSongLength = _SongLength;
+			_CheckMinJackInterval = _MinJackInterval;
+
+			_IsWorking = true;
+		}
+
+		//every note is checked against the first bpm point, moving it concerns all of them
+		const double firstBpmTimePoint = GetFirstBpmTimePoint(*snapshot);
+		isFullCheck |= !_CheckedSnapshot || firstBpmTimePoint != _CheckedFirstBpmTimePoint;
+
+		CheckResult result;
+		CheckTimeSlices(*snapshot, timeSliceIndices, isFullCheck, result);
+
+		_CheckedSnapshot = snapshot;
+		_CheckedFirstBpmTimePoint = firstBpmTimePoint;
+
+		{
+			std::lock_guard<std::mutex> lock(_Mutex);
+
+			if (resetCount == _ResetCount)
+			{
+				if (isFullCheck)
+					_Issues.clear();
+
+				for (const auto& [indexBegin, indexEnd] : result.TimeSliceRanges)
+					_Issues.erase(_Issues.lower_bound(indexBegin), _Issues.lower_bound(indexEnd));
+
+				for (auto& [index, issues] : result.Issues)
+					_Issues[index] = std::move(issues);
+
+				_Revision++;
+			}
+			else
+			{
+				_CheckedSnapshot.reset();
+			}
+
+			_IsWorking = false;
+		}
+
+		_IdleCondition.notify_all();
+	}
+}
+
+void ChartLinter::CheckTimeSlices(const ChartSnapshot& InSnapshot, const std::set<int>& InTimeSliceIndices, const bool InIsFullCheck, CheckResult& OutResult) const
+{
+	const auto& chunks = InSnapshot.GetNoteChunks();
+
+	//the snapshot goes through the columns one by one within a chunk
+	auto sortIssues = [&OutResult]()
+	{
+		for (auto& [index, issues] : OutResult.Issues)
+			std::stable_sort(issues.begin(), issues.end(), [](const LintIssue& InLhs, const LintIssue& InRhs) { return InLhs.TimePoint < InRhs.TimePoint; });
+	};
+
+	if (InIsFullCheck)
+	{
+		if (!chunks.empty())
+			CheckTimeRange(InSnapshot, chunks.begin()->first * SNAPSHOT_CHUNK_LENGTH, (chunks.rbegin()->first + 1) * SNAPSHOT_CHUNK_LENGTH, OutResult.Issues);
+
+		return sortIssues();
+	}
+
+	//neighbouring timeslices are checked in one go
+	std::vector<std::pair<int, int>> ranges;
+
+	for (const int index : InTimeSliceIndices)
+	{
+		if (!ranges.empty() && ranges.back().second == index)
+			ranges.back().second++;
+		else
+			ranges.emplace_back(index, index + 1);
+	}
+
+	//a hold reaches over the notes up to its end, whether it was just placed or just removed, and a note can make a jack with the first note after it
+	for (auto& [indexBegin, indexEnd] : ranges)
+	{
+		const Time timeBegin = indexBegin * TIMESLICE_LENGTH;
+		const Time timeEnd = indexEnd * TIMESLICE_LENGTH;
+
+		Time latestTime = std::max(GetLatestHoldEnd(&InSnapshot, timeBegin, timeEnd), GetLatestHoldEnd(_CheckedSnapshot.get(), timeBegin, timeEnd));
+		latestTime = std::max(latestTime, timeEnd - 1) + _CheckMinJackInterval;
+
+		indexEnd = GetTimeSliceIndex(latestTime) + 1;
+	}
+
+	for (const auto& range : ranges)
+	{
+		if (!OutResult.TimeSliceRanges.empty() && OutResult.TimeSliceRanges.back().second >= range.first)
+			OutResult.TimeSliceRanges.back().second = std::max(OutResult.TimeSliceRanges.back().second, range.second);
+		else
+			OutResult.TimeSliceRanges.push_back(range);
+	}
+
+	for (const auto& [indexBegin, indexEnd] : OutResult.TimeSliceRanges)
+		CheckTimeRange(InSnapshot, indexBegin * TIMESLICE_LENGTH, indexEnd * TIMESLICE_LENGTH, OutResult.Issues);
+
+	sortIssues();
+}
+
+void ChartLinter::CheckTimeRange(const ChartSnapshot& InSnapshot, const Time InTimeBegin, const Time InTimeEnd, std::map<int, std::vector<LintIssue>>& OutIssues) const
+{
+	const size_t columnAmount = size_t(std::max(InSnapshot.GetKeyAmount(), 0));
+	const double firstBpmTimePoint = GetFirstBpmTimePoint(InSnapshot);
+	const auto& chunks = InSnapshot.GetNoteChunks();
+
+	std::vector<Time> previousTimePoints(columnAmount, std::numeric_limits<Time>::min());
+	std::vector<Time> holdBeginTimePoints(columnAmount, 0);
+	std::vector<Time> holdEndTimePoints(columnAmount, std::numeric_limits<Time>::min());
+
+	//the last note right before the range can still form a jack with the first one within
+	InSnapshot.IterateNotesInTimeRange(InTimeBegin - _CheckMinJackInterval, InTimeBegin - 1, [&previousTimePoints](const Note& InNote, const Column InColumn)
+	{
+		if (InColumn < previousTimePoints.size() && IsHitNote(InNote.Type))
+			previousTimePoints[InColumn] = InNote.TimePoint;
+	});
+
+	//a hold reaching into the range from before has its end within the range or after it, whichever hold note comes first tells.
+	//no hold ends further on than the longest one, a column without a hold note up to there has none reaching into the range
+	std::vector<bool> isHoldResolved(columnAmount, false);
+	size_t resolvedAmount = 0;
+
+	auto chunkIt = chunks.lower_bound(GetSnapshotChunkIndex(InTimeBegin));
+	const auto chunkEndIt = chunks.upper_bound(GetSnapshotChunkIndex(InTimeBegin + InSnapshot.GetLongestHoldLength()));
+
+	for (; chunkIt != chunkEndIt && resolvedAmount < columnAmount; ++chunkIt)
+	{
+		const auto& columns = chunkIt->second->Columns;
+
+		for (Column column = 0; column < std::min(columns.size(), columnAmount); ++column)
+		{
+			if (isHoldResolved[column])
+				continue;
+
+			const auto& notes = columns[column];
+			auto noteIt = std::lower_bound(notes.begin(), notes.end(), InTimeBegin, [](const Note& InNote, const Time InTime) { return InNote.TimePoint < InTime; });
+
+			for (; noteIt != notes.end(); ++noteIt)
+			{
+				if (!IsHoldBegin(noteIt->Type) && !IsHoldEnd(noteIt->Type))
+					continue;
+
+				if (IsHoldEnd(noteIt->Type) && noteIt->TimePointBegin < InTimeBegin)
+				{
+					holdBeginTimePoints[column] = noteIt->TimePointBegin;
+					holdEndTimePoints[column] = noteIt->TimePoint;
+				}
+
+				isHoldResolved[column] = true;
+				resolvedAmount++;
+				break;
+			}
+		}
+	}
+
+	auto addIssue = [&OutIssues](const Time InTimePoint, const Column InColumn, const ELintType InType)
+	{
+		OutIssues[GetTimeSliceIndex(InTimePoint)].push_back({ InTimePoint, InColumn, InType });
+	};
+
+	InSnapshot.IterateNotesInTimeRange(InTimeBegin, InTimeEnd - 1, [&](const Note& InNote, const Column InColumn)
+	{
+		if (InColumn >= columnAmount)
+			return;
+
+		if (double(InNote.TimePoint) < firstBpmTimePoint)
+			addIssue(InNote.TimePoint, InColumn, ELintType::BeforeFirstBpmPoint);
+
+		if (InNote.BeatSnap == -1)
+			addIssue(InNote.TimePoint, InColumn, ELintType::UnsnappedNote);
+
+		if (_CheckSongLength > 0 && InNote.TimePoint > _CheckSongLength)
+			addIssue(InNote.TimePoint, InColumn, ELintType::PastSongEnd);
+
+		if (!IsHitNote(InNote.Type))
+			return;
+
+		//a hold may begin right on the end of the one before it, like the editor lets it
+		const bool isFollowingHold = IsHoldBegin(InNote.Type) && InNote.TimePoint == holdEndTimePoints[InColumn];
+
+		if (!isFollowingHold && InNote.TimePoint > holdBeginTimePoints[InColumn] && InNote.TimePoint <= holdEndTimePoints[InColumn])
+			addIssue(InNote.TimePoint, InColumn, ELintType::OverlappingHold);
+
+		if (previousTimePoints[InColumn] != std::numeric_limits<Time>::min())
+		{
+			const Time interval = InNote.TimePoint - previousTimePoints[InColumn];
+
+			if (interval < LINT_STACK_TOLERANCE)
+				addIssue(InNote.TimePoint, InColumn, ELintType::StackedNote);
+			else if (interval < _CheckMinJackInterval)
+				addIssue(InNote.TimePoint, InColumn, ELintType::ImpossibleJack);
+		}
+
+		previousTimePoints[InColumn] = InNote.TimePoint;
+
+		if (!IsHoldBegin(InNote.Type))
+			return;
+
+		if (InNote.TimePointEnd <= InNote.TimePoint)
+		{
+			addIssue(InNote.TimePoint, InColumn, ELintType::ZeroLengthHold);
+			return;
+		}
+
+		holdBeginTimePoints[InColumn] = InNote.TimePoint;
+		holdEndTimePoints[InColumn] = InNote.TimePointEnd;
+	});
+}
+
+Time ChartLinter::GetLatestHoldEnd(const ChartSnapshot* InSnapshot, const Time InTimeBegin, const Time InTimeEnd) const
+{
+	Time latestTime = std::numeric_limits<Time>::min();
+
+	if (!InSnapshot)
+		return latestTime;
+
+	InSnapshot->IterateNotesInTimeRange(InTimeBegin, InTimeEnd - 1, [&latestTime](const Note& InNote, const Column)
+	{
+		if (IsHoldBegin(InNote.Type))
+			latestTime = std::max(latestTime, InNote.TimePointEnd);
+	});
+
+	return latestTime;
+}
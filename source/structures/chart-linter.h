@@ -0,0 +1,121 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+
+#include "chart-types.h"
+
+class ChartSnapshot;
+
+//notes of one column closer than this are stacked on top of each other, up to the jack interval they are an impossible jack
+#define LINT_STACK_TOLERANCE 2
+#define DEFAULT_LINT_MIN_JACK_INTERVAL 30
+
+enum class ELintType
+{
+	StackedNote,
+	OverlappingHold,
+	ZeroLengthHold,
+	BeforeFirstBpmPoint,
+	UnsnappedNote,
+	ImpossibleJack,
+	PastSongEnd,
+
+	COUNT
+};
+
+struct LintIssue
+{
+	Time TimePoint = 0;
+	Column NoteColumn = 0;
+
+	ELintType Type = ELintType::StackedNote;
+};
+
+/*
+* checks a chart for mistakes on a worker thread. the timeslices reported as modified are collected on the main thread
+* and handed over together with a snapshot of the chart, the worker checks just those timeslices again and replaces their issues.
+* a timeslice also takes its neighbours along when a hold or a jack reaches into them, and anything every note depends on,
+* like the first bpm point or the length of the song, has the whole chart checked again.
+*/
+class ChartLinter
+{
+public:
+
+	ChartLinter();
+	~ChartLinter();
+
+	ChartLinter(const ChartLinter&) = delete;
+	ChartLinter& operator=(const ChartLinter&) = delete;
+
+	//throws away all issues, the next snapshot submitted is checked as a whole
+	void Reset(const Time InSongLength);
+	void SetMinJackInterval(const Time InInterval);
+
+	void MarkTimeSliceModified(const int InTimeSliceIndex);
+
+	bool IsWaitingForSnapshot() const;
+	void Submit(std::shared_ptr<const ChartSnapshot> InSnapshot);
+
+	//blocks until the worker is through with everything submitted so far
+	void Wait();
+
+	//sorted by timepoint
+	std::vector<LintIssue> GetIssues() const;
+	size_t GetRevision() const;
+
+	static const char* GetLintName(const ELintType InType);
+
+private:
+
+	void Work();
+
+	//the timeslices checked within [first, second), along with the issues found in them
+	struct CheckResult
+	{
+		std::vector<std::pair<int, int>> TimeSliceRanges;
+		std::map<int, std::vector<LintIssue>> Issues;
+	};
+
+	void CheckTimeSlices(const ChartSnapshot& InSnapshot, const std::set<int>& InTimeSliceIndices, const bool InIsFullCheck, CheckResult& OutResult) const;
+	void CheckTimeRange(const ChartSnapshot& InSnapshot, const Time InTimeBegin, const Time InTimeEnd, std::map<int, std::vector<LintIssue>>& OutIssues) const;
+
+	Time GetLatestHoldEnd(const ChartSnapshot* InSnapshot, const Time InTimeBegin, const Time InTimeEnd) const;
+
+	//main thread only
+	std::set<int> _ModifiedTimeSlices;
+	bool _IsFullCheckDue = true;
+
+	mutable std::mutex _Mutex;
+	std::condition_variable _Condition;
+	std::condition_variable _IdleCondition;
+
+	//guarded by the mutex
+	std::shared_ptr<const ChartSnapshot> _PendingSnapshot;
+	std::set<int> _PendingTimeSlices;
+	bool _IsFullCheckPending = false;
+	bool _IsWorking = false;
+	bool _IsStopping = false;
+
+	Time _SongLength = 0;
+	Time _MinJackInterval = DEFAULT_LINT_MIN_JACK_INTERVAL;
+
+	std::map<int, std::vector<LintIssue>> _Issues;
+	size_t _Revision = 0;
+
+	//results of a check still running while the linter is reset are dropped
+	size_t _ResetCount = 0;
+
+	//worker thread only, the song length and jack interval are copied over for every check
+	std::shared_ptr<const ChartSnapshot> _CheckedSnapshot;
+	double _CheckedFirstBpmTimePoint = 0.0;
+	Time _CheckSongLength = 0;
+	Time _CheckMinJackInterval = DEFAULT_LINT_MIN_JACK_INTERVAL;
+
+	std::thread _Worker;
+};
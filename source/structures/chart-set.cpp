@@ -0,0 +1,127 @@
+#include "chart-set.h"
+
+#include "chart.h"
+#include "chart-builder.h"
+
+int ChartSet::FindDifficulty(const std::string& InDifficultyName) const
+{
+	for (int index = 0; index < int(Difficulties.size()); ++index)
+	{
+		const auto& difficulty = Difficulties[index];
+
+		if (InDifficultyName.empty() ? difficulty.ChartType.find("dance-single") != std::string::npos : difficulty.DifficultyName == InDifficultyName)
+			return index;
+	}
+
+	return -1;
+}
+
+Chart* ChartSet::CreateChart(const int InDifficultyIndex) const
+{
+	Chart* chart = new Chart();
+
+	chart->ArtistUnicode = Metadata.ArtistUnicode;
+	chart->Artist = Metadata.Artist;
+	chart->SongtitleUnicode = Metadata.SongtitleUnicode;
+	chart->SongTitle = Metadata.SongTitle;
+	chart->Charter = Metadata.Charter;
+	chart->AudioPath = Metadata.AudioPath;
+	chart->BackgroundPath = Metadata.BackgroundPath;
+	chart->SmBgChanges = Metadata.SmBgChanges;
+	chart->SmFgChanges = Metadata.SmFgChanges;
+	chart->KeyAmount = 4;
+	chart->BaseOffset = Timing.BaseOffset;
+
+	ChartBuilder builder;
+
+	for (const auto& bpmPoint : Timing.BpmPoints)
+		builder.AddBpmPoint(bpmPoint.TimePoint, bpmPoint.Bpm, bpmPoint.BeatLength);
+
+	for (const auto& stop : Timing.Stops)
+		builder.AddStop(stop.TimePoint, stop.Length);
+
+	for (const auto& sv : Timing.SvMultipliers)
+		builder.AddSV(sv.TimePoint, sv.Multiplier);
+
+	for (const auto& timeSignature : Timing.TimeSignatures)
+		builder.AddTimeSignature(timeSignature.TimePoint, timeSignature.Numerator, timeSignature.Denominator);
+
+	if (InDifficultyIndex >= 0 && InDifficultyIndex < int(Difficulties.size()))
+	{
+		const auto& difficulty = Difficulties[InDifficultyIndex];
+
+		chart->DifficultyName = difficulty.DifficultyName;
+		chart->KeyAmount = difficulty.KeyAmount;
+
+		if (!difficulty.Charter.empty())
+			chart->Charter = difficulty.Charter;
+
+		builder.Reserve(difficulty.Notes.size());
+
+		for (const auto& [column, note] : difficulty.Notes)
+		{
+			switch (note.Type)
+			{
+			case Note::EType::HoldBegin:
+				builder.AddHold(note.TimePoint, note.TimePointEnd, column, note.BeatSnap, -1, note.Position, note.PositionEnd);
+				break;
+			case Note::EType::RollBegin:
+				builder.AddRoll(note.TimePoint, note.TimePointEnd, column, note.BeatSnap, -1, note.Position, note.PositionEnd);
+				break;
+			default:
+				builder.AddNote(note.TimePoint, column, note.Type, note.BeatSnap, note.Position);
+				break;
+			}
+		}
+	}
+
+	builder.Build(*chart);
+
+	return chart;
+}
+
+void ChartSet::StoreChart(const int InDifficultyIndex, Chart& InChart)
+{
+	if (InDifficultyIndex < 0 || InDifficultyIndex >= int(Difficulties.size()))
+		return;
+
+	Metadata.ArtistUnicode = InChart.ArtistUnicode;
+	Metadata.Artist = InChart.Artist;
+	Metadata.SongtitleUnicode = InChart.SongtitleUnicode;
+	Metadata.SongTitle = InChart.SongTitle;
+	Metadata.AudioPath = InChart.AudioPath;
+	Metadata.BackgroundPath = InChart.BackgroundPath;
+	Metadata.SmBgChanges = InChart.SmBgChanges;
+	Metadata.SmFgChanges = InChart.SmFgChanges;
+
+	//the credit of the file stays with the file, the charter of a difficulty is its own
+	if (Metadata.Charter.empty())
+		Metadata.Charter = InChart.Charter;
+
+	Timing = ChartSetTiming();
+	Timing.BaseOffset = InChart.BaseOffset;
+
+	InChart.IterateAllBpmPoints([this](BpmPoint& InBpmPoint) { Timing.BpmPoints.push_back(InBpmPoint); });
+	InChart.IterateAllStops([this](StopPoint& InStop) { Timing.Stops.push_back(InStop); });
+	InChart.IterateAllSVs([this](ScrollVelocityMultiplier& InSV) { Timing.SvMultipliers.push_back(InSV); });
+	InChart.IterateAllTimeSignatures([this](TimeSignature& InTimeSignature) { Timing.TimeSignatures.push_back(InTimeSignature); });
+
+	auto& difficulty = Difficulties[InDifficultyIndex];
+
+	difficulty.DifficultyName = InChart.DifficultyName;
+	difficulty.Charter = InChart.Charter;
+	difficulty.KeyAmount = InChart.KeyAmount;
+	difficulty.Notes.clear();
+	difficulty.Notes.reserve(InChart.Notes.GetNoteAmount());
+
+	InChart.IterateAllNotes([&difficulty](Note& InNote, const Column InColumn)
+	{
+		if (InNote.Type == Note::EType::HoldEnd || InNote.Type == Note::EType::RollEnd)
+			return;
+
+		Note note = InNote;
+		note.Handle = NoteHandle();
+
+		difficulty.Notes.push_back({ InColumn, note });
+	});
+}
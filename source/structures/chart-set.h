@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <filesystem>
+
+#include "chart-types.h"
+
+struct Chart;
+
+struct ChartSetMetadata
+{
+	std::string ArtistUnicode;
+	std::string Artist;
+
+	std::string SongtitleUnicode;
+	std::string SongTitle;
+
+	std::string Charter;
+
+	std::filesystem::path AudioPath;
+	std::filesystem::path BackgroundPath;
+
+	std::string SmBgChanges;
+	std::string SmFgChanges;
+};
+
+struct ChartSetTiming
+{
+	std::vector<BpmPoint> BpmPoints;
+	std::vector<StopPoint> Stops;
+	std::vector<ScrollVelocityMultiplier> SvMultipliers;
+	std::vector<TimeSignature> TimeSignatures;
+
+	//the base offset of the charts, baked into the offset of the file on export
+	double BaseOffset = 0.0;
+};
+
+struct ChartSetDifficulty
+{
+	std::string ChartType = "dance-single";
+	std::string Charter;
+	std::string DifficultyName;
+	std::string Meter = "8";
+	std::string RadarValues = "0.000,0.000,0.000,0.000,0.000";
+
+	int KeyAmount = 4;
+
+	//holds and rolls are kept as their begin only, it carries the timepoint of the end
+	std::vector<std::pair<Column, Note>> Notes;
+};
+
+/*
+* every difficulty of a stepmania file. the metadata and timing are the same for all of them, so they are held once
+* and only the notes are kept per difficulty. a chart is put together from these whenever a difficulty is opened
+* and stored back into the set before the whole set is exported again.
+*/
+class ChartSet
+{
+public:
+
+	//-1 if there is no difficulty by that name, an empty name finds the first dance-single difficulty
+	int FindDifficulty(const std::string& InDifficultyName) const;
+
+	//an index out of range gives a chart holding the metadata and timing only
+	Chart* CreateChart(const int InDifficultyIndex) const;
+
+	//the timing and metadata of the chart become the ones of every difficulty
+	void StoreChart(const int InDifficultyIndex, Chart& InChart);
+
+	ChartSetMetadata Metadata;
+	ChartSetTiming Timing;
+
+	std::vector<ChartSetDifficulty> Difficulties;
+};
@@ -0,0 +1,83 @@
+#include "chart-snapshot.h"
+
+#include <algorithm>
+
+#include "chart.h"
+
+ChartSnapshot::ChartSnapshot(std::shared_ptr<const NoteChunkMap> InNoteChunks, std::shared_ptr<const TimeSliceMap> InTimeSlices, std::shared_ptr<const TempoMap> InTempoMap, const size_t InNoteAmount, const int InKeyAmount)
+	: _NoteChunks(std::move(InNoteChunks))
+	, _TimeSlices(std::move(InTimeSlices))
+	, _TempoMap(std::move(InTempoMap))
+	, _NoteAmount(InNoteAmount)
+	, _KeyAmount(InKeyAmount)
+{
+	for (const auto& [index, chunk] : *_NoteChunks)
+		_LongestHoldLength = std::max(_LongestHoldLength, chunk->LongestHoldLength);
+}
+
+void ChartSnapshot::IterateNotesInTimeRange(const Time InTimeBegin, const Time InTimeEnd, std::function<void(const Note&, const Column)> InWork) const
+{
+	auto chunkIt = _NoteChunks->lower_bound(GetSnapshotChunkIndex(InTimeBegin));
+	auto chunkEndIt = _NoteChunks->upper_bound(GetSnapshotChunkIndex(InTimeEnd));
+
+	for (; chunkIt != chunkEndIt; ++chunkIt)
+	{
+		const auto& columns = chunkIt->second->Columns;
+
+		for (Column column = 0; column < columns.size(); ++column)
+		{
+			const auto& notes = columns[column];
+
+			auto noteIt = std::lower_bound(notes.begin(), notes.end(), InTimeBegin, [](const Note& InNote, const Time InTime) { return InNote.TimePoint < InTime; });
+
+			for (; noteIt != notes.end() && noteIt->TimePoint <= InTimeEnd; ++noteIt)
+				InWork(*noteIt, column);
+		}
+	}
+}
+
+void ChartSnapshot::IterateAllNotes(std::function<void(const Note&, const Column)> InWork) const
+{
+	for (const auto& [index, chunk] : *_NoteChunks)
+		for (Column column = 0; column < chunk->Columns.size(); ++column)
+			for (const auto& note : chunk->Columns[column])
+				InWork(note, column);
+}
+
+void ChartSnapshot::IterateAllTimeSlices(std::function<void(const TimeSlice&)> InWork) const
+{
+	for (const auto& [index, timeSlice] : *_TimeSlices)
+		InWork(*timeSlice);
+}
+
+const SnapshotNoteChunk* ChartSnapshot::GetNoteChunk(const int InChunkIndex) const
+{
+	const auto chunkIt = _NoteChunks->find(InChunkIndex);
+
+	return chunkIt == _NoteChunks->end() ? nullptr : chunkIt->second.get();
+}
+
+const ChartSnapshot::NoteChunkMap& ChartSnapshot::GetNoteChunks() const
+{
+	return *_NoteChunks;
+}
+
+Time ChartSnapshot::GetLongestHoldLength() const
+{
+	return _LongestHoldLength;
+}
+
+const TempoMap& ChartSnapshot::GetTempoMap() const
+{
+	return *_TempoMap;
+}
+
+size_t ChartSnapshot::GetNoteAmount() const
+{
+	return _NoteAmount;
+}
+
+int ChartSnapshot::GetKeyAmount() const
+{
+	return _KeyAmount;
+}
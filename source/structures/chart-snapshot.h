@@ -0,0 +1,72 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <vector>
+#include <functional>
+
+#include "chart-types.h"
+#include "tempo-map.h"
+
+struct TimeSlice;
+
+//notes are shared between snapshots in chunks of this many milliseconds, timing points per timeslice
+#define SNAPSHOT_CHUNK_LENGTH (TIMESLICE_LENGTH * 8)
+
+//floored like the timeslice index, so negative time ends up in its own chunks
+inline int GetSnapshotChunkIndex(const Time InTime)
+{
+	return InTime >= 0 ? InTime / SNAPSHOT_CHUNK_LENGTH : -((SNAPSHOT_CHUNK_LENGTH - 1 - InTime) / SNAPSHOT_CHUNK_LENGTH);
+}
+
+struct SnapshotNoteChunk
+{
+	//sorted by timepoint like the note store, one array per column
+	std::vector<std::vector<Note>> Columns;
+
+	//of the holds and rolls beginning within the chunk
+	Time LongestHoldLength = 0;
+};
+
+/*
+* an immutable view of a chart at the time it was taken, meant to be read from other threads while the chart is edited.
+* the chunks and timeslices are shared with the chart's snapshot cache and every other snapshot taken in the meantime,
+* so taking one only copies what changed since the last one. none of it is ever written to once it is shared.
+*/
+class ChartSnapshot
+{
+public:
+
+	using NoteChunkMap = std::map<int, std::shared_ptr<const SnapshotNoteChunk>>;
+	using TimeSliceMap = std::map<int, std::shared_ptr<const TimeSlice>>;
+
+	ChartSnapshot(std::shared_ptr<const NoteChunkMap> InNoteChunks, std::shared_ptr<const TimeSliceMap> InTimeSlices, std::shared_ptr<const TempoMap> InTempoMap, const size_t InNoteAmount, const int InKeyAmount);
+
+	//column by column within every chunk, so across chunks the notes come in chronological order
+	void IterateNotesInTimeRange(const Time InTimeBegin, const Time InTimeEnd, std::function<void(const Note&, const Column)> InWork) const;
+	void IterateAllNotes(std::function<void(const Note&, const Column)> InWork) const;
+	void IterateAllTimeSlices(std::function<void(const TimeSlice&)> InWork) const;
+
+	//nullptr if the chunk holds no notes
+	const SnapshotNoteChunk* GetNoteChunk(const int InChunkIndex) const;
+
+	//chunks equal by pointer to those of an earlier snapshot hold the same notes
+	const NoteChunkMap& GetNoteChunks() const;
+
+	//no hold or roll reaches further than this past its begin, so a lookup for one reaching over a timepoint can stop there
+	Time GetLongestHoldLength() const;
+
+	const TempoMap& GetTempoMap() const;
+	size_t GetNoteAmount() const;
+	int GetKeyAmount() const;
+
+private:
+
+	std::shared_ptr<const NoteChunkMap> _NoteChunks;
+	std::shared_ptr<const TimeSliceMap> _TimeSlices;
+	std::shared_ptr<const TempoMap> _TempoMap;
+
+	Time _LongestHoldLength = 0;
+	size_t _NoteAmount = 0;
+	int _KeyAmount = 0;
+};
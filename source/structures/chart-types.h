@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+
+/*
+* these types should not have any dependencies on any systems or modules.
+* the chart should almost be treated as a datastructure, since its only handling its own data.
+* worth to note is that this datastructure makes assumptions in which type certain metrics are.
+*/
+
+#define TIMESLICE_LENGTH 500
+
+typedef int Time;
+typedef size_t Column;
+
+//floored, so a timeslice always covers [TimePoint, TimePoint + TIMESLICE_LENGTH), negative time included
+inline int GetTimeSliceIndex(const Time InTime)
+{
+	return InTime >= 0 ? InTime / TIMESLICE_LENGTH : -((TIMESLICE_LENGTH - 1 - InTime) / TIMESLICE_LENGTH);
+}
+
+/*
+* refers to a note by the slot the note store issued for it. the generation increases whenever the slot is freed,
+* so a handle outliving its note is told apart from one of a note taking over the slot later.
+*/
+struct NoteHandle
+{
+	unsigned int Slot = 0;
+	unsigned int Generation = 0;
+
+	bool IsValid() const
+	{
+		return Generation != 0;
+	}
+
+	bool operator==(const NoteHandle& InOther) const
+	{
+		return Slot == InOther.Slot && Generation == InOther.Generation;
+	}
+
+	bool operator!=(const NoteHandle& InOther) const
+	{
+		return !(*this == InOther);
+	}
+};
+
+struct NoteHandleHash
+{
+	size_t operator()(const NoteHandle& InHandle) const
+	{
+		return std::hash<unsigned long long>()((static_cast<unsigned long long>(InHandle.Generation) << 32) | InHandle.Slot);
+	}
+};
+
+/*
+* an exact position on the beat grid, counted in whole beats from the first bpm point. measures are left to the time signatures,
+* so a position stays put whatever they say. the position within the beat is the reduced fraction numerator / denominator,
+* a denominator of 0 means the position is unknown.
+*/
+struct BeatPosition
+{
+	int Beat = 0;
+
+	int16_t Numerator = 0;
+	int16_t Denominator = 0;
+
+	bool IsValid() const
+	{
+		return Denominator != 0;
+	}
+
+	double GetBeat() const
+	{
+		return double(Beat) + double(Numerator) / double(Denominator);
+	}
+
+	bool operator==(const BeatPosition& InOther) const
+	{
+		return Beat == InOther.Beat && Numerator == InOther.Numerator && Denominator == InOther.Denominator;
+	}
+
+	bool operator!=(const BeatPosition& InOther) const
+	{
+		return !(*this == InOther);
+	}
+};
+
+//the position InNumerator / InDenominator beats after the first bpm point, negative numerators included
+inline BeatPosition MakeBeatPosition(long long InNumerator, long long InDenominator)
+{
+	if (InDenominator <= 0)
+		return BeatPosition();
+
+	long long beat = InNumerator >= 0 ? InNumerator / InDenominator : -((InDenominator - 1 - InNumerator) / InDenominator);
+	long long numerator = InNumerator - beat * InDenominator;
+	long long divisor = std::gcd(numerator, InDenominator);
+
+	numerator /= divisor;
+	InDenominator /= divisor;
+
+	if (InDenominator > INT16_MAX)
+		return BeatPosition();
+
+	BeatPosition position;
+	position.Beat = int(beat);
+	position.Numerator = int16_t(numerator);
+	position.Denominator = int16_t(InDenominator);
+
+	return position;
+}
+
+struct Note
+{
+	enum class EType
+	{
+		Common,
+		HoldBegin,
+		HoldEnd,
+        Mine,
+        RollBegin,
+        RollEnd,
+        Lift,
+        Fake,
+
+		COUNT
+	} Type;
+
+	Time TimePoint;
+	int BeatSnap = -1;
+
+	Time TimePointBegin = 0;
+	Time TimePointEnd = 0;
+
+	//exact beats of the note and, on a long note begin, of its end. they stay unknown for notes off the grid
+	BeatPosition Position;
+	BeatPosition PositionEnd;
+
+	//issued by the note store on insertion, copies keep it so they can find their way back to the stored note
+	NoteHandle Handle;
+};
+
+struct BpmPoint
+{
+	Time TimePoint;
+
+	double BeatLength;
+	double Bpm;
+
+	bool operator==(const BpmPoint& InOther)
+	{
+		return (TimePoint == InOther.TimePoint);
+	}
+};
+
+struct ScrollVelocityMultiplier
+{
+	Time TimePoint;
+	double Multiplier;
+
+    bool operator==(const ScrollVelocityMultiplier& InOther)
+    {
+        return (TimePoint == InOther.TimePoint);
+    }
+};
+
+struct TimeSignature
+{
+    Time TimePoint;
+    int Numerator = 4;
+    int Denominator = 4;
+
+    bool operator==(const TimeSignature& other) { return TimePoint == other.TimePoint; }
+};
+
+struct StopPoint
+{
+    Time TimePoint;
+    double Length; // Seconds (StepMania standard) or MS? Standardize on MS internally?
+    // StepMania uses Seconds. Let's use Seconds to distinguish from Length in Time (which is int).
+    // Or simpler, double Seconds.
+
+    bool operator==(const StopPoint& InOther)
+    {
+        return (TimePoint == InOther.TimePoint);
+    }
+};
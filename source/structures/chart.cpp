@@ -1,4 +1,5 @@
 #include "chart.h"
+#include "chart-builder.h"
 
 #include <iostream>
 #include <algorithm>
@@ -6,46 +7,266 @@
 #include <unordered_set>
 #include <limits>
 #include <random>
+#include <numeric>
+#include <cmath>
+#include <bitset>
 
-void NoteReferenceCollection::PushNote(Column InColumn, Note* InNote)
+//drawn from by every chart, so a revision never turns up again on another chart
+static size_t static_TimingRevisionCounter = 0;
+
+static bool IsLongNoteType(const Note::EType InType)
 {
+	switch (InType)
+	{
+	case Note::EType::HoldBegin:
+	case Note::EType::HoldEnd:
+	case Note::EType::RollBegin:
+	case Note::EType::RollEnd:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+static bool IsLongNoteBegin(const Note::EType InType)
+{
+	return InType == Note::EType::HoldBegin || InType == Note::EType::RollBegin;
+}
+
+static bool IsLongNoteEnd(const Note::EType InType)
+{
+	return InType == Note::EType::HoldEnd || InType == Note::EType::RollEnd;
+}
+
+static size_t GetLowestBitIndex(uint64_t InBits)
+{
+	size_t index = 0;
+
+	for (size_t width = 32; width > 0; width /= 2)
+	{
+		if((InBits & ((uint64_t(1) << width) - 1)) == 0)
+		{
+			InBits >>= width;
+			index += width;
+		}
+	}
+
+	return index;
+}
+
+void NoteReferenceCollection::PushNote(Column InColumn, const Note& InNote)
+{
+	if(Contains(InNote.Handle) || !InNote.Handle.IsValid())
+		return;
+
+	const size_t slot = InNote.Handle.Slot;
+
+	if(slot >= _SlotGenerations.size())
+		_SlotGenerations.resize(std::max(slot + 1, _SlotGenerations.size() * 2), 0);
+
+	if(InColumn >= _ColumnSlotBits.size())
+	{
+		_ColumnSlotBits.resize(InColumn + 1);
+		ColumnNoteCount.resize(InColumn + 1, 0);
+	}
+
+	auto& slotBits = _ColumnSlotBits[InColumn];
+
+	if(slot / 64 >= slotBits.size())
+		slotBits.resize(_SlotGenerations.size() / 64 + 1, 0);
+
+	//a slot selected with an earlier generation may still be set in another column
+	if(_SlotGenerations[slot] != 0)
+		ClearSlot(slot);
+
+	_SlotGenerations[slot] = InNote.Handle.Generation;
+	slotBits[slot / 64] |= uint64_t(1) << (slot % 64);
+
 	HasNotes = true;
 	NoteAmount++;
 
-	if(ColumnNoteCount.find(InColumn) == ColumnNoteCount.end())
-		ColumnNoteCount[InColumn] = 0;
-
 	ColumnNoteCount[InColumn] += 1;
-	Notes[InColumn].insert(InNote);
-
 	HighestColumnAmount = std::max(HighestColumnAmount, ColumnNoteCount[InColumn]);
 
-	switch (InNote->Type)
+	switch (InNote.Type)
 	{
 	case Note::EType::Common:
-		TrySetMinMaxTime(InNote->TimePoint);
+    case Note::EType::Mine:
+    case Note::EType::Lift:
+    case Note::EType::Fake:
+		TrySetMinMaxTime(InNote.TimePoint);
 		break;
 
 	case Note::EType::HoldBegin:
     case Note::EType::RollBegin:
-		TrySetMinMaxTime(InNote->TimePointEnd);
+		TrySetMinMaxTime(InNote.TimePointBegin);
+		TrySetMinMaxTime(InNote.TimePointEnd);
 		break;
 	}
 }
 
+bool NoteReferenceCollection::Contains(const NoteHandle InHandle) const
+{
+	return InHandle.IsValid() && InHandle.Slot < _SlotGenerations.size() && _SlotGenerations[InHandle.Slot] == InHandle.Generation;
+}
+
 void NoteReferenceCollection::Clear()
 {
 	HasNotes = false;
 	NoteAmount = 0;
 	HighestColumnAmount = 0;
 
-	Notes.clear();
-	ColumnNoteCount.clear();
+	//the storage is kept for the next selection, only zeroed
+	for (auto& slotBits : _ColumnSlotBits)
+		std::fill(slotBits.begin(), slotBits.end(), 0);
+
+	std::fill(_SlotGenerations.begin(), _SlotGenerations.end(), 0);
+	std::fill(ColumnNoteCount.begin(), ColumnNoteCount.end(), 0);
 
 	MinTimePoint = std::numeric_limits<int>::max();
 	MaxTimePoint = std::numeric_limits<int>::min();
 }
 
+void NoteReferenceCollection::Unite(const NoteReferenceCollection& InOther)
+{
+	if(InOther._SlotGenerations.size() > _SlotGenerations.size())
+		_SlotGenerations.resize(InOther._SlotGenerations.size(), 0);
+
+	if(InOther._ColumnSlotBits.size() > _ColumnSlotBits.size())
+	{
+		_ColumnSlotBits.resize(InOther._ColumnSlotBits.size());
+		ColumnNoteCount.resize(InOther._ColumnSlotBits.size(), 0);
+	}
+
+	for (Column column = 0; column < InOther._ColumnSlotBits.size(); ++column)
+	{
+		const auto& otherSlotBits = InOther._ColumnSlotBits[column];
+		auto& slotBits = _ColumnSlotBits[column];
+
+		if(otherSlotBits.size() > slotBits.size())
+			slotBits.resize(otherSlotBits.size(), 0);
+
+		for (size_t word = 0; word < otherSlotBits.size(); ++word)
+			slotBits[word] |= otherSlotBits[word];
+	}
+
+	for (size_t slot = 0; slot < InOther._SlotGenerations.size(); ++slot)
+	{
+		const unsigned int otherGeneration = InOther._SlotGenerations[slot];
+
+		if(otherGeneration == 0 || otherGeneration == _SlotGenerations[slot])
+			continue;
+
+		//a slot held with different generations was reused, the newer note is the one still existing
+		if(_SlotGenerations[slot] != 0)
+		{
+			const NoteReferenceCollection& newer = otherGeneration > _SlotGenerations[slot] ? InOther : *this;
+			const size_t word = slot / 64;
+			const uint64_t bit = uint64_t(1) << (slot % 64);
+
+			for (Column column = 0; column < _ColumnSlotBits.size(); ++column)
+				if(column >= newer._ColumnSlotBits.size() || word >= newer._ColumnSlotBits[column].size() || !(newer._ColumnSlotBits[column][word] & bit))
+					_ColumnSlotBits[column][word] &= ~bit;
+		}
+
+		_SlotGenerations[slot] = std::max(_SlotGenerations[slot], otherGeneration);
+	}
+
+	MinTimePoint = std::min(MinTimePoint, InOther.MinTimePoint);
+	MaxTimePoint = std::max(MaxTimePoint, InOther.MaxTimePoint);
+
+	Recount();
+}
+
+void NoteReferenceCollection::Intersect(const NoteReferenceCollection& InOther)
+{
+	for (Column column = 0; column < _ColumnSlotBits.size(); ++column)
+	{
+		auto& slotBits = _ColumnSlotBits[column];
+		const size_t otherWordAmount = column < InOther._ColumnSlotBits.size() ? InOther._ColumnSlotBits[column].size() : 0;
+
+		for (size_t word = 0; word < slotBits.size(); ++word)
+			slotBits[word] &= word < otherWordAmount ? InOther._ColumnSlotBits[column][word] : 0;
+	}
+
+	for (size_t slot = 0; slot < _SlotGenerations.size(); ++slot)
+		if(slot >= InOther._SlotGenerations.size() || InOther._SlotGenerations[slot] != _SlotGenerations[slot])
+			_SlotGenerations[slot] = 0;
+
+	MinTimePoint = std::max(MinTimePoint, InOther.MinTimePoint);
+	MaxTimePoint = std::min(MaxTimePoint, InOther.MaxTimePoint);
+
+	Recount();
+}
+
+void NoteReferenceCollection::IterateHandles(std::function<void(const Column, const NoteHandle)> InWork) const
+{
+	for (Column column = 0; column < _ColumnSlotBits.size(); ++column)
+	{
+		const auto& slotBits = _ColumnSlotBits[column];
+
+		for (size_t word = 0; word < slotBits.size(); ++word)
+		{
+			for (uint64_t bits = slotBits[word]; bits != 0; bits &= bits - 1)
+			{
+				const size_t slot = word * 64 + GetLowestBitIndex(bits);
+
+				if(_SlotGenerations[slot] != 0)
+					InWork(column, NoteHandle{ static_cast<unsigned int>(slot), _SlotGenerations[slot] });
+			}
+		}
+	}
+}
+
+void NoteReferenceCollection::ClearSlot(const size_t InSlot)
+{
+	for (Column column = 0; column < _ColumnSlotBits.size(); ++column)
+	{
+		auto& slotBits = _ColumnSlotBits[column];
+
+		if(InSlot / 64 >= slotBits.size() || !(slotBits[InSlot / 64] & (uint64_t(1) << (InSlot % 64))))
+			continue;
+
+		slotBits[InSlot / 64] &= ~(uint64_t(1) << (InSlot % 64));
+		ColumnNoteCount[column]--;
+		NoteAmount--;
+	}
+}
+
+void NoteReferenceCollection::Recount()
+{
+	NoteAmount = 0;
+	HighestColumnAmount = 0;
+
+	for (Column column = 0; column < _ColumnSlotBits.size(); ++column)
+	{
+		auto& slotBits = _ColumnSlotBits[column];
+
+		//bits of slots whose generation was dropped go as well
+		for (size_t word = 0; word < slotBits.size(); ++word)
+			for (uint64_t bits = slotBits[word]; bits != 0; bits &= bits - 1)
+				if(_SlotGenerations[word * 64 + GetLowestBitIndex(bits)] == 0)
+					slotBits[word] &= ~(bits & (~bits + 1));
+
+		int count = 0;
+		for (const uint64_t bits : slotBits)
+			count += std::bitset<64>(bits).count();
+
+		ColumnNoteCount[column] = count;
+		NoteAmount += count;
+		HighestColumnAmount = std::max(HighestColumnAmount, count);
+	}
+
+	HasNotes = NoteAmount > 0;
+
+	if(!HasNotes)
+	{
+		MinTimePoint = std::numeric_limits<int>::max();
+		MaxTimePoint = std::numeric_limits<int>::min();
+	}
+}
+
 void NoteReferenceCollection::TrySetMinMaxTime(Time InTime)
 {
 	MinTimePoint = std::min(MinTimePoint, InTime);
@@ -57,48 +278,75 @@ bool Chart::PlaceNote(const Time InTime, const Column InColumn, const int InBeat
 	if (IsAPotentialNoteDuplicate(InTime, InColumn))
 		return false;
 
-	RegisterTimeSliceHistory(InTime);
+	BeginTransaction();
 	InjectNote(InTime, InColumn, Note::EType::Common, -1, -1, InBeatSnap);
+	Commit();
 
 	return true;
 }
 
-bool Chart::RemoveStop(StopPoint &InStop, const bool InSkipHistoryRegistering)
+bool Chart::RemoveStop(StopPoint &InStop)
 {
-	auto &timeSlice = FindOrAddTimeSlice(InStop.TimePoint);
-	auto &stopCollection = timeSlice.Stops;
+	TimeSlice* timeSlice = FindTimeSlice(InStop.TimePoint);
+
+	if (!timeSlice)
+		return false;
+
+	auto &stopCollection = timeSlice->Stops;
+
+	BeginTransaction();
+	JournalTimingChange(InStop.TimePoint);
 
-	if (!InSkipHistoryRegistering)
-		RegisterTimeSliceHistory(InStop.TimePoint);
+	InvalidateTempoMap(InStop.TimePoint);
 
 	stopCollection.erase(std::remove(stopCollection.begin(), stopCollection.end(), InStop), stopCollection.end());
 
+	UpdateTimingIndices(*timeSlice);
+
+	Commit();
+
 	return true;
 }
 
-bool Chart::RemoveSV(ScrollVelocityMultiplier &InSV, const bool InSkipHistoryRegistering)
+bool Chart::RemoveSV(ScrollVelocityMultiplier &InSV)
 {
-	auto &timeSlice = FindOrAddTimeSlice(InSV.TimePoint);
-	auto &svCollection = timeSlice.SvMultipliers;
+	TimeSlice* timeSlice = FindTimeSlice(InSV.TimePoint);
+
+	if (!timeSlice)
+		return false;
+
+	auto &svCollection = timeSlice->SvMultipliers;
 
-	if (!InSkipHistoryRegistering)
-		RegisterTimeSliceHistory(InSV.TimePoint);
+	BeginTransaction();
+	JournalTimingChange(InSV.TimePoint);
 
 	svCollection.erase(std::remove(svCollection.begin(), svCollection.end(), InSV), svCollection.end());
 
+	UpdateTimingIndices(*timeSlice);
+
+	Commit();
+
 	return true;
 }
 
-bool Chart::RemoveTimeSignature(TimeSignature &InTS, const bool InSkipHistoryRegistering)
+bool Chart::RemoveTimeSignature(TimeSignature &InTS)
 {
-    auto &timeSlice = FindOrAddTimeSlice(InTS.TimePoint);
-    auto &tsCollection = timeSlice.TimeSignatures;
+    TimeSlice* timeSlice = FindTimeSlice(InTS.TimePoint);
+
+    if (!timeSlice)
+        return false;
+
+    auto &tsCollection = timeSlice->TimeSignatures;
 
-    if (!InSkipHistoryRegistering)
-        RegisterTimeSliceHistory(InTS.TimePoint);
+    BeginTransaction();
+    JournalTimingChange(InTS.TimePoint);
 
     tsCollection.erase(std::remove(tsCollection.begin(), tsCollection.end(), InTS), tsCollection.end());
 
+    UpdateTimingIndices(*timeSlice);
+
+    Commit();
+
     return true;
 }
 
@@ -110,29 +358,26 @@ bool Chart::PlaceHold(const Time InTimeBegin, const Time InTimeEnd, const Column
 	if (IsAPotentialNoteDuplicate(InTimeBegin, InColumn) || IsAPotentialNoteDuplicate(InTimeEnd, InColumn))
 		return false;
 
-	RegisterTimeSliceHistoryRanged(InTimeBegin, InTimeEnd);
-
+	BeginTransaction();
 	InjectHold(InTimeBegin, InTimeEnd, InColumn, InBeatSnap);
+	Commit();
 
 	return true;
 }
 
 bool Chart::PlaceBpmPoint(const Time InTime, const double InBpm, const double InBeatLength)
 {
-	RegisterTimeSliceHistory(InTime);
+	BeginTransaction();
 	InjectBpmPoint(InTime, InBpm, InBeatLength);
+	Commit();
 
 	return true;
 }
 
-void Chart::BulkPlaceNotes(const std::vector<std::pair<Column, Note>> &InNotes, const bool InSkipHistoryRegistering, const bool InSkipOnModified)
+void Chart::BulkPlaceNotes(const std::vector<std::pair<Column, Note>> &InNotes, const bool InSkipOnModified)
 {
-	Time timePointMin = InNotes.front().second.TimePoint;
-	Time timePointMax = InNotes.back().second.TimePoint;
-
-	// - TIMESLICE_LENGTH and + TIMESLICE_LENGTH accounts for potential resnaps (AAAAAA)
-	if(!InSkipHistoryRegistering)
-		RegisterTimeSliceHistoryRanged(timePointMin - TIMESLICE_LENGTH, timePointMax + TIMESLICE_LENGTH);
+	ChartBuilder builder;
+	builder.Reserve(InNotes.size() * 2);
 
 	for (const auto &[column, note] : InNotes)
 	{
@@ -142,72 +387,42 @@ void Chart::BulkPlaceNotes(const std::vector<std::pair<Column, Note>> &InNotes,
         case Note::EType::Mine:
         case Note::EType::Lift:
         case Note::EType::Fake:
-			InjectNote(note.TimePoint, column, note.Type, -1, -1, -1, InSkipOnModified);
+			builder.AddNote(note.TimePoint, column, note.Type);
 			break;
 
 		case Note::EType::HoldBegin:
-			InjectHold(note.TimePointBegin, note.TimePointEnd, column, -1, -1, InSkipOnModified);
+			builder.AddHold(note.TimePointBegin, note.TimePointEnd, column);
 			break;
 
         case Note::EType::RollBegin:
-            InjectRoll(note.TimePointBegin, note.TimePointEnd, column, -1, -1, InSkipOnModified);
+            builder.AddRoll(note.TimePointBegin, note.TimePointEnd, column);
             break;
 		}
 	}
+
+	BeginTransaction();
+	builder.Build(*this, InSkipOnModified);
+	Commit();
 }
 
 void Chart::IterateAllSVs(std::function<void(ScrollVelocityMultiplier&)> InWork)
 {
-	for (auto &[ID, timeSlice] : TimeSlices)
-	{
-		for (auto &sv : timeSlice.SvMultipliers)
-		{
-			InWork(sv);
-		}
-	}
+	for (auto* sv : GetSVIndex().GetAll())
+		InWork(*sv);
 }
 
 void Chart::IterateAllTimeSignatures(std::function<void(TimeSignature&)> InWork)
 {
-    for (auto &[ID, timeSlice] : TimeSlices)
-    {
-        for (auto &ts : timeSlice.TimeSignatures)
-        {
-            InWork(ts);
-        }
-    }
+    for (auto* ts : GetTimeSignatureIndex().GetAll())
+        InWork(*ts);
 }
 
-void Chart::MirrorNotes(NoteReferenceCollection& OutNotes)
+bool Chart::MirrorNotes(NoteReferenceCollection& OutNotes)
 {
-	std::vector<std::pair<Column, Note>> bulkOfNotes;
-
-	RegisterTimeSliceHistoryRanged(OutNotes.MinTimePoint, OutNotes.MaxTimePoint);
-
-	for (auto& [column, notes] : OutNotes.Notes)
-	{
-		Column newColumn = (KeyAmount - 1) - column;
-
-		//this is neccesary since removing an element form a vector will change the contents of a pointer pointing to that element
-		std::vector<Note> copiedNotes;
-		for (auto &note : notes)
-			copiedNotes.push_back(*note);
-
-		for (auto &note : copiedNotes)
-		{
-			bulkOfNotes.push_back({newColumn, note});
-			RemoveNote(note.TimePoint, column, false, true, true);
-		}
-	}
-
-	BulkPlaceNotes(bulkOfNotes, true, true);
-
-	IterateTimeSlicesInTimeRange(OutNotes.MinTimePoint, OutNotes.MaxTimePoint, [this](TimeSlice& InTimeSlice)
+	return TransformNotes(OutNotes, [this](Note&, Column& InOutColumn)
 	{
-		_OnModified(InTimeSlice);
+		InOutColumn = (KeyAmount - 1) - InOutColumn;
 	});
-
-	OutNotes.Clear();
 }
 
 void Chart::MirrorNotes(std::vector<std::pair<Column, Note>>& OutNotes)
@@ -216,352 +431,136 @@ void Chart::MirrorNotes(std::vector<std::pair<Column, Note>>& OutNotes)
 		column = (KeyAmount - 1) - column;
 }
 
-void Chart::ScaleNotes(NoteReferenceCollection& OutNotes, float Factor)
+bool Chart::ScaleNotes(NoteReferenceCollection& OutNotes, float Factor)
 {
-	if (!OutNotes.HasNotes)
-		return;
-
-	// Use the minimum time in the selection as the pivot point
-	Time pivotTime = OutNotes.MinTimePoint;
+	//the earliest note of the selection stays in place, everything else is scaled away from it
+	const Time pivotTime = OutNotes.MinTimePoint;
 
-	// Prepare new notes list
-	std::vector<std::pair<Column, Note>> scaledNotes;
+	return TransformNotes(OutNotes, [pivotTime, Factor](Note& InOutNote, Column&)
+	{
+		InOutNote.TimePoint = pivotTime + (Time)((InOutNote.TimePoint - pivotTime) * Factor);
+		InOutNote.TimePointEnd = pivotTime + (Time)((InOutNote.TimePointEnd - pivotTime) * Factor);
+	});
+}
 
-	// Also we need to register history for the range we are modifying.
-	// We are modifying the range [MinTime, MaxTime] -> [MinTime, MinTime + (Max-Min)*Factor]
-	Time scaledMaxTime = pivotTime + (Time)((OutNotes.MaxTimePoint - pivotTime) * Factor);
-	RegisterTimeSliceHistoryRanged(pivotTime, std::max(OutNotes.MaxTimePoint, scaledMaxTime) + TIMESLICE_LENGTH);
+bool Chart::ReverseNotes(NoteReferenceCollection& OutNotes)
+{
+	const Time minTime = OutNotes.MinTimePoint;
+	const Time maxTime = OutNotes.MaxTimePoint;
 
-	for (auto& [column, notes] : OutNotes.Notes)
+	//a long note is flipped as a whole, its former end becomes its begin
+	return TransformNotes(OutNotes, [minTime, maxTime](Note& InOutNote, Column&)
 	{
-		// Need to copy notes because we are going to remove them from the chart
-		std::vector<Note> copiedNotes;
-		for (auto& notePtr : notes)
-			copiedNotes.push_back(*notePtr);
-
-		for (auto& note : copiedNotes)
+		if (IsLongNoteBegin(InOutNote.Type))
 		{
-			// Remove the old note
-			RemoveNote(note.TimePoint, column, false, true, true);
-
-			// Calculate new time
-			Time newTime = pivotTime + (Time)((note.TimePoint - pivotTime) * Factor);
-			note.TimePoint = newTime;
-
-			// Reset beat snap as it likely changes (unless factor is integer, but safer to reset)
-			note.BeatSnap = -1;
+			const Time formerBegin = InOutNote.TimePoint;
 
-			if (note.Type == Note::EType::HoldBegin || note.Type == Note::EType::RollBegin)
-			{
-				Time newEnd = pivotTime + (Time)((note.TimePointEnd - pivotTime) * Factor);
-				note.TimePointBegin = newTime;
-				note.TimePointEnd = newEnd;
-			}
+			InOutNote.TimePoint = maxTime + minTime - InOutNote.TimePointEnd;
+			InOutNote.TimePointEnd = maxTime + minTime - formerBegin;
 
-			scaledNotes.push_back({column, note});
+			return;
 		}
-	}
-
-	// Place new notes
-	BulkPlaceNotes(scaledNotes, true, true);
 
-	// Notify modification
-	IterateTimeSlicesInTimeRange(pivotTime, std::max(OutNotes.MaxTimePoint, scaledMaxTime) + TIMESLICE_LENGTH, [this](TimeSlice& InTimeSlice)
-	{
-		_OnModified(InTimeSlice);
+		InOutNote.TimePoint = maxTime + minTime - InOutNote.TimePoint;
 	});
-
-	// Clear selection as pointers are invalid now
-	OutNotes.Clear();
 }
 
-void Chart::ReverseNotes(NoteReferenceCollection& OutNotes)
+bool Chart::ConvertToHolds(NoteReferenceCollection& OutNotes, Time Length)
 {
-	if (!OutNotes.HasNotes)
-		return;
-
-	Time minTime = OutNotes.MinTimePoint;
-	Time maxTime = OutNotes.MaxTimePoint;
-
-	RegisterTimeSliceHistoryRanged(minTime, maxTime + TIMESLICE_LENGTH);
-
-	std::vector<std::pair<Column, Note>> reversedNotes;
+	if (Length <= 0)
+		return false;
 
-	for (auto& [column, notes] : OutNotes.Notes)
+	return TransformNotes(OutNotes, [Length](Note& InOutNote, Column&)
 	{
-		std::vector<Note> copiedNotes;
-		for (auto& notePtr : notes)
-			copiedNotes.push_back(*notePtr);
-
-		for (auto& note : copiedNotes)
-		{
-			RemoveNote(note.TimePoint, column, false, true, true);
-
-			// Logic: newTime = max + min - oldTime
-			Time newTime = maxTime + minTime - note.TimePoint;
-
-			note.TimePoint = newTime;
-			note.BeatSnap = -1;
-
-			if (note.Type == Note::EType::HoldBegin || note.Type == Note::EType::RollBegin)
-			{
-				// Hold end also flips
-				Time newStart = maxTime + minTime - note.TimePointEnd;
-				// note.TimePoint (newTime) is actually the new End of the reversed hold
-				// Wait, if note.TimePoint is Start:
-				// Old: Start -> End.
-				// New Start = Max + Min - End.
-				// New End   = Max + Min - Start.
-
-				note.TimePointEnd = newTime;
-				note.TimePointBegin = newStart;
-
-				// Fix main TimePoint to be the Begin
-				note.TimePoint = newStart;
-			}
-
-			reversedNotes.push_back({column, note});
-		}
-	}
-
-	BulkPlaceNotes(reversedNotes, true, true);
+		InOutNote.Type = Note::EType::HoldBegin;
+		InOutNote.TimePointEnd = InOutNote.TimePoint + Length;
+	});
+}
 
-	IterateTimeSlicesInTimeRange(minTime, maxTime + TIMESLICE_LENGTH, [this](TimeSlice& InTimeSlice)
+bool Chart::ConvertToTaps(NoteReferenceCollection& OutNotes)
+{
+	return TransformNotes(OutNotes, [](Note& InOutNote, Column&)
 	{
-		_OnModified(InTimeSlice);
+		InOutNote.Type = Note::EType::Common;
 	});
-
-	OutNotes.Clear();
 }
 
-void Chart::ConvertToHolds(NoteReferenceCollection& OutNotes, Time Length)
+void Chart::MoveAllNotes(Time Offset)
 {
-    if (!OutNotes.HasNotes || Length <= 0) return;
-
-    RegisterTimeSliceHistoryRanged(OutNotes.MinTimePoint, OutNotes.MaxTimePoint + Length + TIMESLICE_LENGTH);
-
-    std::vector<std::pair<Column, Note>> newNotes;
-
-    for (auto& [column, notes] : OutNotes.Notes)
-    {
-        std::vector<Note> copiedNotes;
-        for (auto& notePtr : notes)
-            copiedNotes.push_back(*notePtr);
-
-        for (auto& note : copiedNotes)
-        {
-            RemoveNote(note.TimePoint, column, false, true, true);
-
-            note.Type = Note::EType::HoldBegin;
-            note.TimePointBegin = note.TimePoint;
-            // If already hold, extend? Or reset?
-            // "Convert to Hold" usually means set length.
-            note.TimePointEnd = note.TimePoint + Length;
-
-            newNotes.push_back({column, note});
-        }
-    }
+    if (Offset == 0) return;
 
-    BulkPlaceNotes(newNotes, true, true);
+    BeginTransaction();
 
-    IterateTimeSlicesInTimeRange(OutNotes.MinTimePoint, OutNotes.MaxTimePoint + Length + TIMESLICE_LENGTH, [this](TimeSlice& InTimeSlice)
-    {
-        _OnModified(InTimeSlice);
-    });
+    BaseOffset += Offset;
+    _OpenTransaction.BaseOffsetDelta += Offset;
 
-    OutNotes.Clear();
+    Commit();
 }
 
-void Chart::ConvertToTaps(NoteReferenceCollection& OutNotes)
+Time Chart::GetBaseOffset() const
 {
-    if (!OutNotes.HasNotes) return;
-
-    RegisterTimeSliceHistoryRanged(OutNotes.MinTimePoint, OutNotes.MaxTimePoint + TIMESLICE_LENGTH);
-
-    std::vector<std::pair<Column, Note>> newNotes;
-
-    for (auto& [column, notes] : OutNotes.Notes)
-    {
-        std::vector<Note> copiedNotes;
-        for (auto& notePtr : notes)
-            copiedNotes.push_back(*notePtr);
-
-        for (auto& note : copiedNotes)
-        {
-            RemoveNote(note.TimePoint, column, false, true, true);
-
-            note.Type = Note::EType::Common;
-            note.TimePointBegin = 0;
-            note.TimePointEnd = 0;
-
-            newNotes.push_back({column, note});
-        }
-    }
-
-    BulkPlaceNotes(newNotes, true, true);
-
-    IterateTimeSlicesInTimeRange(OutNotes.MinTimePoint, OutNotes.MaxTimePoint + TIMESLICE_LENGTH, [this](TimeSlice& InTimeSlice)
-    {
-        _OnModified(InTimeSlice);
-    });
-
-    OutNotes.Clear();
+    return Time(std::round(BaseOffset));
 }
 
-void Chart::MoveAllNotes(Time Offset)
+Time Chart::ToSongTime(const Time InChartTime) const
 {
-    if (Offset == 0) return;
-
-    // Find full range of chart
-    Time minTime = std::numeric_limits<int>::max();
-    Time maxTime = std::numeric_limits<int>::min();
-
-    IterateAllNotes([&](Note& n, Column c){
-        minTime = std::min(minTime, n.TimePoint);
-        maxTime = std::max(maxTime, n.TimePoint);
-        if (n.Type == Note::EType::HoldBegin || n.Type == Note::EType::RollBegin)
-            maxTime = std::max(maxTime, n.TimePointEnd);
-    });
-
-    // Also include BPM points
-    IterateAllBpmPoints([&](BpmPoint& b){
-        minTime = std::min(minTime, b.TimePoint);
-        maxTime = std::max(maxTime, b.TimePoint);
-    });
-
-    // Stops
-    IterateAllStops([&](StopPoint& s){
-        minTime = std::min(minTime, s.TimePoint);
-        maxTime = std::max(maxTime, s.TimePoint);
-    });
-
-    // SVs
-    IterateAllSVs([&](ScrollVelocityMultiplier& sv){
-        minTime = std::min(minTime, sv.TimePoint);
-        maxTime = std::max(maxTime, sv.TimePoint);
-    });
-
-    // Time Signatures
-    IterateAllTimeSignatures([&](TimeSignature& ts){
-        minTime = std::min(minTime, ts.TimePoint);
-        maxTime = std::max(maxTime, ts.TimePoint);
-    });
-
-    if (maxTime < minTime) return; // Empty chart
-
-    RegisterTimeSliceHistoryRanged(minTime, maxTime + abs(Offset) + TIMESLICE_LENGTH);
-
-    // 1. Collect Notes
-    std::vector<std::pair<Column, Note>> notes;
-    IterateAllNotes([&](Note& n, Column c){
-        if (n.Type == Note::EType::Common || n.Type == Note::EType::HoldBegin ||
-            n.Type == Note::EType::RollBegin || n.Type == Note::EType::Mine ||
-            n.Type == Note::EType::Lift || n.Type == Note::EType::Fake)
-        {
-            notes.push_back({c, n});
-        }
-    });
-
-    // 2. Collect BPMs
-    std::vector<BpmPoint> bpms;
-    IterateAllBpmPoints([&](BpmPoint& b){
-        bpms.push_back(b);
-    });
-
-    // 3. Collect Stops
-    std::vector<StopPoint> stops;
-    IterateAllStops([&](StopPoint& s){
-        stops.push_back(s);
-    });
-
-    // 4. Collect SVs
-    std::vector<ScrollVelocityMultiplier> svs;
-    IterateAllSVs([&](ScrollVelocityMultiplier& sv){
-        svs.push_back(sv);
-    });
-
-    // 5. Collect TS
-    std::vector<TimeSignature> tss;
-    IterateAllTimeSignatures([&](TimeSignature& ts){
-        tss.push_back(ts);
-    });
-
-    // Remove all notes
-    for (auto& [c, n] : notes)
-    {
-        RemoveNote(n.TimePoint, c, false, true, true);
-    }
+    return InChartTime + GetBaseOffset();
+}
 
-    // Remove all BPMs
-    for (auto& b : bpms)
-    {
-        RemoveBpmPoint(b, true);
-    }
+Time Chart::ToChartTime(const Time InSongTime) const
+{
+    return InSongTime - GetBaseOffset();
+}
 
-    // Remove all Stops
-    for (auto& s : stops)
-    {
-        RemoveStop(s, true);
-    }
+bool Chart::RebaseTiming(const TempoMap& InFormerTempoMap, const Time InTimeFrom, const std::vector<Time>& InEditedTimePoints)
+{
+	auto isEdited = [&InEditedTimePoints](const Time InTime)
+	{
+		return std::find(InEditedTimePoints.begin(), InEditedTimePoints.end(), InTime) != InEditedTimePoints.end();
+	};
 
-    // Remove all SVs
-    for (auto& sv : svs)
-    {
-        RemoveSV(sv, true);
-    }
+	//the tempo up to the first bpm point or stop following the edit is made of the timing before it and the edit itself
+	std::vector<BpmPoint> leadingBpmPoints;
+	std::vector<StopPoint> leadingStops;
 
-    // Remove all TS
-    for (auto& ts : tss)
-    {
-        RemoveTimeSignature(ts, true);
-    }
+	Time followingTimePoint = std::numeric_limits<Time>::max();
 
-    // 4. Re-insert with offset
-    for (auto& [c, n] : notes)
-    {
-        n.TimePoint += Offset;
-        if (n.Type == Note::EType::HoldBegin || n.Type == Note::EType::RollBegin)
-        {
-            n.TimePointBegin += Offset;
-            n.TimePointEnd += Offset;
-        }
+	for (const auto& [index, timeSlice] : TimeSlices)
+	{
+		for (const auto& bpmPoint : timeSlice.BpmPoints)
+		{
+			if (bpmPoint.TimePoint < InTimeFrom || isEdited(bpmPoint.TimePoint))
+				leadingBpmPoints.push_back(bpmPoint);
+			else
+				followingTimePoint = std::min(followingTimePoint, bpmPoint.TimePoint);
+		}
 
-        if (n.Type == Note::EType::HoldBegin)
-            InjectHold(n.TimePointBegin, n.TimePointEnd, c, -1, -1, true);
-        else if (n.Type == Note::EType::RollBegin)
-            InjectRoll(n.TimePointBegin, n.TimePointEnd, c, -1, -1, true);
-        else
-            InjectNote(n.TimePoint, c, n.Type, -1, -1, -1, true);
-    }
+		for (const auto& stop : timeSlice.Stops)
+		{
+			if (stop.TimePoint < InTimeFrom)
+				leadingStops.push_back(stop);
+			else
+				followingTimePoint = std::min(followingTimePoint, stop.TimePoint);
+		}
+	}
 
-    for (auto& b : bpms)
-    {
-        b.TimePoint += Offset;
-        InjectBpmPoint(b.TimePoint, b.Bpm, b.BeatLength);
-    }
+	TempoMap leadingTempoMap;
+	leadingTempoMap.Append(std::move(leadingBpmPoints), std::move(leadingStops));
 
-    for (auto& s : stops)
-    {
-        s.TimePoint += Offset;
-        InjectStop(s.TimePoint, s.Length);
-    }
+	if (InFormerTempoMap.IsEmpty() || leadingTempoMap.IsEmpty())
+		return false;
 
-    for (auto& sv : svs)
-    {
-        sv.TimePoint += Offset;
-        InjectSV(sv.TimePoint, sv.Multiplier);
-    }
+	auto rebase = [&InFormerTempoMap, &leadingTempoMap](const Time InTime)
+	{
+		return Time(std::round(leadingTempoMap.GetTimeFromBeat(InFormerTempoMap.GetBeatFromTime(InTime))));
+	};
 
-    for (auto& ts : tss)
-    {
-        ts.TimePoint += Offset;
-        InjectTimeSignature(ts.TimePoint, ts.Numerator, ts.Denominator);
-    }
+	//the timing following the edit keeps its beats and tempos, so from its first point on everything is shifted by the same amount
+	const Time followingShift = followingTimePoint == std::numeric_limits<Time>::max() ? 0 : rebase(followingTimePoint) - followingTimePoint;
 
-    // Notify modification on the whole range
-    IterateTimeSlicesInTimeRange(minTime + Offset, maxTime + Offset + TIMESLICE_LENGTH, [this](TimeSlice& InTimeSlice)
+	return RemapTimePoints(InTimeFrom, InEditedTimePoints, [&rebase, followingTimePoint, followingShift](const Time InTime)
 	{
-		_OnModified(InTimeSlice);
+		return InTime >= followingTimePoint ? InTime + followingShift : rebase(InTime);
 	});
 }
 
@@ -569,16 +568,15 @@ void Chart::GenerateStream(Time Start, Time End, int Divisor, StreamPattern Patt
 {
 	if (Start >= End || Divisor <= 0) return;
 
-	RegisterTimeSliceHistoryRanged(Start - TIMESLICE_LENGTH, End + TIMESLICE_LENGTH);
-
-	// Create beats
-	// Find starting BPM point
-	BpmPoint* bpm = GetPreviousBpmPointFromTimePoint(Start);
-	if (!bpm) bpm = GetNextBpmPointFromTimePoint(-1000000);
+	if (GetTempoMap().IsEmpty()) return; // No timing info
 
-	if (!bpm) return; // No timing info
+	BeginTransaction();
 
 	// Start placing notes
+	// Divisor is Measure Divisor (4, 8, 16...), so every note is 4 / Divisor beats apart
+	const double startBeat = GetBeatFromTime(Start);
+	const double beatsBetweenNotes = 4.0 / double(Divisor);
+
 	Time currentTime = Start;
 	int noteIndex = 0;
 
@@ -654,56 +652,30 @@ void Chart::GenerateStream(Time Start, Time End, int Divisor, StreamPattern Patt
         }
 		noteIndex++;
 
-		// Advance time based on current BPM
-		// We need to re-check BPM at current time?
-		// Yes, if BPM changes.
-		BpmPoint* currentBpm = GetPreviousBpmPointFromTimePoint(currentTime);
-		if (currentBpm)
-		{
-            // Divisor is Measure Divisor (4, 8, 16...). BeatLength is 1 beat (1/4 measure).
-            // Step = BeatLength * (4.0 / Divisor)
-			double step = currentBpm->BeatLength * (4.0 / double(Divisor));
-			currentTime += Time(step);
-		}
-		else
-		{
-			break; // Should not happen if we started with one
-		}
+		// Advance on the beat grid, so BPM changes and stops are followed without accumulating rounding errors
+		currentTime = GetTimeFromBeat(startBeat + beatsBetweenNotes * double(noteIndex));
 	}
 
-	IterateTimeSlicesInTimeRange(Start - TIMESLICE_LENGTH, End + TIMESLICE_LENGTH, [this](TimeSlice& InTimeSlice)
-	{
-		_OnModified(InTimeSlice);
-	});
+	Commit();
+
+	NotifyModified(Start - TIMESLICE_LENGTH, End + TIMESLICE_LENGTH);
 }
 
 std::vector<float> Chart::CalculateNPSGraph(int WindowSizeMs)
 {
-	if (!_BpmPointCounter || WindowSizeMs <= 0)
+	if (!_BpmPointCounter || WindowSizeMs <= 0 || Notes.IsEmpty())
 		return {};
 
 	// Find song length (approximate from max time point of notes)
-	Time maxTime = 0;
-	IterateAllNotes([&maxTime](Note& n, Column c) {
-		maxTime = std::max(maxTime, n.TimePoint);
-	});
+	const Time maxTime = std::max(Notes.GetLastTimePoint(), 0);
 
 	int numWindows = (maxTime / WindowSizeMs) + 2;
-	std::vector<int> counts(numWindows, 0);
-
-	IterateAllNotes([&counts, WindowSizeMs](Note& n, Column c) {
-		if (n.TimePoint >= 0)
-		{
-			int idx = n.TimePoint / WindowSizeMs;
-			if (idx < counts.size())
-				counts[idx]++;
-		}
-	});
 
 	std::vector<float> nps(numWindows);
-	for (size_t i = 0; i < counts.size(); ++i)
+	for (int i = 0; i < numWindows; ++i)
 	{
-		nps[i] = float(counts[i]) * (1000.0f / float(WindowSizeMs));
+		const int count = _NoteDensity.GetNoteAmountInTimeRange(i * WindowSizeMs, (i + 1) * WindowSizeMs);
+		nps[i] = float(count) * (1000.0f / float(WindowSizeMs));
 	}
 
 	return nps;
@@ -712,271 +684,470 @@ std::vector<float> Chart::CalculateNPSGraph(int WindowSizeMs)
 float Chart::GetAverageNPS()
 {
 	// Total notes / Total drain time
-	int noteCount = 0;
+	const int noteCount = _NoteDensity.GetNoteAmount();
 	Time firstNote = std::numeric_limits<int>::max();
-	Time lastNote = std::numeric_limits<int>::min();
+	const Time lastNote = Notes.GetLastTimePoint();
+
+	for (Column column = 0; column < Notes.GetColumnAmount(); ++column)
+		if (!Notes.GetColumn(column).empty())
+			firstNote = std::min(firstNote, Notes.GetColumn(column).front().TimePoint);
+
+	if (noteCount == 0 || lastNote <= firstNote) return 0.0f;
+
+	double seconds = double(lastNote - firstNote) / 1000.0;
+	return float(noteCount) / float(seconds);
+}
+
+float Chart::GetPeakNPS()
+{
+	// Densest 1s window, sliding rather than aligned to whole seconds
+	return float(_NoteDensity.GetPeakWindowNoteAmount()) * (1000.0f / float(PEAK_DENSITY_WINDOW));
+}
+
+const NoteDensity& Chart::GetNoteDensity() const
+{
+	return _NoteDensity;
+}
+
+double Chart::GetBeatFromTime(Time InTime)
+{
+	return GetTempoMap().GetBeatFromTime(InTime);
+}
+
+Time Chart::GetTimeFromBeat(double InBeat)
+{
+	return Time(std::round(GetTempoMap().GetTimeFromBeat(InBeat)));
+}
+
+const TempoMap& Chart::GetTempoMap()
+{
+	if(_TempoMapInvalidTimePoint == std::numeric_limits<Time>::max())
+		return _TempoMap;
+
+	Time timeFrom = _TempoMap.Truncate(_TempoMapInvalidTimePoint);
+
+	std::vector<BpmPoint> bpmPoints;
+	std::vector<StopPoint> stops;
+
+	//only the timeslices from the invalidated timepoint on have to be gathered again
+	for (auto timeSliceIt = TimeSlices.lower_bound(GetTimeSliceIndex(timeFrom)); timeSliceIt != TimeSlices.end(); ++timeSliceIt)
+	{
+		for (auto& bpmPoint : timeSliceIt->second.BpmPoints)
+			if (bpmPoint.TimePoint >= timeFrom)
+				bpmPoints.push_back(bpmPoint);
+
+		for (auto& stop : timeSliceIt->second.Stops)
+			if (stop.TimePoint >= timeFrom)
+				stops.push_back(stop);
+	}
+
+	_TempoMap.Append(std::move(bpmPoints), std::move(stops));
+	_TempoMapInvalidTimePoint = std::numeric_limits<Time>::max();
+
+	return _TempoMap;
+}
+
+void Chart::InvalidateTempoMap(const Time InTimeFrom)
+{
+	_TempoMapInvalidTimePoint = std::min(_TempoMapInvalidTimePoint, InTimeFrom);
+	_TimingChangeTimePoint = std::min(_TimingChangeTimePoint, InTimeFrom);
+	_DirtyTimeSlices.insert(GetTimeSliceIndex(InTimeFrom));
+	_TimingRevision = ++static_TimingRevisionCounter;
+	_IsScrollMapStale = true;
+
+	//bpm points and stops edited in place may have changed their order, they are sorted again on the next query
+	_BpmPointIndex.InvalidateOrder();
+	_StopIndex.InvalidateOrder();
+}
+
+const ScrollMap& Chart::GetScrollMap()
+{
+	if(!_IsScrollMapStale)
+		return _ScrollMap;
+
+	_ScrollMap.Build(GetTempoMap(), GetSVIndex().GetAll());
+	_IsScrollMapStale = false;
+
+	return _ScrollMap;
+}
+
+void Chart::InvalidateScrollMap()
+{
+	_IsScrollMapStale = true;
+}
+
+size_t Chart::GetTimingRevision() const
+{
+	return _TimingRevision;
+}
+
+bool Chart::TakeTimingChange(Time& OutTimeFrom)
+{
+	if (_TimingChangeTimePoint == std::numeric_limits<Time>::max())
+		return false;
+
+	OutTimeFrom = _TimingChangeTimePoint;
+	_TimingChangeTimePoint = std::numeric_limits<Time>::max();
+
+	return true;
+}
+
+void Chart::InvalidateTimingIndices()
+{
+	_BpmPointIndex.Invalidate();
+	_StopIndex.Invalidate();
+	_SvIndex.Invalidate();
+	_TimeSignatureIndex.Invalidate();
+
+	MarkTimingChanged();
+}
+
+void Chart::UpdateTimingIndices(TimeSlice& InTimeSlice)
+{
+	_BpmPointIndex.AssignTimeSlice(InTimeSlice.Index, InTimeSlice.BpmPoints);
+	_StopIndex.AssignTimeSlice(InTimeSlice.Index, InTimeSlice.Stops);
+	_SvIndex.AssignTimeSlice(InTimeSlice.Index, InTimeSlice.SvMultipliers);
+	_TimeSignatureIndex.AssignTimeSlice(InTimeSlice.Index, InTimeSlice.TimeSignatures);
+
+	MarkTimingChanged();
+}
+
+void Chart::MarkTimingChanged()
+{
+	_TimingRevision = ++static_TimingRevisionCounter;
+	_IsScrollMapStale = true;
+
+	CachedBpmPoints.clear();
+	CachedStops.clear();
+	CachedSVs.clear();
+	CachedTimeSignatures.clear();
+}
+
+template<typename T>
+static const TimingIndex<T>& RefreshTimingIndex(std::map<int, TimeSlice>& InTimeSlices, TimingIndex<T>& OutIndex, std::vector<T> TimeSlice::* InMember)
+{
+	if (!OutIndex.IsStale())
+	{
+		OutIndex.Reorder();
+		return OutIndex;
+	}
+
+	std::vector<T*> points;
+	std::vector<int> timeSliceIndices;
+
+	for (auto& [index, timeSlice] : InTimeSlices)
+	{
+		for (auto& point : timeSlice.*InMember)
+		{
+			points.push_back(&point);
+			timeSliceIndices.push_back(index);
+		}
+	}
+
+	OutIndex.Assign(std::move(points), std::move(timeSliceIndices));
+
+	return OutIndex;
+}
+
+const TimingIndex<BpmPoint>& Chart::GetBpmPointIndex()
+{
+	return RefreshTimingIndex(TimeSlices, _BpmPointIndex, &TimeSlice::BpmPoints);
+}
+
+const TimingIndex<StopPoint>& Chart::GetStopIndex()
+{
+	return RefreshTimingIndex(TimeSlices, _StopIndex, &TimeSlice::Stops);
+}
+
+const TimingIndex<ScrollVelocityMultiplier>& Chart::GetSVIndex()
+{
+	return RefreshTimingIndex(TimeSlices, _SvIndex, &TimeSlice::SvMultipliers);
+}
+
+const TimingIndex<TimeSignature>& Chart::GetTimeSignatureIndex()
+{
+	return RefreshTimingIndex(TimeSlices, _TimeSignatureIndex, &TimeSlice::TimeSignatures);
+}
+
+bool Chart::QuantizeNotes(NoteReferenceCollection& OutNotes, int Divisor)
+{
+	const TempoMap& tempoMap = GetTempoMap();
+
+	if (Divisor <= 0 || tempoMap.IsEmpty())
+		return false;
+
+	//the divisor splits every beat like the snap the beat lines are drawn with, so the grid does not depend on the time signatures
+	const double grid = 1.0 / double(Divisor);
+
+	//snaps within the beat grid of the bpm section the timepoint lies in. a section starting on a whole beat lines its grid up
+	//with the beats, so the position follows from the grid step alone, in 1 / divisor beats
+	auto quantizeTime = [&tempoMap, grid, Divisor](const Time InTime, BeatPosition& OutPosition)
+	{
+		const double sectionBeat = tempoMap.GetSectionBeat(InTime);
+		const long long gridStep = (long long)std::round((tempoMap.GetBeatFromTime(InTime) - sectionBeat) / grid);
+
+		const Time time = Time(std::round(tempoMap.GetTimeFromBeat(sectionBeat + gridStep * grid)));
+
+		if (std::abs(sectionBeat - std::round(sectionBeat)) < 0.000001)
+			OutPosition = MakeBeatPosition((long long)std::round(sectionBeat) * Divisor + gridStep, Divisor);
+		else
+			OutPosition = tempoMap.GetBeatPosition(time);
+
+		return time;
+	};
+
+	return TransformNotes(OutNotes, [&tempoMap, &quantizeTime, grid](Note& InOutNote, Column&)
+	{
+		InOutNote.TimePoint = quantizeTime(InOutNote.TimePoint, InOutNote.Position);
 
-	IterateAllNotes([&](Note& n, Column c) {
-		noteCount++;
-		firstNote = std::min(firstNote, n.TimePoint);
-		lastNote = std::max(lastNote, n.TimePoint);
-	});
+		if (!IsLongNoteBegin(InOutNote.Type))
+			return;
 
-	if (noteCount == 0 || lastNote <= firstNote) return 0.0f;
+		InOutNote.TimePointEnd = quantizeTime(InOutNote.TimePointEnd, InOutNote.PositionEnd);
 
-	double seconds = double(lastNote - firstNote) / 1000.0;
-	return float(noteCount) / float(seconds);
+		//a long note collapsing onto a single grid line keeps the length of one grid step
+		if (InOutNote.TimePointEnd <= InOutNote.TimePoint)
+		{
+			InOutNote.TimePointEnd = Time(std::round(tempoMap.GetTimeFromBeat(tempoMap.GetBeatFromTime(InOutNote.TimePoint) + grid)));
+			InOutNote.PositionEnd = tempoMap.GetBeatPosition(InOutNote.TimePointEnd);
+		}
+	});
 }
 
-float Chart::GetPeakNPS()
+bool Chart::ShuffleNotes(NoteReferenceCollection& OutNotes)
 {
-	std::vector<float> graph = CalculateNPSGraph(1000); // 1s window
-	float peak = 0.0f;
-	for (float v : graph) peak = std::max(peak, v);
-	return peak;
+	std::vector<Column> permutation(KeyAmount);
+	std::iota(permutation.begin(), permutation.end(), 0);
+
+	std::random_device randomDevice;
+	std::mt19937 generator(randomDevice());
+	std::shuffle(permutation.begin(), permutation.end(), generator);
+
+	return TransformNotes(OutNotes, [&permutation](Note&, Column& InOutColumn)
+	{
+		if (InOutColumn < permutation.size())
+			InOutColumn = permutation[InOutColumn];
+	});
 }
 
-double Chart::GetBeatFromTime(Time InTime)
+bool Chart::TransformNotes(NoteReferenceCollection& OutNotes, std::function<void(Note&, Column&)> InMapping)
 {
-	if (!_BpmPointCounter)
-		return 0.0;
+	if (!OutNotes.HasNotes)
+		return false;
 
-    std::vector<BpmPoint> points;
-    IterateAllBpmPoints([&](BpmPoint& b){ points.push_back(b); });
-    std::sort(points.begin(), points.end(), [](const BpmPoint& a, const BpmPoint& b){ return a.TimePoint < b.TimePoint; });
+	std::vector<std::pair<Column, Note>> erasures;
+	std::vector<std::pair<Column, Note>> insertions;
 
-    if (points.empty()) return 0.0;
+	Time timeBegin = std::numeric_limits<Time>::max();
+	Time timeEnd = std::numeric_limits<Time>::min();
 
-    // Check if before first point
-    if (InTime < points[0].TimePoint)
-    {
-        return -(double(points[0].TimePoint - InTime) / points[0].BeatLength);
-    }
+	auto widenRange = [&timeBegin, &timeEnd](const Time InTime)
+	{
+		timeBegin = std::min(timeBegin, InTime);
+		timeEnd = std::max(timeEnd, InTime);
+	};
 
-    double totalBeats = 0.0;
-    for (size_t i = 0; i < points.size(); ++i)
-    {
-        Time nextTime = (i + 1 < points.size()) ? points[i+1].TimePoint : std::numeric_limits<int>::max();
+	for (const auto& [column, note] : CollectSelection(OutNotes))
+	{
+		const Note* formerEnd = IsLongNoteBegin(note.Type) ? FindLongNotePartner(column, note) : nullptr;
 
-        if (InTime < nextTime)
-        {
-            double delta = InTime - points[i].TimePoint;
-            return totalBeats + delta / points[i].BeatLength;
-        }
+		erasures.push_back({ column, note });
+		widenRange(note.TimePoint);
 
-        double delta = nextTime - points[i].TimePoint;
-        totalBeats += delta / points[i].BeatLength;
-    }
+		if (formerEnd)
+		{
+			erasures.push_back({ column, *formerEnd });
+			widenRange(formerEnd->TimePoint);
+		}
 
-    return totalBeats;
-}
+		Note mappedNote = note;
+		Column mappedColumn = column;
 
-Time Chart::GetTimeFromBeat(double InBeat)
-{
-	return 0; // Not used directly in this simplified logic
-}
+		InMapping(mappedNote, mappedColumn);
 
-void Chart::QuantizeNotes(NoteReferenceCollection& OutNotes, int Divisor)
-{
-	if (!OutNotes.HasNotes || Divisor <= 0)
-		return;
+		if (mappedColumn >= Column(KeyAmount))
+			return false;
 
-	RegisterTimeSliceHistoryRanged(OutNotes.MinTimePoint, OutNotes.MaxTimePoint + TIMESLICE_LENGTH);
+		//a mapping placing the note on the grid sets its position itself, any other one leaves it to be found again
+		if (mappedNote.TimePoint != note.TimePoint)
+		{
+			mappedNote.BeatSnap = -1;
 
-	std::vector<std::pair<Column, Note>> quantizedNotes;
+			if (mappedNote.Position == note.Position)
+				mappedNote.Position = BeatPosition();
+		}
 
-	for (auto& [column, notes] : OutNotes.Notes)
-	{
-		std::vector<Note> copiedNotes;
-		for (auto& notePtr : notes)
-			copiedNotes.push_back(*notePtr);
+		if (mappedNote.TimePointEnd != note.TimePointEnd && mappedNote.PositionEnd == note.PositionEnd)
+			mappedNote.PositionEnd = BeatPosition();
 
-		for (auto& note : copiedNotes)
+		if (!IsLongNoteBegin(mappedNote.Type))
 		{
-			RemoveNote(note.TimePoint, column, false, true, true);
+			mappedNote.TimePointBegin = -1;
+			mappedNote.TimePointEnd = -1;
+			mappedNote.PositionEnd = BeatPosition();
 
-			// Find BPM point
-			BpmPoint* bpm = GetPreviousBpmPointFromTimePoint(note.TimePoint);
-			if (!bpm) bpm = GetNextBpmPointFromTimePoint(-1000000);
+			insertions.push_back({ mappedColumn, mappedNote });
+			widenRange(mappedNote.TimePoint);
 
-			if (bpm)
-			{
-				double beatLen = bpm->BeatLength;
-				double timeDelta = double(note.TimePoint - bpm->TimePoint);
-				double beat = timeDelta / beatLen;
-
-				// Snap beat
-                double grid = 4.0 / double(Divisor);
-				double snappedBeat = std::round(beat / grid) * grid;
-
-				Time newTime = bpm->TimePoint + Time(snappedBeat * beatLen);
-				note.TimePoint = newTime;
-
-				note.BeatSnap = -1;
-
-				if (note.Type == Note::EType::HoldBegin || note.Type == Note::EType::RollBegin)
-				{
-					// Recalculate for end
-					BpmPoint* bpmEnd = GetPreviousBpmPointFromTimePoint(note.TimePointEnd);
-					if (!bpmEnd) bpmEnd = GetNextBpmPointFromTimePoint(-1000000);
-
-					if (bpmEnd)
-					{
-						double beatLenEnd = bpmEnd->BeatLength;
-						double timeDeltaEnd = double(note.TimePointEnd - bpmEnd->TimePoint);
-						double beatEnd = timeDeltaEnd / beatLenEnd;
-                        double gridEnd = 4.0 / double(Divisor);
-						double snappedBeatEnd = std::round(beatEnd / gridEnd) * gridEnd;
-						note.TimePointEnd = bpmEnd->TimePoint + Time(snappedBeatEnd * beatLenEnd);
-					}
-
-					// Safety: End > Start
-					if (note.TimePointEnd <= note.TimePoint)
-						note.TimePointEnd = note.TimePoint + Time(bpm->BeatLength * (4.0 / Divisor)); // min length
-				}
-			}
-
-			quantizedNotes.push_back({column, note});
+			continue;
 		}
-	}
 
-	BulkPlaceNotes(quantizedNotes, true, true);
+		if (mappedNote.TimePointEnd <= mappedNote.TimePoint)
+			return false;
 
-	IterateTimeSlicesInTimeRange(OutNotes.MinTimePoint, OutNotes.MaxTimePoint + TIMESLICE_LENGTH, [this](TimeSlice& InTimeSlice)
-	{
-		_OnModified(InTimeSlice);
-	});
+		mappedNote.TimePointBegin = mappedNote.TimePoint;
 
-	OutNotes.Clear();
-}
+		//the end keeps its handle and snap where it can, a note turned into a long note gets a new one
+		Note mappedEnd = mappedNote;
+		mappedEnd.Type = mappedNote.Type == Note::EType::HoldBegin ? Note::EType::HoldEnd : Note::EType::RollEnd;
+		mappedEnd.TimePoint = mappedNote.TimePointEnd;
+		mappedEnd.Handle = formerEnd ? formerEnd->Handle : NoteHandle();
+		mappedEnd.BeatSnap = formerEnd && formerEnd->TimePoint == mappedEnd.TimePoint ? formerEnd->BeatSnap : -1;
+		mappedEnd.Position = mappedNote.PositionEnd;
+		mappedEnd.PositionEnd = mappedNote.PositionEnd;
 
-void Chart::ShuffleNotes(NoteReferenceCollection& OutNotes)
-{
-	if (!OutNotes.HasNotes)
-		return;
+		insertions.push_back({ mappedColumn, mappedNote });
+		insertions.push_back({ mappedColumn, mappedEnd });
+		widenRange(mappedNote.TimePoint);
+		widenRange(mappedEnd.TimePoint);
+	}
 
-	RegisterTimeSliceHistoryRanged(OutNotes.MinTimePoint, OutNotes.MaxTimePoint + TIMESLICE_LENGTH);
+	if (insertions.empty() || HasBatchCollision(erasures, insertions))
+		return false;
 
-	// Generate permutation
-	std::vector<int> p(KeyAmount);
-	std::iota(p.begin(), p.end(), 0);
+	std::vector<NoteHandle> erasedHandles;
+	erasedHandles.reserve(erasures.size());
 
-	std::random_device rd;
-	std::mt19937 g(rd());
-	std::shuffle(p.begin(), p.end(), g);
+	BeginTransaction();
 
-	std::vector<std::pair<Column, Note>> shuffledNotes;
+	for (const auto& [column, note] : erasures)
+		erasedHandles.push_back(note.Handle);
 
-	for (auto& [column, notes] : OutNotes.Notes)
-	{
-		Column newColumn = p[column];
+	JournalNotes(false, erasures);
 
-		std::vector<Note> copiedNotes;
-		for (auto& notePtr : notes)
-			copiedNotes.push_back(*notePtr);
+	//journaled once the store has handed out the handles, so undo and redo bring them back
+	Notes.ApplyBatch(erasedHandles, insertions);
 
-		for (auto& note : copiedNotes)
-		{
-			RemoveNote(note.TimePoint, column, false, true, true);
-			shuffledNotes.push_back({newColumn, note});
-		}
-	}
+	JournalNotes(true, insertions);
 
-	BulkPlaceNotes(shuffledNotes, true, true);
+	Commit();
 
-	IterateTimeSlicesInTimeRange(OutNotes.MinTimePoint, OutNotes.MaxTimePoint + TIMESLICE_LENGTH, [this](TimeSlice& InTimeSlice)
-	{
-		_OnModified(InTimeSlice);
-	});
+	NotifyModified(timeBegin, timeEnd);
 
+	//the begins kept their handles, so the selection follows the transformed notes
 	OutNotes.Clear();
+
+	for (const auto& [column, note] : insertions)
+		if (!IsLongNoteEnd(note.Type))
+			OutNotes.PushNote(column, *Notes.Resolve(note.Handle));
+
+	return true;
 }
 
-bool Chart::RemoveNote(const Time InTime, const Column InColumn, const bool InIgnoreHoldChecks, const bool InSkipHistoryRegistering, const bool InSkipOnModified)
+bool Chart::RemoveNote(const Time InTime, const Column InColumn, const bool InIgnoreHoldChecks, const bool InSkipOnModified)
 {
-	auto &timeSlice = FindOrAddTimeSlice(InTime);
-	auto &noteCollection = timeSlice.Notes[InColumn];
-
-	auto noteIt = std::find_if(noteCollection.begin(), noteCollection.end(), [InTime](const Note &InNote)
-							   { return InNote.TimePoint == InTime; });
+	Note* note = Notes.Find(InTime, InColumn);
 
-	if (noteIt == noteCollection.end())
+	if (!note)
 		return false;
 
+	BeginTransaction();
+
 	//hold checks
-	if (InIgnoreHoldChecks == false && (noteIt->Type == Note::EType::HoldBegin || noteIt->Type == Note::EType::HoldEnd ||
-                                        noteIt->Type == Note::EType::RollBegin || noteIt->Type == Note::EType::RollEnd))
+	if (InIgnoreHoldChecks == false && (note->Type == Note::EType::HoldBegin || note->Type == Note::EType::HoldEnd ||
+                                        note->Type == Note::EType::RollBegin || note->Type == Note::EType::RollEnd))
 	{
-		Time holdTimeBegin = noteIt->TimePointBegin;
-		Time holdTimedEnd = noteIt->TimePointEnd;
-
-		if (!InSkipHistoryRegistering)
-			RegisterTimeSliceHistoryRanged(holdTimeBegin, holdTimedEnd);
+		Time holdTimeBegin = note->TimePointBegin;
+		Time holdTimedEnd = note->TimePointEnd;
 
-		//removes all intermidiate notes
-		for (Time time = FindOrAddTimeSlice(holdTimeBegin).TimePoint + TIMESLICE_LENGTH;
-			 time <= FindOrAddTimeSlice(holdTimedEnd).TimePoint - TIMESLICE_LENGTH;
-			 time += TIMESLICE_LENGTH)
+		//removes the begin and the end in one sweep over the hold's range
+		Notes.EraseInTimeRange(holdTimeBegin, holdTimedEnd, InColumn, [this, InColumn, holdTimeBegin, holdTimedEnd](const Note& InNote)
 		{
-			RemoveNote(time, InColumn, true);
-		}
+			if (!IsLongNoteType(InNote.Type) || InNote.TimePointBegin != holdTimeBegin || InNote.TimePointEnd != holdTimedEnd)
+				return false;
 
-		RemoveNote(holdTimeBegin, InColumn, true);
-		RemoveNote(holdTimedEnd, InColumn, true);
-	}
-	else
-	{
-		if (!InIgnoreHoldChecks && !InSkipHistoryRegistering)
-			RegisterTimeSliceHistory(InTime);
+			JournalNote(false, InColumn, InNote);
+
+			return true;
+		});
+
+		Commit();
 
-		noteCollection.erase(noteIt);
+		if(!InSkipOnModified)
+			NotifyModified(holdTimeBegin, holdTimedEnd);
+
+		return true;
 	}
 
+	JournalNote(false, InColumn, *note);
+
+	Notes.Erase(InTime, InColumn);
+
+	Commit();
+
 	if(!InSkipOnModified)
-		_OnModified(timeSlice);
+		NotifyModified(InTime, InTime);
 
 	return true;
 }
 
-bool Chart::RemoveBpmPoint(BpmPoint &InBpmPoint, const bool InSkipHistoryRegistering)
+bool Chart::RemoveBpmPoint(BpmPoint &InBpmPoint)
 {
-	auto &timeSlice = FindOrAddTimeSlice(InBpmPoint.TimePoint);
-	auto &bpmCollection = timeSlice.BpmPoints;
+	TimeSlice* timeSlice = FindTimeSlice(InBpmPoint.TimePoint);
+
+	if (!timeSlice)
+		return false;
+
+	auto &bpmCollection = timeSlice->BpmPoints;
+
+	BeginTransaction();
+	JournalTimingChange(InBpmPoint.TimePoint);
 
-	if (!InSkipHistoryRegistering)
-		RegisterTimeSliceHistory(InBpmPoint.TimePoint);
+	InvalidateTempoMap(InBpmPoint.TimePoint);
 
 	bpmCollection.erase(std::remove(bpmCollection.begin(), bpmCollection.end(), InBpmPoint), bpmCollection.end());
 
-	CachedBpmPoints.clear();
+	UpdateTimingIndices(*timeSlice);
 
 	_BpmPointCounter--;
 
+	Commit();
+
 	return true;
 }
 
-bool Chart::BulkRemoveNotes(NoteReferenceCollection& InNotes, const bool InSkipHistoryRegistering)
+bool Chart::BulkRemoveNotes(NoteReferenceCollection& InNotes)
 {
-	if (!InSkipHistoryRegistering)
-		RegisterTimeSliceHistoryRanged(InNotes.MinTimePoint, InNotes.MaxTimePoint);
+	std::vector<NoteHandle> erasedHandles;
+
+	Time timeBegin = std::numeric_limits<Time>::max();
+	Time timeEnd = std::numeric_limits<Time>::min();
+
+	BeginTransaction();
 
-	for (auto& [column, notes] : InNotes.Notes)
+	for (const auto& [column, note] : CollectSelection(InNotes))
 	{
-		Column newColumn = (KeyAmount - 1) - column;
+		JournalNote(false, column, note);
+		erasedHandles.push_back(note.Handle);
 
-		//this is neccesary since removing an element form a vector will change the contents of a pointer pointing to that element
-		std::vector<Note> copiedNotes;
-		for (auto &note : notes)
-			copiedNotes.push_back(*note);
+		timeBegin = std::min(timeBegin, note.TimePoint);
+		timeEnd = std::max(timeEnd, note.TimePoint);
 
-		for (auto &note : copiedNotes)
-			RemoveNote(note.TimePoint, column, false, true, true);
+		if (const Note* end = IsLongNoteBegin(note.Type) ? FindLongNotePartner(column, note) : nullptr)
+		{
+			JournalNote(false, column, *end);
+			erasedHandles.push_back(end->Handle);
+
+			timeEnd = std::max(timeEnd, end->TimePoint);
+		}
 	}
 
-	IterateTimeSlicesInTimeRange(InNotes.MinTimePoint, InNotes.MaxTimePoint, [this](TimeSlice& InTimeSlice)
-	{
-		_OnModified(InTimeSlice);
-	});
+	Notes.Erase(erasedHandles);
+
+	Commit();
+
+	if (!erasedHandles.empty())
+		NotifyModified(timeBegin, timeEnd);
 
 	InNotes.Clear();
 
@@ -985,8 +1156,6 @@ bool Chart::BulkRemoveNotes(NoteReferenceCollection& InNotes, const bool InSkipH
 
 Note &Chart::InjectNote(const Time InTime, const Column InColumn, const Note::EType InNoteType, const Time InTimeBegin, const Time InTimeEnd, const int InBeatSnap, const bool InSkipOnModified)
 {
-	auto &timeSlice = FindOrAddTimeSlice(InTime);
-
 	Note note;
 	note.Type = InNoteType;
 	note.TimePoint = InTime;
@@ -995,57 +1164,40 @@ Note &Chart::InjectNote(const Time InTime, const Column InColumn, const Note::ET
 	note.TimePointBegin = InTimeBegin;
 	note.TimePointEnd = InTimeEnd;
 
-	timeSlice.Notes[InColumn].push_back(note);
-	Note &injectedNoteRef = timeSlice.Notes[InColumn].back();
+	Note &injectedNoteRef = Notes.Insert(InColumn, note);
 
-	std::sort(timeSlice.Notes[InColumn].begin(), timeSlice.Notes[InColumn].end(), [](const auto &lhs, const auto &rhs)
-			  { return (lhs.TimePoint < rhs.TimePoint); });
+	JournalNote(true, InColumn, injectedNoteRef);
 
 	if(!InSkipOnModified)
-		_OnModified(timeSlice);
+		NotifyModified(InTime, InTime);
 
 	return injectedNoteRef;
 }
 
 Note &Chart::InjectHold(const Time InTimeBegin, const Time InTimeEnd, const Column InColumn, const int InBeatSnapBegin, const int InBeatSnapEnd, const bool InSkipOnModified)
 {
-	Note &noteToReturn = InjectNote(InTimeBegin, InColumn, Note::EType::HoldBegin, InTimeBegin, InTimeEnd, InBeatSnapBegin);
-
-	Time startTime = FindOrAddTimeSlice(InTimeBegin).TimePoint + TIMESLICE_LENGTH;
-	Time endTime = FindOrAddTimeSlice(InTimeEnd).TimePoint - TIMESLICE_LENGTH;
-
-	for (Time time = startTime; time <= endTime; time += TIMESLICE_LENGTH)
-	{
-		InjectNote(time, InColumn, Note::EType::HoldIntermediate, InTimeBegin, InTimeEnd);
-	}
+	InjectNote(InTimeBegin, InColumn, Note::EType::HoldBegin, InTimeBegin, InTimeEnd, InBeatSnapBegin, InSkipOnModified);
 
-	if(!InSkipOnModified)
-		InjectNote(InTimeEnd, InColumn, Note::EType::HoldEnd, InTimeBegin, InTimeEnd, InBeatSnapEnd);
+	InjectNote(InTimeEnd, InColumn, Note::EType::HoldEnd, InTimeBegin, InTimeEnd, InBeatSnapEnd, InSkipOnModified);
 
-	return noteToReturn;
+	//injecting the end shifts the column, so the begin is looked up once both are in place
+	return *Notes.Find(InTimeBegin, InColumn);
 }
 
 Note &Chart::InjectRoll(const Time InTimeBegin, const Time InTimeEnd, const Column InColumn, const int InBeatSnapBegin, const int InBeatSnapEnd, const bool InSkipOnModified)
 {
-	Note &noteToReturn = InjectNote(InTimeBegin, InColumn, Note::EType::RollBegin, InTimeBegin, InTimeEnd, InBeatSnapBegin);
-
-	Time startTime = FindOrAddTimeSlice(InTimeBegin).TimePoint + TIMESLICE_LENGTH;
-	Time endTime = FindOrAddTimeSlice(InTimeEnd).TimePoint - TIMESLICE_LENGTH;
+	InjectNote(InTimeBegin, InColumn, Note::EType::RollBegin, InTimeBegin, InTimeEnd, InBeatSnapBegin, InSkipOnModified);
 
-	for (Time time = startTime; time <= endTime; time += TIMESLICE_LENGTH)
-	{
-		InjectNote(time, InColumn, Note::EType::RollIntermediate, InTimeBegin, InTimeEnd);
-	}
-
-	if(!InSkipOnModified)
-		InjectNote(InTimeEnd, InColumn, Note::EType::RollEnd, InTimeBegin, InTimeEnd, InBeatSnapEnd);
+	InjectNote(InTimeEnd, InColumn, Note::EType::RollEnd, InTimeBegin, InTimeEnd, InBeatSnapEnd, InSkipOnModified);
 
-	return noteToReturn;
+	//injecting the end shifts the column, so the begin is looked up once both are in place
+	return *Notes.Find(InTimeBegin, InColumn);
 }
 
 BpmPoint *Chart::InjectBpmPoint(const Time InTime, const double InBpm, const double InBeatLength)
 {
 	auto &timeSlice = FindOrAddTimeSlice(InTime);
+	JournalTimingChange(InTime);
 
 	BpmPoint bpmPoint;
 	bpmPoint.TimePoint = InTime;
@@ -1059,6 +1211,10 @@ BpmPoint *Chart::InjectBpmPoint(const Time InTime, const double InBpm, const dou
 	std::sort(timeSlice.BpmPoints.begin(), timeSlice.BpmPoints.end(), [](const auto &lhs, const auto &rhs)
 			  { return lhs.TimePoint < rhs.TimePoint; });
 
+	UpdateTimingIndices(timeSlice);
+
+	InvalidateTempoMap(InTime);
+
 	_BpmPointCounter++;
 
 	return bpmPointPtr;
@@ -1067,6 +1223,7 @@ BpmPoint *Chart::InjectBpmPoint(const Time InTime, const double InBpm, const dou
 StopPoint* Chart::InjectStop(const Time InTime, const double Length)
 {
 	auto &timeSlice = FindOrAddTimeSlice(InTime);
+	JournalTimingChange(InTime);
 
 	StopPoint stop;
 	stop.TimePoint = InTime;
@@ -1079,12 +1236,17 @@ StopPoint* Chart::InjectStop(const Time InTime, const double Length)
 	std::sort(timeSlice.Stops.begin(), timeSlice.Stops.end(), [](const auto &lhs, const auto &rhs)
 			  { return lhs.TimePoint < rhs.TimePoint; });
 
+	UpdateTimingIndices(timeSlice);
+
+	InvalidateTempoMap(InTime);
+
 	return stopPtr;
 }
 
 ScrollVelocityMultiplier* Chart::InjectSV(const Time InTime, const double Multiplier)
 {
 	auto &timeSlice = FindOrAddTimeSlice(InTime);
+	JournalTimingChange(InTime);
 
 	ScrollVelocityMultiplier sv;
 	sv.TimePoint = InTime;
@@ -1097,12 +1259,15 @@ ScrollVelocityMultiplier* Chart::InjectSV(const Time InTime, const double Multip
 	std::sort(timeSlice.SvMultipliers.begin(), timeSlice.SvMultipliers.end(), [](const auto &lhs, const auto &rhs)
 			  { return lhs.TimePoint < rhs.TimePoint; });
 
+	UpdateTimingIndices(timeSlice);
+
 	return svPtr;
 }
 
 TimeSignature* Chart::InjectTimeSignature(const Time InTime, const int Numerator, const int Denominator)
 {
     auto &timeSlice = FindOrAddTimeSlice(InTime);
+    JournalTimingChange(InTime);
 
     TimeSignature ts;
     ts.TimePoint = InTime;
@@ -1116,6 +1281,8 @@ TimeSignature* Chart::InjectTimeSignature(const Time InTime, const int Numerator
     std::sort(timeSlice.TimeSignatures.begin(), timeSlice.TimeSignatures.end(), [](const auto &lhs, const auto &rhs)
               { return lhs.TimePoint < rhs.TimePoint; });
 
+    UpdateTimingIndices(timeSlice);
+
     return tsPtr;
 }
 
@@ -1123,24 +1290,37 @@ StopPoint* Chart::MoveStop(StopPoint& InStop, const Time NewTime)
 {
     StopPoint stop = InStop;
 
-    RegisterTimeSliceHistoryRanged(stop.TimePoint, NewTime);
+    BeginTransaction();
+
+    RemoveStop(InStop);
+    StopPoint* movedStop = InjectStop(NewTime, stop.Length);
+
+    Commit();
 
-    RemoveStop(InStop, true);
-    return InjectStop(NewTime, stop.Length);
+    return movedStop;
 }
 
 ScrollVelocityMultiplier* Chart::MoveSV(ScrollVelocityMultiplier& InSV, const Time NewTime)
 {
     ScrollVelocityMultiplier sv = InSV;
-    RegisterTimeSliceHistoryRanged(sv.TimePoint, NewTime);
-    RemoveSV(InSV, true);
-    return InjectSV(NewTime, sv.Multiplier);
+
+    BeginTransaction();
+
+    RemoveSV(InSV);
+    ScrollVelocityMultiplier* movedSV = InjectSV(NewTime, sv.Multiplier);
+
+    Commit();
+
+    return movedSV;
 }
 
 Note *Chart::MoveNote(const Time InTimeFrom, const Time InTimeTo, const Column InColumnFrom, const Column InColumnTo, const int InNewBeatSnap)
 {
 	//have I mentioned that I really dislike handling edge-cases?
 	Note noteToRemove = *FindNote(InTimeFrom, InColumnFrom);
+	Note* movedNote = nullptr;
+
+	BeginTransaction();
 
 	switch (noteToRemove.Type)
 	{
@@ -1149,91 +1329,357 @@ Note *Chart::MoveNote(const Time InTimeFrom, const Time InTimeTo, const Column I
     case Note::EType::Lift:
     case Note::EType::Fake:
 	{
-		auto &timeSliceFrom = FindOrAddTimeSlice(InTimeFrom);
-		auto &timeSliceTo = FindOrAddTimeSlice(InTimeTo);
-
-		if (timeSliceFrom.Index == timeSliceTo.Index)
-			RegisterTimeSliceHistory(InTimeFrom);
-		else
-			RegisterTimeSliceHistoryRanged(InTimeFrom, InTimeTo);
+		//single notes are moved in place and keep their handle
+		Note movedValue = noteToRemove;
+		movedValue.TimePoint = InTimeTo;
+		movedValue.BeatSnap = InNewBeatSnap;
+		movedValue.Position = BeatPosition();
 
-		RemoveNote(InTimeFrom, InColumnFrom, false, true);
-		return &(InjectNote(InTimeTo, InColumnTo, noteToRemove.Type, -1, -1, InNewBeatSnap));
+		movedNote = UpdateNote(noteToRemove.Handle, InColumnTo, movedValue);
 	}
 	break;
 
 	case Note::EType::HoldBegin:
 	{
-		if (InTimeTo < noteToRemove.TimePointBegin)
-			RegisterTimeSliceHistoryRanged(InTimeTo - TIMESLICE_LENGTH, noteToRemove.TimePointEnd);
-		else
-			RegisterTimeSliceHistoryRanged(noteToRemove.TimePointBegin - TIMESLICE_LENGTH, noteToRemove.TimePointEnd);
+		RemoveNote(InTimeFrom, InColumnFrom);
 
-		RemoveNote(InTimeFrom, InColumnFrom, false, true);
-
-		return &(InjectHold(InTimeTo, noteToRemove.TimePointEnd, InColumnTo, InNewBeatSnap));
+		movedNote = &(InjectHold(InTimeTo, noteToRemove.TimePointEnd, InColumnTo, InNewBeatSnap));
 	}
 	break;
 	case Note::EType::HoldEnd:
 	{
-		if (InTimeTo > noteToRemove.TimePointBegin)
-			RegisterTimeSliceHistoryRanged(noteToRemove.TimePointBegin, InTimeTo + TIMESLICE_LENGTH);
-		else
-			RegisterTimeSliceHistoryRanged(noteToRemove.TimePointBegin, noteToRemove.TimePointEnd + TIMESLICE_LENGTH);
-
 		int beatSnap = FindNote(noteToRemove.TimePointBegin, InColumnFrom)->BeatSnap;
 
-		RemoveNote(InTimeFrom, InColumnFrom, false, true);
+		RemoveNote(InTimeFrom, InColumnFrom);
 
-		return &(InjectHold(noteToRemove.TimePointBegin, InTimeTo, InColumnTo, beatSnap));
+		movedNote = &(InjectHold(noteToRemove.TimePointBegin, InTimeTo, InColumnTo, beatSnap));
 	}
 	break;
 
     case Note::EType::RollBegin:
 	{
-		if (InTimeTo < noteToRemove.TimePointBegin)
-			RegisterTimeSliceHistoryRanged(InTimeTo - TIMESLICE_LENGTH, noteToRemove.TimePointEnd);
-		else
-			RegisterTimeSliceHistoryRanged(noteToRemove.TimePointBegin - TIMESLICE_LENGTH, noteToRemove.TimePointEnd);
+		RemoveNote(InTimeFrom, InColumnFrom);
 
-		RemoveNote(InTimeFrom, InColumnFrom, false, true);
-
-		return &(InjectRoll(InTimeTo, noteToRemove.TimePointEnd, InColumnTo, InNewBeatSnap));
+		movedNote = &(InjectRoll(InTimeTo, noteToRemove.TimePointEnd, InColumnTo, InNewBeatSnap));
 	}
 	break;
 	case Note::EType::RollEnd:
 	{
-		if (InTimeTo > noteToRemove.TimePointBegin)
-			RegisterTimeSliceHistoryRanged(noteToRemove.TimePointBegin, InTimeTo + TIMESLICE_LENGTH);
-		else
-			RegisterTimeSliceHistoryRanged(noteToRemove.TimePointBegin, noteToRemove.TimePointEnd + TIMESLICE_LENGTH);
-
 		int beatSnap = FindNote(noteToRemove.TimePointBegin, InColumnFrom)->BeatSnap;
 
-		RemoveNote(InTimeFrom, InColumnFrom, false, true);
+		RemoveNote(InTimeFrom, InColumnFrom);
 
-		return &(InjectRoll(noteToRemove.TimePointBegin, InTimeTo, InColumnTo, beatSnap));
+		movedNote = &(InjectRoll(noteToRemove.TimePointBegin, InTimeTo, InColumnTo, beatSnap));
 	}
 	break;
 
 	default:
-		return nullptr;
 		break;
 	}
-}
 
-Note *Chart::FindNote(const Time InTime, const Column InColumn)
-{
-	auto &timeSlice = FindOrAddTimeSlice(InTime);
-	auto &noteCollection = timeSlice.Notes[InColumn];
+	Commit();
+
+	return movedNote;
+}
+
+Note *Chart::FindNote(const Time InTime, const Column InColumn)
+{
+	return Notes.Find(InTime, InColumn);
+}
+
+const Note *Chart::FindNote(const Time InTime, const Column InColumn) const
+{
+	return Notes.Find(InTime, InColumn);
+}
+
+Note *Chart::ResolveNote(const NoteHandle InHandle)
+{
+	return Notes.Resolve(InHandle);
+}
+
+Note *Chart::ResolveNote(const NoteHandle InHandle, Column& OutColumn)
+{
+	return Notes.Resolve(InHandle, OutColumn);
+}
+
+Note *Chart::UpdateNote(const NoteHandle InHandle, const Column InColumn, const Note& InNote)
+{
+	Column formerColumn;
+	Note* note = Notes.Resolve(InHandle, formerColumn);
+
+	if (!note)
+		return nullptr;
+
+	const Time formerTime = note->TimePoint;
+
+	BeginTransaction();
+
+	JournalNote(false, formerColumn, *note);
+
+	Note* updatedNote = Notes.Update(InHandle, InColumn, InNote);
+
+	JournalNote(true, InColumn, *updatedNote);
+
+	Commit();
+
+	NotifyModified(formerTime, formerTime);
+
+	if (GetTimeSliceIndex(formerTime) != GetTimeSliceIndex(InNote.TimePoint))
+		NotifyModified(InNote.TimePoint, InNote.TimePoint);
+
+	return updatedNote;
+}
+
+std::vector<std::pair<Column, Note>> Chart::CollectSelection(const NoteReferenceCollection& InNotes)
+{
+	std::vector<std::pair<Column, Note>> selection;
+	std::unordered_set<NoteHandle, NoteHandleHash> collectedHandles;
+
+	InNotes.IterateHandles([this, &selection, &collectedHandles](const Column InColumn, const NoteHandle InHandle)
+	{
+		const Note* note = Notes.Resolve(InHandle);
+
+		//a selected end stands for its whole long note
+		if (note && IsLongNoteEnd(note->Type))
+			note = FindLongNotePartner(InColumn, *note);
+
+		if (note && collectedHandles.insert(note->Handle).second)
+			selection.push_back({ InColumn, *note });
+	});
+
+	return selection;
+}
+
+Note* Chart::FindLongNotePartner(const Column InColumn, const Note& InNote)
+{
+	if (InColumn >= Notes.GetColumnAmount())
+		return nullptr;
+
+	const bool isBegin = IsLongNoteBegin(InNote.Type);
+	const Time partnerTime = isBegin ? InNote.TimePointEnd : InNote.TimePointBegin;
+
+	auto& notes = Notes.GetColumn(InColumn);
+
+	for (size_t index = Notes.LowerBound(partnerTime, InColumn); index < notes.size() && notes[index].TimePoint == partnerTime; ++index)
+	{
+		Note& partner = notes[index];
+
+		if ((isBegin ? IsLongNoteEnd(partner.Type) : IsLongNoteBegin(partner.Type)) && partner.TimePointBegin == InNote.TimePointBegin && partner.TimePointEnd == InNote.TimePointEnd)
+			return &partner;
+	}
+
+	return nullptr;
+}
+
+bool Chart::HasBatchCollision(const std::vector<std::pair<Column, Note>>& InErasures, const std::vector<std::pair<Column, Note>>& InInsertions)
+{
+	std::unordered_set<NoteHandle, NoteHandleHash> erasedHandles;
+
+	for (const auto& [column, note] : InErasures)
+		erasedHandles.insert(note.Handle);
+
+	std::map<Column, std::vector<const Note*>> insertionsPerColumn;
+
+	for (const auto& [column, note] : InInsertions)
+		insertionsPerColumn[column].push_back(&note);
+
+	auto isEarlier = [](const Note* lhs, const Note* rhs) { return lhs->TimePoint < rhs->TimePoint; };
+
+	//a long note's end may share its timepoint with the begin of the next one, anything else on the same timepoint collides
+	auto isColliding = [](const Note* lhs, const Note* rhs)
+	{
+		return !(IsLongNoteEnd(lhs->Type) && IsLongNoteBegin(rhs->Type)) && !(IsLongNoteBegin(lhs->Type) && IsLongNoteEnd(rhs->Type));
+	};
+
+	for (auto& [column, insertedNotes] : insertionsPerColumn)
+	{
+		std::sort(insertedNotes.begin(), insertedNotes.end(), isEarlier);
+
+		std::vector<const Note*> keptNotes;
+
+		if (column < Notes.GetColumnAmount())
+			for (const Note& note : Notes.GetColumn(column))
+				if (!erasedHandles.count(note.Handle))
+					keptNotes.push_back(&note);
+
+		std::vector<const Note*> mergedNotes;
+		mergedNotes.reserve(keptNotes.size() + insertedNotes.size());
+
+		std::merge(keptNotes.begin(), keptNotes.end(), insertedNotes.begin(), insertedNotes.end(), std::back_inserter(mergedNotes), isEarlier);
+
+		for (size_t index = 0; index < mergedNotes.size(); ++index)
+			for (size_t otherIndex = index + 1; otherIndex < mergedNotes.size() && mergedNotes[otherIndex]->TimePoint == mergedNotes[index]->TimePoint; ++otherIndex)
+				if (isColliding(mergedNotes[index], mergedNotes[otherIndex]))
+					return true;
+	}
+
+	return false;
+}
+
+bool Chart::RemapTimePoints(const Time InTimeFrom, const std::vector<Time>& InFixedTimePoints, std::function<Time(const Time)> InMapping)
+{
+	Time timeBegin = std::numeric_limits<Time>::max();
+	Time timeEnd = std::numeric_limits<Time>::min();
+
+	auto remap = [&InTimeFrom, &InMapping, &timeBegin, &timeEnd](const Time InTime)
+	{
+		if (InTime < InTimeFrom)
+			return InTime;
+
+		const Time remappedTime = InMapping(InTime);
+
+		timeBegin = std::min({ timeBegin, InTime, remappedTime });
+		timeEnd = std::max({ timeEnd, InTime, remappedTime });
+
+		return remappedTime;
+	};
+
+	auto remapNote = [&remap](Note InNote)
+	{
+		InNote.TimePoint = remap(InNote.TimePoint);
+
+		if (IsLongNoteType(InNote.Type))
+		{
+			InNote.TimePointBegin = remap(InNote.TimePointBegin);
+			InNote.TimePointEnd = remap(InNote.TimePointEnd);
+		}
+
+		return InNote;
+	};
+
+	auto isStackable = [](const Note::EType InType, const Note::EType InOtherType)
+	{
+		return (IsLongNoteEnd(InType) && IsLongNoteBegin(InOtherType)) || (IsLongNoteBegin(InType) && IsLongNoteEnd(InOtherType));
+	};
+
+	std::vector<std::pair<Column, Note>> formerNotes;
+	std::vector<std::pair<Column, Note>> remappedNotes;
+
+	auto pushIfRemapped = [&formerNotes, &remappedNotes](const Column InColumn, const Note& InNote, const Note& InRemappedNote)
+	{
+		if (InRemappedNote.TimePoint == InNote.TimePoint && InRemappedNote.TimePointBegin == InNote.TimePointBegin && InRemappedNote.TimePointEnd == InNote.TimePointEnd)
+			return;
+
+		formerNotes.push_back({ InColumn, InNote });
+		remappedNotes.push_back({ InColumn, InRemappedNote });
+	};
+
+	//the notes are checked first, a mapping pulling one onto or past its neighbour leaves the chart untouched
+	for (Column column = 0; column < Notes.GetColumnAmount(); ++column)
+	{
+		auto& notes = Notes.GetColumn(column);
+		size_t index = Notes.LowerBound(InTimeFrom, column);
+
+		const Note* previousNote = index > 0 ? &notes[index - 1] : nullptr;
+		Time previousTime = previousNote ? previousNote->TimePoint : 0;
+
+		for (; index < notes.size(); ++index)
+		{
+			const Note& note = notes[index];
+			const Note remappedNote = remapNote(note);
+
+			if (previousNote && (remappedNote.TimePoint < previousTime || (remappedNote.TimePoint == previousTime && !isStackable(previousNote->Type, note.Type))))
+				return false;
+
+			if (IsLongNoteType(note.Type) && remappedNote.TimePointEnd <= remappedNote.TimePointBegin)
+				return false;
+
+			//a long note reaching into the range from before it has its end moved alone
+			if (IsLongNoteEnd(note.Type) && note.TimePointBegin < InTimeFrom)
+				if (const Note* noteBegin = FindLongNotePartner(column, note))
+					pushIfRemapped(column, *noteBegin, remapNote(*noteBegin));
+
+			pushIfRemapped(column, note, remappedNote);
+
+			previousNote = &note;
+			previousTime = remappedNote.TimePoint;
+		}
+	}
+
+	auto isMoved = [&InTimeFrom](const Time InTime) { return InTime >= InTimeFrom; };
+	auto isMovedBpmPoint = [&InTimeFrom, &InFixedTimePoints](const BpmPoint& InBpmPoint)
+	{
+		return InBpmPoint.TimePoint >= InTimeFrom && std::find(InFixedTimePoints.begin(), InFixedTimePoints.end(), InBpmPoint.TimePoint) == InFixedTimePoints.end();
+	};
+
+	std::vector<BpmPoint> bpmPoints;
+	std::vector<StopPoint> stops;
+	std::vector<ScrollVelocityMultiplier> svMultipliers;
+	std::vector<TimeSignature> timeSignatures;
+
+	BeginTransaction();
+
+	JournalNotes(false, formerNotes);
+	JournalNotes(true, remappedNotes);
+
+	Notes.Retime(remappedNotes);
+
+	//the timing points are taken out of their timeslices first and put into the new ones afterwards, so none is moved twice
+	auto takeOut = [](auto& OutCollection, auto& OutTaken, auto InPredicate)
+	{
+		auto takenIt = std::stable_partition(OutCollection.begin(), OutCollection.end(), [&InPredicate](const auto& InTimingPoint) { return !InPredicate(InTimingPoint); });
+
+		OutTaken.insert(OutTaken.end(), takenIt, OutCollection.end());
+		OutCollection.erase(takenIt, OutCollection.end());
+	};
+
+	for (auto timeSliceIt = TimeSlices.lower_bound(GetTimeSliceIndex(InTimeFrom)); timeSliceIt != TimeSlices.end(); ++timeSliceIt)
+	{
+		TimeSlice& timeSlice = timeSliceIt->second;
+
+		JournalTimingChange(timeSlice.TimePoint);
+
+		takeOut(timeSlice.BpmPoints, bpmPoints, isMovedBpmPoint);
+		takeOut(timeSlice.Stops, stops, [&isMoved](const StopPoint& InStop) { return isMoved(InStop.TimePoint); });
+		takeOut(timeSlice.SvMultipliers, svMultipliers, [&isMoved](const ScrollVelocityMultiplier& InSV) { return isMoved(InSV.TimePoint); });
+		takeOut(timeSlice.TimeSignatures, timeSignatures, [&isMoved](const TimeSignature& InTS) { return isMoved(InTS.TimePoint); });
+	}
+
+	std::set<int> refilledTimeSlices;
+
+	auto putBack = [this, &remap, &refilledTimeSlices](auto& InTaken, auto InCollection)
+	{
+		for (auto timingPoint : InTaken)
+		{
+			timingPoint.TimePoint = remap(timingPoint.TimePoint);
+
+			JournalTimingChange(timingPoint.TimePoint);
+
+			TimeSlice& timeSlice = FindOrAddTimeSlice(timingPoint.TimePoint);
+			(timeSlice.*InCollection).push_back(timingPoint);
+
+			refilledTimeSlices.insert(timeSlice.Index);
+		}
+	};
+
+	putBack(bpmPoints, &TimeSlice::BpmPoints);
+	putBack(stops, &TimeSlice::Stops);
+	putBack(svMultipliers, &TimeSlice::SvMultipliers);
+	putBack(timeSignatures, &TimeSlice::TimeSignatures);
+
+	auto isEarlier = [](const auto& lhs, const auto& rhs) { return lhs.TimePoint < rhs.TimePoint; };
+
+	for (const int index : refilledTimeSlices)
+	{
+		TimeSlice& timeSlice = TimeSlices[index];
+
+		std::stable_sort(timeSlice.BpmPoints.begin(), timeSlice.BpmPoints.end(), isEarlier);
+		std::stable_sort(timeSlice.Stops.begin(), timeSlice.Stops.end(), isEarlier);
+		std::stable_sort(timeSlice.SvMultipliers.begin(), timeSlice.SvMultipliers.end(), isEarlier);
+		std::stable_sort(timeSlice.TimeSignatures.begin(), timeSlice.TimeSignatures.end(), isEarlier);
+	}
+
+	Commit();
 
-	auto noteIt = std::find_if(noteCollection.begin(), noteCollection.end(), [InTime](const Note &InNote)
-							   { return InNote.TimePoint == InTime; });
+	if (timeBegin > timeEnd)
+		return true;
 
-	if (noteIt == noteCollection.end())
-		return nullptr;
+	InvalidateTimingIndices();
+	InvalidateTempoMap(timeBegin);
 
-	return &(*noteIt);
+	NotifyModified(timeBegin, timeEnd);
+
+	return true;
 }
 
 void Chart::DebugPrint()
@@ -1241,36 +1687,27 @@ void Chart::DebugPrint()
 	std::cout << DifficultyName << std::endl;
 	std::cout << "***************************" << std::endl;
 
-	for (auto [timePoint, slice] : TimeSlices)
+	Notes.IterateAllNotes([](Note& note, const Column column)
 	{
-		for (auto [column, notes] : slice.Notes)
+		std::string type = "";
+		switch (note.Type)
 		{
-			for (auto note : notes)
-			{
-				std::string type = "";
-				switch (note.Type)
-				{
-				case Note::EType::Common:
-					type = "common";
-					break;
-				case Note::EType::HoldBegin:
-					type = "hold begin";
-					break;
-				case Note::EType::HoldIntermediate:
-					type = "hold intermediate";
-					break;
-				case Note::EType::HoldEnd:
-					type = "hold end";
-					break;
-
-				default:
-					break;
-				}
-
-				std::cout << timePoint << ":" << std::to_string(note.TimePoint) << " - " << std::to_string(column) << " - " << type << std::endl;
-			}
+		case Note::EType::Common:
+			type = "common";
+			break;
+		case Note::EType::HoldBegin:
+			type = "hold begin";
+			break;
+		case Note::EType::HoldEnd:
+			type = "hold end";
+			break;
+
+		default:
+			break;
 		}
-	}
+
+		std::cout << std::to_string(note.TimePoint) << " - " << std::to_string(column) << " - " << type << std::endl;
+	});
 
 	std::cout << std::endl;
 }
@@ -1280,16 +1717,62 @@ void Chart::RegisterOnModifiedCallback(std::function<void(TimeSlice &)> InCallba
 	_OnModified = InCallback;
 }
 
-bool Chart::IsAPotentialNoteDuplicate(const Time InTime, const Column InColumn)
+bool Chart::IsAPotentialNoteDuplicate(const Time InTime, const Column InColumn) const
+{
+	return Notes.Find(InTime, InColumn) != nullptr;
+}
+
+TimeSlice *Chart::FindTimeSlice(const Time InTime)
+{
+	auto timeSliceIt = TimeSlices.find(GetTimeSliceIndex(InTime));
+
+	return timeSliceIt != TimeSlices.end() ? &timeSliceIt->second : nullptr;
+}
+
+const TimeSlice *Chart::FindTimeSlice(const Time InTime) const
+{
+	auto timeSliceIt = TimeSlices.find(GetTimeSliceIndex(InTime));
+
+	return timeSliceIt != TimeSlices.end() ? &timeSliceIt->second : nullptr;
+}
+
+int Chart::CompactTimeSlices()
 {
-	auto &notes = FindOrAddTimeSlice(InTime).Notes[InColumn];
-	return (std::find_if(notes.begin(), notes.end(), [InTime](const Note &InNote)
-						 { return InNote.TimePoint == InTime; }) != notes.end());
+	int erasedAmount = 0;
+
+	for (auto timeSliceIt = TimeSlices.begin(); timeSliceIt != TimeSlices.end();)
+	{
+		const TimeSlice& timeSlice = timeSliceIt->second;
+
+		if (!timeSlice.BpmPoints.empty() || !timeSlice.Stops.empty() || !timeSlice.SvMultipliers.empty() || !timeSlice.TimeSignatures.empty())
+		{
+			++timeSliceIt;
+			continue;
+		}
+
+		timeSliceIt = TimeSlices.erase(timeSliceIt);
+		erasedAmount++;
+	}
+
+	return erasedAmount;
+}
+
+void Chart::EraseTimeSliceIfEmpty(const int InIndex)
+{
+	auto timeSliceIt = TimeSlices.find(InIndex);
+
+	if (timeSliceIt == TimeSlices.end())
+		return;
+
+	const TimeSlice& timeSlice = timeSliceIt->second;
+
+	if (timeSlice.BpmPoints.empty() && timeSlice.Stops.empty() && timeSlice.SvMultipliers.empty() && timeSlice.TimeSignatures.empty())
+		TimeSlices.erase(timeSliceIt);
 }
 
 TimeSlice &Chart::FindOrAddTimeSlice(const Time InTime)
 {
-	int index = InTime / TIMESLICE_LENGTH;
+	int index = GetTimeSliceIndex(InTime);
 	if (TimeSlices.find(index) == TimeSlices.end())
 	{
 		TimeSlices[index].TimePoint = index * TIMESLICE_LENGTH;
@@ -1305,63 +1788,111 @@ void Chart::FillNoteCollectionWithAllNotes(NoteReferenceCollection& OutNotes)
 
 	IterateAllNotes([&OutNotes](Note& InNote, Column InColumn)
 	{
-		OutNotes.PushNote(InColumn, &InNote);
+		OutNotes.PushNote(InColumn, InNote);
+	});
+}
+
+void Chart::InvertSelection(NoteReferenceCollection& OutNotes)
+{
+	NoteReferenceCollection inverted;
+
+	IterateAllNotes([&OutNotes, &inverted](Note& InNote, Column InColumn)
+	{
+		if (!OutNotes.Contains(InNote.Handle))
+			inverted.PushNote(InColumn, InNote);
 	});
+
+	OutNotes = std::move(inverted);
 }
 
-void Chart::PushTimeSliceHistoryIfNotAdded(const Time InTime)
+void Chart::IterateSelectedNotes(const NoteReferenceCollection& InNotes, std::function<void(Note&, const Column)> InWork)
 {
-	if (TimeSliceHistory.size() == 0)
+	if (!InNotes.HasNotes)
 		return;
 
-	auto &collection = TimeSliceHistory.top();
+	std::vector<std::pair<Column, Note*>> selectedNotes;
+	selectedNotes.reserve(InNotes.NoteAmount);
 
-	for (auto &timeSlice : collection)
+	std::vector<size_t> columnEnds;
+
+	//every column is walked in time order within the bounds of the selection, the columns are merged afterwards
+	for (Column column = 0; column < Notes.GetColumnAmount(); ++column)
 	{
-		if (InTime >= timeSlice.TimePoint && InTime <= timeSlice.TimePoint + TIMESLICE_LENGTH)
-			return;
+		auto& notes = Notes.GetColumn(column);
+
+		for (size_t index = Notes.LowerBound(InNotes.MinTimePoint, column); index < notes.size() && notes[index].TimePoint <= InNotes.MaxTimePoint; ++index)
+			if (InNotes.Contains(notes[index].Handle))
+				selectedNotes.push_back({ column, &notes[index] });
+
+		columnEnds.push_back(selectedNotes.size());
 	}
 
-	collection.push_back(FindOrAddTimeSlice(InTime));
+	auto isEarlier = [](const std::pair<Column, Note*>& lhs, const std::pair<Column, Note*>& rhs) { return lhs.second->TimePoint < rhs.second->TimePoint; };
+
+	for (size_t column = 1; column < columnEnds.size(); ++column)
+		std::inplace_merge(selectedNotes.begin(), selectedNotes.begin() + columnEnds[column - 1], selectedNotes.begin() + columnEnds[column], isEarlier);
+
+	for (auto& [column, note] : selectedNotes)
+		InWork(*note, column);
 }
 
 void Chart::RevaluateBpmPoint(BpmPoint &InFormerBpmPoint, BpmPoint &InMovedBpmPoint)
 {
-	auto &formerTimeSlice = FindOrAddTimeSlice(InFormerBpmPoint.TimePoint);
-	auto &newTimeSlice = FindOrAddTimeSlice(InMovedBpmPoint.TimePoint);
+	//the moved point still sits in the timeslice it started out in, the one it was moved to may not even exist yet
+	TimeSlice* formerTimeSlice = FindTimeSlice(InFormerBpmPoint.TimePoint);
+
+	if (!formerTimeSlice)
+		return;
+
+	BeginTransaction();
+	JournalTimingChange(InFormerBpmPoint.TimePoint);
+
+	auto &formerBpmCollection = formerTimeSlice->BpmPoints;
 
-	auto &formerBpmCollection = formerTimeSlice.BpmPoints;
+	InvalidateTempoMap(std::min(InFormerBpmPoint.TimePoint, InMovedBpmPoint.TimePoint));
 
-	if (formerTimeSlice.Index != newTimeSlice.Index)
+	if (formerTimeSlice->Index != GetTimeSliceIndex(InMovedBpmPoint.TimePoint))
 	{
 		BpmPoint bpmPointToAdd = InMovedBpmPoint;
 
 		formerBpmCollection.erase(std::remove(formerBpmCollection.begin(), formerBpmCollection.end(), InMovedBpmPoint), formerBpmCollection.end());
-		CachedBpmPoints.clear();
 
-		TimeSliceHistory.top().push_back(newTimeSlice);
+		//the indices let go of the erased point before the injection looks at them
+		UpdateTimingIndices(*formerTimeSlice);
 
 		InjectBpmPoint(bpmPointToAdd.TimePoint, bpmPointToAdd.Bpm, bpmPointToAdd.BeatLength);
 
 		_BpmPointCounter--;
 	}
+	else
+	{
+		UpdateTimingIndices(*formerTimeSlice);
+	}
+
+	Commit();
 }
 
 void Chart::RevaluateStop(StopPoint &InFormerStop, StopPoint &InMovedStop)
 {
-	auto &formerTimeSlice = FindOrAddTimeSlice(InFormerStop.TimePoint);
-	auto &newTimeSlice = FindOrAddTimeSlice(InMovedStop.TimePoint);
+	TimeSlice* formerTimeSlice = FindTimeSlice(InFormerStop.TimePoint);
+
+	if (!formerTimeSlice)
+		return;
+
+	BeginTransaction();
+	JournalTimingChange(InFormerStop.TimePoint);
 
-	auto &formerCollection = formerTimeSlice.Stops;
+	auto &formerCollection = formerTimeSlice->Stops;
 
-	if (formerTimeSlice.Index != newTimeSlice.Index)
+	InvalidateTempoMap(std::min(InFormerStop.TimePoint, InMovedStop.TimePoint));
+
+	if (formerTimeSlice->Index != GetTimeSliceIndex(InMovedStop.TimePoint))
 	{
 		StopPoint stopToAdd = InMovedStop;
 
 		formerCollection.erase(std::remove(formerCollection.begin(), formerCollection.end(), InMovedStop), formerCollection.end());
-		CachedStops.clear();
 
-		TimeSliceHistory.top().push_back(newTimeSlice);
+		UpdateTimingIndices(*formerTimeSlice);
 
 		InjectStop(stopToAdd.TimePoint, stopToAdd.Length);
 	}
@@ -1369,24 +1900,32 @@ void Chart::RevaluateStop(StopPoint &InFormerStop, StopPoint &InMovedStop)
     {
         std::sort(formerCollection.begin(), formerCollection.end(), [](const auto &lhs, const auto &rhs)
                   { return lhs.TimePoint < rhs.TimePoint; });
+
+        UpdateTimingIndices(*formerTimeSlice);
     }
+
+	Commit();
 }
 
 void Chart::RevaluateSV(ScrollVelocityMultiplier &InFormerSV, ScrollVelocityMultiplier &InMovedSV)
 {
-	auto &formerTimeSlice = FindOrAddTimeSlice(InFormerSV.TimePoint);
-	auto &newTimeSlice = FindOrAddTimeSlice(InMovedSV.TimePoint);
+	TimeSlice* formerTimeSlice = FindTimeSlice(InFormerSV.TimePoint);
+
+	if (!formerTimeSlice)
+		return;
+
+	BeginTransaction();
+	JournalTimingChange(InFormerSV.TimePoint);
 
-	auto &formerCollection = formerTimeSlice.SvMultipliers;
+	auto &formerCollection = formerTimeSlice->SvMultipliers;
 
-	if (formerTimeSlice.Index != newTimeSlice.Index)
+	if (formerTimeSlice->Index != GetTimeSliceIndex(InMovedSV.TimePoint))
 	{
 		ScrollVelocityMultiplier svToAdd = InMovedSV;
 
 		formerCollection.erase(std::remove(formerCollection.begin(), formerCollection.end(), InMovedSV), formerCollection.end());
-		CachedSVs.clear();
 
-		TimeSliceHistory.top().push_back(newTimeSlice);
+		UpdateTimingIndices(*formerTimeSlice);
 
 		InjectSV(svToAdd.TimePoint, svToAdd.Multiplier);
 	}
@@ -1394,277 +1933,425 @@ void Chart::RevaluateSV(ScrollVelocityMultiplier &InFormerSV, ScrollVelocityMult
     {
         std::sort(formerCollection.begin(), formerCollection.end(), [](const auto &lhs, const auto &rhs)
                   { return lhs.TimePoint < rhs.TimePoint; });
+
+        UpdateTimingIndices(*formerTimeSlice);
     }
+
+	Commit();
+}
+
+void Chart::BeginTransaction()
+{
+	_TransactionDepth++;
+}
+
+void Chart::Commit()
+{
+	if (_TransactionDepth == 0 || --_TransactionDepth > 0)
+		return;
+
+	if (_OpenTransaction.NoteDeltas.empty() && _OpenTransaction.TimingDeltas.empty() && _OpenTransaction.BaseOffsetDelta == 0.0)
+		return;
+
+	for (auto& timingDelta : _OpenTransaction.TimingDeltas)
+	{
+		timingDelta.After = FindOrAddTimeSlice(timingDelta.Before.TimePoint);
+
+		//a timeslice losing its last timing point is dropped, it holds nothing else
+		EraseTimeSliceIfEmpty(timingDelta.Before.Index);
+	}
+
+	UndoJournal.Push(std::move(_OpenTransaction));
+	_OpenTransaction = ChartTransaction();
+	_OpenTransactionTimeSlices.clear();
+
+	//making new changes clears the future
+	RedoJournal.Clear();
+}
+
+void Chart::JournalTimingChange(const Time InTime)
+{
+	_DirtyTimeSlices.insert(GetTimeSliceIndex(InTime));
+
+	if (_TransactionDepth == 0)
+		return;
+
+	const TimeSlice& timeSlice = FindOrAddTimeSlice(InTime);
+
+	//only the state before the first change within the transaction is of interest
+	if (!_OpenTransactionTimeSlices.insert(timeSlice.Index).second)
+		return;
+
+	_OpenTransaction.TimingDeltas.push_back({ timeSlice, TimeSlice() });
 }
 
-void Chart::RegisterTimeSliceHistory(const Time InTime)
+void Chart::JournalNote(const bool InIsInsertion, const Column InColumn, const Note& InNote)
 {
-    // Clear future when making new changes
-    while (!TimeSliceFuture.empty()) TimeSliceFuture.pop();
-	TimeSliceHistory.push({FindOrAddTimeSlice(InTime)});
+	_DirtyNoteChunks.insert(GetSnapshotChunkIndex(InNote.TimePoint));
+	_NoteDensity.Add(InColumn, InNote.TimePoint, InIsInsertion ? 1 : -1);
+
+	if (_TransactionDepth == 0)
+		return;
+
+	_OpenTransaction.NoteDeltas.push_back({ InIsInsertion, InColumn, InNote });
 }
 
-void Chart::RegisterTimeSliceHistoryRanged(const Time InTimeBegin, const Time InTimeEnd)
+void Chart::JournalNotes(const bool InIsInsertion, const std::vector<std::pair<Column, Note>>& InNotes)
 {
-    // Clear future when making new changes
-    while (!TimeSliceFuture.empty()) TimeSliceFuture.pop();
+	if (InNotes.empty())
+		return;
+
+	Time timeBegin = std::numeric_limits<Time>::max();
+	Time timeEnd = std::numeric_limits<Time>::min();
+
+	for (const auto& [column, note] : InNotes)
+	{
+		timeBegin = std::min(timeBegin, note.TimePoint);
+		timeEnd = std::max(timeEnd, note.TimePoint);
+	}
 
-	std::vector<TimeSlice> timeSlices;
+	//the chunks in between are marked as well, an untouched one is merely copied again
+	for (int chunkIndex = GetSnapshotChunkIndex(timeBegin); chunkIndex <= GetSnapshotChunkIndex(timeEnd); ++chunkIndex)
+		_DirtyNoteChunks.insert(_DirtyNoteChunks.end(), chunkIndex);
 
-	IterateTimeSlicesInTimeRange(InTimeBegin, InTimeEnd, [&timeSlices](TimeSlice &InTimeSlice)
-								 { timeSlices.push_back(InTimeSlice); });
+	_NoteDensity.AddBatch(InNotes, InIsInsertion ? 1 : -1);
 
-	TimeSliceHistory.push(timeSlices);
+	if (_TransactionDepth == 0)
+		return;
+
+	_OpenTransaction.NoteDeltas.reserve(_OpenTransaction.NoteDeltas.size() + InNotes.size());
+
+	for (const auto& [column, note] : InNotes)
+		_OpenTransaction.NoteDeltas.push_back({ InIsInsertion, column, note });
 }
 
 bool Chart::Undo()
 {
-	if (TimeSliceHistory.empty())
+	if (UndoJournal.IsEmpty() || _TransactionDepth > 0)
 		return false;
 
-    // Save current state of the slices we are about to restore into Future
-    std::vector<TimeSlice>& historySlices = TimeSliceHistory.top();
-    std::vector<TimeSlice> currentSlices;
-    for (auto& histSlice : historySlices)
-    {
-        // Find current version of this slice
-        // If it doesn't exist, we create a default (empty) one?
-        // Or if it exists, copy it.
-        // FindOrAddTimeSlice creates if not exists.
-        currentSlices.push_back(FindOrAddTimeSlice(histSlice.TimePoint));
-    }
-    TimeSliceFuture.push(currentSlices);
+	ChartTransaction transaction;
+
+	if (!UndoJournal.Pop(transaction))
+		return false;
 
-    // Apply Undo
-	for (auto &timeSlice : historySlices)
-		_OnModified(TimeSlices[timeSlice.Index] = timeSlice);
+	ReplayTransaction(transaction, true);
 
-	TimeSliceHistory.pop();
+	RedoJournal.Push(std::move(transaction));
 
 	return true;
 }
 
 bool Chart::Redo()
 {
-	if (TimeSliceFuture.empty())
+	if (RedoJournal.IsEmpty() || _TransactionDepth > 0)
 		return false;
 
-    // Save current state of slices we are about to restore into History
-    std::vector<TimeSlice>& futureSlices = TimeSliceFuture.top();
-    std::vector<TimeSlice> currentSlices;
-    for (auto& futSlice : futureSlices)
-    {
-        currentSlices.push_back(FindOrAddTimeSlice(futSlice.TimePoint));
-    }
-    TimeSliceHistory.push(currentSlices);
+	ChartTransaction transaction;
+
+	if (!RedoJournal.Pop(transaction))
+		return false;
 
-    // Apply Redo
-	for (auto &timeSlice : futureSlices)
-		_OnModified(TimeSlices[timeSlice.Index] = timeSlice);
+	ReplayTransaction(transaction, false);
 
-	TimeSliceFuture.pop();
+	UndoJournal.Push(std::move(transaction));
 
 	return true;
 }
 
-void Chart::IterateTimeSlicesInTimeRange(const Time InTimeBegin, const Time InTimeEnd, std::function<void(TimeSlice &)> InWork)
+void Chart::SetHistoryMemoryBudget(const size_t InBytes)
 {
-	if (InTimeBegin > InTimeEnd)
+	UndoJournal.SetMemoryBudget(InBytes);
+	RedoJournal.SetMemoryBudget(InBytes);
+}
+
+std::shared_ptr<const ChartSnapshot> Chart::TakeSnapshot()
+{
+	//timing edited within a transaction still open is not complete yet, it is taken as it currently is
+	for (const auto& timingDelta : _OpenTransaction.TimingDeltas)
+		_DirtyTimeSlices.insert(timingDelta.Before.Index);
+
+	const TempoMap& tempoMap = GetTempoMap();
+	const bool isTempoMapStale = !_SnapshotTempoMap || _SnapshotTempoMap->GetRevision() != tempoMap.GetRevision();
+
+	if (_Snapshot && _DirtyNoteChunks.empty() && _DirtyTimeSlices.empty() && !isTempoMapStale)
+		return _Snapshot;
+
+	//the very first snapshot builds every chunk there is
+	if (!_Snapshot)
+	{
+		IterateAllNotes([this](Note& InNote, const Column) { _DirtyNoteChunks.insert(GetSnapshotChunkIndex(InNote.TimePoint)); });
+
+		for (const auto& [index, timeSlice] : TimeSlices)
+			_DirtyTimeSlices.insert(index);
+	}
+
+	for (const int chunkIndex : _DirtyNoteChunks)
 	{
-		for (TimeSlice *timeSlice = &FindOrAddTimeSlice(InTimeBegin);
-			 timeSlice->TimePoint > InTimeEnd - TIMESLICE_LENGTH;
-			 timeSlice = &FindOrAddTimeSlice(timeSlice->TimePoint - TIMESLICE_LENGTH))
+		const Time chunkTimeBegin = chunkIndex * SNAPSHOT_CHUNK_LENGTH;
+		const Time chunkTimeEnd = chunkTimeBegin + SNAPSHOT_CHUNK_LENGTH;
+
+		auto chunk = std::make_shared<SnapshotNoteChunk>();
+		chunk->Columns.resize(Notes.GetColumnAmount());
+
+		bool isEmpty = true;
+
+		for (Column column = 0; column < Notes.GetColumnAmount(); ++column)
 		{
-			InWork(*timeSlice);
+			const auto& notes = Notes.GetColumn(column);
+
+			auto noteIt = notes.begin() + Notes.LowerBound(chunkTimeBegin, column);
+			auto noteEndIt = notes.begin() + Notes.LowerBound(chunkTimeEnd, column);
+
+			chunk->Columns[column].assign(noteIt, noteEndIt);
+			isEmpty &= noteIt == noteEndIt;
+
+			for (const Note& note : chunk->Columns[column])
+				if (IsLongNoteBegin(note.Type))
+					chunk->LongestHoldLength = std::max(chunk->LongestHoldLength, note.TimePointEnd - note.TimePoint);
 		}
 
-		return;
+		if (isEmpty)
+			_SnapshotNoteChunks.erase(chunkIndex);
+		else
+			_SnapshotNoteChunks[chunkIndex] = std::move(chunk);
 	}
 
-	for (TimeSlice *timeSlice = &FindOrAddTimeSlice(InTimeBegin);
-		 timeSlice->TimePoint <= InTimeEnd;
-		 timeSlice = &FindOrAddTimeSlice(timeSlice->TimePoint + TIMESLICE_LENGTH))
+	for (const int index : _DirtyTimeSlices)
 	{
-		InWork(*timeSlice);
+		const auto timeSliceIt = TimeSlices.find(index);
+
+		if (timeSliceIt == TimeSlices.end())
+			_SnapshotTimeSlices.erase(index);
+		else
+			_SnapshotTimeSlices[index] = std::make_shared<const TimeSlice>(timeSliceIt->second);
 	}
+
+	if (isTempoMapStale)
+		_SnapshotTempoMap = std::make_shared<const TempoMap>(tempoMap);
+
+	_DirtyNoteChunks.clear();
+	_DirtyTimeSlices.clear();
+
+	//only the tables of pointers are copied, the chunks themselves are shared
+	_Snapshot = std::make_shared<const ChartSnapshot>(std::make_shared<const ChartSnapshot::NoteChunkMap>(_SnapshotNoteChunks),
+		std::make_shared<const ChartSnapshot::TimeSliceMap>(_SnapshotTimeSlices), _SnapshotTempoMap, Notes.GetNoteAmount(), KeyAmount);
+
+	return _Snapshot;
 }
 
-void Chart::IterateNotesInTimeRange(const Time InTimeBegin, const Time InTimeEnd, std::function<void(Note &, const Column)> InWork)
+void Chart::MarkSnapshotDirty(const Time InTimeBegin, const Time InTimeEnd)
+{
+	const Time timeBegin = std::min(InTimeBegin, InTimeEnd);
+	const Time timeEnd = std::max(InTimeBegin, InTimeEnd);
+
+	for (int chunkIndex = GetSnapshotChunkIndex(timeBegin); chunkIndex <= GetSnapshotChunkIndex(timeEnd); ++chunkIndex)
+		_DirtyNoteChunks.insert(chunkIndex);
+
+	//only the stored timeslices can have changed in place
+	for (auto timeSliceIt = TimeSlices.lower_bound(GetTimeSliceIndex(timeBegin)); timeSliceIt != TimeSlices.end() && timeSliceIt->first <= GetTimeSliceIndex(timeEnd); ++timeSliceIt)
+		_DirtyTimeSlices.insert(timeSliceIt->first);
+}
+
+void Chart::ReplayTransaction(const ChartTransaction& InTransaction, const bool InIsUndo)
 {
-	for (TimeSlice *timeSlice = &FindOrAddTimeSlice(InTimeBegin);
-		 timeSlice->TimePoint <= InTimeEnd;
-		 timeSlice = &FindOrAddTimeSlice(timeSlice->TimePoint + TIMESLICE_LENGTH))
+	std::set<int> modifiedTimeSlices;
+
+	//undoing walks the deltas backwards so every note is erased in exactly the state it was inserted in
+	const size_t deltaAmount = InTransaction.NoteDeltas.size();
+
+	for (size_t deltaIndex = 0; deltaIndex < deltaAmount; ++deltaIndex)
 	{
-		for (auto &[column, notes] : timeSlice->Notes)
+		const NoteDelta& noteDelta = InTransaction.NoteDeltas[InIsUndo ? deltaAmount - 1 - deltaIndex : deltaIndex];
+
+		if (noteDelta.IsInsertion == InIsUndo)
 		{
-			for (auto &note : notes)
-			{
-				if (note.TimePoint >= InTimeBegin && note.TimePoint <= InTimeEnd)
-					InWork(note, column);
-			}
+			if (EraseExactNote(noteDelta.NoteColumn, noteDelta.Value))
+				_NoteDensity.Add(noteDelta.NoteColumn, noteDelta.Value.TimePoint, -1);
+		}
+		else
+		{
+			Notes.Restore(noteDelta.NoteColumn, noteDelta.Value);
+			_NoteDensity.Add(noteDelta.NoteColumn, noteDelta.Value.TimePoint, 1);
 		}
+
+		_DirtyNoteChunks.insert(GetSnapshotChunkIndex(noteDelta.Value.TimePoint));
+		modifiedTimeSlices.insert(GetTimeSliceIndex(noteDelta.Value.TimePoint));
+	}
+
+	for (const auto& timingDelta : InTransaction.TimingDeltas)
+	{
+		RestoreTiming(InIsUndo ? timingDelta.Before : timingDelta.After);
+		EraseTimeSliceIfEmpty(timingDelta.Before.Index);
+
+		modifiedTimeSlices.insert(timingDelta.Before.Index);
 	}
+
+	BaseOffset += InIsUndo ? -InTransaction.BaseOffsetDelta : InTransaction.BaseOffsetDelta;
+
+	for (const int index : modifiedTimeSlices)
+		NotifyModified(index * TIMESLICE_LENGTH, index * TIMESLICE_LENGTH);
 }
 
-void Chart::IterateAllStops(std::function<void(StopPoint&)> InWork)
+void Chart::RestoreTiming(const TimeSlice& InTiming)
+{
+	auto& timeSlice = FindOrAddTimeSlice(InTiming.TimePoint);
+
+	if(!timeSlice.BpmPoints.empty() || !timeSlice.Stops.empty() || !InTiming.BpmPoints.empty() || !InTiming.Stops.empty())
+		InvalidateTempoMap(InTiming.TimePoint);
+
+	_BpmPointCounter += int(InTiming.BpmPoints.size()) - int(timeSlice.BpmPoints.size());
+
+	timeSlice = InTiming;
+	_DirtyTimeSlices.insert(timeSlice.Index);
+
+	UpdateTimingIndices(timeSlice);
+}
+
+bool Chart::EraseExactNote(const Column InColumn, const Note& InNote)
 {
-	for (auto &[ID, timeSlice] : TimeSlices)
+	//the journaled handle is the note itself, unless the note could not get it back when it was restored
+	if (Notes.EraseInTimeRange(InNote.TimePoint, InNote.TimePoint, InColumn, [&InNote](const Note& InOther) { return InOther.Handle == InNote.Handle; }) > 0)
+		return true;
+
+	bool isErased = false;
+
+	//a hold end may share its timepoint with the begin of the next hold, so the note is told apart by all of its timepoints
+	Notes.EraseInTimeRange(InNote.TimePoint, InNote.TimePoint, InColumn, [&isErased, &InNote](const Note& InOther)
 	{
-		for (auto &stop : timeSlice.Stops)
-		{
-			InWork(stop);
-		}
-	}
+		if (isErased || InOther.Type != InNote.Type || InOther.TimePointBegin != InNote.TimePointBegin || InOther.TimePointEnd != InNote.TimePointEnd)
+			return false;
+
+		isErased = true;
+
+		return true;
+	});
+
+	return isErased;
 }
 
-void Chart::IterateAllNotes(std::function<void(Note &, const Column)> InWork)
+void Chart::IterateTimeSlicesInTimeRange(const Time InTimeBegin, const Time InTimeEnd, std::function<void(TimeSlice &)> InWork)
 {
-	for (auto &[ID, timeSlice] : TimeSlices)
+	const int firstIndex = GetTimeSliceIndex(std::min(InTimeBegin, InTimeEnd));
+	const int lastIndex = GetTimeSliceIndex(std::max(InTimeBegin, InTimeEnd));
+
+	auto timeSliceIt = TimeSlices.lower_bound(firstIndex);
+
+	//timeslices holding no timing points are not stored, they are handed over as an empty stand-in instead
+	for (int index = firstIndex; index <= lastIndex; ++index)
 	{
-		for (auto &[column, notes] : timeSlice.Notes)
+		if (timeSliceIt != TimeSlices.end() && timeSliceIt->first == index)
 		{
-			for (auto &note : notes)
-			{
-				InWork(note, column);
-			}
+			InWork((timeSliceIt++)->second);
+			continue;
 		}
+
+		TimeSlice emptyTimeSlice;
+		emptyTimeSlice.TimePoint = index * TIMESLICE_LENGTH;
+		emptyTimeSlice.Index = index;
+
+		InWork(emptyTimeSlice);
 	}
 }
 
-void Chart::IterateAllBpmPoints(std::function<void(BpmPoint &)> InWork)
+void Chart::NotifyModified(const Time InTimeBegin, const Time InTimeEnd)
 {
-	for (auto &[ID, timeSlice] : TimeSlices)
+	MarkSnapshotDirty(InTimeBegin, InTimeEnd);
+
+	IterateTimeSlicesInTimeRange(InTimeBegin, InTimeEnd, [this](TimeSlice& InTimeSlice)
 	{
-		for (auto &bpmPoint : timeSlice.BpmPoints)
-		{
-			InWork(bpmPoint);
-		}
-	}
+		_OnModified(InTimeSlice);
+	});
+}
+
+void Chart::IterateNotesInTimeRange(const Time InTimeBegin, const Time InTimeEnd, std::function<void(Note &, const Column)> InWork)
+{
+	Notes.IterateNotesInTimeRange(InTimeBegin, InTimeEnd, InWork);
+}
+
+void Chart::IterateLongNotesInTimeRange(const Time InTimeBegin, const Time InTimeEnd, std::function<void(Note &, const Column)> InWork)
+{
+	Notes.IterateLongNotesInTimeRange(InTimeBegin, InTimeEnd, InWork);
+}
+
+void Chart::IterateAllStops(std::function<void(StopPoint&)> InWork)
+{
+	for (auto* stop : GetStopIndex().GetAll())
+		InWork(*stop);
+}
+
+void Chart::IterateAllNotes(std::function<void(Note &, const Column)> InWork)
+{
+	Notes.IterateAllNotes(InWork);
+}
+
+void Chart::IterateAllBpmPoints(std::function<void(BpmPoint &)> InWork)
+{
+	for (auto* bpmPoint : GetBpmPointIndex().GetAll())
+		InWork(*bpmPoint);
 }
 
 std::vector<BpmPoint *> &Chart::GetBpmPointsRelatedToTimeRange(const Time InTimeBegin, const Time InTimeEnd)
 {
-	CachedBpmPoints.clear();
+	const TimingIndex<BpmPoint>& bpmPointIndex = GetBpmPointIndex();
 
-	if (!_BpmPointCounter)
-		return CachedBpmPoints;
+	//the bpm point in effect at the beginning of the range is included, or the first one after it if there is none yet
+	BpmPoint* firstBpmPoint = bpmPointIndex.GetPrevious(InTimeBegin);
 
-	Time newTimeBegin = InTimeBegin - TIMESLICE_LENGTH;
+	if (!firstBpmPoint)
+		firstBpmPoint = bpmPointIndex.GetNext(InTimeBegin);
 
-	for (Time time = newTimeBegin; time >= -10000; time -= TIMESLICE_LENGTH)
+	if (!firstBpmPoint)
 	{
-		auto &timeSlice = FindOrAddTimeSlice(time);
-		if (!timeSlice.BpmPoints.empty())
-		{
-			newTimeBegin = time;
-			break;
-		}
+		CachedBpmPoints.clear();
+		return CachedBpmPoints;
 	}
 
-	IterateTimeSlicesInTimeRange(newTimeBegin, InTimeEnd, [this](TimeSlice &InTimeSlice)
-								 {
-									 if (InTimeSlice.BpmPoints.empty())
-										 return;
-
-									 for (auto &bpmPoint : InTimeSlice.BpmPoints)
-										 CachedBpmPoints.push_back(&bpmPoint);
-								 });
-
-	if (CachedBpmPoints.empty())
-		return GetBpmPointsRelatedToTimeRange(InTimeBegin, InTimeEnd + TIMESLICE_LENGTH);
+	bpmPointIndex.CollectInTimeRange(firstBpmPoint->TimePoint, std::max(InTimeEnd, firstBpmPoint->TimePoint), CachedBpmPoints);
 
 	return CachedBpmPoints;
 }
 
-std::vector<StopPoint *> &Chart::GetStopsRelatedToTimeRange(const Time InTimeBegin, const Time InTimeEnd)
+//covers the timeslices around the range, as the timeslice based lookups always did
+static Time GetPaddedTimeRangeBegin(const Time InTimeBegin)
 {
-	CachedStops.clear();
+	return GetTimeSliceIndex(InTimeBegin - TIMESLICE_LENGTH) * TIMESLICE_LENGTH;
+}
 
-	IterateTimeSlicesInTimeRange(InTimeBegin - TIMESLICE_LENGTH, InTimeEnd + TIMESLICE_LENGTH, [this](TimeSlice &InTimeSlice)
-								 {
-									 if (InTimeSlice.Stops.empty())
-										 return;
+static Time GetPaddedTimeRangeEnd(const Time InTimeEnd)
+{
+	return (GetTimeSliceIndex(InTimeEnd + TIMESLICE_LENGTH) + 1) * TIMESLICE_LENGTH - 1;
+}
 
-									 for (auto &stop : InTimeSlice.Stops)
-										 CachedStops.push_back(&stop);
-								 });
+std::vector<StopPoint *> &Chart::GetStopsRelatedToTimeRange(const Time InTimeBegin, const Time InTimeEnd)
+{
+	GetStopIndex().CollectInTimeRange(GetPaddedTimeRangeBegin(InTimeBegin), GetPaddedTimeRangeEnd(InTimeEnd), CachedStops);
 
 	return CachedStops;
 }
 
 std::vector<ScrollVelocityMultiplier *> &Chart::GetSVsRelatedToTimeRange(const Time InTimeBegin, const Time InTimeEnd)
 {
-	CachedSVs.clear();
-
-	IterateTimeSlicesInTimeRange(InTimeBegin - TIMESLICE_LENGTH, InTimeEnd + TIMESLICE_LENGTH, [this](TimeSlice &InTimeSlice)
-								 {
-									 if (InTimeSlice.SvMultipliers.empty())
-										 return;
-
-									 for (auto &sv : InTimeSlice.SvMultipliers)
-										 CachedSVs.push_back(&sv);
-								 });
+	GetSVIndex().CollectInTimeRange(GetPaddedTimeRangeBegin(InTimeBegin), GetPaddedTimeRangeEnd(InTimeEnd), CachedSVs);
 
 	return CachedSVs;
 }
 
 std::vector<TimeSignature *> &Chart::GetTimeSignaturesRelatedToTimeRange(const Time InTimeBegin, const Time InTimeEnd)
 {
-	CachedTimeSignatures.clear();
-
-	IterateTimeSlicesInTimeRange(InTimeBegin - TIMESLICE_LENGTH, InTimeEnd + TIMESLICE_LENGTH, [this](TimeSlice &InTimeSlice)
-								 {
-									 if (InTimeSlice.TimeSignatures.empty())
-										 return;
-
-									 for (auto &ts : InTimeSlice.TimeSignatures)
-										 CachedTimeSignatures.push_back(&ts);
-								 });
+	GetTimeSignatureIndex().CollectInTimeRange(GetPaddedTimeRangeBegin(InTimeBegin), GetPaddedTimeRangeEnd(InTimeEnd), CachedTimeSignatures);
 
 	return CachedTimeSignatures;
 }
 
 BpmPoint *Chart::GetPreviousBpmPointFromTimePoint(const Time InTime)
 {
-	BpmPoint *foundBpmPoint = nullptr;
-	BpmPoint *previousBpmPoint = nullptr;
-
-	IterateTimeSlicesInTimeRange(0, InTime, [this, InTime, &foundBpmPoint, &previousBpmPoint](TimeSlice &InTimeSlice)
-								 {
-									 if (InTimeSlice.BpmPoints.empty())
-										 return;
-
-									 for (auto &bpmPoint : InTimeSlice.BpmPoints)
-										 if (bpmPoint.TimePoint <= InTime)
-											 previousBpmPoint = &bpmPoint;
-								 });
-
-	foundBpmPoint = previousBpmPoint;
-
-	return foundBpmPoint;
+	return GetBpmPointIndex().GetPrevious(InTime);
 }
 
 BpmPoint *Chart::GetNextBpmPointFromTimePoint(const Time InTime)
 {
-	if (!_BpmPointCounter)
-		return nullptr;
-
-	auto &relevantTimeSlice = FindOrAddTimeSlice(InTime);
-
-	auto timeSliceIt = TimeSlices.find(relevantTimeSlice.Index);
-
-	while (timeSliceIt != TimeSlices.end())
-	{
-		auto &currentTimeSlice = *timeSliceIt;
-
-		for (auto &bpmPoint : currentTimeSlice.second.BpmPoints)
-			if (bpmPoint.TimePoint > InTime)
-				return &bpmPoint;
-
-		timeSliceIt++;
-	}
-
-	return nullptr;
+	return GetBpmPointIndex().GetNext(InTime);
 }
 
 Chart::Chart()
@@ -2,108 +2,66 @@
 
 #include <map>
 #include <vector>
-#include <stack>
 #include <map>
 #include <string>
 #include <utility>
 #include <functional>
 #include <unordered_set>
+#include <set>
+#include <memory>
 #include <filesystem>
+#include <limits>
+#include <cstdint>
+
+#include "chart-types.h"
+#include "note-store.h"
+#include "tempo-map.h"
+#include "scroll-map.h"
+#include "timing-index.h"
+#include "chart-snapshot.h"
+#include "note-density.h"
+#include "undo-history.h"
 
-/*
-* these types should not have any dependencies on any systems or modules.
-* the chart should almost be treated as a datastructure, since its only handling its own data.
-* worth to note is that this datastructure makes assumptions in which type certain metrics are.
-*/
-
-#define TIMESLICE_LENGTH 500
-
-typedef int Time;
-typedef size_t Column;
-
-struct Note
-{
-	enum class EType
-	{
-		Common,
-		HoldBegin,
-		HoldIntermediate,
-		HoldEnd,
-        Mine,
-        RollBegin,
-        RollIntermediate,
-        RollEnd,
-        Lift,
-        Fake,
-
-		COUNT
-	} Type;
-
-	Time TimePoint;
-	int BeatSnap = -1;
-
-	Time TimePointBegin = 0;
-	Time TimePointEnd = 0;
-};
-
-struct BpmPoint
+struct TimeSlice
 {
 	Time TimePoint;
 
-	double BeatLength;
-	double Bpm;
-
-	bool operator==(const BpmPoint& InOther)
-	{
-		return (TimePoint == InOther.TimePoint);
-	}
-};
-
-struct ScrollVelocityMultiplier
-{
-	Time TimePoint;
-	double Multiplier;
+	int Index;
 
-    bool operator==(const ScrollVelocityMultiplier& InOther)
-    {
-        return (TimePoint == InOther.TimePoint);
-    }
+	std::vector<BpmPoint> BpmPoints;
+    std::vector<StopPoint> Stops;
+	std::vector<ScrollVelocityMultiplier> SvMultipliers;
+    std::vector<TimeSignature> TimeSignatures;
 };
 
-struct TimeSignature
+/*
+* the undo journal stores what changed rather than copies of everything that could have changed.
+* notes are journaled one by one as they are inserted or removed, timing points are sparse enough to be journaled
+* as the timing of their whole timeslice before and after the change.
+*/
+struct NoteDelta
 {
-    Time TimePoint;
-    int Numerator = 4;
-    int Denominator = 4;
+	bool IsInsertion;
 
-    bool operator==(const TimeSignature& other) { return TimePoint == other.TimePoint; }
+	Column NoteColumn;
+	Note Value;
 };
 
-struct StopPoint
+struct TimingDelta
 {
-    Time TimePoint;
-    double Length; // Seconds (StepMania standard) or MS? Standardize on MS internally?
-    // StepMania uses Seconds. Let's use Seconds to distinguish from Length in Time (which is int).
-    // Or simpler, double Seconds.
-
-    bool operator==(const StopPoint& InOther)
-    {
-        return (TimePoint == InOther.TimePoint);
-    }
+	TimeSlice Before;
+	TimeSlice After;
 };
 
-struct TimeSlice
+/*
+* one entry of the undo journal, spanning from the outermost BeginTransaction to its Commit.
+*/
+struct ChartTransaction
 {
-	Time TimePoint;
+	std::vector<NoteDelta> NoteDeltas;
+	std::vector<TimingDelta> TimingDeltas;
 
-	int Index;
-	
-	std::map<Column, std::vector<Note>> Notes;
-
-	std::vector<BpmPoint> BpmPoints;
-    std::vector<StopPoint> Stops;
-	std::vector<ScrollVelocityMultiplier> SvMultipliers;
-    std::vector<TimeSignature> TimeSignatures;
+	double BaseOffsetDelta = 0.0;
 };
 
 enum class StreamPattern
@@ -117,31 +75,47 @@ enum class StreamPattern
     Chordjack
 };
 
-enum class StreamPattern
-{
-	Staircase,
-	Trill,
-	Spiral,
-	Random
-};
-
+/*
+* a selection of notes, held by their handles so it stays valid while the chart is edited.
+* notes removed in the meantime simply no longer resolve.
+* every column keeps a bitset over the slots of the note store, next to the generation each slot was selected with,
+* so membership is a lookup, and uniting or intersecting selections works on whole words. selecting every note
+* of a chart costs a few bytes per note rather than a hash node each.
+*/
 struct NoteReferenceCollection
 {
-	void PushNote(Column InColumn, Note* InNote);
+	//selecting a note twice has no effect
+	void PushNote(Column InColumn, const Note& InNote);
+	bool Contains(const NoteHandle InHandle) const;
 	void Clear();
 
+	void Unite(const NoteReferenceCollection& InOther);
+	//the timepoint bounds narrow to where both selections overlap, they may be wider than the notes remaining
+	void Intersect(const NoteReferenceCollection& InOther);
+
+	//column by column in the order of the slots, Chart::IterateSelectedNotes visits them in time order
+	void IterateHandles(std::function<void(const Column, const NoteHandle)> InWork) const;
+
 	void TrySetMinMaxTime(Time InTime);
 
-	std::unordered_map<Column, std::unordered_set<Note *>> Notes;
-	std::unordered_map<Column, int> ColumnNoteCount;
+	//indexed by column
+	std::vector<int> ColumnNoteCount;
 
-	Time MinTimePoint;
-	Time MaxTimePoint;
+	Time MinTimePoint = std::numeric_limits<Time>::max();
+	Time MaxTimePoint = std::numeric_limits<Time>::min();
 
 	bool HasNotes = false;
 
 	int NoteAmount = 0;
 	int HighestColumnAmount = 0;
+
+private:
+
+	void ClearSlot(const size_t InSlot);
+	void Recount();
+
+	std::vector<std::vector<uint64_t>> _ColumnSlotBits;
+	std::vector<unsigned int> _SlotGenerations;
 };
 
 struct Chart
@@ -173,43 +147,76 @@ public: //meta
 	float HP = 0;
 	float OD = 0;
 
+    //the song plays every timepoint of the chart this much later, it is only baked into the timepoints on export
     double BaseOffset = 0.0;
 
     std::string SmBgChanges;
     std::string SmFgChanges;
 
-	std::vector<std::string> InheritedTimingPoints;
-
 public: //accessors
 
 	bool PlaceNote(const Time InTime, const Column InColumn, const int InBeatSnap = -1);
 	bool PlaceHold(const Time InTimeBegin, const Time InTimeEnd, const Column InColumn, const int InBeatSnapBegin = -1, const int InBeatSnapEnd = -1);
 	bool PlaceBpmPoint(const Time InTime, const double InBpm, const double InBeatLength);
 
-	void BulkPlaceNotes(const std::vector<std::pair<Column, Note>>& InNotes, const bool InSkipHistoryRegistering = false, const bool InSkipOnModified = false);
-	void MirrorNotes(NoteReferenceCollection& OutNotes);
+	void BulkPlaceNotes(const std::vector<std::pair<Column, Note>>& InNotes, const bool InSkipOnModified = false);
+	//transforms return false and leave the chart untouched if the result would collide with other notes
+	bool MirrorNotes(NoteReferenceCollection& OutNotes);
 	void MirrorNotes(std::vector<std::pair<Column, Note>>& OutNotes);
-	void ScaleNotes(NoteReferenceCollection& OutNotes, float Factor);
-	void ReverseNotes(NoteReferenceCollection& OutNotes);
-	void ShuffleNotes(NoteReferenceCollection& OutNotes);
-	void QuantizeNotes(NoteReferenceCollection& OutNotes, int Divisor);
-    void ConvertToHolds(NoteReferenceCollection& OutNotes, Time Length);
-    void ConvertToTaps(NoteReferenceCollection& OutNotes);
+	bool ScaleNotes(NoteReferenceCollection& OutNotes, float Factor);
+	bool ReverseNotes(NoteReferenceCollection& OutNotes);
+	bool ShuffleNotes(NoteReferenceCollection& OutNotes);
+	bool QuantizeNotes(NoteReferenceCollection& OutNotes, int Divisor);
+    bool ConvertToHolds(NoteReferenceCollection& OutNotes, Time Length);
+    bool ConvertToTaps(NoteReferenceCollection& OutNotes);
+
+	//maps the begin of every selected note to its new timepoint, column and type. long notes bring their end along,
+	//the whole selection is swapped in one pass as a single undo entry and the selection follows the transformed notes
+	bool TransformNotes(NoteReferenceCollection& OutNotes, std::function<void(Note&, Column&)> InMapping);
+    //shifts the whole chart against the song by moving the base offset, nothing stored is touched and the undo entry holds just the offset
     void MoveAllNotes(Time Offset);
+    Time GetBaseOffset() const;
+    Time ToSongTime(const Time InChartTime) const;
+    Time ToChartTime(const Time InSongTime) const;
+	//keeps everything from InTimeFrom on at the beat it had under InFormerTempoMap once the timing was edited. notes, stops, sv, time signatures
+	//and the bpm points following the edit are moved to wherever their beat lies now, in one pass as a single undo entry.
+	//the bpm points at InEditedTimePoints make up the edit and stay where they are, returns false and leaves the chart untouched if notes would collide
+	bool RebaseTiming(const TempoMap& InFormerTempoMap, const Time InTimeFrom, const std::vector<Time>& InEditedTimePoints);
 	void GenerateStream(Time Start, Time End, int Divisor, StreamPattern Pattern);
 
+	//read from the note density kept along with every edit, so they cost O(windows) rather than a pass over all notes
 	std::vector<float> CalculateNPSGraph(int WindowSizeMs);
 	float GetAverageNPS();
 	float GetPeakNPS();
+	const NoteDensity& GetNoteDensity() const;
 
 	double GetBeatFromTime(Time InTime);
 	Time GetTimeFromBeat(double InBeat);
 
-	bool RemoveNote(const Time InTime, const Column InColumn, const bool InIgnoreHoldChecks = false, const bool InSkipHistoryRegistering = false, const bool InSkipOnModified = false);
-	bool RemoveBpmPoint(BpmPoint& InBpmPoint, const bool InSkipHistoryRegistering = false);
-    bool RemoveStop(StopPoint& InStop, const bool InSkipHistoryRegistering = false);
-    bool RemoveSV(ScrollVelocityMultiplier& InSV, const bool InSkipHistoryRegistering = false);
-	bool BulkRemoveNotes(NoteReferenceCollection& InNotes, const bool InSkipHistoryRegistering = false);
+	const TempoMap& GetTempoMap();
+	void InvalidateTempoMap(const Time InTimeFrom);
+
+	//built again as a whole on the first query after the timing changed, sv edited in place have to invalidate it themselves
+	const ScrollMap& GetScrollMap();
+	void InvalidateScrollMap();
+
+	//changes with every edit to any kind of timing point, and is never shared by two charts
+	size_t GetTimingRevision() const;
+
+	//the earliest timepoint a bpm point or stop changed at since the last call, every note from there on may sit on another beat now
+	bool TakeTimingChange(Time& OutTimeFrom);
+
+	const TimingIndex<BpmPoint>& GetBpmPointIndex();
+	const TimingIndex<StopPoint>& GetStopIndex();
+	const TimingIndex<ScrollVelocityMultiplier>& GetSVIndex();
+	const TimingIndex<TimeSignature>& GetTimeSignatureIndex();
+
+	bool RemoveNote(const Time InTime, const Column InColumn, const bool InIgnoreHoldChecks = false, const bool InSkipOnModified = false);
+	bool RemoveBpmPoint(BpmPoint& InBpmPoint);
+    bool RemoveStop(StopPoint& InStop);
+    bool RemoveSV(ScrollVelocityMultiplier& InSV);
+    bool RemoveTimeSignature(TimeSignature& InTS);
+	bool BulkRemoveNotes(NoteReferenceCollection& InNotes);
 
 	Note& InjectNote(const Time InTime, const Column InColumn, const Note::EType InNoteType, const Time InTimeBegin = -1, const Time InTimeEnd = -1, const int InBeatSnap = -1, const bool InSkipOnModified = false);
 	Note& InjectHold(const Time InTimeBegin, const Time InTimeEnd, const Column InColumn,  const int InBeatSnapBegin = -1, const int InBeatSnapEnd = -1, const bool InSkipOnModified = false);
@@ -223,24 +230,53 @@ public: //accessors
     StopPoint* MoveStop(StopPoint& InStop, const Time NewTime);
     ScrollVelocityMultiplier* MoveSV(ScrollVelocityMultiplier& InSV, const Time NewTime);
 	Note* FindNote(const Time InTime, const Column InColumn);
-	bool IsAPotentialNoteDuplicate(const Time InTime, const Column InColumn);
+	const Note* FindNote(const Time InTime, const Column InColumn) const;
+	Note* ResolveNote(const NoteHandle InHandle);
+	Note* ResolveNote(const NoteHandle InHandle, Column& OutColumn);
+	Note* UpdateNote(const NoteHandle InHandle, const Column InColumn, const Note& InNote);
+	bool IsAPotentialNoteDuplicate(const Time InTime, const Column InColumn) const;
+
+	//only timeslices holding timing points are stored, lookups never add one
+	TimeSlice* FindTimeSlice(const Time InTime);
+	const TimeSlice* FindTimeSlice(const Time InTime) const;
 	TimeSlice& FindOrAddTimeSlice(const Time InTime);
+
+	//drops every timeslice without timing points and returns how many there were
+	int CompactTimeSlices();
 	
 	void FillNoteCollectionWithAllNotes(NoteReferenceCollection& OutNotes);
+	//selects exactly the notes that were not selected
+	void InvertSelection(NoteReferenceCollection& OutNotes);
+	void IterateSelectedNotes(const NoteReferenceCollection& InNotes, std::function<void(Note&, const Column)> InWork);
 
 	void RevaluateBpmPoint(BpmPoint& InFormerBpmPoint, BpmPoint& InMovedBpmPoint);
     void RevaluateStop(StopPoint& InFormerStop, StopPoint& InMovedStop);
     void RevaluateSV(ScrollVelocityMultiplier& InFormerSV, ScrollVelocityMultiplier& InMovedSV);
-	void PushTimeSliceHistoryIfNotAdded(const Time InTime);
-	void RegisterTimeSliceHistory(const Time InTime);
-	void RegisterTimeSliceHistoryRanged(const Time InTimeBegin, const Time InTimeEnd);
 
+	//transactions nest, every change made until the outermost one is committed becomes a single undo entry
+	void BeginTransaction();
+	void Commit();
+	void JournalTimingChange(const Time InTime);
+
+	//false with nothing to take back, or when the history entry could not be read back, which leaves it in the journal
 	bool Undo();
     bool Redo();
 
+	void SetHistoryMemoryBudget(const size_t InBytes);
+
+	//an immutable copy for readers on other threads. chunks left untouched since the last snapshot are shared with it,
+	//and as long as nothing changed at all the last snapshot itself is handed out again
+	std::shared_ptr<const ChartSnapshot> TakeSnapshot();
+
+	//for anything writing notes or timing points in place, bypassing the journal
+	void MarkSnapshotDirty(const Time InTimeBegin, const Time InTimeEnd);
+
+	//visits every timeslice the range touches without adding any, the ones not stored are handed over as empty stand-ins
 	void IterateTimeSlicesInTimeRange(const Time InTimeBegin, const Time InTimeEnd, std::function<void(TimeSlice&)> InWork);
 	void IterateNotesInTimeRange(const Time InTimeBegin, const Time InTimeEnd, std::function<void(Note&, const Column)> InWork);
 
+	void IterateLongNotesInTimeRange(const Time InTimeBegin, const Time InTimeEnd, std::function<void(Note&, const Column)> InWork);
+
 	void IterateAllNotes(std::function<void(Note&, const Column)> InWork);
 	void IterateAllBpmPoints(std::function<void(BpmPoint&)> InWork);
     void IterateAllStops(std::function<void(StopPoint&)> InWork);
@@ -259,10 +295,11 @@ public: //accessors
 
 public: //data ownership
 
+	NoteStore Notes;
 	std::map<int, TimeSlice> TimeSlices;
 
-	std::stack<std::vector<TimeSlice>> TimeSliceHistory;
-    std::stack<std::vector<TimeSlice>> TimeSliceFuture;
+	UndoHistory UndoJournal;
+	UndoHistory RedoJournal;
 
 	std::vector<BpmPoint*> CachedBpmPoints;
     std::vector<StopPoint*> CachedStops;
@@ -271,8 +308,61 @@ public: //data ownership
 
 private:
 
+	//merges whole batches of notes and timing points in, bypassing the per object bookkeeping of the Inject functions
+	friend class ChartBuilder;
+
+	void JournalNote(const bool InIsInsertion, const Column InColumn, const Note& InNote);
+	void JournalNotes(const bool InIsInsertion, const std::vector<std::pair<Column, Note>>& InNotes);
+	void ReplayTransaction(const ChartTransaction& InTransaction, const bool InIsUndo);
+	void RestoreTiming(const TimeSlice& InTiming);
+	bool EraseExactNote(const Column InColumn, const Note& InNote);
+	void EraseTimeSliceIfEmpty(const int InIndex);
+	void NotifyModified(const Time InTimeBegin, const Time InTimeEnd);
+	void InvalidateTimingIndices();
+	//puts the points of a single timeslice back into the indices, instead of gathering them again from every timeslice
+	void UpdateTimingIndices(TimeSlice& InTimeSlice);
+	void MarkTimingChanged();
+	std::vector<std::pair<Column, Note>> CollectSelection(const NoteReferenceCollection& InNotes);
+	Note* FindLongNotePartner(const Column InColumn, const Note& InNote);
+	bool HasBatchCollision(const std::vector<std::pair<Column, Note>>& InErasures, const std::vector<std::pair<Column, Note>>& InInsertions);
+	//moves every note and timing point from InTimeFrom on to the timepoint the mapping gives for it, except the bpm points at InFixedTimePoints.
+	//the mapping has to keep the notes of a column in order, they are then retimed in place
+	bool RemapTimePoints(const Time InTimeFrom, const std::vector<Time>& InFixedTimePoints, std::function<Time(const Time)> InMapping);
+
 	std::function<void(TimeSlice&)> _OnModified;	
 
+	ChartTransaction _OpenTransaction;
+	std::unordered_set<int> _OpenTransactionTimeSlices;
+	int _TransactionDepth = 0;
+
+	//rebuilt lazily from the earliest timepoint any bpm point or stop changed at
+	TempoMap _TempoMap;
+	Time _TempoMapInvalidTimePoint = std::numeric_limits<Time>::max();
+	Time _TimingChangeTimePoint = std::numeric_limits<Time>::max();
+
+	ScrollMap _ScrollMap;
+	bool _IsScrollMapStale = true;
+
+	//gathered again from the timeslices on the first query after a timing change
+	TimingIndex<BpmPoint> _BpmPointIndex;
+	TimingIndex<StopPoint> _StopIndex;
+	TimingIndex<ScrollVelocityMultiplier> _SvIndex;
+	TimingIndex<TimeSignature> _TimeSignatureIndex;
+
+	size_t _TimingRevision = 0;
+
+	//the chunks and timeslices the next snapshot shares with the last one, except for the ones marked dirty in the meantime
+	ChartSnapshot::NoteChunkMap _SnapshotNoteChunks;
+	ChartSnapshot::TimeSliceMap _SnapshotTimeSlices;
+	std::shared_ptr<const TempoMap> _SnapshotTempoMap;
+	std::shared_ptr<const ChartSnapshot> _Snapshot;
+
+	std::set<int> _DirtyNoteChunks;
+	std::set<int> _DirtyTimeSlices;
+
+	//follows every note journaled or replayed
+	NoteDensity _NoteDensity;
+
 	int _BpmPointCounter = 0;
 	bool _HasNegativePlacedBpmPoint = false;
 };
\ No newline at end of file
@@ -34,10 +34,16 @@ bool Configuration::Load()
 		ShowColumnLines = configFile["ShowColumnLines"].as<bool>();
 	if (configFile["ShowWaveform"])
 		ShowWaveform = configFile["ShowWaveform"].as<bool>();
+	if (configFile["PreviewScrollVelocities"])
+		PreviewScrollVelocities = configFile["PreviewScrollVelocities"].as<bool>();
 	if (configFile["UseAutoTiming"])
 		UseAutoTiming = configFile["UseAutoTiming"].as<bool>();
+	if (configFile["UseTempoRebase"])
+		UseTempoRebase = configFile["UseTempoRebase"].as<bool>();
 	if (configFile["ShowColumnHeatmap"])
 		ShowColumnHeatmap = configFile["ShowColumnHeatmap"].as<bool>();
+	if (configFile["HistoryMemoryBudget"])
+		HistoryMemoryBudget = configFile["HistoryMemoryBudget"].as<int>();
 
 	return true;
 }
@@ -57,10 +63,16 @@ void Configuration::Save()
 	out << YAML::Value << ShowColumnLines;
 	out << YAML::Key << "ShowWaveform";
 	out << YAML::Value << ShowWaveform;
+	out << YAML::Key << "PreviewScrollVelocities";
+	out << YAML::Value << PreviewScrollVelocities;
 	out << YAML::Key << "UseAutoTiming";
 	out << YAML::Value << UseAutoTiming;
+	out << YAML::Key << "UseTempoRebase";
+	out << YAML::Value << UseTempoRebase;
 	out << YAML::Key << "ShowColumnHeatmap";
 	out << YAML::Value << ShowColumnHeatmap;
+	out << YAML::Key << "HistoryMemoryBudget";
+	out << YAML::Value << HistoryMemoryBudget;
 	out << YAML::EndMap;
 
 	std::ofstream configFile("config.yaml");
@@ -12,9 +12,14 @@ struct Configuration
 	bool UsePitch = true;
 	bool ShowColumnLines = false;
 	bool ShowWaveform = true;
+	bool PreviewScrollVelocities = false;
 	bool UseAutoTiming = false;
+	bool UseTempoRebase = false;
 	bool ShowColumnHeatmap = false;
 
+	//in megabytes, undo history beyond it is spilled to disk
+	int HistoryMemoryBudget = 64;
+
 	const int RecentFilePathsMaxSize = 10;
 	//FIFO, but needs to remove invalid paths on access (like if the files have moved)
 	std::vector<std::string> RecentFilePaths;
@@ -17,7 +17,8 @@ struct Cursor
 	Time UnsnappedTimePoint = 0;
 	Column CursorColumn = 0;
 
-	std::vector<const Note*> HoveredNotes;
+	//sorted by timepoint
+	std::vector<NoteHandle> HoveredNotes;
 
 	int BeatSnap = -1;
 	int TimeFieldY = 0;
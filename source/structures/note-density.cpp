@@ -0,0 +1,236 @@
+#include "note-density.h"
+
+#include <algorithm>
+
+void NoteDensity::Add(const Column InColumn, const Time InTime, const int InAmount)
+{
+	_NoteAmount += InAmount;
+
+	if(InTime < 0)
+		return;
+
+	const size_t bucket = size_t(InTime / DENSITY_RESOLUTION);
+
+	//grown by doubling, so rebuilding the trees stays amortized constant per note
+	if(bucket >= _Total.Buckets.size())
+	{
+		const size_t bucketAmount = std::max(bucket + 1, _Total.Buckets.size() * 2);
+
+		_Total.Grow(bucketAmount);
+
+		for (auto& column : _Columns)
+			column.Grow(bucketAmount);
+
+		_Windows.Rebuild(_Total.Buckets);
+	}
+
+	if(InColumn >= _Columns.size())
+	{
+		_Columns.resize(InColumn + 1);
+
+		for (auto& column : _Columns)
+			column.Grow(_Total.Buckets.size());
+	}
+
+	_Total.Add(bucket, InAmount);
+	_Columns[InColumn].Add(bucket, InAmount);
+
+	const size_t windowBuckets = PEAK_DENSITY_WINDOW / DENSITY_RESOLUTION;
+	_Windows.Add(bucket + 1 > windowBuckets ? bucket + 1 - windowBuckets : 0, bucket + 1, InAmount);
+}
+
+void NoteDensity::AddBatch(const std::vector<std::pair<Column, Note>>& InNotes, const int InAmount)
+{
+	size_t bucketAmount = _Total.Buckets.size();
+	size_t columnAmount = _Columns.size();
+
+	for (const auto& [column, note] : InNotes)
+	{
+		if(note.TimePoint >= 0)
+			bucketAmount = std::max(bucketAmount, size_t(note.TimePoint / DENSITY_RESOLUTION) + 1);
+
+		columnAmount = std::max(columnAmount, size_t(column) + 1);
+	}
+
+	if(bucketAmount == 0 || InNotes.size() * DENSITY_BATCH_BUCKETS_PER_NOTE < bucketAmount)
+	{
+		for (const auto& [column, note] : InNotes)
+			Add(column, note.TimePoint, InAmount);
+
+		return;
+	}
+
+	_Total.Buckets.resize(bucketAmount, 0);
+	_Columns.resize(columnAmount);
+
+	for (auto& column : _Columns)
+		column.Buckets.resize(bucketAmount, 0);
+
+	for (const auto& [column, note] : InNotes)
+	{
+		_NoteAmount += InAmount;
+
+		if(note.TimePoint < 0)
+			continue;
+
+		const size_t bucket = size_t(note.TimePoint / DENSITY_RESOLUTION);
+
+		_Total.Buckets[bucket] += InAmount;
+		_Columns[column].Buckets[bucket] += InAmount;
+	}
+
+	_Total.Grow(bucketAmount);
+
+	for (auto& column : _Columns)
+		column.Grow(bucketAmount);
+
+	_Windows.Rebuild(_Total.Buckets);
+}
+
+void NoteDensity::Clear()
+{
+	*this = NoteDensity();
+}
+
+int NoteDensity::GetNoteAmount() const
+{
+	return _NoteAmount;
+}
+
+int NoteDensity::GetNoteAmountInTimeRange(const Time InTimeBegin, const Time InTimeEnd) const
+{
+	return CountInTimeRange(_Total, InTimeBegin, InTimeEnd);
+}
+
+int NoteDensity::GetNoteAmountInTimeRange(const Column InColumn, const Time InTimeBegin, const Time InTimeEnd) const
+{
+	if(InColumn >= _Columns.size())
+		return 0;
+
+	return CountInTimeRange(_Columns[InColumn], InTimeBegin, InTimeEnd);
+}
+
+int NoteDensity::GetPeakWindowNoteAmount() const
+{
+	return _Windows.GetMax();
+}
+
+int NoteDensity::CountInTimeRange(const FenwickTree& InTree, const Time InTimeBegin, const Time InTimeEnd) const
+{
+	const size_t bucketBegin = size_t(std::max(InTimeBegin, 0) / DENSITY_RESOLUTION);
+	const size_t bucketEnd = size_t(std::max(InTimeEnd, 0) / DENSITY_RESOLUTION);
+
+	if(bucketEnd <= bucketBegin)
+		return 0;
+
+	return InTree.GetPrefix(bucketEnd) - InTree.GetPrefix(bucketBegin);
+}
+
+void NoteDensity::FenwickTree::Add(const size_t InBucket, const int InAmount)
+{
+	Buckets[InBucket] += InAmount;
+
+	for (size_t index = InBucket + 1; index <= Tree.size(); index += index & (~index + 1))
+		Tree[index - 1] += InAmount;
+}
+
+int NoteDensity::FenwickTree::GetPrefix(size_t InBucketEnd) const
+{
+	int sum = 0;
+
+	for (size_t index = std::min(InBucketEnd, Tree.size()); index > 0; index -= index & (~index + 1))
+		sum += Tree[index - 1];
+
+	return sum;
+}
+
+void NoteDensity::FenwickTree::Grow(const size_t InBucketAmount)
+{
+	Buckets.resize(InBucketAmount, 0);
+	Tree.assign(Buckets.begin(), Buckets.end());
+
+	//every node hands its sum up to its parent once, building the tree in linear time
+	for (size_t index = 1; index <= Tree.size(); ++index)
+	{
+		const size_t parent = index + (index & (~index + 1));
+
+		if(parent <= Tree.size())
+			Tree[parent - 1] += Tree[index - 1];
+	}
+}
+
+void NoteDensity::WindowTree::Add(const size_t InWindowBegin, const size_t InWindowEnd, const int InAmount)
+{
+	if(WindowAmount == 0 || InWindowBegin >= InWindowEnd)
+		return;
+
+	Add(1, 0, WindowAmount, InWindowBegin, std::min(InWindowEnd, WindowAmount), InAmount);
+}
+
+void NoteDensity::WindowTree::Rebuild(const std::vector<int>& InBuckets)
+{
+	const size_t windowBuckets = PEAK_DENSITY_WINDOW / DENSITY_RESOLUTION;
+
+	WindowAmount = InBuckets.size();
+
+	//the window starting in every bucket, summed up with a running window
+	std::vector<int> windows(WindowAmount, 0);
+	int sum = 0;
+
+	for (size_t bucket = InBuckets.size(); bucket-- > 0;)
+	{
+		sum += InBuckets[bucket];
+
+		if(bucket + windowBuckets < InBuckets.size())
+			sum -= InBuckets[bucket + windowBuckets];
+
+		windows[bucket] = sum;
+	}
+
+	Max.assign(WindowAmount * 4, 0);
+	Pending.assign(WindowAmount * 4, 0);
+
+	Build(1, 0, WindowAmount, windows);
+}
+
+int NoteDensity::WindowTree::GetMax() const
+{
+	return Max.empty() ? 0 : Max[1];
+}
+
+void NoteDensity::WindowTree::Add(const size_t InNode, const size_t InNodeBegin, const size_t InNodeEnd, const size_t InWindowBegin, const size_t InWindowEnd, const int InAmount)
+{
+	if(InWindowEnd <= InNodeBegin || InNodeEnd <= InWindowBegin)
+		return;
+
+	//a node covered as a whole keeps the addition to itself instead of handing it down
+	if(InWindowBegin <= InNodeBegin && InNodeEnd <= InWindowEnd)
+	{
+		Max[InNode] += InAmount;
+		Pending[InNode] += InAmount;
+		return;
+	}
+
+	const size_t nodeMiddle = (InNodeBegin + InNodeEnd) / 2;
+
+	Add(InNode * 2, InNodeBegin, nodeMiddle, InWindowBegin, InWindowEnd, InAmount);
+	Add(InNode * 2 + 1, nodeMiddle, InNodeEnd, InWindowBegin, InWindowEnd, InAmount);
+
+	Max[InNode] = std::max(Max[InNode * 2], Max[InNode * 2 + 1]) + Pending[InNode];
+}
+
+void NoteDensity::WindowTree::Build(const size_t InNode, const size_t InNodeBegin, const size_t InNodeEnd, const std::vector<int>& InWindows)
+{
+	if(InNodeEnd - InNodeBegin == 1)
+	{
+		Max[InNode] = InWindows[InNodeBegin];
+		return;
+	}
+
+	const size_t nodeMiddle = (InNodeBegin + InNodeEnd) / 2;
+
+	Build(InNode * 2, InNodeBegin, nodeMiddle, InWindows);
+	Build(InNode * 2 + 1, nodeMiddle, InNodeEnd, InWindows);
+
+	Max[InNode] = std::max(Max[InNode * 2], Max[InNode * 2 + 1]);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+
+#include "chart-types.h"
+
+//the graph and the peak are counted in buckets of this many milliseconds
+#define DENSITY_RESOLUTION 10
+#define PEAK_DENSITY_WINDOW 1000
+
+//a batch needs at least one note per this many buckets to be worth rebuilding the trees for
+#define DENSITY_BATCH_BUCKETS_PER_NOTE 16
+
+/*
+* note counts over time, kept up to date with every note inserted or erased instead of being gathered from all notes on demand.
+* every column and the total have a fenwick tree over the buckets, so the notes within any time range are counted in O(log n).
+* the peak is a segment tree over every PEAK_DENSITY_WINDOW long window, a note adds to all windows containing it
+* and the densest one is always at the root. notes placed before 0 only count towards the total amount.
+*/
+class NoteDensity
+{
+public:
+
+	void Add(const Column InColumn, const Time InTime, const int InAmount);
+
+	//counts every note into its bucket first and rebuilds the trees once, a batch small against the buckets is added note by note
+	void AddBatch(const std::vector<std::pair<Column, Note>>& InNotes, const int InAmount);
+	void Clear();
+
+	int GetNoteAmount() const;
+
+	//within [InTimeBegin, InTimeEnd), rounded down to the resolution
+	int GetNoteAmountInTimeRange(const Time InTimeBegin, const Time InTimeEnd) const;
+	int GetNoteAmountInTimeRange(const Column InColumn, const Time InTimeBegin, const Time InTimeEnd) const;
+
+	//the most notes any PEAK_DENSITY_WINDOW long window holds
+	int GetPeakWindowNoteAmount() const;
+
+private:
+
+	struct FenwickTree
+	{
+		void Add(const size_t InBucket, const int InAmount);
+		int GetPrefix(size_t InBucketEnd) const;
+		void Grow(const size_t InBucketAmount);
+
+		std::vector<int> Buckets;
+		std::vector<int> Tree;
+	};
+
+	//range addition with the maximum at the root, its leaves are the windows starting in every bucket
+	struct WindowTree
+	{
+		void Add(const size_t InWindowBegin, const size_t InWindowEnd, const int InAmount);
+		void Rebuild(const std::vector<int>& InBuckets);
+		int GetMax() const;
+
+		void Add(const size_t InNode, const size_t InNodeBegin, const size_t InNodeEnd, const size_t InWindowBegin, const size_t InWindowEnd, const int InAmount);
+		void Build(const size_t InNode, const size_t InNodeBegin, const size_t InNodeEnd, const std::vector<int>& InWindows);
+
+		size_t WindowAmount = 0;
+
+		std::vector<int> Max;
+		std::vector<int> Pending;
+	};
+
+	int CountInTimeRange(const FenwickTree& InTree, const Time InTimeBegin, const Time InTimeEnd) const;
+
+	FenwickTree _Total;
+	std::vector<FenwickTree> _Columns;
+	WindowTree _Windows;
+
+	int _NoteAmount = 0;
+};
@@ -0,0 +1,584 @@
+#include "note-store.h"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_set>
+
+static bool IsLongNoteBegin(const Note& InNote)
+{
+	return InNote.Type == Note::EType::HoldBegin || InNote.Type == Note::EType::RollBegin;
+}
+
+Note& NoteStore::Insert(const Column InColumn, const Note& InNote)
+{
+	_NoteAmount++;
+
+	return InsertWithHandle(InColumn, InNote, AcquireSlot());
+}
+
+Note& NoteStore::Restore(const Column InColumn, const Note& InNote)
+{
+	_NoteAmount++;
+
+	return InsertWithHandle(InColumn, InNote, ReclaimSlot(InNote.Handle));
+}
+
+Note* NoteStore::Find(const Time InTime, const Column InColumn)
+{
+	return const_cast<Note*>(static_cast<const NoteStore*>(this)->Find(InTime, InColumn));
+}
+
+const Note* NoteStore::Find(const Time InTime, const Column InColumn) const
+{
+	if(InColumn >= _Columns.size())
+		return nullptr;
+
+	auto& notes = _Columns[InColumn].Notes;
+	size_t index = LowerBound(InTime, InColumn);
+
+	if(index == notes.size() || notes[index].TimePoint != InTime)
+		return nullptr;
+
+	return &notes[index];
+}
+
+Note* NoteStore::Resolve(const NoteHandle InHandle)
+{
+	Column column;
+
+	return Resolve(InHandle, column);
+}
+
+Note* NoteStore::Resolve(const NoteHandle InHandle, Column& OutColumn)
+{
+	if(InHandle.Slot >= _Slots.size())
+		return nullptr;
+
+	const NoteSlot& slot = _Slots[InHandle.Slot];
+
+	if(!slot.IsOccupied || slot.Generation != InHandle.Generation)
+		return nullptr;
+
+	auto& notes = _Columns[slot.NoteColumn].Notes;
+
+	//only the notes sharing the timepoint of the slot are candidates
+	for (size_t index = LowerBound(slot.TimePoint, slot.NoteColumn); index < notes.size() && notes[index].TimePoint == slot.TimePoint; ++index)
+	{
+		if(notes[index].Handle != InHandle)
+			continue;
+
+		OutColumn = slot.NoteColumn;
+
+		return &notes[index];
+	}
+
+	return nullptr;
+}
+
+Note* NoteStore::Update(const NoteHandle InHandle, const Column InColumn, const Note& InNote)
+{
+	Column formerColumn;
+	Note* note = Resolve(InHandle, formerColumn);
+
+	if(!note)
+		return nullptr;
+
+	auto& column = _Columns[formerColumn];
+	auto noteIt = column.Notes.begin() + (note - column.Notes.data());
+
+	if(IsLongNoteBegin(*noteIt))
+		RemoveLongNote(column, *noteIt);
+
+	column.Notes.erase(noteIt);
+	column.IsBlockIndexDirty = true;
+
+	return &InsertWithHandle(InColumn, InNote, InHandle);
+}
+
+void NoteStore::ApplyBatch(const std::vector<NoteHandle>& InErasures, std::vector<std::pair<Column, Note>>& InOutInsertions)
+{
+	std::unordered_set<NoteHandle, NoteHandleHash> erasedHandles;
+	std::vector<bool> isColumnAffected(_Columns.size(), false);
+
+	for (const NoteHandle handle : InErasures)
+	{
+		Column column;
+
+		if(!Resolve(handle, column) || !erasedHandles.insert(handle).second)
+			continue;
+
+		isColumnAffected[column] = true;
+	}
+
+	//handles taken over stay occupied, the remaining ones are freed
+	std::unordered_set<NoteHandle, NoteHandleHash> reusedHandles;
+
+	for (const auto& [column, note] : InOutInsertions)
+		if(erasedHandles.count(note.Handle))
+			reusedHandles.insert(note.Handle);
+
+	for (const NoteHandle handle : erasedHandles)
+		if(!reusedHandles.count(handle))
+			ReleaseSlot(handle);
+
+	std::vector<std::vector<Note>> insertionsPerColumn;
+
+	for (auto& [column, note] : InOutInsertions)
+	{
+		if(column >= insertionsPerColumn.size())
+			insertionsPerColumn.resize(column + 1);
+
+		if(!reusedHandles.count(note.Handle))
+			note.Handle = AcquireSlot();
+
+		insertionsPerColumn[column].push_back(note);
+	}
+
+	if(insertionsPerColumn.size() > _Columns.size())
+		_Columns.resize(insertionsPerColumn.size());
+
+	isColumnAffected.resize(_Columns.size(), false);
+
+	for (Column column = 0; column < insertionsPerColumn.size(); ++column)
+		isColumnAffected[column] = isColumnAffected[column] || !insertionsPerColumn[column].empty();
+
+	for (Column column = 0; column < _Columns.size(); ++column)
+	{
+		if(!isColumnAffected[column])
+			continue;
+
+		auto& noteColumn = _Columns[column];
+		auto& notes = noteColumn.Notes;
+
+		if(!erasedHandles.empty())
+			notes.erase(std::remove_if(notes.begin(), notes.end(), [&erasedHandles](const Note& InNote) { return erasedHandles.count(InNote.Handle) > 0; }), notes.end());
+
+		if(column < insertionsPerColumn.size() && !insertionsPerColumn[column].empty())
+		{
+			auto& insertions = insertionsPerColumn[column];
+
+			std::stable_sort(insertions.begin(), insertions.end(), [](const Note& lhs, const Note& rhs) { return lhs.TimePoint < rhs.TimePoint; });
+
+			for (const auto& note : insertions)
+			{
+				NoteSlot& slot = _Slots[note.Handle.Slot];
+				slot.NoteColumn = column;
+				slot.TimePoint = note.TimePoint;
+			}
+
+			//both sides are sorted, so they are merged rather than inserted one by one
+			std::vector<Note> mergedNotes;
+			mergedNotes.reserve(notes.size() + insertions.size());
+
+			std::merge(notes.begin(), notes.end(), insertions.begin(), insertions.end(), std::back_inserter(mergedNotes), [](const Note& lhs, const Note& rhs)
+			{
+				return lhs.TimePoint < rhs.TimePoint;
+			});
+
+			notes.swap(mergedNotes);
+		}
+
+		noteColumn.IsBlockIndexDirty = true;
+		RebuildLongNotes(noteColumn);
+	}
+
+	_NoteAmount = _NoteAmount - erasedHandles.size() + InOutInsertions.size();
+}
+
+void NoteStore::Retime(const std::vector<std::pair<Column, Note>>& InNotes)
+{
+	//every note is looked up before the first one is changed, the lookups rely on the block index
+	std::vector<Note*> storedNotes;
+	storedNotes.reserve(InNotes.size());
+
+	std::vector<bool> isColumnAffected(_Columns.size(), false);
+
+	for (const auto& [column, note] : InNotes)
+	{
+		Column storedColumn;
+		storedNotes.push_back(Resolve(note.Handle, storedColumn));
+
+		if(storedNotes.back())
+			isColumnAffected[storedColumn] = true;
+	}
+
+	for (size_t index = 0; index < InNotes.size(); ++index)
+	{
+		if(!storedNotes[index])
+			continue;
+
+		Note& storedNote = *storedNotes[index];
+		const Note& retimedNote = InNotes[index].second;
+
+		storedNote.TimePoint = retimedNote.TimePoint;
+		storedNote.TimePointBegin = retimedNote.TimePointBegin;
+		storedNote.TimePointEnd = retimedNote.TimePointEnd;
+
+		_Slots[storedNote.Handle.Slot].TimePoint = storedNote.TimePoint;
+	}
+
+	for (Column column = 0; column < _Columns.size(); ++column)
+	{
+		if(!isColumnAffected[column])
+			continue;
+
+		_Columns[column].IsBlockIndexDirty = true;
+		RebuildLongNotes(_Columns[column]);
+	}
+}
+
+bool NoteStore::Erase(const Time InTime, const Column InColumn)
+{
+	if(!Find(InTime, InColumn))
+		return false;
+
+	auto& column = _Columns[InColumn];
+	auto noteIt = column.Notes.begin() + LowerBound(InTime, InColumn);
+
+	if(IsLongNoteBegin(*noteIt))
+		RemoveLongNote(column, *noteIt);
+
+	ReleaseSlot(noteIt->Handle);
+
+	column.Notes.erase(noteIt);
+	column.IsBlockIndexDirty = true;
+
+	_NoteAmount--;
+
+	return true;
+}
+
+void NoteStore::Erase(const std::vector<NoteHandle>& InHandles)
+{
+	std::vector<std::pair<Column, Note>> insertions;
+
+	ApplyBatch(InHandles, insertions);
+}
+
+int NoteStore::EraseInTimeRange(const Time InTimeBegin, const Time InTimeEnd, const Column InColumn, std::function<bool(const Note&)> InPredicate)
+{
+	if(InColumn >= _Columns.size() || InTimeBegin > InTimeEnd)
+		return 0;
+
+	auto& column = _Columns[InColumn];
+
+	auto rangeBegin = column.Notes.begin() + LowerBound(InTimeBegin, InColumn);
+	auto rangeEnd = std::upper_bound(rangeBegin, column.Notes.end(), InTimeEnd, [](const Time InTime, const Note& InOther)
+	{
+		return InTime < InOther.TimePoint;
+	});
+
+	//partitioning instead of removing keeps the erased notes intact, so their long notes can be dropped as well
+	auto removedBegin = std::stable_partition(rangeBegin, rangeEnd, [&InPredicate](const Note& InNote) { return !InPredicate(InNote); });
+	int erasedAmount = int(rangeEnd - removedBegin);
+
+	if(!erasedAmount)
+		return 0;
+
+	for (auto noteIt = removedBegin; noteIt != rangeEnd; ++noteIt)
+	{
+		if(IsLongNoteBegin(*noteIt))
+			RemoveLongNote(column, *noteIt);
+
+		ReleaseSlot(noteIt->Handle);
+	}
+
+	column.Notes.erase(removedBegin, rangeEnd);
+	column.IsBlockIndexDirty = true;
+
+	_NoteAmount -= erasedAmount;
+
+	return erasedAmount;
+}
+
+size_t NoteStore::LowerBound(const Time InTime, const Column InColumn) const
+{
+	if(InColumn >= _Columns.size())
+		return 0;
+
+	const auto& column = _Columns[InColumn];
+
+	if(column.IsBlockIndexDirty)
+		RefreshBlockIndex(column);
+
+	//the first note at or after InTime is either within the block preceding the first block starting at or after InTime, or it is that block's first note
+	size_t block = std::lower_bound(column.BlockIndex.begin(), column.BlockIndex.end(), InTime) - column.BlockIndex.begin();
+
+	size_t searchBegin = block ? (block - 1) * NOTE_BLOCK_SIZE : 0;
+	size_t searchEnd = std::min(block * NOTE_BLOCK_SIZE, column.Notes.size());
+
+	return std::lower_bound(column.Notes.begin() + searchBegin, column.Notes.begin() + searchEnd, InTime, [](const Note& InOther, const Time InTime)
+	{
+		return InOther.TimePoint < InTime;
+	}) - column.Notes.begin();
+}
+
+void NoteStore::IterateNotesInTimeRange(const Time InTimeBegin, const Time InTimeEnd, std::function<void(Note&, const Column)> InWork)
+{
+	for (Column column = 0; column < _Columns.size(); ++column)
+	{
+		auto& notes = _Columns[column].Notes;
+
+		for (size_t index = LowerBound(InTimeBegin, column); index < notes.size() && notes[index].TimePoint <= InTimeEnd; ++index)
+			InWork(notes[index], column);
+	}
+}
+
+void NoteStore::IterateAllNotes(std::function<void(Note&, const Column)> InWork)
+{
+	//merges all columns so the notes come out in chronological order, which the exporters rely on
+	std::vector<size_t> cursors(_Columns.size(), 0);
+
+	while(true)
+	{
+		Column earliestColumn = _Columns.size();
+		Time earliestTime = std::numeric_limits<Time>::max();
+
+		for (Column column = 0; column < _Columns.size(); ++column)
+		{
+			const auto& notes = _Columns[column].Notes;
+
+			if(cursors[column] < notes.size() && (earliestColumn == _Columns.size() || notes[cursors[column]].TimePoint < earliestTime))
+			{
+				earliestColumn = column;
+				earliestTime = notes[cursors[column]].TimePoint;
+			}
+		}
+
+		if(earliestColumn == _Columns.size())
+			return;
+
+		InWork(_Columns[earliestColumn].Notes[cursors[earliestColumn]++], earliestColumn);
+	}
+}
+
+void NoteStore::IterateLongNotesInTimeRange(const Time InTimeBegin, const Time InTimeEnd, std::function<void(Note&, const Column)> InWork)
+{
+	for (Column column = 0; column < _Columns.size(); ++column)
+	{
+		auto& noteColumn = _Columns[column];
+
+		if(noteColumn.IsLongNoteReachDirty)
+			RefreshLongNoteReach(noteColumn);
+
+		size_t index = std::lower_bound(noteColumn.LongNoteReach.begin(), noteColumn.LongNoteReach.end(), InTimeBegin) - noteColumn.LongNoteReach.begin();
+
+		for (; index < noteColumn.LongNotes.size() && noteColumn.LongNotes[index].TimePointBegin <= InTimeEnd; ++index)
+		{
+			const LongNote& longNote = noteColumn.LongNotes[index];
+
+			if(longNote.TimePointEnd < InTimeBegin)
+				continue;
+
+			//the begin shares its timepoint with at most a handful of notes, such as the end of a directly preceding hold
+			for (size_t noteIndex = LowerBound(longNote.TimePointBegin, column); noteIndex < noteColumn.Notes.size() && noteColumn.Notes[noteIndex].TimePoint == longNote.TimePointBegin; ++noteIndex)
+			{
+				Note& note = noteColumn.Notes[noteIndex];
+
+				if(IsLongNoteBegin(note) && note.TimePointEnd == longNote.TimePointEnd)
+				{
+					InWork(note, column);
+					break;
+				}
+			}
+		}
+	}
+}
+
+std::vector<Note>& NoteStore::GetColumn(const Column InColumn)
+{
+	return FindOrAddColumn(InColumn).Notes;
+}
+
+size_t NoteStore::GetColumnAmount() const
+{
+	return _Columns.size();
+}
+
+size_t NoteStore::GetNoteAmount() const
+{
+	return _NoteAmount;
+}
+
+Time NoteStore::GetFirstTimePoint() const
+{
+	Time firstTimePoint = std::numeric_limits<Time>::max();
+
+	for(const auto& column : _Columns)
+		if(!column.Notes.empty())
+			firstTimePoint = std::min(firstTimePoint, column.Notes.front().TimePoint);
+
+	return firstTimePoint;
+}
+
+Time NoteStore::GetLastTimePoint() const
+{
+	Time lastTimePoint = std::numeric_limits<Time>::min();
+
+	for(const auto& column : _Columns)
+		if(!column.Notes.empty())
+			lastTimePoint = std::max(lastTimePoint, column.Notes.back().TimePoint);
+
+	return lastTimePoint;
+}
+
+bool NoteStore::IsEmpty() const
+{
+	return _NoteAmount == 0;
+}
+
+void NoteStore::Clear()
+{
+	//the slots are kept, handles to the cleared notes have to turn stale rather than point at whatever comes next
+	for (const auto& column : _Columns)
+		for (const auto& note : column.Notes)
+			ReleaseSlot(note.Handle);
+
+	_Columns.clear();
+	_NoteAmount = 0;
+}
+
+NoteStore::NoteColumn& NoteStore::FindOrAddColumn(const Column InColumn)
+{
+	if(InColumn >= _Columns.size())
+		_Columns.resize(InColumn + 1);
+
+	return _Columns[InColumn];
+}
+
+Note& NoteStore::InsertWithHandle(const Column InColumn, const Note& InNote, const NoteHandle InHandle)
+{
+	auto& column = FindOrAddColumn(InColumn);
+
+	//upper bound keeps notes sharing a timepoint in insertion order
+	auto noteIt = std::upper_bound(column.Notes.begin(), column.Notes.end(), InNote.TimePoint, [](const Time InTime, const Note& InOther)
+	{
+		return InTime < InOther.TimePoint;
+	});
+
+	noteIt = column.Notes.insert(noteIt, InNote);
+	noteIt->Handle = InHandle;
+	column.IsBlockIndexDirty = true;
+
+	if(IsLongNoteBegin(InNote))
+		AddLongNote(column, InNote);
+
+	NoteSlot& slot = _Slots[InHandle.Slot];
+	slot.NoteColumn = InColumn;
+	slot.TimePoint = InNote.TimePoint;
+
+	return *noteIt;
+}
+
+NoteHandle NoteStore::AcquireSlot()
+{
+	//a reclaimed slot is left in the free list and skipped once it comes up
+	while(!_FreeSlots.empty() && _Slots[_FreeSlots.back()].IsOccupied)
+		_FreeSlots.pop_back();
+
+	if(_FreeSlots.empty())
+	{
+		_FreeSlots.push_back((unsigned int)(_Slots.size()));
+		_Slots.emplace_back();
+	}
+
+	unsigned int slotIndex = _FreeSlots.back();
+	_FreeSlots.pop_back();
+
+	NoteSlot& slot = _Slots[slotIndex];
+	slot.IsOccupied = true;
+
+	return { slotIndex, slot.Generation };
+}
+
+NoteHandle NoteStore::ReclaimSlot(const NoteHandle InHandle)
+{
+	if(!InHandle.IsValid() || InHandle.Slot >= _Slots.size() || _Slots[InHandle.Slot].IsOccupied)
+		return AcquireSlot();
+
+	NoteSlot& slot = _Slots[InHandle.Slot];
+	slot.IsOccupied = true;
+	slot.Generation = InHandle.Generation;
+	slot.HighestGeneration = std::max(slot.HighestGeneration, InHandle.Generation);
+
+	return InHandle;
+}
+
+void NoteStore::ReleaseSlot(const NoteHandle InHandle)
+{
+	if(InHandle.Slot >= _Slots.size() || _Slots[InHandle.Slot].Generation != InHandle.Generation)
+		return;
+
+	NoteSlot& slot = _Slots[InHandle.Slot];
+	slot.IsOccupied = false;
+	slot.Generation = ++slot.HighestGeneration;
+
+	_FreeSlots.push_back(InHandle.Slot);
+}
+
+void NoteStore::RefreshLongNoteReach(const NoteColumn& InColumn) const
+{
+	InColumn.LongNoteReach.clear();
+
+	Time reach = std::numeric_limits<Time>::min();
+
+	for (const auto& longNote : InColumn.LongNotes)
+	{
+		reach = std::max(reach, longNote.TimePointEnd);
+		InColumn.LongNoteReach.push_back(reach);
+	}
+
+	InColumn.IsLongNoteReachDirty = false;
+}
+
+void NoteStore::AddLongNote(NoteColumn& OutColumn, const Note& InNote)
+{
+	auto longNoteIt = std::upper_bound(OutColumn.LongNotes.begin(), OutColumn.LongNotes.end(), InNote.TimePointBegin, [](const Time InTime, const LongNote& InOther)
+	{
+		return InTime < InOther.TimePointBegin;
+	});
+
+	OutColumn.LongNotes.insert(longNoteIt, { InNote.TimePointBegin, InNote.TimePointEnd });
+	OutColumn.IsLongNoteReachDirty = true;
+}
+
+void NoteStore::RemoveLongNote(NoteColumn& OutColumn, const Note& InNote)
+{
+	auto longNoteIt = std::lower_bound(OutColumn.LongNotes.begin(), OutColumn.LongNotes.end(), InNote.TimePointBegin, [](const LongNote& InOther, const Time InTime)
+	{
+		return InOther.TimePointBegin < InTime;
+	});
+
+	for (; longNoteIt != OutColumn.LongNotes.end() && longNoteIt->TimePointBegin == InNote.TimePointBegin; ++longNoteIt)
+	{
+		if(longNoteIt->TimePointEnd != InNote.TimePointEnd)
+			continue;
+
+		OutColumn.LongNotes.erase(longNoteIt);
+		OutColumn.IsLongNoteReachDirty = true;
+
+		return;
+	}
+}
+
+void NoteStore::RebuildLongNotes(NoteColumn& OutColumn)
+{
+	OutColumn.LongNotes.clear();
+
+	//the notes are sorted by timepoint, which for a long note's begin is its begin
+	for (const auto& note : OutColumn.Notes)
+		if(IsLongNoteBegin(note))
+			OutColumn.LongNotes.push_back({ note.TimePointBegin, note.TimePointEnd });
+
+	OutColumn.IsLongNoteReachDirty = true;
+}
+
+void NoteStore::RefreshBlockIndex(const NoteColumn& InColumn) const
+{
+	InColumn.BlockIndex.clear();
+
+	for (size_t index = 0; index < InColumn.Notes.size(); index += NOTE_BLOCK_SIZE)
+		InColumn.BlockIndex.push_back(InColumn.Notes[index].TimePoint);
+
+	InColumn.IsBlockIndexDirty = false;
+}
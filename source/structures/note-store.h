@@ -0,0 +1,111 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+
+#include "chart-types.h"
+
+#define NOTE_BLOCK_SIZE 64
+
+struct LongNote
+{
+	Time TimePointBegin;
+	Time TimePointEnd;
+};
+
+/*
+* column-major note storage. every column owns one contiguous array of notes sorted by timepoint,
+* next to a coarse index holding the timepoint of every NOTE_BLOCK_SIZE'th note. seeks binary search the
+* coarse index first and only then the notes of a single block, so lookups stay O(log n) and cache friendly.
+* holds and rolls are additionally kept per column as a sorted interval list, so the bodies overlapping a time range are found in O(log n + k).
+* a reference handed out is only valid until the next insertion or erasure in the same column, to hold onto a note
+* across edits use its handle instead. the slot table maps every handle to the column and timepoint of its note.
+*/
+class NoteStore
+{
+public:
+
+	Note& Insert(const Column InColumn, const Note& InNote);
+	//inserts a note taken back by undo or redo under the handle it carries, so handles held onto it resolve again.
+	//a handle whose slot has been taken by another note in the meantime is replaced by a new one
+	Note& Restore(const Column InColumn, const Note& InNote);
+	Note* Find(const Time InTime, const Column InColumn);
+	const Note* Find(const Time InTime, const Column InColumn) const;
+
+	Note* Resolve(const NoteHandle InHandle);
+	Note* Resolve(const NoteHandle InHandle, Column& OutColumn);
+
+	//replaces the note in place, it keeps its handle even when it ends up at another timepoint or in another column
+	Note* Update(const NoteHandle InHandle, const Column InColumn, const Note& InNote);
+
+	//erases and inserts any amount of notes in one pass per affected column. inserted notes carrying the handle of an erased note take it over,
+	//every other one is handed the handle it got
+	void ApplyBatch(const std::vector<NoteHandle>& InErasures, std::vector<std::pair<Column, Note>>& InOutInsertions);
+	//rewrites the timepoints of the notes found by the handles in place. they have to leave every column in the same order,
+	//so nothing is erased or inserted and every note keeps its handle
+	void Retime(const std::vector<std::pair<Column, Note>>& InNotes);
+
+	bool Erase(const Time InTime, const Column InColumn);
+	void Erase(const std::vector<NoteHandle>& InHandles);
+	int EraseInTimeRange(const Time InTimeBegin, const Time InTimeEnd, const Column InColumn, std::function<bool(const Note&)> InPredicate);
+
+	size_t LowerBound(const Time InTime, const Column InColumn) const;
+
+	void IterateNotesInTimeRange(const Time InTimeBegin, const Time InTimeEnd, std::function<void(Note&, const Column)> InWork);
+	void IterateAllNotes(std::function<void(Note&, const Column)> InWork);
+	void IterateLongNotesInTimeRange(const Time InTimeBegin, const Time InTimeEnd, std::function<void(Note&, const Column)> InWork);
+
+	std::vector<Note>& GetColumn(const Column InColumn);
+	size_t GetColumnAmount() const;
+	size_t GetNoteAmount() const;
+	Time GetFirstTimePoint() const;
+	Time GetLastTimePoint() const;
+	bool IsEmpty() const;
+	void Clear();
+
+private:
+
+	struct NoteColumn
+	{
+		std::vector<Note> Notes;
+
+		mutable std::vector<Time> BlockIndex;
+		mutable bool IsBlockIndexDirty = false;
+
+		//sorted by begin, LongNoteReach holds the running maximum of the ends so the first long note reaching into a time range can be binary searched
+		std::vector<LongNote> LongNotes;
+		mutable std::vector<Time> LongNoteReach;
+		mutable bool IsLongNoteReachDirty = false;
+	};
+
+	struct NoteSlot
+	{
+		Column NoteColumn = 0;
+		Time TimePoint = 0;
+
+		unsigned int Generation = 1;
+		//a restored handle brings back an older generation, freeing the slot again continues after the highest one ever issued
+		unsigned int HighestGeneration = 1;
+		bool IsOccupied = false;
+	};
+
+	NoteColumn& FindOrAddColumn(const Column InColumn);
+	Note& InsertWithHandle(const Column InColumn, const Note& InNote, const NoteHandle InHandle);
+
+	NoteHandle AcquireSlot();
+	NoteHandle ReclaimSlot(const NoteHandle InHandle);
+	void ReleaseSlot(const NoteHandle InHandle);
+
+	void RefreshBlockIndex(const NoteColumn& InColumn) const;
+	void RefreshLongNoteReach(const NoteColumn& InColumn) const;
+
+	void AddLongNote(NoteColumn& OutColumn, const Note& InNote);
+	void RemoveLongNote(NoteColumn& OutColumn, const Note& InNote);
+	void RebuildLongNotes(NoteColumn& OutColumn);
+
+	std::vector<NoteColumn> _Columns;
+	size_t _NoteAmount = 0;
+
+	std::vector<NoteSlot> _Slots;
+	std::vector<unsigned int> _FreeSlots;
+};
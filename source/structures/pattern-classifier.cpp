@@ -0,0 +1,193 @@
+#include "pattern-classifier.h"
+
+#include <algorithm>
+
+#include "chart-snapshot.h"
+
+//share of the rows in a section needed for it to count as the pattern
+#define PATTERN_JACK_SHARE 0.5
+#define PATTERN_CHORDJACK_SHARE 0.5
+#define PATTERN_HAND_SHARE 0.15
+#define PATTERN_JUMP_SHARE 0.15
+#define PATTERN_TRILL_SHARE 0.6
+
+static uint32_t CountBits(uint32_t InMask)
+{
+	InMask = InMask - ((InMask >> 1) & 0x55555555u);
+	InMask = (InMask & 0x33333333u) + ((InMask >> 2) & 0x33333333u);
+
+	return (((InMask + (InMask >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+}
+
+static int GetSectionIndex(const Time InTime)
+{
+	return InTime >= 0 ? InTime / PATTERN_SECTION_LENGTH : -((PATTERN_SECTION_LENGTH - 1 - InTime) / PATTERN_SECTION_LENGTH);
+}
+
+void PatternClassifier::Analyze(const ChartSnapshot& InSnapshot)
+{
+	GatherRows(InSnapshot);
+	ClassifyRows();
+}
+
+const std::vector<PatternSection>& PatternClassifier::GetSections() const
+{
+	return _Sections;
+}
+
+EPatternType PatternClassifier::GetPatternAt(const Time InTime) const
+{
+	auto sectionIt = std::upper_bound(_Sections.begin(), _Sections.end(), InTime, [](const Time InTime, const PatternSection& InSection)
+	{
+		return InTime < InSection.TimeBegin;
+	});
+
+	if (sectionIt == _Sections.begin() || InTime >= (--sectionIt)->TimeEnd)
+		return EPatternType::None;
+
+	return sectionIt->Type;
+}
+
+const char* PatternClassifier::GetPatternName(const EPatternType InType)
+{
+	switch (InType)
+	{
+	case EPatternType::Stream: return "Stream";
+	case EPatternType::Jumpstream: return "Jumpstream";
+	case EPatternType::Handstream: return "Handstream";
+	case EPatternType::Jacks: return "Jacks";
+	case EPatternType::Trills: return "Trills";
+	case EPatternType::Chordjacks: return "Chordjacks";
+	default: return "None";
+	}
+}
+
+static bool IsRowNote(const Note& InNote)
+{
+	return InNote.Type == Note::EType::Common || InNote.Type == Note::EType::HoldBegin || InNote.Type == Note::EType::RollBegin || InNote.Type == Note::EType::Lift;
+}
+
+void PatternClassifier::GatherRows(const ChartSnapshot& InSnapshot)
+{
+	_RowTimePoints.clear();
+	_RowMasks.clear();
+
+	_RowTimePoints.reserve(InSnapshot.GetNoteAmount());
+	_RowMasks.reserve(InSnapshot.GetNoteAmount());
+
+	//a chunk spans few enough milliseconds to give every one of them a mask, the notes are sorted into rows by their timepoint alone
+	std::vector<uint32_t> chunkMasks(SNAPSHOT_CHUNK_LENGTH, 0);
+
+	for (const auto& [index, chunk] : InSnapshot.GetNoteChunks())
+	{
+		const Time chunkTimeBegin = index * SNAPSHOT_CHUNK_LENGTH;
+		const Column columnAmount = std::min<Column>(chunk->Columns.size(), 32);
+
+		for (Column column = 0; column < columnAmount; ++column)
+			for (const auto& note : chunk->Columns[column])
+				chunkMasks[note.TimePoint - chunkTimeBegin] |= uint32_t(IsRowNote(note)) << column;
+
+		for (Time offset = 0; offset < SNAPSHOT_CHUNK_LENGTH; ++offset)
+		{
+			if (!chunkMasks[offset])
+				continue;
+
+			_RowTimePoints.push_back(chunkTimeBegin + offset);
+			_RowMasks.push_back(chunkMasks[offset]);
+
+			chunkMasks[offset] = 0;
+		}
+	}
+}
+
+void PatternClassifier::ClassifyRows()
+{
+	const size_t rowAmount = _RowMasks.size();
+	const uint32_t* masks = _RowMasks.data();
+
+	_RowChordSizes.resize(rowAmount);
+	_RowIsJack.resize(rowAmount);
+	_RowIsTrill.resize(rowAmount);
+
+	_Sections.clear();
+
+	if (rowAmount == 0)
+		return;
+
+	for (size_t row = 0; row < rowAmount; ++row)
+		_RowChordSizes[row] = uint8_t(CountBits(masks[row]));
+
+	//a jack hits a column the row right before it did
+	_RowIsJack[0] = 0;
+
+	for (size_t row = 1; row < rowAmount; ++row)
+		_RowIsJack[row] = uint8_t((masks[row] & masks[row - 1]) != 0);
+
+	//a trill goes back and forth between two single notes
+	std::fill_n(_RowIsTrill.begin(), std::min<size_t>(rowAmount, 2), uint8_t(0));
+
+	for (size_t row = 2; row < rowAmount; ++row)
+		_RowIsTrill[row] = uint8_t((masks[row] == masks[row - 2]) & (masks[row] != masks[row - 1]) & (_RowChordSizes[row] == 1) & (_RowChordSizes[row - 1] == 1));
+
+	size_t rowBegin = 0;
+
+	while (rowBegin < rowAmount)
+	{
+		const int sectionIndex = GetSectionIndex(_RowTimePoints[rowBegin]);
+		const Time sectionTimeEnd = (sectionIndex + 1) * PATTERN_SECTION_LENGTH;
+
+		const size_t rowEnd = std::lower_bound(_RowTimePoints.begin() + rowBegin, _RowTimePoints.end(), sectionTimeEnd) - _RowTimePoints.begin();
+		const EPatternType type = ClassifySection(rowBegin, rowEnd);
+
+		if (type != EPatternType::None)
+		{
+			const Time sectionTimeBegin = sectionIndex * PATTERN_SECTION_LENGTH;
+
+			if (!_Sections.empty() && _Sections.back().Type == type && _Sections.back().TimeEnd == sectionTimeBegin)
+				_Sections.back().TimeEnd = sectionTimeEnd;
+			else
+				_Sections.push_back({ sectionTimeBegin, sectionTimeEnd, type });
+		}
+
+		rowBegin = rowEnd;
+	}
+}
+
+EPatternType PatternClassifier::ClassifySection(const size_t InRowBegin, const size_t InRowEnd) const
+{
+	const size_t rowAmount = InRowEnd - InRowBegin;
+
+	if (rowAmount < PATTERN_MIN_ROW_AMOUNT)
+		return EPatternType::None;
+
+	int jumpAmount = 0;
+	int handAmount = 0;
+	int jackAmount = 0;
+	int chordJackAmount = 0;
+	int trillAmount = 0;
+
+	for (size_t row = InRowBegin; row < InRowEnd; ++row)
+	{
+		jumpAmount += _RowChordSizes[row] == 2;
+		handAmount += _RowChordSizes[row] >= 3;
+		jackAmount += _RowIsJack[row];
+		chordJackAmount += _RowIsJack[row] & (_RowChordSizes[row] >= 2);
+		trillAmount += _RowIsTrill[row];
+	}
+
+	const double rows = double(rowAmount);
+
+	if (jackAmount >= rows * PATTERN_JACK_SHARE)
+		return chordJackAmount >= jackAmount * PATTERN_CHORDJACK_SHARE ? EPatternType::Chordjacks : EPatternType::Jacks;
+
+	if (handAmount >= rows * PATTERN_HAND_SHARE)
+		return EPatternType::Handstream;
+
+	if (jumpAmount >= rows * PATTERN_JUMP_SHARE)
+		return EPatternType::Jumpstream;
+
+	if (trillAmount >= rows * PATTERN_TRILL_SHARE)
+		return EPatternType::Trills;
+
+	return EPatternType::Stream;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "chart-types.h"
+
+class ChartSnapshot;
+
+//the chart is classified in sections of this many milliseconds, neighbouring sections of the same pattern are joined afterwards
+#define PATTERN_SECTION_LENGTH 1000
+#define PATTERN_MIN_ROW_AMOUNT 4
+
+enum class EPatternType
+{
+	None,
+	Stream,
+	Jumpstream,
+	Handstream,
+	Jacks,
+	Trills,
+	Chordjacks,
+
+	COUNT
+};
+
+struct PatternSection
+{
+	Time TimeBegin = 0;
+	Time TimeEnd = 0;
+
+	EPatternType Type = EPatternType::None;
+};
+
+/*
+* recognizes patterns in a chart by looking at its rows, every timepoint holding a note is a row and its columns are a bitmask.
+* jacks, chords and trills all come down to comparing a row with the ones before it, so each property is worked out
+* for all rows at once in a loop over the plain mask array without any branches, which the compiler turns into vector instructions.
+* the rows of every section are then counted up and the most telling property decides the pattern.
+*/
+class PatternClassifier
+{
+public:
+
+	void Analyze(const ChartSnapshot& InSnapshot);
+
+	const std::vector<PatternSection>& GetSections() const;
+	EPatternType GetPatternAt(const Time InTime) const;
+
+	static const char* GetPatternName(const EPatternType InType);
+
+private:
+
+	void GatherRows(const ChartSnapshot& InSnapshot);
+	void ClassifyRows();
+
+	EPatternType ClassifySection(const size_t InRowBegin, const size_t InRowEnd) const;
+
+	//one entry per row, columns past the 32nd are left out
+	std::vector<Time> _RowTimePoints;
+	std::vector<uint32_t> _RowMasks;
+
+	std::vector<uint8_t> _RowChordSizes;
+	std::vector<uint8_t> _RowIsJack;
+	std::vector<uint8_t> _RowIsTrill;
+
+	std::vector<PatternSection> _Sections;
+};
@@ -0,0 +1,140 @@
+#include "scroll-map.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "tempo-map.h"
+
+//a cursor jumping further than this many anchors ahead searches for the timepoint instead of stepping there
+#define SCROLL_CURSOR_MAX_STEPS 8
+
+void ScrollMap::Build(const TempoMap& InTempoMap, const std::vector<ScrollVelocityMultiplier*>& InSVs)
+{
+	_Anchors.clear();
+
+	const std::vector<TempoAnchor>& tempoAnchors = InTempoMap.GetAnchors();
+	const double referenceBeatLength = tempoAnchors.empty() ? 0.0 : tempoAnchors.front().BeatLength;
+
+	double beatLength = referenceBeatLength;
+	double multiplier = 1.0;
+	bool isFrozen = false;
+
+	size_t tempoIndex = 0;
+	size_t svIndex = 0;
+
+	while (tempoIndex < tempoAnchors.size() || svIndex < InSVs.size())
+	{
+		const Time tempoTimePoint = tempoIndex < tempoAnchors.size() ? tempoAnchors[tempoIndex].TimePoint : std::numeric_limits<Time>::max();
+		const Time svTimePoint = svIndex < InSVs.size() ? InSVs[svIndex]->TimePoint : std::numeric_limits<Time>::max();
+		const Time timePoint = std::min(tempoTimePoint, svTimePoint);
+
+		//of several changes on one timepoint the last one is in effect
+		for (; tempoIndex < tempoAnchors.size() && tempoAnchors[tempoIndex].TimePoint == timePoint; ++tempoIndex)
+		{
+			beatLength = tempoAnchors[tempoIndex].BeatLength;
+			isFrozen = tempoAnchors[tempoIndex].IsFrozen;
+		}
+
+		for (; svIndex < InSVs.size() && InSVs[svIndex]->TimePoint == timePoint; ++svIndex)
+			multiplier = InSVs[svIndex]->Multiplier;
+
+		const double tempoSpeed = referenceBeatLength > 0.0 && beatLength > 0.0 ? referenceBeatLength / beatLength : 1.0;
+		const double speed = isFrozen ? 0.0 : std::max(0.0, multiplier) * tempoSpeed;
+
+		//a change keeping the speed needs no anchor, as long as nothing changes the speed every timepoint is its own position
+		if (speed == (_Anchors.empty() ? 1.0 : _Anchors.back().Speed))
+			continue;
+
+		const double position = _Anchors.empty() ? double(timePoint) : GetPositionAtAnchor(_Anchors.size() - 1, timePoint);
+
+		_Anchors.push_back({ timePoint, position, speed });
+	}
+}
+
+double ScrollMap::GetPosition(const Time InTime) const
+{
+	if (_Anchors.empty())
+		return double(InTime);
+
+	return GetPositionAtAnchor(GetAnchorIndex(InTime), InTime);
+}
+
+double ScrollMap::GetTimeFromPosition(const double InPosition) const
+{
+	if (_Anchors.empty())
+		return InPosition;
+
+	const ScrollAnchor& firstAnchor = _Anchors.front();
+
+	if (InPosition < firstAnchor.Position)
+		return double(firstAnchor.TimePoint) - (firstAnchor.Position - InPosition);
+
+	auto anchorIt = std::upper_bound(_Anchors.begin(), _Anchors.end(), InPosition, [](const double InPosition, const ScrollAnchor& InAnchor)
+	{
+		return InPosition < InAnchor.Position;
+	});
+
+	const ScrollAnchor& anchor = *(--anchorIt);
+
+	//only the last anchor can stand still past the position, any other is followed by one further on
+	if (anchor.Speed <= 0.0)
+		return double(anchor.TimePoint);
+
+	return double(anchor.TimePoint) + (InPosition - anchor.Position) / anchor.Speed;
+}
+
+bool ScrollMap::IsEmpty() const
+{
+	return _Anchors.empty();
+}
+
+size_t ScrollMap::GetAnchorIndex(const Time InTime) const
+{
+	auto anchorIt = std::upper_bound(_Anchors.begin(), _Anchors.end(), InTime, [](const Time InTime, const ScrollAnchor& InAnchor)
+	{
+		return InTime < InAnchor.TimePoint;
+	});
+
+	return anchorIt == _Anchors.begin() ? 0 : size_t(anchorIt - _Anchors.begin()) - 1;
+}
+
+double ScrollMap::GetPositionAtAnchor(const size_t InAnchorIndex, const Time InTime) const
+{
+	const ScrollAnchor& anchor = _Anchors[InAnchorIndex];
+
+	//only happens on the first anchor, the field scrolls at speed 1 before it
+	if (InTime < anchor.TimePoint)
+		return anchor.Position - double(anchor.TimePoint - InTime);
+
+	return anchor.Position + double(InTime - anchor.TimePoint) * anchor.Speed;
+}
+
+ScrollCursor::ScrollCursor(const ScrollMap& InScrollMap)
+	: _ScrollMap(InScrollMap)
+{
+}
+
+double ScrollCursor::GetPosition(const Time InTime)
+{
+	const std::vector<ScrollAnchor>& anchors = _ScrollMap._Anchors;
+
+	if (anchors.empty())
+		return double(InTime);
+
+	//the map may have been built again since the last timepoint
+	if (_AnchorIndex >= anchors.size() || InTime < anchors[_AnchorIndex].TimePoint)
+		_AnchorIndex = _ScrollMap.GetAnchorIndex(InTime);
+
+	for (int step = 0; _AnchorIndex + 1 < anchors.size() && anchors[_AnchorIndex + 1].TimePoint <= InTime; ++step)
+	{
+		if (step == SCROLL_CURSOR_MAX_STEPS)
+		{
+			_AnchorIndex = _ScrollMap.GetAnchorIndex(InTime);
+			break;
+		}
+
+		++_AnchorIndex;
+	}
+
+	return _ScrollMap.GetPositionAtAnchor(_AnchorIndex, InTime);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+
+#include "chart-types.h"
+
+class TempoMap;
+
+struct ScrollAnchor
+{
+	Time TimePoint;
+
+	//how far the field has scrolled at this anchor, in milliseconds at the speed of the first bpm point
+	double Position;
+
+	//the speed in effect from this anchor on, the sv multiplier times the tempo relative to the first bpm point
+	double Speed;
+};
+
+/*
+* prefix integral of the scroll speed over the bpm points, stops and sv of a chart, which is where every note sits on the timefield
+* as players see it. every anchor stores the position reached at its timepoint, so a timepoint is placed by a binary search over
+* the anchors and a linear step within one of them. a stop holds the field still and negative sv are taken as standing still as well,
+* so the position never decreases and can be turned back into a timepoint. before the first anchor the field scrolls at speed 1,
+* a chart without timing maps every timepoint onto itself.
+*/
+class ScrollMap
+{
+public:
+
+	void Build(const TempoMap& InTempoMap, const std::vector<ScrollVelocityMultiplier*>& InSVs);
+
+	double GetPosition(const Time InTime) const;
+
+	//the last timepoint reaching the position, a position the field stands still on resolves to where it moves on again
+	double GetTimeFromPosition(const double InPosition) const;
+
+	bool IsEmpty() const;
+
+private:
+
+	friend class ScrollCursor;
+
+	size_t GetAnchorIndex(const Time InTime) const;
+	double GetPositionAtAnchor(const size_t InAnchorIndex, const Time InTime) const;
+
+	std::vector<ScrollAnchor> _Anchors;
+};
+
+/*
+* walks a scroll map along timepoints handed over in ascending order, stepping from anchor to anchor rather than searching
+* for every one of them. a timepoint going backwards is searched for again, so any order gives the right position.
+*/
+class ScrollCursor
+{
+public:
+
+	explicit ScrollCursor(const ScrollMap& InScrollMap);
+
+	double GetPosition(const Time InTime);
+
+private:
+
+	const ScrollMap& _ScrollMap;
+	size_t _AnchorIndex = 0;
+};
@@ -0,0 +1,541 @@
+#include "strain-rating.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <thread>
+#include <tuple>
+
+#include "chart-snapshot.h"
+
+#define INDIVIDUAL_DECAY_BASE 0.125
+#define OVERALL_DECAY_BASE 0.30
+#define HOLD_FACTOR 1.25
+#define HOLD_TOLERANCE 1.0
+#define SECTION_WEIGHT_DECAY 0.9
+#define STAR_SCALING_FACTOR 0.018
+
+//strains closer than this to the ones of the last update count as the same
+#define STRAIN_EPSILON 1e-9
+
+static double ApplyDecay(const double InValue, const double InDeltaTime, const double InDecayBase)
+{
+	return InValue * std::pow(InDecayBase, InDeltaTime / 1000.0);
+}
+
+static long long GetSection(const double InTime)
+{
+	return (long long)std::floor(InTime / STRAIN_SECTION_LENGTH);
+}
+
+static bool IsStrainEqual(const double InLhs, const double InRhs)
+{
+	return std::abs(InLhs - InRhs) <= STRAIN_EPSILON * std::max(1.0, std::abs(InRhs));
+}
+
+StrainRating::StrainRating()
+{
+	_Worker = std::thread(&StrainRating::Work, this);
+}
+
+StrainRating::~StrainRating()
+{
+	{
+		std::lock_guard<std::mutex> lock(_Mutex);
+		_IsStopping = true;
+	}
+
+	_Condition.notify_one();
+	_Worker.join();
+}
+
+void StrainRating::Submit(std::shared_ptr<const ChartSnapshot> InSnapshot)
+{
+	if (!InSnapshot || InSnapshot == _SubmittedSnapshot)
+		return;
+
+	_SubmittedSnapshot = InSnapshot;
+
+	{
+		std::lock_guard<std::mutex> lock(_Mutex);
+
+		//a snapshot not picked up yet is simply replaced, the worker compares against the one it calculated last
+		_PendingSnapshot = std::move(InSnapshot);
+	}
+
+	_Condition.notify_one();
+}
+
+void StrainRating::Clear()
+{
+	_SubmittedSnapshot.reset();
+
+	std::lock_guard<std::mutex> lock(_Mutex);
+
+	_PendingSnapshot.reset();
+	_IsClearPending = true;
+	_ClearCount++;
+
+	_StarRatings.clear();
+	_SectionPeaks.clear();
+}
+
+void StrainRating::Wait()
+{
+	std::unique_lock<std::mutex> lock(_Mutex);
+	_IdleCondition.wait(lock, [this]() { return !_IsWorking && !_PendingSnapshot; });
+}
+
+double StrainRating::GetRate(const size_t InRateIndex) const
+{
+	return STRAIN_RATE_MIN + STRAIN_RATE_STEP * double(InRateIndex);
+}
+
+double StrainRating::GetStarRating(const size_t InRateIndex) const
+{
+	std::lock_guard<std::mutex> lock(_Mutex);
+
+	return InRateIndex < _StarRatings.size() ? _StarRatings[InRateIndex] : 0.0;
+}
+
+std::vector<double> StrainRating::GetSectionPeaks(const size_t InRateIndex) const
+{
+	std::lock_guard<std::mutex> lock(_Mutex);
+
+	return InRateIndex < _SectionPeaks.size() ? _SectionPeaks[InRateIndex] : std::vector<double>();
+}
+
+void StrainRating::Work()
+{
+	while (true)
+	{
+		std::shared_ptr<const ChartSnapshot> snapshot;
+		bool isClear = false;
+		size_t clearCount = 0;
+
+		{
+			std::unique_lock<std::mutex> lock(_Mutex);
+			_Condition.wait(lock, [this]() { return _IsStopping || _PendingSnapshot; });
+
+			if (_IsStopping)
+				return;
+
+			snapshot = std::move(_PendingSnapshot);
+			_PendingSnapshot.reset();
+
+			isClear = _IsClearPending;
+			_IsClearPending = false;
+
+			clearCount = _ClearCount;
+			_IsWorking = true;
+		}
+
+		if (isClear)
+			ClearCalculation();
+
+		Calculate(snapshot);
+
+		{
+			std::lock_guard<std::mutex> lock(_Mutex);
+
+			if (clearCount == _ClearCount)
+			{
+				_StarRatings.resize(_RateStrains.size());
+				_SectionPeaks.resize(_RateStrains.size());
+
+				for (size_t rateIndex = 0; rateIndex < _RateStrains.size(); ++rateIndex)
+				{
+					_StarRatings[rateIndex] = _RateStrains[rateIndex].StarRating;
+					_SectionPeaks[rateIndex] = _RateStrains[rateIndex].SectionPeaks;
+				}
+			}
+
+			_IsWorking = false;
+		}
+
+		_IdleCondition.notify_all();
+	}
+}
+
+void StrainRating::Calculate(const std::shared_ptr<const ChartSnapshot>& InSnapshot)
+{
+	if (InSnapshot == _Snapshot)
+		return;
+
+	Time timeBegin = std::numeric_limits<Time>::min();
+	Time timeEnd = std::numeric_limits<Time>::max();
+
+	//chunks still shared with the last snapshot hold the very same notes, any other chunk is compared note by note
+	if (_Snapshot && _KeyAmount == InSnapshot->GetKeyAmount() && !_RateStrains.empty())
+	{
+		const auto& previousChunks = _Snapshot->GetNoteChunks();
+		const auto& chunks = InSnapshot->GetNoteChunks();
+
+		int firstChangedChunk = std::numeric_limits<int>::max();
+		int lastChangedChunk = std::numeric_limits<int>::min();
+
+		auto markChanged = [&firstChangedChunk, &lastChangedChunk](const int InChunkIndex)
+		{
+			firstChangedChunk = std::min(firstChangedChunk, InChunkIndex);
+			lastChangedChunk = std::max(lastChangedChunk, InChunkIndex);
+		};
+
+		for (const auto& [index, chunk] : chunks)
+		{
+			const auto previousChunkIt = previousChunks.find(index);
+
+			if ((previousChunkIt == previousChunks.end() || previousChunkIt->second != chunk) && !IsChunkUnchanged(*InSnapshot, index))
+				markChanged(index);
+		}
+
+		for (const auto& [index, chunk] : previousChunks)
+			if (chunks.find(index) == chunks.end() && !IsChunkUnchanged(*InSnapshot, index))
+				markChanged(index);
+
+		if (firstChangedChunk > lastChangedChunk)
+		{
+			_Snapshot = InSnapshot;
+			return;
+		}
+
+		timeBegin = firstChangedChunk * SNAPSHOT_CHUNK_LENGTH;
+		timeEnd = (lastChangedChunk + 1) * SNAPSHOT_CHUNK_LENGTH;
+	}
+	else
+	{
+		_Notes = StrainNotes();
+		_RateStrains.clear();
+	}
+
+	_Snapshot = InSnapshot;
+	_KeyAmount = InSnapshot->GetKeyAmount();
+
+	const long long previousNoteAmount = (long long)_Notes.TimePoints.size();
+	ReplaceNotes(*InSnapshot, timeBegin, timeEnd);
+	const long long noteAmountDelta = (long long)_Notes.TimePoints.size() - previousNoteAmount;
+
+	if (_RateStrains.empty())
+	{
+		_RateStrains.resize(STRAIN_RATE_AMOUNT);
+
+		for (size_t rateIndex = 0; rateIndex < _RateStrains.size(); ++rateIndex)
+			_RateStrains[rateIndex].Rate = STRAIN_RATE_MIN + STRAIN_RATE_STEP * double(rateIndex);
+	}
+
+	//the rates do not depend on each other, so they are spread over as many threads as there are cores
+	const size_t threadAmount = std::min<size_t>(_RateStrains.size(), std::max(1u, std::thread::hardware_concurrency()));
+
+	auto calculateRates = [this, threadAmount, timeBegin, timeEnd, noteAmountDelta](const size_t InThreadIndex)
+	{
+		for (size_t rateIndex = InThreadIndex; rateIndex < _RateStrains.size(); rateIndex += threadAmount)
+		{
+			CalculateRate(_RateStrains[rateIndex], timeBegin, timeEnd, noteAmountDelta);
+			CalculateStarRating(_RateStrains[rateIndex]);
+		}
+	};
+
+	std::vector<std::thread> threads;
+
+	for (size_t threadIndex = 1; threadIndex < threadAmount; ++threadIndex)
+		threads.emplace_back(calculateRates, threadIndex);
+
+	calculateRates(0);
+
+	for (auto& thread : threads)
+		thread.join();
+}
+
+void StrainRating::ClearCalculation()
+{
+	_Snapshot.reset();
+	_Notes = StrainNotes();
+	_RateStrains.clear();
+	_KeyAmount = 0;
+}
+
+void StrainRating::GatherNotes(const ChartSnapshot& InSnapshot, const Time InTimeBegin, const Time InTimeEnd, StrainNotes& OutNotes) const
+{
+	std::vector<std::tuple<Time, unsigned int, Time>> notes;
+
+	auto gatherNote = [&notes](const Note& InNote, const Column InColumn)
+	{
+		switch (InNote.Type)
+		{
+		case Note::EType::Common:
+		case Note::EType::Lift:
+			notes.emplace_back(InNote.TimePoint, (unsigned int)InColumn, InNote.TimePoint);
+			break;
+
+		case Note::EType::HoldBegin:
+		case Note::EType::RollBegin:
+			notes.emplace_back(InNote.TimePoint, (unsigned int)InColumn, std::max(InNote.TimePoint, InNote.TimePointEnd));
+			break;
+
+		default:
+			break;
+		}
+	};
+
+	//the chunk index of the widest range there is would overflow
+	if (InTimeBegin == std::numeric_limits<Time>::min() && InTimeEnd == std::numeric_limits<Time>::max())
+		InSnapshot.IterateAllNotes(gatherNote);
+	else
+		InSnapshot.IterateNotesInTimeRange(InTimeBegin, InTimeEnd - 1, gatherNote);
+
+	//the snapshot hands them out column by column within a chunk
+	std::sort(notes.begin(), notes.end());
+
+	OutNotes.TimePoints.reserve(notes.size());
+	OutNotes.TimePointEnds.reserve(notes.size());
+	OutNotes.Columns.reserve(notes.size());
+
+	for (const auto& [timePoint, column, timePointEnd] : notes)
+	{
+		OutNotes.TimePoints.push_back(timePoint);
+		OutNotes.Columns.push_back(column);
+		OutNotes.TimePointEnds.push_back(timePointEnd);
+	}
+}
+
+void StrainRating::ReplaceNotes(const ChartSnapshot& InSnapshot, const Time InTimeBegin, const Time InTimeEnd)
+{
+	StrainNotes notes;
+	GatherNotes(InSnapshot, InTimeBegin, InTimeEnd, notes);
+
+	const size_t begin = std::lower_bound(_Notes.TimePoints.begin(), _Notes.TimePoints.end(), InTimeBegin) - _Notes.TimePoints.begin();
+	const size_t end = std::lower_bound(_Notes.TimePoints.begin(), _Notes.TimePoints.end(), InTimeEnd) - _Notes.TimePoints.begin();
+
+	auto splice = [begin, end](auto& OutValues, const auto& InValues)
+	{
+		OutValues.erase(OutValues.begin() + begin, OutValues.begin() + end);
+		OutValues.insert(OutValues.begin() + begin, InValues.begin(), InValues.end());
+	};
+
+	splice(_Notes.TimePoints, notes.TimePoints);
+	splice(_Notes.TimePointEnds, notes.TimePointEnds);
+	splice(_Notes.Columns, notes.Columns);
+}
+
+bool StrainRating::IsChunkUnchanged(const ChartSnapshot& InSnapshot, const int InChunkIndex) const
+{
+	const Time timeBegin = InChunkIndex * SNAPSHOT_CHUNK_LENGTH;
+	const Time timeEnd = timeBegin + SNAPSHOT_CHUNK_LENGTH;
+
+	StrainNotes notes;
+	GatherNotes(InSnapshot, timeBegin, timeEnd, notes);
+
+	const size_t begin = std::lower_bound(_Notes.TimePoints.begin(), _Notes.TimePoints.end(), timeBegin) - _Notes.TimePoints.begin();
+	const size_t end = std::lower_bound(_Notes.TimePoints.begin(), _Notes.TimePoints.end(), timeEnd) - _Notes.TimePoints.begin();
+
+	if (end - begin != notes.TimePoints.size())
+		return false;
+
+	return std::equal(notes.TimePoints.begin(), notes.TimePoints.end(), _Notes.TimePoints.begin() + begin)
+		&& std::equal(notes.TimePointEnds.begin(), notes.TimePointEnds.end(), _Notes.TimePointEnds.begin() + begin)
+		&& std::equal(notes.Columns.begin(), notes.Columns.end(), _Notes.Columns.begin() + begin);
+}
+
+void StrainRating::CalculateRate(RateStrain& InOutRateStrain, const Time InTimeBegin, const Time InTimeEnd, const long long InNoteAmountDelta) const
+{
+	const size_t noteAmount = _Notes.TimePoints.size();
+	const size_t keyAmount = size_t(std::max(_KeyAmount, 1));
+	const double rate = InOutRateStrain.Rate;
+
+	RateCheckpoints& checkpoints = InOutRateStrain.Checkpoints;
+	std::vector<double>& peaks = InOutRateStrain.SectionPeaks;
+
+	if (noteAmount == 0)
+	{
+		peaks.clear();
+		checkpoints = RateCheckpoints();
+		return;
+	}
+
+	const long long firstSection = GetSection(double(_Notes.TimePoints.front()) / rate);
+	const long long previousSectionAmount = (long long)checkpoints.NoteIndices.size();
+
+	//a section ahead of the first note changes which section is which, everything is calculated anew
+	if (firstSection != InOutRateStrain.FirstSection || previousSectionAmount == 0)
+	{
+		InOutRateStrain.FirstSection = firstSection;
+		peaks.clear();
+		checkpoints = RateCheckpoints();
+	}
+
+	const long long sectionAmount = (long long)checkpoints.NoteIndices.size();
+
+	//the checkpoint of the section the edit begins in has seen none of it
+	long long section = 0;
+
+	if (sectionAmount > 0 && InTimeBegin != std::numeric_limits<Time>::min())
+		section = std::clamp(GetSection(double(InTimeBegin) / rate) - firstSection, 0LL, sectionAmount - 1);
+
+	//past the section the edit ends in, a state equal to the one of the last update means the rest has not changed either
+	long long convergenceSection = std::numeric_limits<long long>::max();
+
+	if (InTimeEnd != std::numeric_limits<Time>::max())
+		convergenceSection = GetSection(double(InTimeEnd) / rate) - firstSection + 1;
+
+	std::vector<double> individualStrains(keyAmount, 0.0);
+	std::vector<double> holdEndTimePoints(keyAmount, 0.0);
+	double overallStrain = 1.0;
+	double previousTimePoint = double(_Notes.TimePoints.front()) / rate;
+	size_t noteIndex = 0;
+
+	if (section > 0)
+	{
+		noteIndex = checkpoints.NoteIndices[section];
+		overallStrain = checkpoints.OverallStrains[section];
+		previousTimePoint = checkpoints.PreviousTimePoints[section];
+
+		std::copy_n(checkpoints.IndividualStrains.begin() + section * keyAmount, keyAmount, individualStrains.begin());
+		std::copy_n(checkpoints.HoldEndTimePoints.begin() + section * keyAmount, keyAmount, holdEndTimePoints.begin());
+	}
+
+	auto getInitialStrain = [&](const long long InSection)
+	{
+		if (noteIndex == 0)
+			return 0.0;
+
+		const double sectionTimePoint = double(firstSection + InSection) * STRAIN_SECTION_LENGTH;
+		const double deltaTime = sectionTimePoint - previousTimePoint;
+
+		return ApplyDecay(individualStrains[_Notes.Columns[noteIndex - 1]], deltaTime, INDIVIDUAL_DECAY_BASE) + ApplyDecay(overallStrain, deltaTime, OVERALL_DECAY_BASE);
+	};
+
+	auto isConverged = [&](const long long InSection)
+	{
+		if (InSection < convergenceSection || InSection >= sectionAmount)
+			return false;
+
+		if ((long long)checkpoints.NoteIndices[InSection] + InNoteAmountDelta != (long long)noteIndex)
+			return false;
+
+		if (checkpoints.PreviousTimePoints[InSection] != previousTimePoint || !IsStrainEqual(overallStrain, checkpoints.OverallStrains[InSection]))
+			return false;
+
+		for (size_t column = 0; column < keyAmount; ++column)
+		{
+			if (checkpoints.HoldEndTimePoints[InSection * keyAmount + column] != holdEndTimePoints[column])
+				return false;
+
+			if (!IsStrainEqual(individualStrains[column], checkpoints.IndividualStrains[InSection * keyAmount + column]))
+				return false;
+		}
+
+		return true;
+	};
+
+	auto storeCheckpoint = [&](const long long InSection)
+	{
+		if (InSection >= (long long)checkpoints.NoteIndices.size())
+		{
+			checkpoints.NoteIndices.resize(InSection + 1);
+			checkpoints.OverallStrains.resize(InSection + 1);
+			checkpoints.PreviousTimePoints.resize(InSection + 1);
+			checkpoints.IndividualStrains.resize((InSection + 1) * keyAmount);
+			checkpoints.HoldEndTimePoints.resize((InSection + 1) * keyAmount);
+		}
+
+		checkpoints.NoteIndices[InSection] = noteIndex;
+		checkpoints.OverallStrains[InSection] = overallStrain;
+		checkpoints.PreviousTimePoints[InSection] = previousTimePoint;
+
+		std::copy_n(individualStrains.begin(), keyAmount, checkpoints.IndividualStrains.begin() + InSection * keyAmount);
+		std::copy_n(holdEndTimePoints.begin(), keyAmount, checkpoints.HoldEndTimePoints.begin() + InSection * keyAmount);
+	};
+
+	auto storePeak = [&peaks](const long long InSection, const double InPeak)
+	{
+		if (InSection >= (long long)peaks.size())
+			peaks.resize(InSection + 1);
+
+		peaks[InSection] = InPeak;
+	};
+
+	storeCheckpoint(section);
+	double peak = getInitialStrain(section);
+
+	for (; noteIndex < noteAmount; ++noteIndex)
+	{
+		const double timePoint = double(_Notes.TimePoints[noteIndex]) / rate;
+		const double timePointEnd = double(_Notes.TimePointEnds[noteIndex]) / rate;
+		const unsigned int column = std::min<unsigned int>(_Notes.Columns[noteIndex], (unsigned int)keyAmount - 1);
+
+		const long long noteSection = GetSection(timePoint) - firstSection;
+
+		while (section < noteSection)
+		{
+			storePeak(section, peak);
+			section++;
+
+			if (isConverged(section))
+			{
+				for (long long index = section; index < sectionAmount; ++index)
+					checkpoints.NoteIndices[index] = size_t((long long)checkpoints.NoteIndices[index] + InNoteAmountDelta);
+
+				return;
+			}
+
+			storeCheckpoint(section);
+			peak = getInitialStrain(section);
+		}
+
+		const double deltaTime = timePoint - previousTimePoint;
+
+		double holdFactor = 1.0;
+		double holdAddition = 0.0;
+
+		for (size_t otherColumn = 0; otherColumn < keyAmount; ++otherColumn)
+		{
+			const double holdEndTimePoint = holdEndTimePoints[otherColumn];
+
+			//a note ending after a hold that is held through its beginning
+			if (holdEndTimePoint > timePoint + HOLD_TOLERANCE && timePointEnd > holdEndTimePoint + HOLD_TOLERANCE)
+				holdAddition = 1.0;
+
+			if (std::abs(timePointEnd - holdEndTimePoint) < HOLD_TOLERANCE)
+				holdAddition = 0.0;
+
+			//a note within a hold is harder to hit
+			if (holdEndTimePoint > timePointEnd + HOLD_TOLERANCE)
+				holdFactor = HOLD_FACTOR;
+
+			individualStrains[otherColumn] = ApplyDecay(individualStrains[otherColumn], deltaTime, INDIVIDUAL_DECAY_BASE);
+		}
+
+		holdEndTimePoints[column] = timePointEnd;
+		individualStrains[column] += 2.0 * holdFactor;
+		overallStrain = ApplyDecay(overallStrain, deltaTime, OVERALL_DECAY_BASE) + (1.0 + holdAddition) / holdFactor;
+		previousTimePoint = timePoint;
+
+		peak = std::max(peak, individualStrains[column] + overallStrain);
+	}
+
+	storePeak(section, peak);
+
+	peaks.resize(section + 1);
+	checkpoints.NoteIndices.resize(section + 1);
+	checkpoints.OverallStrains.resize(section + 1);
+	checkpoints.PreviousTimePoints.resize(section + 1);
+	checkpoints.IndividualStrains.resize((section + 1) * keyAmount);
+	checkpoints.HoldEndTimePoints.resize((section + 1) * keyAmount);
+}
+
+void StrainRating::CalculateStarRating(RateStrain& InOutRateStrain) const
+{
+	std::vector<double> peaks = InOutRateStrain.SectionPeaks;
+	std::sort(peaks.begin(), peaks.end(), std::greater<double>());
+
+	double difficulty = 0.0;
+	double weight = 1.0;
+
+	for (const double peak : peaks)
+	{
+		difficulty += peak * weight;
+		weight *= SECTION_WEIGHT_DECAY;
+	}
+
+	InOutRateStrain.StarRating = difficulty * STAR_SCALING_FACTOR;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+
+#include "chart-types.h"
+
+class ChartSnapshot;
+
+//strain peaks are taken per section of this many milliseconds, at the rate the chart is played at
+#define STRAIN_SECTION_LENGTH 400.0
+
+//0.5x to 2.0x
+#define STRAIN_RATE_MIN 0.5
+#define STRAIN_RATE_STEP 0.1
+#define STRAIN_RATE_AMOUNT 16
+
+/*
+* an osu!mania style star rating, calculated for every rate between STRAIN_RATE_MIN and 2.0x at once, one thread per batch of rates.
+* every column builds up its own strain, the overall strain is shared by all of them, and a hold being held through a note makes it harder.
+* the state of every rate is remembered at the beginning of each section, so an edit is calculated again from the section it lands in
+* until the state turns out to be the same as before, anything past that keeps its strain from the last update.
+* snapshots are handed over to a worker thread like for the linter, the getters give the rating of the last snapshot it got through.
+*/
+class StrainRating
+{
+public:
+
+	StrainRating();
+	~StrainRating();
+
+	StrainRating(const StrainRating&) = delete;
+	StrainRating& operator=(const StrainRating&) = delete;
+
+	//the worker works out what changed since the snapshot it got last and calculates only that again, the same snapshot twice is ignored
+	void Submit(std::shared_ptr<const ChartSnapshot> InSnapshot);
+
+	//throws the rating away, the next snapshot submitted is calculated from scratch
+	void Clear();
+
+	//blocks until the worker is through with everything submitted so far
+	void Wait();
+
+	double GetRate(const size_t InRateIndex) const;
+	double GetStarRating(const size_t InRateIndex) const;
+
+	//the peak strain of every section from the first note on, at the given rate
+	std::vector<double> GetSectionPeaks(const size_t InRateIndex) const;
+
+private:
+
+	//the notes that make up the strain sorted by timepoint, holds and rolls carry the timepoint they end at
+	struct StrainNotes
+	{
+		std::vector<Time> TimePoints;
+		std::vector<Time> TimePointEnds;
+		std::vector<unsigned int> Columns;
+	};
+
+	//the strain right before the first note of a section, the per column values of every section are laid out one after another
+	struct RateCheckpoints
+	{
+		std::vector<size_t> NoteIndices;
+		std::vector<double> OverallStrains;
+		std::vector<double> PreviousTimePoints;
+
+		std::vector<double> IndividualStrains;
+		std::vector<double> HoldEndTimePoints;
+	};
+
+	struct RateStrain
+	{
+		double Rate = 1.0;
+		double StarRating = 0.0;
+
+		//sections are counted from the one the first note is in
+		long long FirstSection = 0;
+
+		std::vector<double> SectionPeaks;
+		RateCheckpoints Checkpoints;
+	};
+
+	void Work();
+	void Calculate(const std::shared_ptr<const ChartSnapshot>& InSnapshot);
+	void ClearCalculation();
+
+	void GatherNotes(const ChartSnapshot& InSnapshot, const Time InTimeBegin, const Time InTimeEnd, StrainNotes& OutNotes) const;
+	void ReplaceNotes(const ChartSnapshot& InSnapshot, const Time InTimeBegin, const Time InTimeEnd);
+
+	//whether the notes of the chunk make up the same strain as before, which they still do when only their snaps changed
+	bool IsChunkUnchanged(const ChartSnapshot& InSnapshot, const int InChunkIndex) const;
+
+	void CalculateRate(RateStrain& InOutRateStrain, const Time InTimeBegin, const Time InTimeEnd, const long long InNoteAmountDelta) const;
+	void CalculateStarRating(RateStrain& InOutRateStrain) const;
+
+	//main thread only
+	std::shared_ptr<const ChartSnapshot> _SubmittedSnapshot;
+
+	mutable std::mutex _Mutex;
+	std::condition_variable _Condition;
+	std::condition_variable _IdleCondition;
+
+	//guarded by the mutex
+	std::shared_ptr<const ChartSnapshot> _PendingSnapshot;
+	bool _IsClearPending = false;
+	bool _IsWorking = false;
+	bool _IsStopping = false;
+
+	std::vector<double> _StarRatings;
+	std::vector<std::vector<double>> _SectionPeaks;
+
+	//results of a calculation still running while the rating is cleared are dropped
+	size_t _ClearCount = 0;
+
+	//worker thread only
+	std::shared_ptr<const ChartSnapshot> _Snapshot;
+
+	StrainNotes _Notes;
+	std::vector<RateStrain> _RateStrains;
+
+	int _KeyAmount = 0;
+
+	std::thread _Worker;
+};
@@ -0,0 +1,224 @@
+#include "tempo-map.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+Time TempoMap::Truncate(const Time InTimeFrom)
+{
+	Time timeFrom = InTimeFrom;
+
+	//a stop in progress may still be changed by bpm points within it, so it is rebuilt from its beginning
+	while(!_Anchors.empty() && (_Anchors.back().TimePoint >= timeFrom || _Anchors.back().IsFrozen))
+	{
+		timeFrom = std::min(timeFrom, _Anchors.back().TimePoint);
+		_Anchors.pop_back();
+	}
+
+	return timeFrom;
+}
+
+void TempoMap::Append(std::vector<BpmPoint> InBpmPoints, std::vector<StopPoint> InStops)
+{
+	std::sort(InBpmPoints.begin(), InBpmPoints.end(), [](const auto& lhs, const auto& rhs) { return lhs.TimePoint < rhs.TimePoint; });
+	std::sort(InStops.begin(), InStops.end(), [](const auto& lhs, const auto& rhs) { return lhs.TimePoint < rhs.TimePoint; });
+
+	Time frozenUntil = std::numeric_limits<Time>::min();
+	bool isSectionBeginOnResume = false;
+
+	auto resumeIfDue = [this, &frozenUntil, &isSectionBeginOnResume](const Time InTime)
+	{
+		if(_Anchors.empty() || !_Anchors.back().IsFrozen || InTime < frozenUntil)
+			return;
+
+		const TempoAnchor& frozenAnchor = _Anchors.back();
+		_Anchors.push_back({ frozenUntil, frozenAnchor.Beat, frozenAnchor.BeatLength, false, isSectionBeginOnResume });
+
+		isSectionBeginOnResume = false;
+	};
+
+	size_t bpmIndex = 0;
+	size_t stopIndex = 0;
+
+	//bpm points go first on equal timepoints, so a stop placed on a bpm point already freezes at the new tempo
+	while(bpmIndex < InBpmPoints.size() || stopIndex < InStops.size())
+	{
+		const bool isBpmPointNext = stopIndex == InStops.size() || (bpmIndex < InBpmPoints.size() && InBpmPoints[bpmIndex].TimePoint <= InStops[stopIndex].TimePoint);
+
+		if(isBpmPointNext)
+		{
+			const BpmPoint& bpmPoint = InBpmPoints[bpmIndex++];
+
+			resumeIfDue(bpmPoint.TimePoint);
+
+			if(_Anchors.empty())
+			{
+				_Anchors.push_back({ bpmPoint.TimePoint, 0.0, bpmPoint.BeatLength, false, true });
+				continue;
+			}
+
+			if(_Anchors.back().IsFrozen)
+			{
+				_Anchors.back().BeatLength = bpmPoint.BeatLength;
+				isSectionBeginOnResume = true;
+				continue;
+			}
+
+			_Anchors.push_back({ bpmPoint.TimePoint, GetBeatAtAnchor(_Anchors.back(), bpmPoint.TimePoint), bpmPoint.BeatLength, false, true });
+		}
+		else
+		{
+			const StopPoint& stop = InStops[stopIndex++];
+
+			resumeIfDue(stop.TimePoint);
+
+			if(_Anchors.empty() || stop.Length <= 0.0)
+				continue;
+
+			const Time stopLength = Time(std::round(stop.Length * 1000.0));
+
+			//overlapping stops chain up
+			if(_Anchors.back().IsFrozen)
+			{
+				frozenUntil += stopLength;
+				continue;
+			}
+
+			const TempoAnchor& previousAnchor = _Anchors.back();
+			_Anchors.push_back({ stop.TimePoint, GetBeatAtAnchor(previousAnchor, stop.TimePoint), previousAnchor.BeatLength, true, false });
+
+			frozenUntil = stop.TimePoint + stopLength;
+		}
+	}
+
+	resumeIfDue(std::numeric_limits<Time>::max());
+
+	_Revision++;
+}
+
+double TempoMap::GetBeatFromTime(const Time InTime) const
+{
+	if(_Anchors.empty())
+		return 0.0;
+
+	const TempoAnchor& firstAnchor = _Anchors.front();
+
+	if(InTime < firstAnchor.TimePoint)
+		return firstAnchor.Beat - double(firstAnchor.TimePoint - InTime) / firstAnchor.BeatLength;
+
+	return GetBeatAtAnchor(_Anchors[GetAnchorIndex(InTime)], InTime);
+}
+
+double TempoMap::GetTimeFromBeat(const double InBeat) const
+{
+	if(_Anchors.empty())
+		return 0.0;
+
+	//the first anchor reaching the beat, on a stop this is the timepoint it starts at
+	auto anchorIt = std::lower_bound(_Anchors.begin(), _Anchors.end(), InBeat, [](const TempoAnchor& InAnchor, const double InBeat)
+	{
+		return InAnchor.Beat < InBeat;
+	});
+
+	if(anchorIt != _Anchors.end() && anchorIt->Beat == InBeat)
+		return double(anchorIt->TimePoint);
+
+	if(anchorIt != _Anchors.begin())
+		--anchorIt;
+
+	return double(anchorIt->TimePoint) + (InBeat - anchorIt->Beat) * anchorIt->BeatLength;
+}
+
+double TempoMap::GetSectionBeat(const Time InTime) const
+{
+	if(_Anchors.empty())
+		return 0.0;
+
+	for (size_t index = GetAnchorIndex(InTime) + 1; index-- > 0;)
+		if(_Anchors[index].IsSectionBegin)
+			return _Anchors[index].Beat;
+
+	return _Anchors.front().Beat;
+}
+
+BeatPosition TempoMap::GetBeatPosition(const Time InTime) const
+{
+	if(_Anchors.empty())
+		return BeatPosition();
+
+	const double beat = GetBeatFromTime(InTime);
+	const double wholeBeat = std::floor(beat);
+	const double fraction = beat - wholeBeat;
+
+	const int denominator = GetBeatDenominator(fraction, GetBeatLength(InTime));
+
+	if(denominator == 0)
+		return BeatPosition();
+
+	return MakeBeatPosition((long long)(wholeBeat) * denominator + (long long)(std::round(fraction * denominator)), denominator);
+}
+
+bool TempoMap::IsAtBeatPosition(const Time InTime, const BeatPosition& InPosition) const
+{
+	if(_Anchors.empty() || !InPosition.IsValid())
+		return false;
+
+	//compared in beats, every timepoint within a stop shares the beat the stop is placed on
+	return std::abs(GetBeatFromTime(InTime) - InPosition.GetBeat()) * GetBeatLength(InTime) <= BEAT_TOLERANCE;
+}
+
+double TempoMap::GetBeatLength(const Time InTime) const
+{
+	if(_Anchors.empty())
+		return 0.0;
+
+	if(InTime < _Anchors.front().TimePoint)
+		return _Anchors.front().BeatLength;
+
+	return _Anchors[GetAnchorIndex(InTime)].BeatLength;
+}
+
+bool TempoMap::IsEmpty() const
+{
+	return _Anchors.empty();
+}
+
+size_t TempoMap::GetRevision() const
+{
+	return _Revision;
+}
+
+const std::vector<TempoAnchor>& TempoMap::GetAnchors() const
+{
+	return _Anchors;
+}
+
+int TempoMap::GetBeatDenominator(const double InFraction, const double InBeatLength)
+{
+	//5ths, 7ths and 9ths are tried before the finer fractions so their notes are not pulled onto a nearby 16th
+	static const int denominators[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 12, 16, 24, 48 };
+
+	for (const int denominator : denominators)
+		if(std::abs(InFraction - std::round(InFraction * denominator) / denominator) * InBeatLength <= BEAT_TOLERANCE)
+			return denominator;
+
+	return 0;
+}
+
+size_t TempoMap::GetAnchorIndex(const Time InTime) const
+{
+	auto anchorIt = std::upper_bound(_Anchors.begin(), _Anchors.end(), InTime, [](const Time InTime, const TempoAnchor& InAnchor)
+	{
+		return InTime < InAnchor.TimePoint;
+	});
+
+	return anchorIt == _Anchors.begin() ? 0 : size_t(anchorIt - _Anchors.begin()) - 1;
+}
+
+double TempoMap::GetBeatAtAnchor(const TempoAnchor& InAnchor, const Time InTime) const
+{
+	if(InAnchor.IsFrozen)
+		return InAnchor.Beat;
+
+	return InAnchor.Beat + double(InTime - InAnchor.TimePoint) / InAnchor.BeatLength;
+}
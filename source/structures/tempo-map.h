@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+
+#include "chart-types.h"
+
+//a timepoint this many milliseconds off a grid line still counts as sitting on it
+#define BEAT_TOLERANCE 2.0
+
+struct TempoAnchor
+{
+	Time TimePoint;
+	double Beat;
+
+	//the tempo in effect from this anchor on, kept on frozen anchors as well so the resuming anchor knows it
+	double BeatLength;
+
+	//a frozen anchor starts a stop, the beat does not advance until the next anchor
+	bool IsFrozen = false;
+
+	//placed by a bpm point, the beat grid of a section counts from here
+	bool IsSectionBegin = false;
+};
+
+/*
+* prefix sums of beats over the bpm points and stops of a chart. every anchor stores the beat reached at its timepoint,
+* so converting between time and beat is a binary search over the anchors plus a linear step within one of them.
+* beat 0 lies on the first bpm point, stops placed before it are ignored.
+* the revision increases with every rebuild, so anything derived from the timing can tell whether it went stale.
+*/
+class TempoMap
+{
+public:
+
+	//drops every anchor depending on timing at or after InTimeFrom and returns the timepoint from which timing has to be appended again
+	Time Truncate(const Time InTimeFrom);
+	void Append(std::vector<BpmPoint> InBpmPoints, std::vector<StopPoint> InStops);
+
+	double GetBeatFromTime(const Time InTime) const;
+	double GetTimeFromBeat(const double InBeat) const;
+	double GetSectionBeat(const Time InTime) const;
+
+	//the exact position of a timepoint on the grid, unknown when it lies on none of the fractions GetBeatDenominator tries
+	BeatPosition GetBeatPosition(const Time InTime) const;
+	bool IsAtBeatPosition(const Time InTime, const BeatPosition& InPosition) const;
+
+	//the length of one beat in milliseconds at the timepoint, before the first bpm point the first tempo is carried back
+	double GetBeatLength(const Time InTime) const;
+
+	bool IsEmpty() const;
+	size_t GetRevision() const;
+
+	const std::vector<TempoAnchor>& GetAnchors() const;
+
+	//the smallest denominator up to 1/48 whose fraction is within the tolerance of the beat fraction, 0 when there is none
+	static int GetBeatDenominator(const double InFraction, const double InBeatLength);
+
+private:
+
+	size_t GetAnchorIndex(const Time InTime) const;
+	double GetBeatAtAnchor(const TempoAnchor& InAnchor, const Time InTime) const;
+
+	std::vector<TempoAnchor> _Anchors;
+	size_t _Revision = 0;
+};
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+#include "chart-types.h"
+
+/*
+* every timing point of one kind across all timeslices, an array of pointers to the points within their timeslices sorted by timepoint.
+* next to every pointer sits the index of the timeslice owning the point. an edit to one timeslice replaces only the entries of that
+* timeslice, whatever was handed out before stays valid until the next timing change. points edited in place keep their entries,
+* the order is restored on the next query. only changes to many timeslices at once mark the whole index stale to be gathered again.
+*/
+template<typename T>
+class TimingIndex
+{
+public:
+
+	void Assign(std::vector<T*>&& InPoints, std::vector<int>&& InTimeSliceIndices)
+	{
+		_Points = std::move(InPoints);
+		_TimeSliceIndices = std::move(InTimeSliceIndices);
+
+		//timeslices are visited in order, so only points moved within their timeslice can still be out of place
+		_IsOrderStale = true;
+		Reorder();
+
+		_IsStale = false;
+	}
+
+	//the entries of the timeslice are taken out, the points it holds now put back in place
+	void AssignTimeSlice(const int InTimeSliceIndex, std::vector<T>& InPoints)
+	{
+		if(_IsStale)
+			return;
+
+		size_t keptAmount = 0;
+
+		for (size_t index = 0; index < _Points.size(); ++index)
+		{
+			if(_TimeSliceIndices[index] == InTimeSliceIndex)
+				continue;
+
+			_Points[keptAmount] = _Points[index];
+			_TimeSliceIndices[keptAmount] = _TimeSliceIndices[index];
+			keptAmount++;
+		}
+
+		_Points.resize(keptAmount);
+		_TimeSliceIndices.resize(keptAmount);
+
+		//the entries left point into other timeslices, which the edit has not touched
+		Reorder();
+
+		for (auto& point : InPoints)
+		{
+			const size_t index = UpperBound(point.TimePoint);
+
+			_Points.insert(_Points.begin() + index, &point);
+			_TimeSliceIndices.insert(_TimeSliceIndices.begin() + index, InTimeSliceIndex);
+		}
+	}
+
+	void Invalidate()
+	{
+		_IsStale = true;
+	}
+
+	//points moved in place stay where their entries are until the next query sorts them
+	void InvalidateOrder()
+	{
+		_IsOrderStale = true;
+	}
+
+	//sorts the entries again if points were moved in place, the pointers themselves are still valid
+	void Reorder()
+	{
+		if(!_IsOrderStale)
+			return;
+
+		//hardly anything is out of place, so every entry is only shifted as far back as it has to go
+		for (size_t index = 1; index < _Points.size(); ++index)
+		{
+			T* point = _Points[index];
+			const int timeSliceIndex = _TimeSliceIndices[index];
+
+			size_t target = index;
+
+			for (; target > 0 && point->TimePoint < _Points[target - 1]->TimePoint; --target)
+			{
+				_Points[target] = _Points[target - 1];
+				_TimeSliceIndices[target] = _TimeSliceIndices[target - 1];
+			}
+
+			_Points[target] = point;
+			_TimeSliceIndices[target] = timeSliceIndex;
+		}
+
+		_IsOrderStale = false;
+	}
+
+	bool IsStale() const
+	{
+		return _IsStale;
+	}
+
+	bool IsOrderStale() const
+	{
+		return _IsOrderStale;
+	}
+
+	bool IsEmpty() const
+	{
+		return _Points.empty();
+	}
+
+	const std::vector<T*>& GetAll() const
+	{
+		return _Points;
+	}
+
+	//the last point at or before the timepoint
+	T* GetPrevious(const Time InTime) const
+	{
+		const size_t index = UpperBound(InTime);
+
+		return index == 0 ? nullptr : _Points[index - 1];
+	}
+
+	//the first point after the timepoint
+	T* GetNext(const Time InTime) const
+	{
+		const size_t index = UpperBound(InTime);
+
+		return index == _Points.size() ? nullptr : _Points[index];
+	}
+
+	void CollectInTimeRange(const Time InTimeBegin, const Time InTimeEnd, std::vector<T*>& OutPoints) const
+	{
+		OutPoints.clear();
+
+		const size_t indexEnd = UpperBound(InTimeEnd);
+
+		for (size_t index = LowerBound(InTimeBegin); index < indexEnd; ++index)
+			OutPoints.push_back(_Points[index]);
+	}
+
+	void IterateInTimeRange(const Time InTimeBegin, const Time InTimeEnd, std::function<void(T&)> InWork) const
+	{
+		const size_t indexEnd = UpperBound(InTimeEnd);
+
+		for (size_t index = LowerBound(InTimeBegin); index < indexEnd; ++index)
+			InWork(*_Points[index]);
+	}
+
+private:
+
+	size_t LowerBound(const Time InTime) const
+	{
+		return std::lower_bound(_Points.begin(), _Points.end(), InTime, [](const T* InPoint, const Time InTime) { return InPoint->TimePoint < InTime; }) - _Points.begin();
+	}
+
+	size_t UpperBound(const Time InTime) const
+	{
+		return std::upper_bound(_Points.begin(), _Points.end(), InTime, [](const Time InTime, const T* InPoint) { return InTime < InPoint->TimePoint; }) - _Points.begin();
+	}
+
+	std::vector<T*> _Points;
+	std::vector<int> _TimeSliceIndices;
+
+	bool _IsStale = true;
+	bool _IsOrderStale = false;
+};
@@ -0,0 +1,341 @@
+#include "undo-history.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <zlib.h>
+
+#include "chart.h"
+
+template<typename T>
+static void WriteValue(std::vector<unsigned char>& OutData, const T& InValue)
+{
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&InValue);
+	OutData.insert(OutData.end(), bytes, bytes + sizeof(T));
+}
+
+template<typename T>
+static void WriteVector(std::vector<unsigned char>& OutData, const std::vector<T>& InValues)
+{
+	WriteValue(OutData, InValues.size());
+
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(InValues.data());
+	OutData.insert(OutData.end(), bytes, bytes + InValues.size() * sizeof(T));
+}
+
+template<typename T>
+static void ReadValue(const unsigned char*& InOutCursor, T& OutValue)
+{
+	std::memcpy(&OutValue, InOutCursor, sizeof(T));
+	InOutCursor += sizeof(T);
+}
+
+template<typename T>
+static void ReadVector(const unsigned char*& InOutCursor, std::vector<T>& OutValues)
+{
+	size_t size = 0;
+	ReadValue(InOutCursor, size);
+
+	OutValues.resize(size);
+
+	if(size)
+		std::memcpy(OutValues.data(), InOutCursor, size * sizeof(T));
+
+	InOutCursor += size * sizeof(T);
+}
+
+static void WriteTimeSlice(std::vector<unsigned char>& OutData, const TimeSlice& InTimeSlice)
+{
+	WriteValue(OutData, InTimeSlice.TimePoint);
+	WriteValue(OutData, InTimeSlice.Index);
+	WriteVector(OutData, InTimeSlice.BpmPoints);
+	WriteVector(OutData, InTimeSlice.Stops);
+	WriteVector(OutData, InTimeSlice.SvMultipliers);
+	WriteVector(OutData, InTimeSlice.TimeSignatures);
+}
+
+static void ReadTimeSlice(const unsigned char*& InOutCursor, TimeSlice& OutTimeSlice)
+{
+	ReadValue(InOutCursor, OutTimeSlice.TimePoint);
+	ReadValue(InOutCursor, OutTimeSlice.Index);
+	ReadVector(InOutCursor, OutTimeSlice.BpmPoints);
+	ReadVector(InOutCursor, OutTimeSlice.Stops);
+	ReadVector(InOutCursor, OutTimeSlice.SvMultipliers);
+	ReadVector(InOutCursor, OutTimeSlice.TimeSignatures);
+}
+
+static size_t GetTimeSliceSize(const TimeSlice& InTimeSlice)
+{
+	return sizeof(TimeSlice) + InTimeSlice.BpmPoints.capacity() * sizeof(BpmPoint) + InTimeSlice.Stops.capacity() * sizeof(StopPoint) +
+		InTimeSlice.SvMultipliers.capacity() * sizeof(ScrollVelocityMultiplier) + InTimeSlice.TimeSignatures.capacity() * sizeof(TimeSignature);
+}
+
+static size_t GetTransactionSize(const ChartTransaction& InTransaction)
+{
+	size_t size = sizeof(ChartTransaction) + InTransaction.NoteDeltas.capacity() * sizeof(NoteDelta);
+
+	for (const auto& timingDelta : InTransaction.TimingDeltas)
+		size += GetTimeSliceSize(timingDelta.Before) + GetTimeSliceSize(timingDelta.After);
+
+	return size;
+}
+
+UndoHistory::~UndoHistory()
+{
+	if(!_SpillFile.is_open())
+		return;
+
+	_SpillFile.close();
+
+	std::error_code error;
+	std::filesystem::remove(_SpillFilePath, error);
+}
+
+void UndoHistory::Push(ChartTransaction&& InTransaction)
+{
+	Entry entry;
+	entry.Transaction = std::make_unique<ChartTransaction>(std::move(InTransaction));
+	entry.LiveSize = GetTransactionSize(*entry.Transaction);
+
+	_LiveBytes += entry.LiveSize;
+	_Entries.push_back(std::move(entry));
+
+	EnforceBudget();
+}
+
+bool UndoHistory::Pop(ChartTransaction& OutTransaction)
+{
+	Entry& entry = _Entries.back();
+
+	if(!RestoreEntry(entry))
+		return false;
+
+	_LiveBytes -= entry.LiveSize;
+
+	OutTransaction = std::move(*entry.Transaction);
+	_Entries.pop_back();
+
+	return true;
+}
+
+bool UndoHistory::IsEmpty() const
+{
+	return _Entries.empty();
+}
+
+size_t UndoHistory::GetSize() const
+{
+	return _Entries.size();
+}
+
+void UndoHistory::Clear()
+{
+	_Entries.clear();
+
+	_SpilledAmount = 0;
+	_LiveBytes = 0;
+	_CompressedBytes = 0;
+	_SpilledBytes = 0;
+	_SpillEnd = 0;
+}
+
+void UndoHistory::SetMemoryBudget(const size_t InBytes)
+{
+	_MemoryBudget = InBytes;
+
+	EnforceBudget();
+}
+
+HistoryMemoryUsage UndoHistory::GetMemoryUsage() const
+{
+	HistoryMemoryUsage usage;
+
+	usage.LiveBytes = _LiveBytes;
+	usage.CompressedBytes = _CompressedBytes;
+	usage.SpilledBytes = _SpilledBytes;
+
+	for (const auto& entry : _Entries)
+	{
+		switch (entry.Storage)
+		{
+		case EStorage::Live: usage.LiveEntries++; break;
+		case EStorage::Compressed: usage.CompressedEntries++; break;
+		case EStorage::Spilled: usage.SpilledEntries++; break;
+		}
+	}
+
+	return usage;
+}
+
+void UndoHistory::EnforceBudget()
+{
+	//only the entry that just left the live window can still be uncompressed
+	if(_Entries.size() > HISTORY_LIVE_ENTRIES)
+	{
+		Entry& entry = _Entries[_Entries.size() - HISTORY_LIVE_ENTRIES - 1];
+
+		if(entry.Storage == EStorage::Live)
+			CompressEntry(entry);
+	}
+
+	//the newest entry always stays in memory, whatever its size
+	while(_LiveBytes + _CompressedBytes > _MemoryBudget && _SpilledAmount + 1 < _Entries.size())
+	{
+		if(!SpillEntry(_Entries[_SpilledAmount]))
+			return;
+
+		_SpilledAmount++;
+	}
+}
+
+void UndoHistory::CompressEntry(Entry& OutEntry)
+{
+	std::vector<unsigned char> rawData;
+
+	WriteVector(rawData, OutEntry.Transaction->NoteDeltas);
+	WriteValue(rawData, OutEntry.Transaction->TimingDeltas.size());
+
+	for (const auto& timingDelta : OutEntry.Transaction->TimingDeltas)
+	{
+		WriteTimeSlice(rawData, timingDelta.Before);
+		WriteTimeSlice(rawData, timingDelta.After);
+	}
+
+	WriteValue(rawData, OutEntry.Transaction->BaseOffsetDelta);
+
+	uLongf compressedSize = compressBound(uLong(rawData.size()));
+	OutEntry.CompressedData.resize(compressedSize);
+
+	if(compress2(OutEntry.CompressedData.data(), &compressedSize, rawData.data(), uLong(rawData.size()), Z_BEST_SPEED) != Z_OK)
+	{
+		OutEntry.CompressedData.clear();
+		return;
+	}
+
+	OutEntry.CompressedData.resize(compressedSize);
+	OutEntry.CompressedData.shrink_to_fit();
+	OutEntry.RawSize = rawData.size();
+	OutEntry.CompressedSize = compressedSize;
+	OutEntry.Storage = EStorage::Compressed;
+	OutEntry.Transaction.reset();
+
+	_LiveBytes -= OutEntry.LiveSize;
+	_CompressedBytes += OutEntry.CompressedSize;
+}
+
+bool UndoHistory::SpillEntry(Entry& OutEntry)
+{
+	if(OutEntry.Storage == EStorage::Live)
+		CompressEntry(OutEntry);
+
+	if(OutEntry.Storage != EStorage::Compressed || !OpenSpillFile())
+		return false;
+
+	_SpillFile.seekp(_SpillEnd);
+	_SpillFile.write(reinterpret_cast<const char*>(OutEntry.CompressedData.data()), std::streamsize(OutEntry.CompressedSize));
+
+	if(!_SpillFile)
+	{
+		_SpillFile.clear();
+		return false;
+	}
+
+	OutEntry.SpillOffset = _SpillEnd;
+	OutEntry.Storage = EStorage::Spilled;
+	std::vector<unsigned char>().swap(OutEntry.CompressedData);
+
+	_SpillEnd += std::streamoff(OutEntry.CompressedSize);
+	_CompressedBytes -= OutEntry.CompressedSize;
+	_SpilledBytes += OutEntry.CompressedSize;
+
+	return true;
+}
+
+bool UndoHistory::RestoreEntry(Entry& OutEntry)
+{
+	if(OutEntry.Storage == EStorage::Live)
+		return true;
+
+	//nothing about the entry changes until it is read back in whole
+	std::vector<unsigned char> spilledData;
+
+	if(OutEntry.Storage == EStorage::Spilled)
+	{
+		spilledData.resize(OutEntry.CompressedSize);
+
+		_SpillFile.seekg(OutEntry.SpillOffset);
+		_SpillFile.read(reinterpret_cast<char*>(spilledData.data()), std::streamsize(OutEntry.CompressedSize));
+
+		const bool isRead = _SpillFile && _SpillFile.gcount() == std::streamsize(OutEntry.CompressedSize);
+		_SpillFile.clear();
+
+		if(!isRead)
+			return false;
+	}
+
+	const std::vector<unsigned char>& compressedData = OutEntry.Storage == EStorage::Spilled ? spilledData : OutEntry.CompressedData;
+
+	std::vector<unsigned char> rawData(OutEntry.RawSize);
+	uLongf rawSize = uLongf(OutEntry.RawSize);
+
+	if(uncompress(rawData.data(), &rawSize, compressedData.data(), uLong(OutEntry.CompressedSize)) != Z_OK || rawSize != uLongf(OutEntry.RawSize))
+		return false;
+
+	auto transaction = std::make_unique<ChartTransaction>();
+	const unsigned char* cursor = rawData.data();
+
+	ReadVector(cursor, transaction->NoteDeltas);
+
+	size_t timingDeltaAmount = 0;
+	ReadValue(cursor, timingDeltaAmount);
+	transaction->TimingDeltas.resize(timingDeltaAmount);
+
+	for (auto& timingDelta : transaction->TimingDeltas)
+	{
+		ReadTimeSlice(cursor, timingDelta.Before);
+		ReadTimeSlice(cursor, timingDelta.After);
+	}
+
+	ReadValue(cursor, transaction->BaseOffsetDelta);
+
+	if(OutEntry.Storage == EStorage::Spilled)
+	{
+		//the newest spilled entry is the last one in the file, the next spill may take over its space
+		_SpillEnd = OutEntry.SpillOffset;
+		_SpilledAmount--;
+		_SpilledBytes -= OutEntry.CompressedSize;
+	}
+	else
+	{
+		_CompressedBytes -= OutEntry.CompressedSize;
+		std::vector<unsigned char>().swap(OutEntry.CompressedData);
+	}
+
+	OutEntry.Transaction = std::move(transaction);
+	OutEntry.LiveSize = GetTransactionSize(*OutEntry.Transaction);
+	OutEntry.Storage = EStorage::Live;
+
+	_LiveBytes += OutEntry.LiveSize;
+
+	return true;
+}
+
+bool UndoHistory::OpenSpillFile()
+{
+	if(_SpillFile.is_open())
+		return true;
+
+	std::error_code error;
+	std::filesystem::path directory = std::filesystem::temp_directory_path(error);
+
+	if(error)
+		return false;
+
+	const auto timeStamp = std::chrono::steady_clock::now().time_since_epoch().count();
+	_SpillFilePath = directory / ("leraine-history-" + std::to_string(timeStamp) + "-" + std::to_string(reinterpret_cast<uintptr_t>(this)) + ".tmp");
+
+	_SpillFile.open(_SpillFilePath, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+
+	return _SpillFile.is_open();
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <filesystem>
+
+struct ChartTransaction;
+
+//the newest entries are kept as they are, so undoing recent changes never waits for zlib
+#define HISTORY_LIVE_ENTRIES 32
+#define DEFAULT_HISTORY_MEMORY_BUDGET (64 * 1024 * 1024)
+
+struct HistoryMemoryUsage
+{
+	size_t LiveBytes = 0;
+	size_t CompressedBytes = 0;
+	size_t SpilledBytes = 0;
+
+	size_t LiveEntries = 0;
+	size_t CompressedEntries = 0;
+	size_t SpilledEntries = 0;
+};
+
+/*
+* a stack of chart transactions held within a memory budget. entries falling out of the newest HISTORY_LIVE_ENTRIES are
+* compressed with zlib, and once the budget is exceeded the oldest ones are spilled to a scratch file of the session.
+* since undo only ever pops the newest entry, the spilled entries form a stack within the scratch file as well,
+* and paging one back in simply hands its space over to whatever gets spilled next.
+*/
+class UndoHistory
+{
+public:
+
+	UndoHistory() = default;
+	~UndoHistory();
+
+	UndoHistory(const UndoHistory&) = delete;
+	UndoHistory& operator=(const UndoHistory&) = delete;
+
+	void Push(ChartTransaction&& InTransaction);
+	//fails and keeps the entry where it is if it cannot be read back from the scratch file or decompressed
+	bool Pop(ChartTransaction& OutTransaction);
+
+	bool IsEmpty() const;
+	size_t GetSize() const;
+	void Clear();
+
+	void SetMemoryBudget(const size_t InBytes);
+	HistoryMemoryUsage GetMemoryUsage() const;
+
+private:
+
+	enum class EStorage
+	{
+		Live,
+		Compressed,
+		Spilled
+	};
+
+	struct Entry
+	{
+		EStorage Storage = EStorage::Live;
+
+		std::unique_ptr<ChartTransaction> Transaction;
+		size_t LiveSize = 0;
+
+		std::vector<unsigned char> CompressedData;
+		size_t RawSize = 0;
+		size_t CompressedSize = 0;
+
+		std::streamoff SpillOffset = 0;
+	};
+
+	void EnforceBudget();
+
+	void CompressEntry(Entry& OutEntry);
+	bool SpillEntry(Entry& OutEntry);
+	bool RestoreEntry(Entry& OutEntry);
+
+	bool OpenSpillFile();
+
+	std::deque<Entry> _Entries;
+
+	//entries below this index live in the scratch file
+	size_t _SpilledAmount = 0;
+
+	size_t _MemoryBudget = DEFAULT_HISTORY_MEMORY_BUDGET;
+	size_t _LiveBytes = 0;
+	size_t _CompressedBytes = 0;
+	size_t _SpilledBytes = 0;
+
+	std::fstream _SpillFile;
+	std::filesystem::path _SpillFilePath;
+	std::streamoff _SpillEnd = 0;
+};
@@ -2,9 +2,19 @@
 #include <cassert>
 #include <vector>
 #include <cmath>
+#include <chrono>
+#include <random>
+#include <fstream>
+#include <filesystem>
+#include <thread>
 
 #include "../source/structures/chart.h"
+#include "../source/structures/chart-builder.h"
+#include "../source/structures/strain-rating.h"
+#include "../source/structures/pattern-classifier.h"
+#include "../source/structures/chart-linter.h"
 #include "../source/modules/chart-parser-module.h"
+#include "../source/modules/beat-module.h"
 
 // Simple test framework
 #define ASSERT(cond) if(!(cond)) { std::cerr << "Assertion failed: " << #cond << std::endl; return 1; }
@@ -188,6 +198,1600 @@ int TestStopEditing()
     return 0;
 }
 
+int TestNoteStore()
+{
+    Chart chart;
+    chart.KeyAmount = 4;
+
+    // Inject out of order so the column has to stay sorted across several blocks
+    for (int i = 999; i >= 0; --i)
+        chart.InjectNote(i * 10, i % 4, Note::EType::Common);
+
+    ASSERT(chart.Notes.GetNoteAmount() == 1000);
+    ASSERT(chart.FindNote(5000, 0) != nullptr);
+    ASSERT(chart.FindNote(5005, 0) == nullptr);
+
+    int inRange = 0;
+    chart.IterateNotesInTimeRange(2000, 2990, [&](Note&, Column){ inRange++; });
+    ASSERT(inRange == 100);
+
+    // All notes come out in chronological order
+    Time lastTime = -1;
+    bool isChronological = true;
+    chart.IterateAllNotes([&](Note& n, Column){ isChronological &= n.TimePoint >= lastTime; lastTime = n.TimePoint; });
+    ASSERT(isChronological);
+
+    // Removing a hold takes its intermediate notes and its end with it
+    chart.InjectHold(20000, 22000, 1);
+    ASSERT(chart.RemoveNote(22000, 1));
+    ASSERT(chart.FindNote(20000, 1) == nullptr);
+    ASSERT(chart.Notes.GetNoteAmount() == 1000);
+
+    // Undo reinserts the removed note
+    chart.RemoveNote(5000, 0);
+    ASSERT(chart.FindNote(5000, 0) == nullptr);
+    ASSERT(chart.Undo());
+    ASSERT(chart.FindNote(5000, 0) != nullptr);
+    ASSERT(chart.Notes.GetNoteAmount() == 1000);
+
+    return 0;
+}
+
+int TestLongNotes()
+{
+    Chart chart;
+    chart.KeyAmount = 4;
+
+    // A minute long hold is only its begin and its end
+    chart.InjectHold(0, 60000, 0);
+    chart.InjectRoll(1000, 2000, 1);
+    chart.InjectHold(5000, 6000, 0);
+    ASSERT(chart.Notes.GetNoteAmount() == 6);
+
+    int overlapping = 0;
+    chart.IterateLongNotesInTimeRange(30000, 30500, [&](Note&, Column){ overlapping++; });
+    ASSERT(overlapping == 1);
+
+    overlapping = 0;
+    chart.IterateLongNotesInTimeRange(1500, 5500, [&](Note&, Column){ overlapping++; });
+    ASSERT(overlapping == 3);
+
+    overlapping = 0;
+    chart.IterateLongNotesInTimeRange(61000, 62000, [&](Note&, Column){ overlapping++; });
+    ASSERT(overlapping == 0);
+
+    // Removing the hold also drops its interval
+    ASSERT(chart.RemoveNote(60000, 0));
+    overlapping = 0;
+    chart.IterateLongNotesInTimeRange(30000, 30500, [&](Note&, Column){ overlapping++; });
+    ASSERT(overlapping == 0);
+    ASSERT(chart.Notes.GetNoteAmount() == 4);
+
+    return 0;
+}
+
+int TestTempoMap()
+{
+    Chart chart;
+    chart.KeyAmount = 4;
+
+    // 120 BPM from 1000, 240 BPM from 3000, a 1 second stop at 4000
+    chart.InjectBpmPoint(1000, 120.0, 500.0);
+    chart.InjectBpmPoint(3000, 240.0, 250.0);
+    chart.InjectStop(4000, 1.0);
+
+    ASSERT(std::abs(chart.GetBeatFromTime(1000) - 0.0) < 0.0001);
+    ASSERT(std::abs(chart.GetBeatFromTime(500) + 1.0) < 0.0001);
+    ASSERT(std::abs(chart.GetBeatFromTime(3000) - 4.0) < 0.0001);
+    ASSERT(std::abs(chart.GetBeatFromTime(4000) - 8.0) < 0.0001);
+
+    // The beat is frozen during the stop, the beat on it maps to where it begins
+    ASSERT(std::abs(chart.GetBeatFromTime(4500) - 8.0) < 0.0001);
+    ASSERT(std::abs(chart.GetBeatFromTime(5250) - 9.0) < 0.0001);
+    ASSERT(chart.GetTimeFromBeat(8.0) == 4000);
+    ASSERT(chart.GetTimeFromBeat(9.0) == 5250);
+    ASSERT(chart.GetTimeFromBeat(2.0) == 2000);
+
+    // Changing the second BPM point only shifts what follows it
+    size_t revision = chart.GetTempoMap().GetRevision();
+    BpmPoint* bpmPoint = chart.GetPreviousBpmPointFromTimePoint(3000);
+    ASSERT(bpmPoint != nullptr && bpmPoint->TimePoint == 3000);
+    bpmPoint->BeatLength = 500.0;
+    bpmPoint->Bpm = 120.0;
+    chart.InvalidateTempoMap(bpmPoint->TimePoint);
+
+    ASSERT(chart.GetTempoMap().GetRevision() != revision);
+    ASSERT(std::abs(chart.GetBeatFromTime(4000) - 6.0) < 0.0001);
+    ASSERT(chart.GetTimeFromBeat(7.0) == 5500);
+    ASSERT(chart.GetTimeFromBeat(2.0) == 2000);
+
+    // Quantizing follows the stop as well
+    chart.InjectNote(5480, 0, Note::EType::Common);
+    NoteReferenceCollection selection;
+    chart.FillNoteCollectionWithAllNotes(selection);
+    chart.QuantizeNotes(selection, 4);
+    ASSERT(chart.FindNote(5500, 0) != nullptr);
+
+    return 0;
+}
+
+int TestUndoJournal()
+{
+    Chart chart;
+    chart.KeyAmount = 4;
+
+    // A hold ending where the next one begins
+    chart.PlaceHold(1000, 2000, 0);
+    chart.BeginTransaction();
+    chart.InjectHold(2000, 3000, 0);
+    chart.Commit();
+    chart.PlaceNote(5000, 1);
+    ASSERT(chart.Notes.GetNoteAmount() == 5);
+
+    // Moving a note is a single entry
+    chart.MoveNote(5000, 8000, 1, 2, -1);
+    ASSERT(chart.FindNote(8000, 2) != nullptr);
+    ASSERT(chart.Undo());
+    ASSERT(chart.FindNote(5000, 1) != nullptr);
+    ASSERT(chart.FindNote(8000, 2) == nullptr);
+    ASSERT(chart.Redo());
+    ASSERT(chart.FindNote(8000, 2) != nullptr);
+    ASSERT(chart.Notes.GetNoteAmount() == 5);
+
+    // Undoing the second hold leaves the end of the first one in place
+    ASSERT(chart.Undo());
+    ASSERT(chart.Undo());
+    ASSERT(chart.Undo());
+    ASSERT(chart.Notes.GetNoteAmount() == 2);
+    Note* holdEnd = chart.FindNote(2000, 0);
+    ASSERT(holdEnd != nullptr && holdEnd->Type == Note::EType::HoldEnd);
+
+    // Nested transactions become one entry
+    chart.BeginTransaction();
+    chart.PlaceNote(4000, 3);
+    chart.PlaceNote(4500, 3);
+    chart.Commit();
+    ASSERT(chart.Notes.GetNoteAmount() == 4);
+    ASSERT(chart.Undo());
+    ASSERT(chart.Notes.GetNoteAmount() == 2);
+
+    // Timing is journaled per timeslice, the tempo map follows
+    chart.PlaceBpmPoint(0, 120.0, 500.0);
+    ASSERT(std::abs(chart.GetBeatFromTime(1000) - 2.0) < 0.0001);
+
+    chart.BeginTransaction();
+    chart.JournalTimingChange(0);
+    BpmPoint* bpmPoint = chart.GetPreviousBpmPointFromTimePoint(0);
+    ASSERT(bpmPoint != nullptr);
+    bpmPoint->Bpm = 240.0;
+    bpmPoint->BeatLength = 250.0;
+    chart.InvalidateTempoMap(0);
+    chart.Commit();
+    ASSERT(std::abs(chart.GetBeatFromTime(1000) - 4.0) < 0.0001);
+
+    ASSERT(chart.Undo());
+    ASSERT(std::abs(chart.GetBeatFromTime(1000) - 2.0) < 0.0001);
+    ASSERT(chart.Undo());
+    ASSERT(chart.GetTempoMap().IsEmpty());
+    ASSERT(chart.Redo());
+    ASSERT(!chart.GetTempoMap().IsEmpty());
+
+    // New changes clear what could have been redone
+    chart.PlaceNote(6000, 0);
+    ASSERT(!chart.Redo());
+
+    return 0;
+}
+
+int TestUndoHistory()
+{
+    Chart chart;
+    chart.KeyAmount = 4;
+
+    // A tiny budget spills all but the newest entry to disk
+    chart.SetHistoryMemoryBudget(1);
+    chart.PlaceBpmPoint(0, 120.0, 500.0);
+    for (int i = 0; i < 100; ++i)
+        chart.PlaceNote(1000 + i * 100, i % 4);
+
+    HistoryMemoryUsage usage = chart.UndoJournal.GetMemoryUsage();
+    ASSERT(chart.UndoJournal.GetSize() == 101);
+    ASSERT(usage.LiveEntries == 1);
+    ASSERT(usage.SpilledEntries == 100);
+    ASSERT(usage.SpilledBytes > 0);
+
+    // Undoing pages every entry back in
+    for (int i = 0; i < 100; ++i)
+        ASSERT(chart.Undo());
+    ASSERT(chart.Notes.IsEmpty());
+    ASSERT(!chart.GetTempoMap().IsEmpty());
+    ASSERT(chart.Undo());
+    ASSERT(chart.GetTempoMap().IsEmpty());
+    ASSERT(!chart.Undo());
+
+    // And redoing replays them, with the spill file reused
+    for (int i = 0; i < 101; ++i)
+        ASSERT(chart.Redo());
+    ASSERT(chart.Notes.GetNoteAmount() == 100);
+    ASSERT(chart.FindNote(1000 + 99 * 100, 3) != nullptr);
+    ASSERT(std::abs(chart.GetBeatFromTime(1000) - 2.0) < 0.0001);
+
+    // With room to spare only the entries past the live window are compressed
+    Chart roomyChart;
+    roomyChart.KeyAmount = 4;
+    for (int i = 0; i < HISTORY_LIVE_ENTRIES + 10; ++i)
+        roomyChart.PlaceNote(i * 100, 0);
+    usage = roomyChart.UndoJournal.GetMemoryUsage();
+    ASSERT(usage.LiveEntries == HISTORY_LIVE_ENTRIES);
+    ASSERT(usage.CompressedEntries == 10);
+    ASSERT(usage.SpilledEntries == 0);
+    ASSERT(roomyChart.Undo());
+
+    // An entry that cannot be read back stays in the journal rather than being replayed empty
+    Chart spilledChart;
+    spilledChart.KeyAmount = 4;
+    spilledChart.SetHistoryMemoryBudget(1);
+    for (int i = 0; i < 10; ++i)
+        spilledChart.PlaceNote(1000 + i * 100, i % 4);
+
+    for (const auto& file : std::filesystem::directory_iterator(std::filesystem::temp_directory_path()))
+        if (file.path().filename().string().rfind("leraine-history-", 0) == 0)
+            std::filesystem::resize_file(file.path(), 0);
+
+    int undoneAmount = 0;
+    while (spilledChart.Undo())
+        undoneAmount++;
+
+    const size_t failedUndoSize = spilledChart.UndoJournal.GetSize();
+    ASSERT(undoneAmount < 10 && failedUndoSize == size_t(10 - undoneAmount));
+    ASSERT(spilledChart.Notes.GetNoteAmount() == size_t(10 - undoneAmount));
+    ASSERT(!spilledChart.Undo());
+    ASSERT(spilledChart.UndoJournal.GetSize() == failedUndoSize);
+
+    return 0;
+}
+
+int TestNoteHandles()
+{
+    Chart chart;
+    chart.KeyAmount = 4;
+
+    chart.PlaceNote(5000, 0);
+    NoteHandle handle = chart.FindNote(5000, 0)->Handle;
+    ASSERT(handle.IsValid());
+
+    // The handle survives the column reallocating underneath it
+    for (int i = 0; i < 1000; ++i)
+        chart.InjectNote(i * 10, 0, Note::EType::Common);
+    Note* note = chart.ResolveNote(handle);
+    ASSERT(note != nullptr && note->TimePoint == 5000);
+
+    // Moving a single note keeps its handle
+    Note* movedNote = chart.MoveNote(5000, 12000, 0, 2, -1);
+    ASSERT(movedNote != nullptr && movedNote->Handle == handle);
+    Column column = 0;
+    note = chart.ResolveNote(handle, column);
+    ASSERT(note != nullptr && note->TimePoint == 12000 && column == 2);
+
+    // A selection stays valid across edits elsewhere
+    NoteReferenceCollection selection;
+    selection.PushNote(2, *note);
+    chart.PlaceNote(11000, 2);
+    chart.PlaceNote(13000, 2);
+    ASSERT(selection.Contains(chart.FindNote(12000, 2)->Handle));
+
+    // Removing the note turns the handle stale, even once its slot is reused
+    ASSERT(chart.RemoveNote(12000, 2));
+    ASSERT(chart.ResolveNote(handle) == nullptr);
+    chart.PlaceNote(14000, 3);
+    Note* reusingNote = chart.FindNote(14000, 3);
+    ASSERT(reusingNote->Handle.Slot == handle.Slot && reusingNote->Handle != handle);
+    ASSERT(chart.ResolveNote(handle) == nullptr);
+    NoteHandle reusingHandle = reusingNote->Handle;
+
+    // Undoing the removal brings the note back under its handle, once the note reusing the slot is gone
+    ASSERT(chart.Undo());
+    ASSERT(chart.Undo());
+    note = chart.ResolveNote(handle, column);
+    ASSERT(note != nullptr && note->TimePoint == 12000 && column == 2);
+    ASSERT(chart.ResolveNote(reusingHandle) == nullptr);
+
+    // A selection edited, taken back and done again keeps resolving to the same notes
+    chart.InjectHold(20000, 21000, 0);
+    NoteHandle holdHandle = chart.FindNote(20000, 0)->Handle;
+    NoteHandle holdEndHandle = chart.FindNote(21000, 0)->Handle;
+    selection.Clear();
+    selection.PushNote(2, *chart.FindNote(12000, 2));
+    selection.PushNote(0, *chart.FindNote(20000, 0));
+    ASSERT(chart.MirrorNotes(selection));
+    ASSERT(chart.Undo());
+    note = chart.ResolveNote(handle, column);
+    ASSERT(note != nullptr && note->TimePoint == 12000 && column == 2);
+    note = chart.ResolveNote(holdHandle, column);
+    ASSERT(note != nullptr && note->TimePoint == 20000 && column == 0);
+    ASSERT(chart.ResolveNote(holdEndHandle) == chart.FindNote(21000, 0));
+    ASSERT(chart.Redo());
+    note = chart.ResolveNote(holdHandle, column);
+    ASSERT(note != nullptr && note->TimePoint == 20000 && column == 3);
+    ASSERT(chart.ResolveNote(holdEndHandle) == chart.FindNote(21000, 3));
+
+    // So does a single moved note
+    ASSERT(chart.MoveNote(12000, 15000, 1, 1, -1) != nullptr);
+    ASSERT(chart.Undo());
+    note = chart.ResolveNote(handle, column);
+    ASSERT(note != nullptr && note->TimePoint == 12000 && column == 1);
+
+    return 0;
+}
+
+int TestBatchTransform()
+{
+    Chart chart;
+    chart.KeyAmount = 4;
+
+    chart.InjectNote(1000, 0, Note::EType::Common);
+    chart.InjectHold(1500, 2500, 1);
+    chart.InjectNote(2000, 3, Note::EType::Common);
+    NoteHandle holdHandle = chart.FindNote(1500, 1)->Handle;
+
+    // Selecting a hold's end as well still moves the hold only once
+    NoteReferenceCollection selection;
+    chart.FillNoteCollectionWithAllNotes(selection);
+    size_t undoSize = chart.UndoJournal.GetSize();
+
+    ASSERT(chart.MirrorNotes(selection));
+    ASSERT(chart.UndoJournal.GetSize() == undoSize + 1);
+    ASSERT(chart.Notes.GetNoteAmount() == 4);
+    ASSERT(chart.FindNote(1000, 3) && chart.FindNote(2000, 0));
+    Column column = 0;
+    Note* hold = chart.ResolveNote(holdHandle, column);
+    ASSERT(hold != nullptr && column == 2 && hold->TimePointEnd == 2500);
+    ASSERT(chart.FindNote(2500, 2) && chart.FindNote(2500, 2)->Type == Note::EType::HoldEnd);
+    ASSERT(selection.NoteAmount == 3);
+
+    // A transform running into a note outside the selection leaves the chart untouched
+    chart.InjectNote(3000, 2, Note::EType::Common);
+    NoteReferenceCollection tap;
+    tap.PushNote(3, *chart.FindNote(1000, 3));
+    ASSERT(!chart.TransformNotes(tap, [](Note& InOutNote, Column& InOutColumn) { InOutNote.TimePoint = 3000; InOutColumn = 2; }));
+    ASSERT(chart.FindNote(1000, 3) && chart.Notes.GetNoteAmount() == 5);
+
+    // Converting to holds and back again, one undo entry each
+    undoSize = chart.UndoJournal.GetSize();
+    ASSERT(chart.ConvertToHolds(tap, 250));
+    ASSERT(chart.FindNote(1250, 3) && chart.FindNote(1250, 3)->Type == Note::EType::HoldEnd);
+    ASSERT(chart.ConvertToTaps(tap));
+    ASSERT(chart.FindNote(1250, 3) == nullptr && chart.FindNote(1000, 3)->Type == Note::EType::Common);
+    ASSERT(chart.UndoJournal.GetSize() == undoSize + 2);
+
+    // Undoing the mirror restores every note where it was
+    ASSERT(chart.Undo() && chart.Undo() && chart.Undo());
+    ASSERT(chart.FindNote(1000, 0) && chart.FindNote(2000, 3));
+    ASSERT(chart.FindNote(1500, 1) && chart.FindNote(2500, 1) && chart.Notes.GetNoteAmount() == 5);
+
+    return 0;
+}
+
+int TestChartBuilder()
+{
+    // Benchmark: 100k objects handed over in random order, the way a parser or a large paste would
+    const int objectAmount = 100000;
+    std::vector<Time> timePoints(objectAmount);
+    for (int i = 0; i < objectAmount; ++i)
+        timePoints[i] = i * 10;
+    std::shuffle(timePoints.begin(), timePoints.end(), std::mt19937(42));
+
+    Chart chart;
+    chart.KeyAmount = 4;
+
+    auto begin = std::chrono::steady_clock::now();
+
+    ChartBuilder builder;
+    builder.Reserve(objectAmount + objectAmount / 10);
+    for (int i = 0; i < objectAmount; ++i)
+    {
+        if (i % 10 == 0)
+            builder.AddHold(timePoints[i], timePoints[i] + 5, Column(i % 4));
+        else
+            builder.AddNote(timePoints[i], Column(i % 4), Note::EType::Common);
+
+        if (i % 1000 == 0)
+            builder.AddBpmPoint(timePoints[i], 120.0, 500.0);
+    }
+    builder.AddStop(5000, 0.5);
+    builder.Build(chart);
+
+    double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "  built " << objectAmount << " objects in " << milliseconds << " ms" << std::endl;
+
+    // Generous enough for a slow debug machine, a per object search and shift takes far longer
+    ASSERT(milliseconds < 2000.0);
+
+    // The same notes injected one by one are the baseline the builder has to beat
+    const int baselineAmount = objectAmount / 10;
+
+    Chart baselineChart;
+    baselineChart.KeyAmount = 4;
+
+    begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < baselineAmount; ++i)
+        baselineChart.InjectNote(timePoints[i], Column(i % 4), Note::EType::Common, -1, -1, -1, true);
+    double baselineMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    Chart builtChart;
+    builtChart.KeyAmount = 4;
+
+    ChartBuilder baselineBuilder;
+    begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < baselineAmount; ++i)
+        baselineBuilder.AddNote(timePoints[i], Column(i % 4), Note::EType::Common);
+    baselineBuilder.Build(builtChart, true);
+    double builtMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "  injected " << baselineAmount << " notes in " << baselineMilliseconds << " ms, built them in " << builtMilliseconds << " ms" << std::endl;
+
+    ASSERT(builtMilliseconds < baselineMilliseconds);
+    ASSERT(builtChart.Notes.GetNoteAmount() == baselineChart.Notes.GetNoteAmount());
+
+    ASSERT(builder.IsEmpty());
+    ASSERT(chart.Notes.GetNoteAmount() == size_t(objectAmount + objectAmount / 10));
+    for (Column column = 0; column < 4; ++column)
+    {
+        const auto& notes = chart.Notes.GetColumn(column);
+        ASSERT(std::is_sorted(notes.begin(), notes.end(), [](const Note& lhs, const Note& rhs) { return lhs.TimePoint < rhs.TimePoint; }));
+        ASSERT(chart.ResolveNote(notes.front().Handle) == &notes.front());
+    }
+
+    // Timing ends up sorted in its timeslices and drives the tempo map
+    ASSERT(chart.GetBpmPointsRelatedToTimeRange(0, objectAmount * 10).size() == size_t(objectAmount / 1000));
+    ASSERT(chart.GetStopsRelatedToTimeRange(0, 10000).size() == 1);
+    ASSERT(!chart.GetTempoMap().IsEmpty());
+
+    // Long notes are indexed, and loading does not leave an undo entry behind
+    int longNoteAmount = 0;
+    chart.IterateLongNotesInTimeRange(0, objectAmount * 10, [&longNoteAmount](Note&, const Column) { longNoteAmount++; });
+    ASSERT(longNoteAmount == objectAmount / 10);
+    ASSERT(chart.UndoJournal.IsEmpty());
+
+    // Pasting through the builder is a single undo entry
+    chart.BulkPlaceNotes({ { 0, chart.Notes.GetColumn(0).front() }, { 1, chart.Notes.GetColumn(1).front() } });
+    ASSERT(chart.UndoJournal.GetSize() == 1);
+    ASSERT(chart.Notes.GetNoteAmount() == size_t(objectAmount + objectAmount / 10 + 2));
+    ASSERT(chart.Undo());
+    ASSERT(chart.Notes.GetNoteAmount() == size_t(objectAmount + objectAmount / 10));
+
+    return 0;
+}
+
+int TestTimeSliceCompaction()
+{
+    Chart chart;
+    chart.KeyAmount = 4;
+    chart.PlaceBpmPoint(0, 120.0, 500.0);
+    chart.PlaceNote(20000, 0);
+    chart.PlaceHold(30000, 31000, 1);
+    size_t timeSliceAmount = chart.TimeSlices.size();
+
+    // Viewing and querying the chart leaves the timeslices alone
+    for (Time time = -10000; time < 60000; time += 1000)
+    {
+        chart.GetBpmPointsRelatedToTimeRange(time, time + 2000);
+        chart.GetStopsRelatedToTimeRange(time, time + 2000);
+        chart.GetSVsRelatedToTimeRange(time, time + 2000);
+        chart.GetTimeSignaturesRelatedToTimeRange(time, time + 2000);
+        chart.GetNextBpmPointFromTimePoint(time);
+        chart.IsAPotentialNoteDuplicate(time, 0);
+    }
+    int visitedAmount = 0;
+    chart.IterateTimeSlicesInTimeRange(0, 4999, [&visitedAmount](TimeSlice&) { visitedAmount++; });
+    ASSERT(visitedAmount == 10);
+    ASSERT(chart.TimeSlices.size() == timeSliceAmount);
+    ASSERT(chart.FindTimeSlice(20000) == nullptr);
+
+    // A bpm point still reaches into a range far behind it
+    ASSERT(chart.GetBpmPointsRelatedToTimeRange(50000, 51000).size() == 1);
+
+    // A timeslice losing its last timing point is dropped, undo brings it back
+    chart.InjectStop(12000, 0.5);
+    ASSERT(chart.FindTimeSlice(12000) != nullptr);
+    ASSERT(chart.RemoveStop(*chart.GetStopsRelatedToTimeRange(12000, 12000)[0]));
+    ASSERT(chart.FindTimeSlice(12000) == nullptr);
+    ASSERT(chart.Undo());
+    ASSERT(chart.FindTimeSlice(12000) != nullptr && chart.FindTimeSlice(12000)->Stops.size() == 1);
+    ASSERT(chart.Redo());
+    ASSERT(chart.FindTimeSlice(12000) == nullptr);
+
+    // Removing or moving a point no timeslice holds looks for its timeslice without adding one
+    StopPoint strayStop = { 42000, 0.5 };
+    ASSERT(!chart.RemoveStop(strayStop));
+    StopPoint movedStrayStop = { 43000, 0.5 };
+    chart.RevaluateStop(strayStop, movedStrayStop);
+    ASSERT(chart.TimeSlices.size() == timeSliceAmount);
+
+    // Left over empty timeslices are compacted away
+    chart.FindOrAddTimeSlice(40000);
+    chart.FindOrAddTimeSlice(45000);
+    ASSERT(chart.CompactTimeSlices() == 2);
+    ASSERT(chart.TimeSlices.size() == timeSliceAmount);
+
+    return 0;
+}
+
+int TestTimingIndex()
+{
+    Chart chart;
+    chart.KeyAmount = 4;
+
+    // Thousands of SV points placed out of order come back sorted
+    std::vector<Time> svTimes;
+    for (int i = 0; i < 5000; ++i)
+        svTimes.push_back(i * 37);
+    std::shuffle(svTimes.begin(), svTimes.end(), std::mt19937(7));
+    for (Time time : svTimes)
+        chart.InjectSV(time, 1.0);
+
+    const auto& allSVs = chart.GetSVIndex().GetAll();
+    ASSERT(allSVs.size() == 5000);
+    ASSERT(std::is_sorted(allSVs.begin(), allSVs.end(), [](const auto* lhs, const auto* rhs) { return lhs->TimePoint < rhs->TimePoint; }));
+    auto& visibleSVs = chart.GetSVsRelatedToTimeRange(10000, 11000);
+    ASSERT(!visibleSVs.empty() && visibleSVs.front()->TimePoint >= 9000 && visibleSVs.back()->TimePoint < 12000);
+
+    // Previous and next bpm points, the previous one includes the timepoint itself
+    chart.InjectBpmPoint(1000, 120.0, 500.0);
+    chart.InjectBpmPoint(60000, 240.0, 250.0);
+    chart.InjectBpmPoint(30000, 180.0, 333.3);
+    ASSERT(chart.GetPreviousBpmPointFromTimePoint(500) == nullptr);
+    ASSERT(chart.GetPreviousBpmPointFromTimePoint(30000)->TimePoint == 30000);
+    ASSERT(chart.GetPreviousBpmPointFromTimePoint(59999)->TimePoint == 30000);
+    ASSERT(chart.GetNextBpmPointFromTimePoint(30000)->TimePoint == 60000);
+    ASSERT(chart.GetNextBpmPointFromTimePoint(60000) == nullptr);
+    ASSERT(chart.GetBpmPointsRelatedToTimeRange(40000, 45000).size() == 1);
+    ASSERT(chart.GetBpmPointsRelatedToTimeRange(0, 100).front()->TimePoint == 1000);
+
+    // The index follows removals, their undo, and points moved in place
+    ASSERT(chart.RemoveBpmPoint(*chart.GetPreviousBpmPointFromTimePoint(30000)));
+    ASSERT(chart.GetNextBpmPointFromTimePoint(1000)->TimePoint == 60000);
+    ASSERT(chart.Undo());
+    ASSERT(chart.GetNextBpmPointFromTimePoint(1000)->TimePoint == 30000);
+    BpmPoint* movedBpmPoint = chart.GetPreviousBpmPointFromTimePoint(1000);
+    BpmPoint formerBpmPoint = *movedBpmPoint;
+    movedBpmPoint->TimePoint = 70000;
+    chart.InvalidateTempoMap(1000);
+    ASSERT(chart.GetBpmPointIndex().GetAll().back()->TimePoint == 70000);
+
+    // Moving it over into another timeslice only swaps the entries of the two timeslices
+    chart.RevaluateBpmPoint(formerBpmPoint, *movedBpmPoint);
+    const auto& allBpmPoints = chart.GetBpmPointIndex().GetAll();
+    ASSERT(allBpmPoints.size() == 3 && allBpmPoints.back()->TimePoint == 70000 && allBpmPoints.back()->Bpm == 120.0);
+    ASSERT(chart.GetPreviousBpmPointFromTimePoint(1000) == nullptr);
+
+    // Removing from the middle of thousands of points leaves every other entry pointing at its own point
+    ASSERT(chart.RemoveSV(*chart.GetSVIndex().GetPrevious(37 * 2500)));
+    const auto& remainingSVs = chart.GetSVIndex().GetAll();
+    ASSERT(remainingSVs.size() == 4999);
+    for (size_t i = 0; i < remainingSVs.size(); ++i)
+        ASSERT(remainingSVs[i]->TimePoint == Time(i < 2500 ? i : i + 1) * 37);
+
+    return 0;
+}
+
+int TestChartSnapshots()
+{
+    Chart chart;
+    chart.KeyAmount = 4;
+    chart.InjectBpmPoint(0, 120.0, 500.0);
+
+    for (int i = 0; i < 2000; ++i)
+        chart.InjectNote(i * 50, i % 4, Note::EType::Common);
+
+    auto first = chart.TakeSnapshot();
+    ASSERT(first->GetNoteAmount() == 2000);
+    ASSERT(chart.TakeSnapshot() == first);
+
+    // Editing one place rebuilds its chunk only, the old snapshot stays as it was
+    chart.BeginTransaction();
+    chart.RemoveNote(50000, 0);
+    chart.InjectNote(50025, 2, Note::EType::Common);
+    chart.Commit();
+
+    auto second = chart.TakeSnapshot();
+    const int editedChunk = GetSnapshotChunkIndex(50000);
+    ASSERT(second != first);
+    ASSERT(second->GetNoteChunk(0) == first->GetNoteChunk(0));
+    ASSERT(second->GetNoteChunk(editedChunk) != first->GetNoteChunk(editedChunk));
+
+    int firstAt50000 = 0;
+    int secondAt50025 = 0;
+    first->IterateNotesInTimeRange(50000, 50000, [&](const Note&, const Column) { firstAt50000++; });
+    second->IterateNotesInTimeRange(50025, 50025, [&](const Note&, const Column) { secondAt50025++; });
+    ASSERT(firstAt50000 == 1 && secondAt50025 == 1);
+
+    size_t noteAmount = 0;
+    second->IterateAllNotes([&](const Note&, const Column) { noteAmount++; });
+    ASSERT(noteAmount == second->GetNoteAmount());
+
+    // Undo, timing and in place edits are picked up as well
+    ASSERT(chart.Undo());
+    chart.InjectBpmPoint(40000, 240.0, 250.0);
+    auto third = chart.TakeSnapshot();
+    ASSERT(third->GetNoteChunk(editedChunk)->Columns[0].size() == first->GetNoteChunk(editedChunk)->Columns[0].size());
+    ASSERT(std::abs(third->GetTempoMap().GetBeatFromTime(41000) - 84.0) < 0.001);
+    ASSERT(std::abs(second->GetTempoMap().GetBeatFromTime(41000) - 82.0) < 0.001);
+
+    chart.FindNote(1000, 0)->BeatSnap = 7;
+    ASSERT(chart.TakeSnapshot() == third);
+    chart.MarkSnapshotDirty(1000, 1000);
+    auto fourth = chart.TakeSnapshot();
+    ASSERT(fourth->GetNoteChunk(0)->Columns[0][5].BeatSnap == 7);
+    ASSERT(third->GetNoteChunk(0)->Columns[0][5].BeatSnap != 7);
+
+    return 0;
+}
+
+int TestChartSet()
+{
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "leraine-chart-set-test.sm";
+
+    {
+        std::ofstream file(path);
+        file << "#TITLE:Set;\n#ARTIST:Someone;\n#OFFSET:0.000;\n#BPMS:0.000=120.000,8.000=240.000;\n#STOPS:4.000=0.500;\n";
+        file << "#NOTES:\n     dance-single:\n     A:\n     Easy:\n     3:\n     0,0,0,0,0:\n1000\n0100\n0010\n0001\n,\n2000\n0000\n3000\n0000\n;\n";
+        file << "#NOTES:\n     dance-single:\n     B:\n     Hard:\n     9:\n     0,0,0,0,0:\n1111\n1111\n1111\n1111\n;\n";
+    }
+
+    ChartParserModule parser;
+
+    // Both difficulties are read in one pass and hold the timing once
+    auto definitions = parser.ScanForCharts(path);
+    ASSERT(definitions.size() == 2);
+    ASSERT(definitions[0].DifficultyName == "Easy" && definitions[1].DifficultyName == "Hard");
+
+    ChartSet* chartSet = parser.ParseChartSet(path);
+    ASSERT(chartSet->Timing.BpmPoints.size() == 2 && chartSet->Timing.Stops.size() == 1);
+    ASSERT(chartSet->Timing.BpmPoints[1].TimePoint == 4500);
+    ASSERT(chartSet->Difficulties[0].Notes.size() == 5 && chartSet->Difficulties[1].Notes.size() == 16);
+
+    Chart* hard = parser.LoadChart(path, "Hard");
+    ASSERT(hard->DifficultyName == "Hard" && hard->Notes.GetNoteAmount() == 16);
+    ASSERT(hard->SongTitle == "Set");
+
+    // Saving one difficulty writes the other one along with it
+    hard->RemoveNote(0, 0);
+    parser.ExportChartSet(hard);
+    delete hard;
+
+    definitions = parser.ScanForCharts(path);
+    ASSERT(definitions.size() == 2);
+
+    Chart* easy = parser.LoadChart(path, "Easy");
+    ASSERT(easy->Notes.GetNoteAmount() == 6);
+    ASSERT(easy->FindNote(2000, 0) && easy->FindNote(2000, 0)->Type == Note::EType::HoldBegin);
+    ASSERT(easy->FindNote(3500, 0) && easy->FindNote(3500, 0)->Type == Note::EType::HoldEnd);
+    delete easy;
+
+    Chart* savedHard = parser.LoadChart(path, "Hard");
+    ASSERT(savedHard->Notes.GetNoteAmount() == 15);
+    delete savedHard;
+
+    std::filesystem::remove(path);
+
+    return 0;
+}
+
+int TestCompactSelection()
+{
+    Chart chart;
+    chart.KeyAmount = 4;
+
+    for (int i = 0; i < 30000; ++i)
+        chart.InjectNote(i * 10, i % 4, Note::EType::Common);
+
+    NoteReferenceCollection all;
+    chart.FillNoteCollectionWithAllNotes(all);
+    ASSERT(all.NoteAmount == 30000 && all.ColumnNoteCount[2] == 7500);
+    ASSERT(all.MinTimePoint == 0 && all.MaxTimePoint == 299990);
+
+    // Selecting the same note twice counts it once
+    NoteReferenceCollection selection;
+    selection.PushNote(1, *chart.FindNote(10, 1));
+    selection.PushNote(1, *chart.FindNote(10, 1));
+    selection.PushNote(3, *chart.FindNote(30, 3));
+    ASSERT(selection.NoteAmount == 2 && selection.Contains(chart.FindNote(30, 3)->Handle));
+    ASSERT(!selection.Contains(chart.FindNote(20, 2)->Handle));
+
+    // Inverting, uniting and intersecting keep the counts and bounds
+    NoteReferenceCollection inverted = selection;
+    chart.InvertSelection(inverted);
+    ASSERT(inverted.NoteAmount == 29998 && inverted.ColumnNoteCount[1] == 7499);
+    ASSERT(!inverted.Contains(chart.FindNote(10, 1)->Handle) && inverted.Contains(chart.FindNote(20, 2)->Handle));
+
+    NoteReferenceCollection united = inverted;
+    united.Unite(selection);
+    ASSERT(united.NoteAmount == 30000 && united.MinTimePoint == 0 && united.MaxTimePoint == 299990);
+
+    NoteReferenceCollection intersected = all;
+    intersected.Intersect(selection);
+    ASSERT(intersected.NoteAmount == 2 && intersected.ColumnNoteCount[3] == 1 && intersected.ColumnNoteCount[0] == 0);
+
+    // Iteration across columns comes in time order
+    Time previousTime = std::numeric_limits<Time>::min();
+    int visited = 0;
+    bool isChronological = true;
+    chart.IterateSelectedNotes(inverted, [&](Note& InNote, const Column)
+    {
+        isChronological &= InNote.TimePoint >= previousTime;
+        previousTime = InNote.TimePoint;
+        visited++;
+    });
+    ASSERT(isChronological && visited == 29998);
+
+    // A removed note no longer counts as selected once its slot is reused
+    const NoteHandle removedHandle = chart.FindNote(10, 1)->Handle;
+    ASSERT(chart.RemoveNote(10, 1));
+    chart.InjectNote(5, 0, Note::EType::Common);
+    ASSERT(chart.FindNote(5, 0)->Handle.Slot == removedHandle.Slot);
+    ASSERT(!selection.Contains(chart.FindNote(5, 0)->Handle));
+
+    return 0;
+}
+
+int TestIncrementalDensity()
+{
+    Chart chart;
+    chart.KeyAmount = 4;
+    chart.InjectBpmPoint(0, 120.0, 500.0);
+
+    std::mt19937 random(11);
+    for (int i = 0; i < 5000; ++i)
+        chart.PlaceNote(Time(random() % 120000), random() % 4);
+
+    // Edits and their undo keep the density in line with a count over all notes
+    chart.PlaceHold(130000, 131000, 1);
+    chart.RemoveNote(chart.Notes.GetColumn(2)[10].TimePoint, 2);
+    ASSERT(chart.Undo());
+    ASSERT(chart.Undo());
+    ASSERT(chart.Redo());
+
+    auto countInRange = [&chart](Time InBegin, Time InEnd)
+    {
+        int count = 0;
+        chart.IterateAllNotes([&](Note& InNote, Column) { count += InNote.TimePoint >= InBegin && InNote.TimePoint < InEnd; });
+        return count;
+    };
+
+    std::vector<float> graph = chart.CalculateNPSGraph(500);
+    ASSERT(graph.size() == size_t(131000 / 500 + 2));
+    for (size_t i = 0; i < graph.size(); i += 37)
+        ASSERT(graph[i] == float(countInRange(Time(i) * 500, Time(i + 1) * 500)) * 2.0f);
+
+    std::vector<Time> times;
+    chart.IterateAllNotes([&](Note& InNote, Column) { times.push_back(InNote.TimePoint); });
+    std::sort(times.begin(), times.end());
+
+    int peak = 0;
+    for (Time windowBegin = 0; windowBegin < 132000; windowBegin += DENSITY_RESOLUTION)
+    {
+        auto windowEnd = std::lower_bound(times.begin(), times.end(), windowBegin + PEAK_DENSITY_WINDOW);
+        peak = std::max(peak, int(windowEnd - std::lower_bound(times.begin(), times.end(), windowBegin)));
+    }
+    ASSERT(chart.GetPeakNPS() == float(peak));
+
+    ASSERT(chart.GetNoteDensity().GetNoteAmount() == int(chart.Notes.GetNoteAmount()));
+    ASSERT(chart.GetNoteDensity().GetNoteAmountInTimeRange(1, 130000, 131010) == 2);
+
+    return 0;
+}
+
+int TestStrainRating()
+{
+    Chart chart;
+    chart.KeyAmount = 4;
+    chart.InjectBpmPoint(0, 120.0, 500.0);
+
+    std::mt19937 random(5);
+    for (int i = 0; i < 3000; ++i)
+        chart.PlaceNote(Time(random() % 90000), random() % 4);
+    chart.PlaceHold(20000, 24000, 0);
+
+    StrainRating rating;
+    rating.Submit(chart.TakeSnapshot());
+    rating.Wait();
+
+    // Faster rates are harder
+    for (size_t rateIndex = 1; rateIndex < STRAIN_RATE_AMOUNT; ++rateIndex)
+        ASSERT(rating.GetStarRating(rateIndex) > rating.GetStarRating(rateIndex - 1));
+    ASSERT(rating.GetSectionPeaks(5).size() == size_t(chart.Notes.GetLastTimePoint() / 400 + 1));
+
+    // After edits the incremental update matches a rating calculated from scratch
+    auto compareWithFresh = [&chart, &rating]()
+    {
+        StrainRating fresh;
+        fresh.Submit(chart.TakeSnapshot());
+        fresh.Wait();
+
+        for (size_t rateIndex = 0; rateIndex < STRAIN_RATE_AMOUNT; ++rateIndex)
+        {
+            const std::vector<double> peaks = rating.GetSectionPeaks(rateIndex);
+            const std::vector<double> freshPeaks = fresh.GetSectionPeaks(rateIndex);
+
+            if (peaks.size() != freshPeaks.size() || std::abs(rating.GetStarRating(rateIndex) - fresh.GetStarRating(rateIndex)) > 1e-6)
+                return false;
+
+            for (size_t section = 0; section < peaks.size(); ++section)
+                if (std::abs(peaks[section] - freshPeaks[section]) > 1e-6)
+                    return false;
+        }
+
+        return true;
+    };
+
+    chart.PlaceNote(45010, 2);
+    chart.PlaceHold(60000, 61500, 3);
+    rating.Submit(chart.TakeSnapshot());
+    rating.Wait();
+    ASSERT(compareWithFresh());
+
+    chart.RemoveNote(chart.Notes.GetColumn(1).front().TimePoint, 1);
+    chart.PlaceNote(95000, 1);
+    rating.Submit(chart.TakeSnapshot());
+    rating.Wait();
+    ASSERT(compareWithFresh());
+
+    ASSERT(chart.Undo());
+    ASSERT(chart.Undo());
+    rating.Submit(chart.TakeSnapshot());
+    rating.Wait();
+    ASSERT(compareWithFresh());
+
+    // Snaps changing alone leave the strain as it was, the chunks are new but their notes compare equal
+    const double starRating = rating.GetStarRating(5);
+    chart.IterateAllNotes([](Note& InNote, const Column) { InNote.BeatSnap = 3; });
+    chart.MarkSnapshotDirty(0, 100000);
+    rating.Submit(chart.TakeSnapshot());
+    rating.Wait();
+    ASSERT(rating.GetStarRating(5) == starRating);
+    ASSERT(compareWithFresh());
+
+    // Holds overlapping the ones before them are harder than taps
+    Chart plain;
+    plain.KeyAmount = 4;
+    plain.InjectBpmPoint(0, 120.0, 500.0);
+    Chart held;
+    held.KeyAmount = 4;
+    held.InjectBpmPoint(0, 120.0, 500.0);
+
+    for (Time time = 0; time < 4000; time += 100)
+    {
+        plain.PlaceNote(time, time / 100 % 2);
+        held.PlaceHold(time, time + 150, time / 100 % 2);
+    }
+
+    StrainRating plainRating;
+    plainRating.Submit(plain.TakeSnapshot());
+    plainRating.Wait();
+    StrainRating heldRating;
+    heldRating.Submit(held.TakeSnapshot());
+    heldRating.Wait();
+    ASSERT(heldRating.GetStarRating(5) > plainRating.GetStarRating(5));
+
+    return 0;
+}
+
+int TestPatternClassifier()
+{
+    Chart chart;
+    chart.KeyAmount = 4;
+    chart.InjectBpmPoint(0, 120.0, 500.0);
+
+    // One pattern per two seconds, each row 100ms apart
+    const Column staircase[] = { 0, 1, 2, 3 };
+    for (int i = 0; i < 20; ++i)
+    {
+        chart.InjectNote(i * 100, staircase[i % 4], Note::EType::Common);
+        chart.InjectNote(2000 + i * 100, i % 2, Note::EType::Common);
+        chart.InjectNote(4000 + i * 100, 2, Note::EType::Common);
+
+        for (Column column = 0; column < 4; ++column)
+            chart.InjectNote(6000 + i * 100, column, Note::EType::Common);
+
+        // Singles with a jump every third row, no column repeated from the row before
+        const Column jumpstream[][2] = { { 0, 2 }, { 1, 1 }, { 3, 3 }, { 0, 2 }, { 3, 3 }, { 1, 1 } };
+        chart.InjectNote(8000 + i * 100, jumpstream[i % 6][0], Note::EType::Common);
+        if (jumpstream[i % 6][1] != jumpstream[i % 6][0])
+            chart.InjectNote(8000 + i * 100, jumpstream[i % 6][1], Note::EType::Common);
+
+        const Column handstream[][3] = { { 0, 1, 3 }, { 2, 2, 2 }, { 0, 0, 0 }, { 1, 2, 3 }, { 0, 0, 0 }, { 3, 3, 3 } };
+        for (Column column : handstream[i % 6])
+            if (!chart.FindNote(10000 + i * 100, column))
+                chart.InjectNote(10000 + i * 100, column, Note::EType::Common);
+    }
+
+    PatternClassifier classifier;
+    classifier.Analyze(*chart.TakeSnapshot());
+
+    ASSERT(classifier.GetPatternAt(1000) == EPatternType::Stream);
+    ASSERT(classifier.GetPatternAt(3000) == EPatternType::Trills);
+    ASSERT(classifier.GetPatternAt(5000) == EPatternType::Jacks);
+    ASSERT(classifier.GetPatternAt(7000) == EPatternType::Chordjacks);
+    ASSERT(classifier.GetPatternAt(9000) == EPatternType::Jumpstream);
+    ASSERT(classifier.GetPatternAt(11000) == EPatternType::Handstream);
+    ASSERT(classifier.GetPatternAt(13000) == EPatternType::None);
+
+    // Neighbouring sections of one pattern are joined
+    ASSERT(classifier.GetSections().size() == 6);
+    ASSERT(classifier.GetSections()[0].TimeBegin == 0 && classifier.GetSections()[0].TimeEnd == 2000);
+
+    // A marathon chart is classified well within a frame
+    const int rowAmount = 200000;
+    Chart marathon;
+    marathon.KeyAmount = 7;
+
+    ChartBuilder builder;
+    std::mt19937 random(3);
+    for (int i = 0; i < rowAmount; ++i)
+        builder.AddNote(i * 10, Column(random() % 7), Note::EType::Common);
+    builder.Build(marathon);
+
+    auto snapshot = marathon.TakeSnapshot();
+    auto begin = std::chrono::steady_clock::now();
+    classifier.Analyze(*snapshot);
+    double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "  classified " << rowAmount << " rows in " << milliseconds << " ms" << std::endl;
+
+    ASSERT(!classifier.GetSections().empty());
+    ASSERT(classifier.GetSections().back().TimeEnd == rowAmount * 10);
+
+    return 0;
+}
+
+int TestChartLinter()
+{
+    Chart chart;
+    chart.KeyAmount = 4;
+    chart.InjectBpmPoint(1000, 120.0, 500.0);
+
+    for (int i = 0; i < 200; ++i)
+        chart.InjectNote(1000 + i * 125, i % 4, Note::EType::Common, -1, -1, 4);
+
+    chart.InjectNote(500, 1, Note::EType::Common, -1, -1, 4);
+    chart.InjectNote(2010, 0, Note::EType::Common, -1, -1, 4);
+    chart.InjectNote(3700, 0, Note::EType::Common, -1, -1, -1);
+    chart.InjectHold(5100, 5100, 2, 4, 4);
+    chart.InjectHold(6040, 7540, 0, 4, 4);
+    chart.InjectNote(26500, 3, Note::EType::Common, -1, -1, 4);
+
+    ChartLinter linter;
+    linter.Reset(26000);
+
+    auto countIssues = [](const std::vector<LintIssue>& InIssues, ELintType InType)
+    {
+        return std::count_if(InIssues.begin(), InIssues.end(), [InType](const LintIssue& InIssue) { return InIssue.Type == InType; });
+    };
+
+    ASSERT(linter.IsWaitingForSnapshot());
+    linter.Submit(chart.TakeSnapshot());
+    linter.Wait();
+
+    std::vector<LintIssue> issues = linter.GetIssues();
+    ASSERT(countIssues(issues, ELintType::BeforeFirstBpmPoint) == 1);
+    ASSERT(countIssues(issues, ELintType::ImpossibleJack) == 1);
+    ASSERT(countIssues(issues, ELintType::UnsnappedNote) == 1);
+    ASSERT(countIssues(issues, ELintType::ZeroLengthHold) == 1);
+    ASSERT(countIssues(issues, ELintType::PastSongEnd) == 1);
+    ASSERT(countIssues(issues, ELintType::OverlappingHold) == 3);
+    ASSERT(countIssues(issues, ELintType::StackedNote) == 0);
+    ASSERT(std::is_sorted(issues.begin(), issues.end(), [](const LintIssue& lhs, const LintIssue& rhs) { return lhs.TimePoint < rhs.TimePoint; }));
+
+    // Only the modified timeslices are checked again, yet the result matches a check of the whole chart
+    chart.RegisterOnModifiedCallback([&linter](TimeSlice& InTimeSlice) { linter.MarkTimeSliceModified(InTimeSlice.Index); });
+
+    chart.RemoveNote(6040, 0);
+    chart.PlaceNote(12000, 2);
+    chart.InjectNote(15000, 0, Note::EType::Common, -1, -1, 4);
+    ASSERT(linter.IsWaitingForSnapshot());
+    linter.Submit(chart.TakeSnapshot());
+    linter.Wait();
+
+    ChartLinter fullLinter;
+    fullLinter.Reset(26000);
+    fullLinter.Submit(chart.TakeSnapshot());
+    fullLinter.Wait();
+
+    issues = linter.GetIssues();
+    std::vector<LintIssue> fullIssues = fullLinter.GetIssues();
+    ASSERT(issues.size() == fullIssues.size());
+    for (size_t i = 0; i < issues.size(); ++i)
+        ASSERT(issues[i].TimePoint == fullIssues[i].TimePoint && issues[i].NoteColumn == fullIssues[i].NoteColumn && issues[i].Type == fullIssues[i].Type);
+
+    ASSERT(countIssues(issues, ELintType::OverlappingHold) == 0);
+    ASSERT(countIssues(issues, ELintType::StackedNote) == 1);
+
+    // A hold beginning right where the one before it ends is no overlap, no matter which of the two the check starts at
+    Chart backToBackChart;
+    backToBackChart.KeyAmount = 4;
+    backToBackChart.InjectBpmPoint(0, 120.0, 500.0);
+    backToBackChart.InjectHold(1000, 1500, 0, 4, 4);
+    backToBackChart.InjectHold(1500, 2000, 0, 4, 4);
+
+    ChartLinter backToBackLinter;
+    backToBackLinter.Reset(26000);
+    backToBackLinter.Submit(backToBackChart.TakeSnapshot());
+    backToBackLinter.Wait();
+
+    ASSERT(countIssues(backToBackLinter.GetIssues(), ELintType::OverlappingHold) == 0);
+
+    backToBackChart.RegisterOnModifiedCallback([&backToBackLinter](TimeSlice& InTimeSlice) { backToBackLinter.MarkTimeSliceModified(InTimeSlice.Index); });
+    backToBackChart.PlaceNote(1750, 1);
+    backToBackLinter.Submit(backToBackChart.TakeSnapshot());
+    backToBackLinter.Wait();
+
+    ASSERT(countIssues(backToBackLinter.GetIssues(), ELintType::OverlappingHold) == 0);
+
+    // A hold beginning several chunks before a modified timeslice is still found, the lookup only goes as far as the longest hold
+    backToBackChart.InjectHold(3000, 20000, 2, 4, 4);
+    ASSERT(backToBackChart.TakeSnapshot()->GetLongestHoldLength() == 17000);
+    backToBackLinter.Submit(backToBackChart.TakeSnapshot());
+    backToBackLinter.Wait();
+
+    backToBackChart.PlaceNote(15000, 2);
+    backToBackLinter.Submit(backToBackChart.TakeSnapshot());
+    backToBackLinter.Wait();
+
+    ASSERT(countIssues(backToBackLinter.GetIssues(), ELintType::OverlappingHold) == 1);
+
+    return 0;
+}
+
+int TestAnalyticSnaps()
+{
+    Chart chart;
+    chart.KeyAmount = 4;
+    chart.InjectBpmPoint(1000, 120.0, 500.0);
+    chart.InjectBpmPoint(3033, 200.0, 300.0);
+
+    const TempoMap& tempoMap = chart.GetTempoMap();
+
+    ASSERT(BeatModule::GetBeatSnapFromTime(tempoMap, 1000) == 1);
+    ASSERT(BeatModule::GetBeatSnapFromTime(tempoMap, 1250) == 2);
+    ASSERT(BeatModule::GetBeatSnapFromTime(tempoMap, 1125) == 4);
+    ASSERT(BeatModule::GetBeatSnapFromTime(tempoMap, 1167) == 3);
+    ASSERT(BeatModule::GetBeatSnapFromTime(tempoMap, 1094) == 16);
+    ASSERT(BeatModule::GetBeatSnapFromTime(tempoMap, 1063) == 8);
+    ASSERT(BeatModule::GetBeatSnapFromTime(tempoMap, 1042) == 12);
+
+    // 5ths and 48ths have no snap of their own, neither has anything before the first bpm point
+    ASSERT(BeatModule::GetBeatSnapFromTime(tempoMap, 1100) == -1);
+    ASSERT(BeatModule::GetBeatSnapFromTime(tempoMap, 1010) == -1);
+    ASSERT(BeatModule::GetBeatSnapFromTime(tempoMap, 500) == -1);
+
+    // A later bpm point off the previous grid starts a grid of its own
+    ASSERT(BeatModule::GetBeatSnapFromTime(tempoMap, 3033) == 1);
+    ASSERT(BeatModule::GetBeatSnapFromTime(tempoMap, 3183) == 2);
+    ASSERT(BeatModule::GetBeatSnapFromTime(tempoMap, 3108) == 4);
+
+    // The parallel whole chart assignment matches assigning timeslice by timeslice
+    std::mt19937 rng(19);
+    std::uniform_int_distribution<int> timeDist(0, 200000);
+
+    for (int i = 0; i < 40000; ++i)
+        chart.InjectNote(timeDist(rng), i % 4, Note::EType::Common, -1, -1, 0);
+
+    BeatModule beatModule;
+    beatModule.AssignNotesToSnapsInChart(&chart);
+
+    std::vector<int> chartSnaps;
+    chart.IterateAllNotes([&chartSnaps](Note& InNote, const Column) { chartSnaps.push_back(InNote.BeatSnap); });
+
+    chart.IterateAllNotes([](Note& InNote, const Column) { InNote.BeatSnap = 0; });
+    beatModule.RecalculateSnaps(&chart, 0, 200000 + TIMESLICE_LENGTH);
+
+    std::vector<int> sliceSnaps;
+    chart.IterateAllNotes([&sliceSnaps](Note& InNote, const Column) { sliceSnaps.push_back(InNote.BeatSnap); });
+
+    ASSERT(chartSnaps == sliceSnaps);
+    ASSERT(std::count(chartSnaps.begin(), chartSnaps.end(), 0) == 0);
+
+    return 0;
+}
+
+int TestBeatPositions()
+{
+    // Positions are reduced and whole beats are floored
+    ASSERT(MakeBeatPosition(6, 8) == MakeBeatPosition(3, 4));
+    ASSERT(MakeBeatPosition(-1, 4).Beat == -1 && MakeBeatPosition(-1, 4).Numerator == 3);
+    ASSERT(std::abs(MakeBeatPosition(13, 12).GetBeat() - 1.0 - 1.0 / 12.0) < 0.000001);
+
+    const std::filesystem::path smPath = std::filesystem::temp_directory_path() / "leraine-beat-position-test.sm";
+    const std::filesystem::path osuPath = std::filesystem::temp_directory_path() / "leraine-beat-position-test.osu";
+    const std::filesystem::path exportPath = std::filesystem::temp_directory_path() / "leraine-beat-position-export.sm";
+
+    {
+        std::ofstream file(smPath);
+        file << "#TITLE:Positions;\n#OFFSET:0.000;\n#BPMS:0.000=140.000;\n";
+        file << "#NOTES:\n     dance-single:\n     A:\n     Hard:\n     9:\n     0,0,0,0,0:\n";
+        file << "1000\n0100\n0000\n0000\n0000\n0000\n0000\n0000\n0000\n0000\n0000\n0000\n,\n";
+
+        // A 64th in the second measure and a 20th holding on until the third
+        for (int row = 0; row < 64; ++row)
+            file << (row == 3 ? "0010" : "0000") << "\n";
+        file << ",\n";
+        for (int row = 0; row < 20; ++row)
+            file << (row == 7 ? "0003" : row == 0 ? "0002" : "0000") << "\n";
+        file << ";\n";
+    }
+
+    ChartParserModule parser;
+    BeatModule beatModule;
+
+    Chart* chart = parser.LoadChart(smPath);
+    beatModule.AssignNotesToSnapsInChart(chart);
+
+    std::vector<std::pair<Time, BeatPosition>> original;
+    chart->IterateAllNotes([&original](Note& InNote, const Column) { original.push_back({ InNote.TimePoint, InNote.Position }); });
+
+    ASSERT(chart->Notes.GetNoteAmount() == 5);
+    ASSERT(chart->FindNote(0, 0)->Position == MakeBeatPosition(0, 1));
+    ASSERT(std::all_of(original.begin(), original.end(), [](const auto& InNote) { return InNote.second.IsValid(); }));
+
+    const Note* hold = nullptr;
+    chart->IterateAllNotes([&hold](Note& InNote, const Column) { if (InNote.Type == Note::EType::HoldBegin) hold = &InNote; });
+    // A measure of the file spans 4 beats
+    ASSERT(hold && hold->Position == MakeBeatPosition(8, 1) && hold->PositionEnd == MakeBeatPosition((2 * 20 + 7) * 4, 20));
+
+    // sm to osu and back to sm lands every note on the row it started on
+    parser.SetCurrentChartPath(osuPath);
+    parser.ExportChartSet(chart);
+    delete chart;
+
+    Chart* osuChart = parser.LoadChart(osuPath);
+    beatModule.AssignNotesToSnapsInChart(osuChart);
+
+    parser.SetCurrentChartPath(exportPath);
+    parser.ExportChartSet(osuChart);
+    delete osuChart;
+
+    Chart* roundTrip = parser.LoadChart(exportPath);
+    beatModule.AssignNotesToSnapsInChart(roundTrip);
+
+    std::vector<std::pair<Time, BeatPosition>> roundTripped;
+    roundTrip->IterateAllNotes([&roundTripped](Note& InNote, const Column) { roundTripped.push_back({ InNote.TimePoint, InNote.Position }); });
+    delete roundTrip;
+
+    ASSERT(original == roundTripped);
+
+    // The exported measures hold no more rows than their notes need
+    std::ifstream exported(exportPath);
+    std::string line;
+    std::vector<int> measureRows(1, 0);
+    bool inNotes = false;
+
+    while (std::getline(exported, line))
+    {
+        if (line.rfind("#NOTES", 0) == 0)
+            inNotes = true;
+        else if (inNotes && (line[0] == ',' || line[0] == ';'))
+            measureRows.push_back(0);
+        else if (inNotes && line.size() == 4 && line.find(':') == std::string::npos)
+            measureRows.back()++;
+    }
+
+    ASSERT(measureRows.size() == 4 && measureRows[0] == 12 && measureRows[1] == 64 && measureRows[2] == 20);
+
+    std::filesystem::remove(smPath);
+    std::filesystem::remove(osuPath);
+    std::filesystem::remove(exportPath);
+
+    // Quantizing sets the position from the grid step
+    Chart quantized;
+    quantized.KeyAmount = 4;
+    quantized.InjectBpmPoint(1000, 120.0, 500.0);
+    quantized.InjectNote(1160, 0, Note::EType::Common);
+
+    NoteReferenceCollection selection;
+    selection.PushNote(0, *quantized.FindNote(1160, 0));
+    ASSERT(quantized.QuantizeNotes(selection, 12));
+    ASSERT(quantized.FindNote(1167, 0) && quantized.FindNote(1167, 0)->Position == MakeBeatPosition(1, 3));
+
+    // Positions count beats, so a time signature changing the measures leaves them where they are
+    quantized.InjectTimeSignature(1000, 3, 4);
+    quantized.InjectNote(2800, 1, Note::EType::Common);
+    selection.Clear();
+    selection.PushNote(1, *quantized.FindNote(2800, 1));
+    ASSERT(quantized.QuantizeNotes(selection, 4));
+    ASSERT(quantized.FindNote(2750, 1) && quantized.FindNote(2750, 1)->Position == MakeBeatPosition(14, 4));
+    ASSERT(quantized.GetTempoMap().IsAtBeatPosition(2750, MakeBeatPosition(7, 2)));
+
+    return 0;
+}
+
+int TestBeatLineCache()
+{
+    Chart chart;
+    chart.KeyAmount = 4;
+    chart.InjectBpmPoint(1000, 120.0, 500.0);
+    chart.InjectBpmPoint(7013, 175.0, 60000.0 / 175.0);
+    chart.InjectStop(9000, 0.25);
+    chart.InjectTimeSignature(1000, 3, 4);
+
+    auto collectLines = [](BeatModule& InBeatModule, const Time InTimeBegin, const Time InTimeEnd)
+    {
+        std::vector<BeatLine> lines;
+        InBeatModule.IterateThroughBeatlines([&lines, InTimeBegin, InTimeEnd](const BeatLine& InBeatLine)
+        {
+            if (InBeatLine.TimePoint >= InTimeBegin && InBeatLine.TimePoint <= InTimeEnd)
+                lines.push_back(InBeatLine);
+        });
+        return lines;
+    };
+
+    auto isSame = [](const std::vector<BeatLine>& InLhs, const std::vector<BeatLine>& InRhs)
+    {
+        if (InLhs.size() != InRhs.size())
+            return false;
+
+        for (size_t i = 0; i < InLhs.size(); ++i)
+            if (InLhs[i].TimePoint != InRhs[i].TimePoint || InLhs[i].BeatCount != InRhs[i].BeatCount || InLhs[i].BeatSnap != InRhs[i].BeatSnap || InLhs[i].IsMeasure != InRhs[i].IsMeasure)
+                return false;
+
+        return true;
+    };
+
+    BeatModule cached;
+
+    // Scrolling both ways, zooming and jumping, the kept lines match the ones generated from scratch
+    const std::vector<std::pair<Time, Time>> windows = { { 0, 2000 }, { 150, 2150 }, { 1900, 3900 }, { 1500, 3500 }, { 2000, 2800 }, { 1000, 6000 }, { 6500, 9500 }, { 30000, 32000 }, { 500, 1500 } };
+
+    for (int division : { 4, 48 })
+    {
+        for (const auto& [timeBegin, timeEnd] : windows)
+        {
+            cached.GenerateTimeRangeBeatLines(timeBegin, timeEnd, &chart, division);
+
+            BeatModule fresh;
+            fresh.GenerateTimeRangeBeatLines(timeBegin, timeEnd, &chart, division);
+
+            ASSERT(isSame(collectLines(cached, timeBegin, timeEnd), collectLines(fresh, timeBegin, timeEnd)));
+        }
+    }
+
+    // A timing change drops the kept lines
+    cached.GenerateTimeRangeBeatLines(1000, 3000, &chart, 4);
+    chart.InjectBpmPoint(2000, 60.0, 1000.0);
+    cached.GenerateTimeRangeBeatLines(1100, 3100, &chart, 4);
+
+    BeatModule fresh;
+    fresh.GenerateTimeRangeBeatLines(1100, 3100, &chart, 4);
+    ASSERT(isSame(collectLines(cached, 1100, 3100), collectLines(fresh, 1100, 3100)));
+
+    // The lookups find what a scan over the lines finds
+    std::vector<BeatLine> lines = collectLines(cached, std::numeric_limits<Time>::min(), std::numeric_limits<Time>::max());
+
+    for (Time time = lines.front().TimePoint - 10; time < lines.back().TimePoint + 10; time += 7)
+    {
+        BeatLine previous = lines.front();
+        for (const auto& line : lines)
+            if (line.TimePoint < time)
+                previous = line;
+
+        BeatLine next = lines.back();
+        for (auto line = lines.rbegin(); line != lines.rend(); ++line)
+            if (line->TimePoint > time)
+                next = *line;
+
+        BeatLine closest = lines.back();
+        for (auto line = lines.rbegin(); line != lines.rend(); ++line)
+            if (line->TimePoint >= time - 2)
+                closest = *line;
+
+        ASSERT(cached.GetCurrentBeatLine(time).TimePoint == previous.TimePoint);
+        ASSERT(cached.GetCurrentBeatLine(time, 0, false).TimePoint == next.TimePoint);
+        ASSERT(cached.GetClosestBeatLineToTimePoint(time).TimePoint == closest.TimePoint);
+    }
+
+    return 0;
+}
+
+int TestTimingPropagation()
+{
+    Chart chart;
+    chart.KeyAmount = 4;
+    chart.InjectBpmPoint(1000, 120.0, 500.0);
+
+    for (int i = 0; i < 4000; ++i)
+        chart.InjectNote(1000 + i * 125, i % 4, Note::EType::Common);
+
+    BeatModule beatModule;
+    beatModule.AssignNotesToSnapsInChart(&chart);
+
+    Time timeBegin = 0;
+    Time timeEnd = 0;
+    ASSERT(!beatModule.PropagateTimingChanges(&chart, timeBegin, timeEnd));
+    ASSERT(!beatModule.IsPropagatingTimingChanges());
+
+    auto propagate = [&]()
+    {
+        bool isApplied = false;
+
+        do
+        {
+            isApplied |= beatModule.PropagateTimingChanges(&chart, timeBegin, timeEnd);
+            std::this_thread::yield();
+        } while (beatModule.IsPropagatingTimingChanges());
+
+        return isApplied;
+    };
+
+    auto isUpToDate = [&chart]()
+    {
+        const TempoMap& tempoMap = chart.GetTempoMap();
+        bool isUpToDate = true;
+
+        chart.IterateAllNotes([&tempoMap, &isUpToDate](Note& InNote, const Column)
+        {
+            isUpToDate &= InNote.BeatSnap == BeatModule::GetBeatSnapFromTime(tempoMap, InNote.TimePoint);
+            isUpToDate &= InNote.Position == tempoMap.GetBeatPosition(InNote.TimePoint);
+        });
+
+        return isUpToDate;
+    };
+
+    // A new bpm point reaches every note after it, and only those
+    chart.InjectBpmPoint(200010, 100.0, 600.0);
+    ASSERT(!isUpToDate());
+    ASSERT(propagate());
+    ASSERT(timeBegin == 200010 && timeEnd == 1000 + 3999 * 125 + 1);
+    ASSERT(isUpToDate());
+
+    // Timing changed while the worker is busy is picked up after it, the results before the change are kept
+    chart.InjectBpmPoint(300007, 150.0, 400.0);
+    beatModule.PropagateTimingChanges(&chart, timeBegin, timeEnd);
+    chart.InjectStop(250000, 0.1);
+    ASSERT(propagate());
+    ASSERT(isUpToDate());
+
+    // Moving the first bpm point shifts every beat, the notes before it included
+    BpmPoint formerFirst = *chart.GetBpmPointIndex().GetAll().front();
+    BpmPoint* first = chart.GetBpmPointIndex().GetAll().front();
+    first->TimePoint = 1063;
+    chart.RevaluateBpmPoint(formerFirst, *first);
+    ASSERT(propagate());
+    ASSERT(timeBegin == 1000);
+    ASSERT(isUpToDate());
+
+    return 0;
+}
+
+int TestTempoRebase()
+{
+    Chart chart;
+    chart.KeyAmount = 4;
+    chart.InjectBpmPoint(1000, 120.0, 500.0);
+    chart.InjectBpmPoint(5000, 240.0, 250.0);
+    chart.InjectSV(6000, 2.0);
+    chart.InjectStop(7000, 0.5);
+    chart.InjectTimeSignature(3000, 3, 4);
+
+    chart.InjectNote(500, 0, Note::EType::Common);
+    chart.InjectNote(1000, 0, Note::EType::Common);
+    chart.InjectNote(1500, 0, Note::EType::Common);
+    chart.InjectNote(3000, 0, Note::EType::Common);
+    chart.InjectHold(3000, 5500, 1);
+    chart.InjectNote(5250, 2, Note::EType::Common);
+    chart.InjectNote(8000, 2, Note::EType::Common);
+    chart.InjectHold(8000, 9000, 3);
+
+    const NoteHandle handle = chart.FindNote(1500, 0)->Handle;
+    const size_t undoSize = chart.UndoJournal.GetSize();
+
+    // Slowing down the first section keeps its notes on their beats, everything after the next bpm point follows rigidly
+    const TempoMap formerTempoMap = chart.GetTempoMap();
+    BpmPoint* first = chart.GetBpmPointIndex().GetAll().front();
+
+    chart.BeginTransaction();
+    chart.JournalTimingChange(first->TimePoint);
+    first->Bpm = 100.0;
+    first->BeatLength = 600.0;
+    chart.InvalidateTempoMap(first->TimePoint);
+    ASSERT(chart.RebaseTiming(formerTempoMap, 1000, { 1000 }));
+    chart.Commit();
+
+    ASSERT(chart.UndoJournal.GetSize() == undoSize + 1);
+
+    auto isRebased = [&chart]()
+    {
+        const Note* hold = chart.FindNote(3400, 1);
+        const Note* lateHold = chart.FindNote(8800, 3);
+
+        return chart.FindNote(500, 0) && chart.FindNote(1000, 0) && chart.FindNote(1600, 0) && chart.FindNote(3400, 0)
+            && hold && hold->TimePointEnd == 6300 && chart.FindNote(6300, 1) && chart.FindNote(6300, 1)->TimePointBegin == 3400
+            && chart.FindNote(6050, 2) && chart.FindNote(8800, 2)
+            && lateHold && lateHold->TimePointEnd == 9800 && chart.FindNote(9800, 3)
+            && chart.GetBpmPointIndex().GetAll().back()->TimePoint == 5800
+            && chart.GetSVIndex().GetAll().front()->TimePoint == 6800
+            && chart.GetStopIndex().GetAll().front()->TimePoint == 7800
+            && chart.GetTimeSignatureIndex().GetAll().front()->TimePoint == 3400
+            && chart.Notes.GetNoteAmount() == 10;
+    };
+
+    ASSERT(isRebased());
+    ASSERT(chart.ResolveNote(handle) && chart.ResolveNote(handle)->TimePoint == 1600);
+    ASSERT(std::abs(chart.GetTempoMap().GetBeatFromTime(8800) - formerTempoMap.GetBeatFromTime(8000)) < 0.001);
+
+    // One undo entry takes back the edit and the rebase together
+    ASSERT(chart.Undo());
+    ASSERT(chart.FindNote(1500, 0) && chart.FindNote(5250, 2) && chart.FindNote(9000, 3));
+    ASSERT(chart.GetBpmPointIndex().GetAll().back()->TimePoint == 5000);
+    ASSERT(chart.GetStopIndex().GetAll().front()->TimePoint == 7000);
+    ASSERT(chart.GetBpmPointIndex().GetAll().front()->BeatLength == 500.0);
+    ASSERT(chart.Redo());
+    ASSERT(isRebased());
+
+    // A rebase pulling two notes of a column onto the same timepoint leaves the chart untouched
+    Chart crowdedChart;
+    crowdedChart.KeyAmount = 4;
+    crowdedChart.InjectBpmPoint(0, 120.0, 500.0);
+    crowdedChart.InjectNote(1000, 0, Note::EType::Common);
+    crowdedChart.InjectNote(1001, 0, Note::EType::Common);
+
+    const TempoMap crowdedTempoMap = crowdedChart.GetTempoMap();
+    BpmPoint* crowdedFirst = crowdedChart.GetBpmPointIndex().GetAll().front();
+    crowdedFirst->Bpm = 12000.0;
+    crowdedFirst->BeatLength = 5.0;
+    crowdedChart.InvalidateTempoMap(0);
+
+    ASSERT(!crowdedChart.RebaseTiming(crowdedTempoMap, 0, { 0 }));
+    ASSERT(crowdedChart.FindNote(1000, 0) && crowdedChart.FindNote(1001, 0));
+
+    return 0;
+}
+
+int TestBaseOffset()
+{
+    Chart chart;
+    chart.KeyAmount = 4;
+    chart.InjectBpmPoint(1000, 120.0, 500.0);
+    chart.InjectNote(1000, 0, Note::EType::Common);
+    chart.InjectHold(1500, 2000, 1);
+
+    // Moving all notes shifts the base offset only, every timepoint stored stays as it is
+    const size_t undoSize = chart.UndoJournal.GetSize();
+    chart.MoveAllNotes(250);
+    ASSERT(chart.UndoJournal.GetSize() == undoSize + 1);
+    ASSERT(chart.GetBaseOffset() == 250);
+    ASSERT(chart.FindNote(1000, 0) && chart.FindNote(1500, 1) && chart.GetBpmPointIndex().GetAll().front()->TimePoint == 1000);
+    ASSERT(chart.ToSongTime(1000) == 1250 && chart.ToChartTime(1250) == 1000);
+
+    chart.MoveAllNotes(-50);
+    ASSERT(chart.GetBaseOffset() == 200);
+
+    ASSERT(chart.Undo());
+    ASSERT(chart.GetBaseOffset() == 250);
+    ASSERT(chart.Undo());
+    ASSERT(chart.GetBaseOffset() == 0);
+    ASSERT(chart.Redo());
+    ASSERT(chart.GetBaseOffset() == 250);
+
+    // Shifts spilled to disk come back with their offset
+    chart.SetHistoryMemoryBudget(1);
+    chart.MoveAllNotes(100);
+    chart.MoveAllNotes(100);
+    ASSERT(chart.UndoJournal.GetMemoryUsage().SpilledEntries > 0);
+    ASSERT(chart.Undo() && chart.Undo() && chart.Undo());
+    ASSERT(chart.GetBaseOffset() == 0);
+    ASSERT(chart.Redo() && chart.Redo() && chart.Redo());
+    ASSERT(chart.GetBaseOffset() == 450);
+
+    // The offset is baked into the timepoints on export
+    const std::filesystem::path osuPath = std::filesystem::temp_directory_path() / "leraine-base-offset-test.osu";
+    const std::filesystem::path smPath = std::filesystem::temp_directory_path() / "leraine-base-offset-test.sm";
+
+    ChartParserModule parser;
+
+    for (const auto& path : { osuPath, smPath })
+    {
+        parser.SetCurrentChartPath(path);
+        parser.ExportChartSet(&chart);
+
+        Chart* exported = parser.LoadChart(path);
+        ASSERT(exported->BaseOffset == 0.0);
+        ASSERT(exported->FindNote(1450, 0) && exported->FindNote(1950, 1) && exported->FindNote(1950, 1)->TimePointEnd == 2450);
+        ASSERT(exported->GetBpmPointIndex().GetAll().front()->TimePoint == 1450);
+        delete exported;
+
+        std::filesystem::remove(path);
+    }
+
+    ASSERT(chart.FindNote(1000, 0) && chart.GetBaseOffset() == 450);
+
+    return 0;
+}
+
+int TestScrollMap()
+{
+    // Without any timing every timepoint is its own position
+    Chart emptyChart;
+    ASSERT(emptyChart.GetScrollMap().IsEmpty());
+    ASSERT(emptyChart.GetScrollMap().GetPosition(1234) == 1234.0);
+    ASSERT(emptyChart.GetScrollMap().GetTimeFromPosition(-50.0) == -50.0);
+
+    Chart chart;
+    chart.KeyAmount = 4;
+    chart.InjectBpmPoint(0, 120.0, 500.0);
+    chart.InjectSV(1000, 0.5);
+    chart.InjectBpmPoint(2000, 240.0, 250.0);
+    chart.InjectStop(3000, 0.5);
+
+    // Half speed from the sv, doubled again by the tempo, and standing still through the stop
+    const ScrollMap& scrollMap = chart.GetScrollMap();
+    ASSERT(scrollMap.GetPosition(-100) == -100.0);
+    ASSERT(scrollMap.GetPosition(500) == 500.0);
+    ASSERT(scrollMap.GetPosition(1500) == 1250.0);
+    ASSERT(scrollMap.GetPosition(2500) == 2000.0);
+    ASSERT(scrollMap.GetPosition(3200) == 2500.0);
+    ASSERT(scrollMap.GetPosition(4000) == 3000.0);
+
+    ASSERT(scrollMap.GetTimeFromPosition(1250.0) == 1500.0);
+    ASSERT(scrollMap.GetTimeFromPosition(2500.0) == 3500.0);
+    ASSERT(scrollMap.GetTimeFromPosition(3000.0) == 4000.0);
+
+    // A cursor walking forwards and backwards agrees with the lookup everywhere
+    ScrollCursor scrollCursor(scrollMap);
+    for (Time time = -200; time < 5000; time += 7)
+        ASSERT(scrollCursor.GetPosition(time) == scrollMap.GetPosition(time));
+    for (Time time = 5000; time > -200; time -= 13)
+        ASSERT(scrollCursor.GetPosition(time) == scrollMap.GetPosition(time));
+
+    // Timing edits and sv changed in place both build the map again
+    chart.InjectSV(4000, 2.0);
+    ASSERT(chart.GetScrollMap().GetPosition(4500) == 5000.0);
+
+    chart.GetSVIndex().GetAll().back()->Multiplier = 1.0;
+    chart.InvalidateScrollMap();
+    ASSERT(chart.GetScrollMap().GetPosition(4500) == 4000.0);
+
+    // Inherited timing points of osu! come in as sv, a red line without one of its own resets the sv
+    const std::filesystem::path osuPath = std::filesystem::temp_directory_path() / "leraine-scroll-map-test.osu";
+    const std::filesystem::path exportPath = std::filesystem::temp_directory_path() / "leraine-scroll-map-export.osu";
+
+    {
+        std::ofstream file(osuPath);
+        file << "osu file format v14\n\n[Difficulty]\nCircleSize:4\n\n";
+        file << "[TimingPoints]\n0,500,4,0,0,10,1,0\n1000,-200,4,0,0,10,0,0\n2000,500,4,0,0,10,1,0\n3000,-50,4,0,0,10,0,0\n\n";
+        file << "[HitObjects]\n64,192,1000,1,0,0:0:0:0:\n";
+    }
+
+    ChartParserModule parser;
+
+    auto getSVs = [](Chart* InChart)
+    {
+        std::vector<std::pair<Time, double>> svs;
+        for (const auto* sv : InChart->GetSVIndex().GetAll())
+            svs.push_back({ sv->TimePoint, sv->Multiplier });
+        return svs;
+    };
+
+    Chart* osuChart = parser.LoadChart(osuPath);
+    const std::vector<std::pair<Time, double>> expectedSVs = { { 1000, 0.5 }, { 2000, 1.0 }, { 3000, 2.0 } };
+    ASSERT(getSVs(osuChart) == expectedSVs);
+    ASSERT(osuChart->GetBpmPointIndex().GetAll().size() == 2);
+
+    // An sv carried across a red line is written again after it
+    osuChart->RemoveSV(*osuChart->GetSVIndex().GetAll()[1]);
+
+    parser.SetCurrentChartPath(exportPath);
+    parser.ExportChartSet(osuChart);
+    delete osuChart;
+
+    Chart* roundTrip = parser.LoadChart(exportPath);
+    const std::vector<std::pair<Time, double>> roundTrippedSVs = { { 1000, 0.5 }, { 2000, 0.5 }, { 3000, 2.0 } };
+    ASSERT(getSVs(roundTrip) == roundTrippedSVs);
+    delete roundTrip;
+
+    std::filesystem::remove(osuPath);
+    std::filesystem::remove(exportPath);
+
+    return 0;
+}
+
 int main() {
     int result = 0;
     TEST(TestChartLogic);
@@ -196,6 +1800,30 @@ int main() {
     TEST(TestStops);
     TEST(TestStopEditing);
     TEST(TestSVEditing);
+    TEST(TestNoteStore);
+    TEST(TestLongNotes);
+    TEST(TestTempoMap);
+    TEST(TestUndoJournal);
+    TEST(TestUndoHistory);
+    TEST(TestNoteHandles);
+    TEST(TestBatchTransform);
+    TEST(TestChartBuilder);
+    TEST(TestTimeSliceCompaction);
+    TEST(TestTimingIndex);
+    TEST(TestChartSnapshots);
+    TEST(TestChartSet);
+    TEST(TestCompactSelection);
+    TEST(TestIncrementalDensity);
+    TEST(TestStrainRating);
+    TEST(TestPatternClassifier);
+    TEST(TestChartLinter);
+    TEST(TestAnalyticSnaps);
+    TEST(TestBeatPositions);
+    TEST(TestBeatLineCache);
+    TEST(TestTimingPropagation);
+    TEST(TestTempoRebase);
+    TEST(TestBaseOffset);
+    TEST(TestScrollMap);
 
     if (result == 0) std::cout << "All tests passed!" << std::endl;
     return result;